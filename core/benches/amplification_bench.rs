@@ -0,0 +1,136 @@
+//! Output Amplification Benchmarks
+//!
+//! The platform cost of the IME is the synthetic backspaces and characters
+//! it emits. Replays the corpora word by word (Telex, SPACE after each word)
+//! and reports emitted `backspace + chars` per typed keystroke, broken down
+//! by `EditCause`, for the default policy and for low-amplification mode
+//! (`Engine::set_low_amplification`). Also reports how many words end with
+//! different text under the two policies (the accuracy side of the trade-off).
+
+#[allow(dead_code)]
+#[path = "support/corpus.rs"]
+mod corpus;
+
+use criterion::{black_box, criterion_group, criterion_main, Criterion, Throughput};
+use goxviet_core::data::keys;
+use goxviet_core::engine::{Action, EditCause, Engine};
+
+const CAUSES: [(EditCause, &str); 6] = [
+    (EditCause::Compose, "compose"),
+    (EditCause::ToneReposition, "tone_reposition"),
+    (EditCause::AutoRestore, "auto_restore"),
+    (EditCause::InstantRestore, "instant_restore"),
+    (EditCause::Shortcut, "shortcut"),
+    (EditCause::Other, "other"),
+];
+
+#[derive(Default)]
+struct Amplification {
+    keystrokes: u64,
+    /// Emitted backspaces + chars per cause (indexed by `EditCause as u8`)
+    emitted: [u64; 7],
+    edits: [u64; 7],
+    /// Final on-screen text of each word
+    words: Vec<String>,
+}
+
+impl Amplification {
+    fn total(&self) -> u64 {
+        self.emitted.iter().sum()
+    }
+}
+
+/// Replay words and simulate the screen to get the committed text per word
+fn replay(words: &[Vec<(u16, bool)>], low_amplification: bool) -> Amplification {
+    let mut e = Engine::new();
+    e.set_method(0);
+    e.set_low_amplification(low_amplification);
+    let mut amp = Amplification::default();
+    let mut screen: Vec<char> = Vec::new();
+
+    for word in words {
+        screen.clear();
+        for &(key, caps) in word.iter().chain([(keys::SPACE, false)].iter()) {
+            let r = e.on_key(key, caps, false);
+            amp.keystrokes += 1;
+            let cause = e.last_edit_cause() as usize;
+            if r.action == Action::Send as u8 || r.action == Action::Restore as u8 {
+                amp.emitted[cause] += r.backspace as u64 + r.count as u64;
+                amp.edits[cause] += 1;
+                let keep = screen.len().saturating_sub(r.backspace as usize);
+                screen.truncate(keep);
+                screen.extend(r.as_slice().iter().filter_map(|&c| char::from_u32(c)));
+            } else if key == keys::SPACE {
+                screen.push(' ');
+            } else if let Some(c) = goxviet_core::utils::key_to_char(key, caps) {
+                screen.push(c);
+            }
+            r.release();
+        }
+        amp.words
+            .push(screen.iter().collect::<String>().trim_end().to_string());
+    }
+    amp
+}
+
+fn report(name: &str, words: &[Vec<(u16, bool)>]) {
+    let base = replay(words, false);
+    let low = replay(words, true);
+    let changed = corpus::words_differ(&base.words, &low.words);
+
+    println!(
+        "{name}: {} words, {} keystrokes",
+        words.len(),
+        base.keystrokes
+    );
+    for (label, amp) in [("  default", &base), ("  low_amplification", &low)] {
+        let per_key = |n: u64| n as f64 / amp.keystrokes.max(1) as f64;
+        let causes: Vec<String> = CAUSES
+            .iter()
+            .filter(|(c, _)| amp.edits[*c as usize] > 0)
+            .map(|(c, n)| {
+                let i = *c as usize;
+                format!(
+                    "{n} {:.4} ({} edits)",
+                    per_key(amp.emitted[i]),
+                    amp.edits[i]
+                )
+            })
+            .collect();
+        println!(
+            "{label}: {:.4} emitted/keystroke | {}",
+            per_key(amp.total()),
+            causes.join(", ")
+        );
+    }
+    println!(
+        "  trade-off: {:.1}% fewer emitted units, {} words ({:.2}%) end differently",
+        100.0 * (1.0 - low.total() as f64 / base.total().max(1) as f64),
+        changed,
+        100.0 * changed as f64 / words.len().max(1) as f64
+    );
+}
+
+fn bench_amplification(c: &mut Criterion) {
+    let vietnamese = corpus::load_words(corpus::VIETNAMESE, usize::MAX);
+    let english = corpus::load_words(corpus::ENGLISH, 20_000);
+    let prose = corpus::mixed(&vietnamese, &english);
+    report("vietnamese_22k", &vietnamese);
+    report("english_100k (first 20k)", &english);
+    report("mixed prose (4 vi : 1 en)", &prose);
+
+    let sample: Vec<_> = prose.iter().take(2_000).cloned().collect();
+    let keystrokes = corpus::keystrokes(&sample);
+    let mut group = c.benchmark_group("amplification_replay");
+    group.throughput(Throughput::Elements(keystrokes));
+    group.bench_function("default", |b| {
+        b.iter(|| black_box(replay(&sample, false).total()))
+    });
+    group.bench_function("low_amplification", |b| {
+        b.iter(|| black_box(replay(&sample, true).total()))
+    });
+    group.finish();
+}
+
+criterion_group!(benches, bench_amplification);
+criterion_main!(benches);
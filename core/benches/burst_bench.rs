@@ -0,0 +1,94 @@
+//! Burst Mode Benchmarks
+//!
+//! A machine-speed burst of mixed Vietnamese/English text with a few
+//! corrections, handled through the FFI the way a host would:
+//! - `per_key`: every key through `ime_key_ext`; the host injects each edit
+//! - `burst`: keys offered to `ime_burst_key` (queued), then one
+//!   `ime_burst_end` edit
+//!
+//! Reports processed keys/second (criterion throughput) and prints the
+//! injection work each way: edits (separate injections) and synthetic
+//! events (backspaces + characters).
+
+use criterion::{black_box, criterion_group, criterion_main, Criterion, Throughput};
+use goxviet_core::input::layout::translate_char;
+use goxviet_core::{
+    ime_burst_begin, ime_burst_end, ime_burst_key, ime_clear_all, ime_free, ime_free_wide,
+    ime_init, ime_key_ext,
+};
+
+const SESSION: &str = "tieengs vieejt laf ngoon nguwx cuar nguwowif vieejt nam \
+                       the restore process should keep english words intact \
+                       chungs toi ddang hocj\x08\x08cj tieengs anh vaf phaps ";
+
+fn burst_keys(repeat: usize) -> Vec<(u16, bool, bool)> {
+    SESSION
+        .repeat(repeat)
+        .chars()
+        .map(|c| {
+            let k = translate_char(c).unwrap();
+            (k.key, k.caps, k.shift)
+        })
+        .collect()
+}
+
+/// Per-key handling; returns (edits, synthetic events)
+fn per_key(stream: &[(u16, bool, bool)]) -> (usize, usize) {
+    let (mut edits, mut events) = (0, 0);
+    for &(key, caps, shift) in stream {
+        let r = ime_key_ext(key, caps, false, shift);
+        // SAFETY: non-null results from ime_key_ext, freed once
+        unsafe {
+            if (*r).action != 0 {
+                edits += 1;
+                events += (*r).backspace as usize + (*r).count as usize;
+            }
+            ime_free(black_box(r));
+        }
+    }
+    ime_clear_all();
+    (edits, events)
+}
+
+/// One burst; returns (edits, synthetic events)
+fn burst(stream: &[(u16, bool, bool)]) -> (usize, usize) {
+    ime_burst_begin();
+    for &(key, caps, shift) in stream {
+        let status = ime_burst_key(key, caps, false, shift, 0); // 1: queued
+        black_box(status);
+    }
+    let r = ime_burst_end(u32::MAX);
+    ime_clear_all();
+    // SAFETY: non-null result from ime_burst_end, freed once
+    unsafe {
+        let events = (*r).backspace as usize + (*r).count as usize;
+        ime_free_wide(black_box(r));
+        (1, events)
+    }
+}
+
+fn bench_burst(c: &mut Criterion) {
+    ime_init();
+    let mut group = c.benchmark_group("burst");
+    for repeat in [1usize, 10] {
+        let stream = burst_keys(repeat);
+        let (edits, events) = per_key(&stream);
+        let (burst_edits, burst_events) = burst(&stream);
+        println!(
+            "{} keys: per_key {edits} edits / {events} events, \
+             burst {burst_edits} edit / {burst_events} events",
+            stream.len(),
+        );
+        group.throughput(Throughput::Elements(stream.len() as u64));
+        group.bench_function(format!("per_key/{}", stream.len()), |b| {
+            b.iter(|| per_key(&stream))
+        });
+        group.bench_function(format!("burst/{}", stream.len()), |b| {
+            b.iter(|| burst(&stream))
+        });
+    }
+    group.finish();
+}
+
+criterion_group!(benches, bench_burst);
+criterion_main!(benches);
@@ -0,0 +1,91 @@
+//! Cold Start Benchmarks
+//!
+//! Measures `ime_init` through the first keystrokes in a fresh process,
+//! where no page, allocator arena or lazy table is warm yet. Every sample
+//! re-runs this binary with `GOXVIET_COLD_START=<scenario>`; the child
+//! times one scenario through the C ABI and prints the nanoseconds.
+//!
+//! - `init`: `ime_init` alone
+//! - `first_key`: `ime_init` + one key
+//! - `first_word`: `ime_init` + "vieetj" + space (word commit)
+//! - `first_english_word`: `ime_init` + "console" + space (dictionary
+//!   lookups fault in the word lists)
+//! - `first_english_word_prefetched`: same, after `Dictionary::prefetch`
+//!   ran before the clock started (what `ime_prefetch_dictionaries` does
+//!   in the background)
+
+use criterion::{criterion_group, Criterion};
+use goxviet_core::engine::Dictionary;
+use goxviet_core::utils::char_to_key;
+use goxviet_core::{ime_free, ime_init, ime_key_ext};
+use std::process::Command;
+use std::time::{Duration, Instant};
+
+const SCENARIO_ENV: &str = "GOXVIET_COLD_START";
+
+const SCENARIOS: [&str; 5] = [
+    "init",
+    "first_key",
+    "first_word",
+    "first_english_word",
+    "first_english_word_prefetched",
+];
+
+fn type_keys(text: &str) {
+    for c in text.chars() {
+        let r = ime_key_ext(char_to_key(c), false, false, false);
+        unsafe { ime_free(r) };
+    }
+}
+
+/// Child side: time one scenario, print nanoseconds
+fn run_scenario(scenario: &str) {
+    if scenario == "first_english_word_prefetched" {
+        Dictionary::prefetch();
+    }
+    let start = Instant::now();
+    ime_init();
+    match scenario {
+        "first_key" => type_keys("v"),
+        "first_word" => type_keys("vieetj "),
+        "first_english_word" | "first_english_word_prefetched" => type_keys("console "),
+        _ => {}
+    }
+    println!("{}", start.elapsed().as_nanos());
+}
+
+/// Parent side: one fresh process per sample
+fn spawn_scenario(exe: &std::path::Path, scenario: &str) -> Duration {
+    let output = Command::new(exe)
+        .env(SCENARIO_ENV, scenario)
+        .output()
+        .expect("re-run benchmark binary");
+    let nanos = String::from_utf8_lossy(&output.stdout)
+        .trim()
+        .parse()
+        .expect("child prints nanoseconds");
+    Duration::from_nanos(nanos)
+}
+
+fn bench_cold_start(c: &mut Criterion) {
+    let exe = std::env::current_exe().expect("benchmark binary path");
+    let mut group = c.benchmark_group("cold_start");
+    group.sample_size(20);
+    for scenario in SCENARIOS {
+        group.bench_function(scenario, |b| {
+            b.iter_custom(|iters| (0..iters).map(|_| spawn_scenario(&exe, scenario)).sum())
+        });
+    }
+    group.finish();
+}
+
+criterion_group!(benches, bench_cold_start);
+
+fn main() {
+    if let Ok(scenario) = std::env::var(SCENARIO_ENV) {
+        run_scenario(&scenario);
+        return;
+    }
+    benches();
+    Criterion::default().configure_from_args().final_summary();
+}
@@ -0,0 +1,59 @@
+//! Commit Event Benchmarks
+//!
+//! Key-path cost of publishing committed words, typing a Telex sentence
+//! (16 commits per pass):
+//! - `typing/off`: no ring attached (baseline)
+//! - `typing/on`: ring attached, drained after each pass
+//! - `ring/push`: one record published and drained (producer + consumer)
+//!
+//! Draining runs on the benchmark thread so single-core machines measure
+//! the ring rather than a spinning consumer.
+
+use criterion::{black_box, criterion_group, criterion_main, Criterion, Throughput};
+use goxviet_core::engine::features::{CommitKind, CommitRecord, CommitRing};
+use goxviet_core::engine::Engine;
+use goxviet_core::utils::char_to_key;
+
+const TEXT: &str =
+    "Tieengs Vieejt laf ngoon nguwx cuar nguwowif Vieejt Nam, dduowcj dungf roongj raix. ";
+
+static RING: CommitRing = CommitRing::new();
+
+fn bench_typing(c: &mut Criterion) {
+    let text: Vec<(u16, bool)> = TEXT
+        .chars()
+        .map(|c| (char_to_key(c), c.is_uppercase()))
+        .collect();
+    let mut group = c.benchmark_group("typing");
+    group.throughput(Throughput::Elements(text.len() as u64));
+
+    let mut out = [CommitRecord::EMPTY; 32];
+    for (name, ring) in [("off", None), ("on", Some(&RING))] {
+        let mut e = Engine::new();
+        e.set_commit_ring(ring);
+        group.bench_function(name, |b| {
+            b.iter(|| {
+                for &(key, caps) in &text {
+                    e.on_key_ext(key, caps, false, false).release();
+                }
+                RING.drain(&mut out)
+            })
+        });
+    }
+    group.finish();
+    assert_eq!(RING.dropped(), 0);
+}
+
+fn bench_ring(c: &mut Criterion) {
+    let word: Vec<char> = "nguyễn".chars().collect();
+    let mut out = [CommitRecord::EMPTY; 1];
+    c.bench_function("ring/push", |b| {
+        b.iter(|| {
+            RING.push(49, CommitKind::Vietnamese, black_box(&word));
+            RING.drain(&mut out)
+        })
+    });
+}
+
+criterion_group!(benches, bench_typing, bench_ring);
+criterion_main!(benches);
@@ -0,0 +1,112 @@
+//! Composition Mode Benchmarks
+//!
+//! Replays the Vietnamese (Telex) and English corpora word by word and
+//! compares direct mode with composition (preedit) mode:
+//! - Injected events, using the macOS injection model (each backspace and
+//!   each 20-UTF-16-unit text chunk is a key down + key up pair)
+//! - Marked-text updates in composition mode (not injected)
+//! - Engine time per keystroke in both modes
+
+#[allow(dead_code)]
+#[path = "support/corpus.rs"]
+mod corpus;
+
+use criterion::{black_box, criterion_group, criterion_main, Criterion, Throughput};
+use goxviet_core::data::keys;
+use goxviet_core::engine::{Action, Engine, Result};
+
+/// Text chunk size used by the platform injector (UTF-16 units)
+const CHUNK_UTF16: usize = 20;
+
+#[derive(Default, Debug)]
+struct Events {
+    keystrokes: u64,
+    injected: u64,
+    marked_updates: u64,
+}
+
+/// Injected key events for a backspace+text edit
+fn edit_events(r: &Result) -> u64 {
+    let utf16: usize = r
+        .as_slice()
+        .iter()
+        .filter_map(|&c| char::from_u32(c))
+        .map(char::len_utf16)
+        .sum();
+    2 * r.backspace as u64 + 2 * utf16.div_ceil(CHUNK_UTF16) as u64
+}
+
+fn count(r: &Result, ev: &mut Events) {
+    match r.action {
+        a if a == Action::Send as u8 || a == Action::Restore as u8 => {
+            ev.injected += edit_events(r);
+        }
+        a if a == Action::Preedit as u8 => {
+            ev.marked_updates += 1;
+            // Pulling a restored word back from the document
+            ev.injected += 2 * r.backspace as u64;
+        }
+        a if a == Action::Commit as u8 || a == Action::CommitPassThrough as u8 => {
+            ev.injected += edit_events(r);
+        }
+        _ => {}
+    }
+}
+
+fn replay(words: &[Vec<(u16, bool)>], composition: bool) -> Events {
+    let mut e = Engine::new();
+    e.set_method(0);
+    e.set_composition_mode(composition);
+    let mut ev = Events::default();
+    for word in words {
+        for &(key, caps) in word.iter().chain([(keys::SPACE, false)].iter()) {
+            let r = e.on_key(key, caps, false);
+            ev.keystrokes += 1;
+            count(&r, &mut ev);
+            r.release();
+        }
+    }
+    let r = e.commit_preedit();
+    count(&r, &mut ev);
+    r.release();
+    ev
+}
+
+fn report(name: &str, words: &[Vec<(u16, bool)>]) {
+    let direct = replay(words, false);
+    let composed = replay(words, true);
+    let saved = direct.injected.saturating_sub(composed.injected);
+    println!(
+        "{name}: {} words, {} keystrokes | direct {} injected | composition {} injected + {} marked-text updates | saved {} ({:.1}%)",
+        words.len(),
+        direct.keystrokes,
+        direct.injected,
+        composed.injected,
+        composed.marked_updates,
+        saved,
+        100.0 * saved as f64 / direct.injected.max(1) as f64
+    );
+}
+
+fn bench_composition(c: &mut Criterion) {
+    let vietnamese = corpus::load_words(corpus::VIETNAMESE, usize::MAX);
+    let english = corpus::load_words(corpus::ENGLISH, 20_000);
+    report("vietnamese_22k", &vietnamese);
+    report("english_100k (first 20k)", &english);
+
+    let sample: Vec<_> = vietnamese.iter().take(2_000).cloned().collect();
+    let keystrokes = corpus::keystrokes(&sample);
+
+    let mut group = c.benchmark_group("composition_replay");
+    group.throughput(Throughput::Elements(keystrokes));
+    group.bench_function("direct", |b| {
+        b.iter(|| black_box(replay(&sample, false).injected))
+    });
+    group.bench_function("composition", |b| {
+        b.iter(|| black_box(replay(&sample, true).injected))
+    });
+    group.finish();
+}
+
+criterion_group!(benches, bench_composition);
+criterion_main!(benches);
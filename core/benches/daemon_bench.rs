@@ -0,0 +1,164 @@
+//! Daemon Benchmarks
+//!
+//! Round-trip latency and throughput of typing through `goxviet-daemon`
+//! (in-process `Daemon` on a temporary socket, real Unix socket I/O):
+//!
+//! - `round_trip/ping`: protocol floor, no engine work
+//! - `round_trip/key`: one key per request
+//! - `round_trip/batch_32`: 32 keys per request
+//! - `throughput/<clients>x<batch>`: N client threads typing concurrently,
+//!   each on its own connection; time per key across all clients
+//!
+//! Compare with in-process typing of the same text (`Engine::on_key_ext`
+//! directly), ~1µs per key in release builds.
+
+#[cfg(unix)]
+mod unix {
+    use criterion::{criterion_group, Criterion, Throughput};
+    use goxviet_core::daemon::{Client, Daemon, KeyEvent, StopHandle};
+    use goxviet_core::utils::char_to_key;
+    use std::path::PathBuf;
+    use std::sync::{Arc, Barrier, Mutex, OnceLock};
+    use std::thread::JoinHandle;
+    use std::time::{Duration, Instant};
+
+    const TEXT: &str = "vieetj nam tieengs vieetj hoaf binhf console ";
+
+    /// Daemon shared by all benchmark groups
+    struct BenchDaemon {
+        path: PathBuf,
+        stop: StopHandle,
+        thread: Mutex<Option<JoinHandle<std::io::Result<()>>>>,
+    }
+
+    static DAEMON: OnceLock<BenchDaemon> = OnceLock::new();
+
+    fn daemon_path() -> &'static PathBuf {
+        let daemon = DAEMON.get_or_init(|| {
+            let path =
+                std::env::temp_dir().join(format!("goxviet-bench-{}.sock", std::process::id()));
+            let daemon = Daemon::bind(&path).expect("bind bench socket");
+            let stop = daemon.stop_handle();
+            let thread = std::thread::spawn(move || daemon.serve());
+            BenchDaemon {
+                path,
+                stop,
+                thread: Mutex::new(Some(thread)),
+            }
+        });
+        &daemon.path
+    }
+
+    /// Stop the shared daemon, if a benchmark started it; its socket file
+    /// is removed once `serve()` has returned
+    pub fn stop_daemon() {
+        if let Some(daemon) = DAEMON.get() {
+            daemon.stop.stop();
+            if let Some(thread) = daemon.thread.lock().unwrap().take() {
+                let _ = thread.join();
+            }
+        }
+    }
+
+    /// Endless key stream cycling through `TEXT`
+    fn key_stream() -> impl Iterator<Item = KeyEvent> {
+        TEXT.chars()
+            .map(|c| KeyEvent::new(char_to_key(c), false))
+            .collect::<Vec<_>>()
+            .into_iter()
+            .cycle()
+    }
+
+    /// Send `iters` batches of `batch` keys on one connection
+    fn type_batches(
+        client: &mut Client,
+        keys: &mut impl Iterator<Item = KeyEvent>,
+        batch: usize,
+        iters: u64,
+    ) {
+        let mut buf = Vec::with_capacity(batch);
+        for _ in 0..iters {
+            buf.clear();
+            buf.extend(keys.by_ref().take(batch));
+            let replies = client.keys(0, &buf).expect("keys round trip");
+            criterion::black_box(replies.count());
+        }
+    }
+
+    fn bench_round_trip(c: &mut Criterion) {
+        let mut client = Client::connect(daemon_path()).unwrap();
+        let mut keys = key_stream();
+        let mut group = c.benchmark_group("round_trip");
+        group.bench_function("ping", |b| b.iter(|| client.ping().unwrap()));
+        group.bench_function("key", |b| {
+            b.iter_custom(|iters| {
+                let start = Instant::now();
+                type_batches(&mut client, &mut keys, 1, iters);
+                start.elapsed()
+            })
+        });
+        group.throughput(Throughput::Elements(32));
+        group.bench_function("batch_32", |b| {
+            b.iter_custom(|iters| {
+                let start = Instant::now();
+                type_batches(&mut client, &mut keys, 32, iters);
+                start.elapsed()
+            })
+        });
+        group.finish();
+    }
+
+    /// Wall time for `clients` threads to each send `iters` batches
+    fn concurrent(path: &PathBuf, clients: usize, batch: usize, iters: u64) -> Duration {
+        let barrier = Arc::new(Barrier::new(clients + 1));
+        let handles: Vec<_> = (0..clients)
+            .map(|_| {
+                let path = path.clone();
+                let barrier = Arc::clone(&barrier);
+                std::thread::spawn(move || {
+                    let mut client = Client::connect(&path).unwrap();
+                    client.ping().unwrap();
+                    let mut keys = key_stream();
+                    barrier.wait();
+                    type_batches(&mut client, &mut keys, batch, iters);
+                })
+            })
+            .collect();
+        barrier.wait();
+        let start = Instant::now();
+        for h in handles {
+            h.join().unwrap();
+        }
+        start.elapsed()
+    }
+
+    fn bench_throughput(c: &mut Criterion) {
+        let path = daemon_path();
+        let mut group = c.benchmark_group("throughput");
+        group.sample_size(10);
+        for clients in [1, 8, 32] {
+            for batch in [1, 32] {
+                group.throughput(Throughput::Elements((clients * batch) as u64));
+                group.bench_function(format!("{clients}x{batch}"), |b| {
+                    b.iter_custom(|iters| concurrent(path, clients, batch, iters))
+                });
+            }
+        }
+        group.finish();
+    }
+
+    criterion_group!(benches, bench_round_trip, bench_throughput);
+}
+
+// `criterion_main!` plus stopping the daemon, so no socket file is left
+#[cfg(unix)]
+fn main() {
+    unix::benches();
+    criterion::Criterion::default()
+        .configure_from_args()
+        .final_summary();
+    unix::stop_daemon();
+}
+
+#[cfg(not(unix))]
+fn main() {}
@@ -0,0 +1,178 @@
+//! Edit Planner Simulator Benchmarks
+//!
+//! Replays the corpora word by word (Telex, SPACE after each word) against
+//! a simulated screen, once with the engine's own "N backspaces + text"
+//! edits and once with edits planned for each injection cost model
+//! (`Engine::set_edit_costs`). Reports the total injection cost of both,
+//! how the planner injected its edits, and how many words end with
+//! different text (must be 0: planning never changes what is typed).
+//!
+//! The cost models are rough per-method prices (µs) from the delays that
+//! the macOS `TextInjectionHelper` uses for each injection method.
+
+#[allow(dead_code)]
+#[path = "support/corpus.rs"]
+mod corpus;
+
+use criterion::{black_box, criterion_group, criterion_main, Criterion, Throughput};
+use goxviet_core::data::keys;
+use goxviet_core::engine::edit_plan::COST_UNSUPPORTED;
+use goxviet_core::engine::{Action, EditCosts, Engine};
+
+const MODELS: [(&str, EditCosts); 5] = [
+    (
+        "instant",
+        EditCosts {
+            per_edit: 50,
+            per_backspace: 5,
+            per_char: 5,
+            per_replace: COST_UNSUPPORTED,
+            per_deferred_key: COST_UNSUPPORTED,
+        },
+    ),
+    (
+        "slow (terminals)",
+        EditCosts {
+            per_edit: 8000,
+            per_backspace: 3000,
+            per_char: 3000,
+            per_replace: COST_UNSUPPORTED,
+            per_deferred_key: COST_UNSUPPORTED,
+        },
+    ),
+    (
+        "selection",
+        EditCosts {
+            per_edit: 500,
+            per_backspace: 200,
+            per_char: 200,
+            per_replace: 400,
+            per_deferred_key: COST_UNSUPPORTED,
+        },
+    ),
+    (
+        "autocomplete",
+        EditCosts {
+            per_edit: 8000,
+            per_backspace: 1000,
+            per_char: 200,
+            per_replace: COST_UNSUPPORTED,
+            per_deferred_key: 2000,
+        },
+    ),
+    (
+        "ax_direct",
+        EditCosts {
+            per_edit: 5000,
+            per_backspace: 1,
+            per_char: 1,
+            per_replace: 0,
+            per_deferred_key: 500,
+        },
+    ),
+];
+
+#[derive(Default)]
+struct Replay {
+    cost: u64,
+    /// Edits injected as backspaces + text / as range replacements
+    sends: u64,
+    replaces: u64,
+    /// Keys shown as typed while their word was deferred
+    deferred_keys: u64,
+    /// Final on-screen text of each word
+    words: Vec<String>,
+}
+
+/// Replay words against a simulated screen, pricing each edit with `costs`
+/// (`plan`: the engine plans for them, else plain engine edits)
+fn replay(words: &[Vec<(u16, bool)>], costs: &EditCosts, plan: bool) -> Replay {
+    let mut e = Engine::new();
+    e.set_method(0);
+    if plan {
+        e.set_edit_costs(*costs);
+    }
+    let mut out = Replay::default();
+    let mut screen: Vec<char> = Vec::new();
+
+    for word in words {
+        screen.clear();
+        for &(key, caps) in word.iter().chain([(keys::SPACE, false)].iter()) {
+            let r = e.on_key(key, caps, false);
+            let bs = r.backspace as usize;
+            out.cost += costs.edit_cost(r.action, bs, r.count as usize);
+            let chars = r.as_slice().iter().filter_map(|&c| char::from_u32(c));
+            if r.action == Action::ReplaceRange as u8 {
+                out.replaces += 1;
+                let end = screen.len() - r.keep as usize;
+                screen.splice(end - bs..end, chars);
+            } else if r.action != Action::None as u8 {
+                out.sends += 1;
+                screen.truncate(screen.len().saturating_sub(bs));
+                screen.extend(chars);
+            } else if key == keys::SPACE {
+                screen.push(' ');
+            } else if let Some(c) = goxviet_core::utils::key_to_char(key, caps) {
+                screen.push(c);
+            }
+            if e.edit_deferred() {
+                out.deferred_keys += 1;
+                out.cost += costs.per_deferred_key as u64;
+            }
+            r.release();
+        }
+        out.words
+            .push(screen.iter().collect::<String>().trim_end().to_string());
+    }
+    out
+}
+
+fn report(name: &str, words: &[Vec<(u16, bool)>]) {
+    let keystrokes = corpus::keystrokes(words);
+    println!("{name}: {} words, {keystrokes} keystrokes", words.len());
+    for (model, costs) in &MODELS {
+        let plain = replay(words, costs, false);
+        let planned = replay(words, costs, true);
+        let changed = corpus::words_differ(&plain.words, &planned.words);
+        println!(
+            "  {model}: plain {:.2} s ({} edits) | planned {:.2} s ({:.1}% less): \
+             {} send, {} replace_range, {} deferred keys | {changed} words differ",
+            plain.cost as f64 / 1e6,
+            plain.sends,
+            planned.cost as f64 / 1e6,
+            100.0 * (1.0 - planned.cost as f64 / plain.cost.max(1) as f64),
+            planned.sends,
+            planned.replaces,
+            planned.deferred_keys,
+        );
+    }
+}
+
+fn bench_edit_plan(c: &mut Criterion) {
+    let vietnamese = corpus::load_words(corpus::VIETNAMESE, usize::MAX);
+    let english = corpus::load_words(corpus::ENGLISH, 20_000);
+    let prose = corpus::mixed(&vietnamese, &english);
+    report("vietnamese_22k", &vietnamese);
+    report("english_100k (first 20k)", &english);
+    report("mixed prose (4 vi : 1 en)", &prose);
+
+    let sample: Vec<_> = prose.iter().take(2_000).cloned().collect();
+    let keystrokes = corpus::keystrokes(&sample);
+    let mut group = c.benchmark_group("edit_plan_replay");
+    group.throughput(Throughput::Elements(keystrokes));
+    let (_, selection) = MODELS[2];
+    let (_, ax) = MODELS[4];
+    group.bench_function("plain", |b| {
+        b.iter(|| black_box(replay(&sample, &selection, false).cost))
+    });
+    group.bench_function("planned_selection", |b| {
+        b.iter(|| black_box(replay(&sample, &selection, true).cost))
+    });
+    group.bench_function("planned_ax_direct", |b| {
+        b.iter(|| black_box(replay(&sample, &ax, true).cost))
+    });
+    group.finish();
+}
+
+criterion_group!(benches, bench_edit_plan);
+criterion_main!(benches);
@@ -0,0 +1,91 @@
+//! Long Expansion Benchmarks
+//!
+//! Types a snippet trigger + SPACE and delivers a long expansion:
+//! - `u8_split`: the expansion cut into 255-character `Result`s, one
+//!   allocation and platform call per piece (the pre-wide workaround)
+//! - `wide_inline`: `on_key_wide` returns the whole expansion (the UTF-32
+//!   buffer moves into the result, no copy)
+//! - `wide_chunked`: `on_key_wide` + `read_expansion` into a reused
+//!   512-character stack buffer
+
+use criterion::{black_box, criterion_group, criterion_main, Criterion, Throughput};
+use goxviet_core::data::keys;
+use goxviet_core::engine::shortcut::Shortcut;
+use goxviet_core::engine::{Engine, Result};
+
+const TRIGGER: [u16; 3] = [keys::S, keys::I, keys::G];
+
+fn engine(text: &str) -> Engine {
+    let mut e = Engine::new();
+    e.set_method(0);
+    e.shortcuts_mut().add(Shortcut::snippet("sig", text));
+    e
+}
+
+fn u8_split(e: &mut Engine, text: &[char]) -> usize {
+    for &k in &TRIGGER {
+        e.on_key_ext(k, false, false, false).release();
+    }
+    e.on_key_ext(keys::SPACE, false, false, false).release();
+    let mut delivered = 0;
+    for piece in text.chunks(u8::MAX as usize) {
+        let r = Result::send(0, piece);
+        delivered += black_box(r.as_slice()).len();
+        r.release();
+    }
+    delivered
+}
+
+fn wide_inline(e: &mut Engine) -> usize {
+    for &k in &TRIGGER {
+        e.on_key_wide(k, false, false, false, usize::MAX).release();
+    }
+    let w = e.on_key_wide(keys::SPACE, false, false, false, usize::MAX);
+    let n = black_box(w.as_slice()).len();
+    w.release();
+    n
+}
+
+fn wide_chunked(e: &mut Engine) -> usize {
+    for &k in &TRIGGER {
+        e.on_key_wide(k, false, false, false, 0).release();
+    }
+    e.on_key_wide(keys::SPACE, false, false, false, 0).release();
+    let mut out = [0u32; 512];
+    let mut delivered = 0;
+    loop {
+        let n = e.read_expansion(&mut out);
+        if n == 0 {
+            break;
+        }
+        delivered += black_box(&out[..n]).len();
+    }
+    delivered
+}
+
+fn bench_expansion(c: &mut Criterion) {
+    for len in [1_000usize, 20_000] {
+        let text: String = "Trân trọng cảm ơn quý khách. "
+            .chars()
+            .cycle()
+            .take(len)
+            .collect();
+        let chars: Vec<char> = text.chars().collect();
+        let mut e = engine(&text);
+        println!(
+            "expansion {len} chars: u8 path needs {} results, wide path 1 result (inline) or {} reads of 512",
+            len.div_ceil(u8::MAX as usize),
+            (len + 1).div_ceil(512)
+        );
+
+        let mut group = c.benchmark_group(format!("expansion_{len}"));
+        group.throughput(Throughput::Elements(len as u64));
+        group.bench_function("u8_split", |b| b.iter(|| u8_split(&mut e, &chars)));
+        group.bench_function("wide_inline", |b| b.iter(|| wide_inline(&mut e)));
+        group.bench_function("wide_chunked", |b| b.iter(|| wide_chunked(&mut e)));
+        group.finish();
+    }
+}
+
+criterion_group!(benches, bench_expansion);
+criterion_main!(benches);
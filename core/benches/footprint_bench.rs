@@ -0,0 +1,80 @@
+//! Footprint Benchmarks (startup side)
+//!
+//! Run once per feature set to compare minimal and full builds:
+//! - Cold start: first engine + first words in a fresh process, which
+//!   includes page-ins of the embedded dictionaries
+//! - Warm engine construction and init-to-first-word latency
+//! - Steady-state typing of a mixed Vietnamese/English sentence
+//!
+//! `scripts/footprint_bench.sh` builds both configurations, reports the
+//! library sizes and runs this bench for each.
+
+use criterion::{black_box, criterion_group, criterion_main, Criterion};
+use goxviet_core::engine::Engine;
+use goxviet_core::utils::type_word;
+use goxviet_core::{
+    compiled_features, FEATURE_DICTIONARIES, FEATURE_ENCODING, FEATURE_ENGLISH_DETECTION,
+    FEATURE_SHORTCUTS, FEATURE_UPDATER,
+};
+use std::time::Instant;
+
+const SENTENCE: &str = "tieengs vieetj cos console vaf release nuwowcs ngoaif ";
+
+/// Short label for the compiled feature set ("full", "minimal" or a list)
+fn build_label() -> String {
+    let bits = compiled_features();
+    let names = [
+        (FEATURE_ENGLISH_DETECTION, "english"),
+        (FEATURE_DICTIONARIES, "dict"),
+        (FEATURE_SHORTCUTS, "shortcuts"),
+        (FEATURE_ENCODING, "encoding"),
+        (FEATURE_UPDATER, "updater"),
+    ];
+    if names.iter().all(|(bit, _)| bits & bit != 0) {
+        return "full".to_string();
+    }
+    let on: Vec<&str> = names
+        .iter()
+        .filter(|(bit, _)| bits & bit != 0)
+        .map(|(_, name)| *name)
+        .collect();
+    if on.is_empty() {
+        "minimal".to_string()
+    } else {
+        on.join("+")
+    }
+}
+
+fn bench_footprint(c: &mut Criterion) {
+    let label = build_label();
+
+    // Must run before anything else touches the engine or its data
+    let start = Instant::now();
+    let mut e = Engine::new();
+    let screen = type_word(&mut e, SENTENCE);
+    println!(
+        "[{label}] cold start (engine + first sentence): {:.1} µs -> {screen:?}",
+        start.elapsed().as_secs_f64() * 1e6
+    );
+
+    let mut group = c.benchmark_group(format!("footprint[{label}]"));
+
+    group.bench_function("engine_new", |b| b.iter(|| black_box(Engine::new())));
+
+    group.bench_function("init_to_first_word", |b| {
+        b.iter(|| {
+            let mut e = Engine::new();
+            black_box(type_word(&mut e, black_box("vieetj ")))
+        })
+    });
+
+    let mut e = Engine::new();
+    group.bench_function("type_sentence", |b| {
+        b.iter(|| black_box(type_word(&mut e, black_box(SENTENCE))))
+    });
+
+    group.finish();
+}
+
+criterion_group!(benches, bench_footprint);
+criterion_main!(benches);
@@ -0,0 +1,60 @@
+//! Fuzz Replay Benchmarks
+//!
+//! Replays the inputs the fuzz targets saved as slow (`fuzz/slow/`, see
+//! `fuzz/src/lib.rs`), or the harness seeds when none are saved, through
+//! the same harness. Reports per input how many steps it drives, the
+//! slowest step, ns per step and the largest allocation of a step, then
+//! benchmarks each input so a fix shows up as a regression-free speedup.
+
+#[allow(dead_code)]
+#[path = "../fuzz/src/lib.rs"]
+mod harness;
+
+use criterion::{black_box, criterion_group, criterion_main, Criterion, Throughput};
+use harness::{run, saved_cases, seeds, CountingAlloc, Limits};
+
+#[global_allocator]
+static ALLOC: CountingAlloc = CountingAlloc;
+
+fn bench_fuzz_replay(c: &mut Criterion) {
+    let mut cases = saved_cases();
+    if cases.is_empty() {
+        println!(
+            "no saved slow inputs in {}, replaying seeds",
+            harness::slow_dir().display()
+        );
+        cases = seeds();
+    }
+
+    println!(
+        "{:<40} {:>6} {:>10} {:>9} {:>10}",
+        "input", "steps", "max ns", "ns/step", "max alloc"
+    );
+    for (name, target, data) in &cases {
+        let r = run(*target, data, &Limits::DEFAULT);
+        println!(
+            "{:<40} {:>6} {:>10} {:>9} {:>10}",
+            name,
+            r.steps,
+            r.max_step_ns,
+            r.total_ns / r.steps.max(1) as u64,
+            r.max_step_alloc
+        );
+        for finding in &r.findings {
+            println!("  {finding:?}");
+        }
+    }
+
+    let mut group = c.benchmark_group("fuzz_replay");
+    for (name, target, data) in &cases {
+        let steps = run(*target, data, &Limits::NONE).steps;
+        group.throughput(Throughput::Elements(steps.max(1) as u64));
+        group.bench_function(name.as_str(), |b| {
+            b.iter(|| black_box(run(*target, data, &Limits::NONE).steps))
+        });
+    }
+    group.finish();
+}
+
+criterion_group!(benches, bench_fuzz_replay);
+criterion_main!(benches);
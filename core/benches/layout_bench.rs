@@ -0,0 +1,105 @@
+//! Keyboard Layout Benchmarks
+//!
+//! Cost of translating platform input into engine keys, per keystroke of
+//! a Telex sentence:
+//! - `translate/scancode_<layout>`: evdev scancode → engine key
+//! - `translate/char`: character → engine key event
+//! - `typing/native`: `on_key_ext` with engine keycodes (baseline)
+//! - `typing/evdev_dvorak` / `typing/char`: translation + `on_key_ext`
+
+use criterion::{black_box, criterion_group, criterion_main, Criterion, Throughput};
+use goxviet_core::engine::Engine;
+use goxviet_core::input::layout::{self, Layout, ScancodeSet};
+
+const TEXT: &str =
+    "Tieengs Vieejt laf ngoon nguwx cuar nguwowif Vieejt Nam, dduowcj dungf roongj raix. ";
+
+const LAYOUTS: [(&str, Layout); 4] = [
+    ("us", Layout::Us),
+    ("dvorak", Layout::Dvorak),
+    ("colemak", Layout::Colemak),
+    ("azerty", Layout::Azerty),
+];
+
+/// Evdev scancodes that type `TEXT` on `layout`
+fn scancodes(layout: Layout) -> Vec<(u16, bool)> {
+    TEXT.chars()
+        .filter_map(|c| {
+            let key = layout::translate_char(c)?.key;
+            let code = (0..256).find(|&code| {
+                layout::translate_scancode(ScancodeSet::Evdev, layout, code) == Some(key)
+            })?;
+            Some((code, c.is_uppercase()))
+        })
+        .collect()
+}
+
+fn bench_translate(c: &mut Criterion) {
+    let mut group = c.benchmark_group("translate");
+    group.throughput(Throughput::Elements(TEXT.len() as u64));
+    for (name, layout) in LAYOUTS {
+        let codes = scancodes(layout);
+        group.bench_function(format!("scancode_{name}"), |b| {
+            b.iter(|| {
+                for &(code, _) in &codes {
+                    black_box(layout::translate_scancode(
+                        ScancodeSet::Evdev,
+                        black_box(layout),
+                        black_box(code),
+                    ));
+                }
+            })
+        });
+    }
+    group.bench_function("char", |b| {
+        b.iter(|| {
+            for ch in black_box(TEXT).chars() {
+                black_box(layout::translate_char(ch));
+            }
+        })
+    });
+    group.finish();
+}
+
+fn bench_typing(c: &mut Criterion) {
+    let mut group = c.benchmark_group("typing");
+    group.throughput(Throughput::Elements(TEXT.len() as u64));
+    let native: Vec<_> = TEXT
+        .chars()
+        .filter_map(|c| layout::translate_char(c).map(|k| (k.key, k.caps)))
+        .collect();
+    let dvorak = scancodes(Layout::Dvorak);
+    let mut e = Engine::new();
+
+    group.bench_function("native", |b| {
+        b.iter(|| {
+            for &(key, caps) in &native {
+                e.on_key_ext(key, caps, false, false).release();
+            }
+        })
+    });
+    group.bench_function("evdev_dvorak", |b| {
+        b.iter(|| {
+            for &(code, caps) in &dvorak {
+                if let Some(key) =
+                    layout::translate_scancode(ScancodeSet::Evdev, Layout::Dvorak, code)
+                {
+                    e.on_key_ext(key, caps, false, false).release();
+                }
+            }
+        })
+    });
+    group.bench_function("char", |b| {
+        b.iter(|| {
+            for ch in TEXT.chars() {
+                if let Some(k) = layout::translate_char(ch) {
+                    e.on_key_ext(k.key, k.caps, false, k.shift).release();
+                }
+            }
+        })
+    });
+    group.finish();
+}
+
+criterion_group!(benches, bench_translate, bench_typing);
+criterion_main!(benches);
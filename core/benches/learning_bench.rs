@@ -0,0 +1,102 @@
+//! Adaptive Restore Learning Benchmarks
+//!
+//! Shows that lookup and record cost stay constant regardless of how many
+//! corrections have been learned (fixed-size count-min sketch):
+//! - bias lookup with 0 / 1k / 100k recorded corrections
+//! - recording a correction
+//! - per-keystroke engine overhead with learning on vs off
+//! - save/load of the fixed-size file
+
+use criterion::{black_box, criterion_group, criterion_main, BenchmarkId, Criterion};
+use goxviet_core::data::keys;
+use goxviet_core::engine::restore_learning::hash_keys;
+use goxviet_core::engine::{Engine, LanguageBias, RestoreSketch};
+
+fn sketch_with(n: u32) -> Box<RestoreSketch> {
+    let mut s = RestoreSketch::new();
+    for i in 0..n {
+        let bias = if i % 2 == 0 {
+            LanguageBias::English
+        } else {
+            LanguageBias::Vietnamese
+        };
+        s.record(
+            hash_keys([(i & 0x7f) as u16, (i >> 7) as u16, (i >> 14) as u16]),
+            bias,
+        );
+    }
+    s
+}
+
+fn bench_sketch(c: &mut Criterion) {
+    let word = [
+        keys::C,
+        keys::O,
+        keys::N,
+        keys::S,
+        keys::O,
+        keys::L,
+        keys::E,
+    ];
+    let mut group = c.benchmark_group("learning_bias_lookup");
+    for n in [0u32, 1_000, 100_000] {
+        let sketch = sketch_with(n);
+        group.bench_with_input(BenchmarkId::from_parameter(n), &sketch, |b, s| {
+            b.iter(|| black_box(s.bias(hash_keys(black_box(word)))));
+        });
+    }
+    group.finish();
+
+    c.bench_function("learning_record", |b| {
+        let mut s = sketch_with(1_000);
+        let mut i = 0u16;
+        b.iter(|| {
+            i = i.wrapping_add(1);
+            s.record(hash_keys([i, keys::A]), LanguageBias::English);
+        });
+    });
+
+    let sketch = sketch_with(100_000);
+    c.bench_function("learning_save_load", |b| {
+        b.iter(|| {
+            let bytes = sketch.to_bytes();
+            black_box(RestoreSketch::from_bytes(&bytes).unwrap())
+        });
+    });
+}
+
+fn bench_engine_overhead(c: &mut Criterion) {
+    let word = [
+        keys::C,
+        keys::O,
+        keys::N,
+        keys::S,
+        keys::O,
+        keys::L,
+        keys::E,
+    ];
+    let mut group = c.benchmark_group("learning_engine_word");
+    for enabled in [false, true] {
+        let mut e = Engine::new();
+        if enabled {
+            e.set_learning(Some(sketch_with(100_000)));
+        }
+        let name = if enabled {
+            "learning_on"
+        } else {
+            "learning_off"
+        };
+        group.bench_function(name, |b| {
+            b.iter(|| {
+                for &k in &word {
+                    black_box(e.on_key(k, false, false));
+                }
+                e.clear_all();
+            });
+        });
+    }
+    group.finish();
+}
+
+criterion_group!(benches, bench_sketch, bench_engine_overhead);
+criterion_main!(benches);
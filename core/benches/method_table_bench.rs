@@ -0,0 +1,112 @@
+//! Input Method Table Benchmarks
+//!
+//! Per-key modifier lookup, over the keys of a Telex sentence:
+//! - `classify/table`: `MethodTable::action` (one index) + `is_modifier`
+//! - `classify/trait`: the former dispatch, a `dyn` method object with one
+//!   `match` per role (kept here as the baseline)
+//! - `typing/builtin` / `typing/loaded`: `on_key_ext` with the built-in
+//!   Telex table vs. the same definition loaded at runtime
+
+use criterion::{black_box, criterion_group, criterion_main, Criterion, Throughput};
+use goxviet_core::data::keys;
+use goxviet_core::engine::Engine;
+use goxviet_core::input::{self, telex, ToneType};
+use goxviet_core::utils::char_to_key;
+
+const TEXT: &str =
+    "Tieengs Vieejt laf ngoon nguwx cuar nguwowif Vieejt Nam, dduowcj dungf roongj raix. ";
+
+/// Trait-object Telex, as dispatched before method tables
+trait Method {
+    fn mark(&self, key: u16) -> Option<u8>;
+    fn tone(&self, key: u16) -> Option<ToneType>;
+    fn stroke(&self, key: u16) -> bool;
+    fn remove(&self, key: u16) -> bool;
+}
+
+struct MatchTelex;
+
+impl Method for MatchTelex {
+    fn mark(&self, key: u16) -> Option<u8> {
+        match key {
+            keys::S => Some(1),
+            keys::F => Some(2),
+            keys::R => Some(3),
+            keys::X => Some(4),
+            keys::J => Some(5),
+            _ => None,
+        }
+    }
+
+    fn tone(&self, key: u16) -> Option<ToneType> {
+        match key {
+            keys::A | keys::E | keys::O => Some(ToneType::Circumflex),
+            keys::W => Some(ToneType::Horn),
+            _ => None,
+        }
+    }
+
+    fn stroke(&self, key: u16) -> bool {
+        key == keys::D
+    }
+
+    fn remove(&self, key: u16) -> bool {
+        key == keys::Z
+    }
+}
+
+fn bench_classify(c: &mut Criterion) {
+    let text: Vec<u16> = TEXT.chars().map(char_to_key).collect();
+    let mut group = c.benchmark_group("classify");
+    group.throughput(Throughput::Elements(text.len() as u64));
+
+    let table = input::get(0);
+    group.bench_function("table", |b| {
+        b.iter(|| {
+            for &key in &text {
+                black_box(black_box(table).action(key).is_modifier());
+            }
+        })
+    });
+    let method: &dyn Method = &MatchTelex;
+    group.bench_function("trait", |b| {
+        b.iter(|| {
+            for &key in &text {
+                let m = black_box(method);
+                black_box(
+                    m.stroke(key)
+                        || m.remove(key)
+                        || m.tone(key).is_some()
+                        || m.mark(key).is_some(),
+                );
+            }
+        })
+    });
+    group.finish();
+}
+
+fn bench_typing(c: &mut Criterion) {
+    let text: Vec<(u16, bool)> = TEXT
+        .chars()
+        .map(|c| (char_to_key(c), c.is_uppercase()))
+        .collect();
+    let mut group = c.benchmark_group("typing");
+    group.throughput(Throughput::Elements(text.len() as u64));
+
+    let mut builtin = Engine::new();
+    let mut loaded = Engine::new();
+    loaded.load_method(telex::DEFINITION).unwrap();
+    for (name, e) in [("builtin", &mut builtin), ("loaded", &mut loaded)] {
+        group.bench_function(name, |b| {
+            b.iter(|| {
+                for &(key, caps) in &text {
+                    e.on_key_ext(key, caps, false, false).release();
+                }
+            })
+        });
+    }
+    group.finish();
+}
+
+criterion_group!(benches, bench_classify, bench_typing);
+criterion_main!(benches);
@@ -0,0 +1,152 @@
+//! Output Encoding Benchmarks
+//!
+//! Platforms that consume UTF-16 (macOS `NSString`, Windows `SendInput`)
+//! convert every `Result` from UTF-32. Compares, per keystroke of a Telex
+//! replay of the Vietnamese corpus:
+//! - `utf32_then_convert`: `on_key` + `Result` → `String` → `Vec<u16>`
+//!   (what the platform layer does today)
+//! - `into_utf16_nfc` / `into_utf16_nfd` / `into_utf8_nfc`: `on_key` +
+//!   `output::encode_*` into a reused stack buffer (what `ime_key_into_*` does)
+//!
+//! plus an encoding-only microbenchmark over the emitted edits.
+
+#[allow(dead_code)]
+#[path = "support/corpus.rs"]
+mod corpus;
+
+use criterion::{black_box, criterion_group, criterion_main, Criterion, Throughput};
+use goxviet_core::engine::output::{self, MAX_UTF16_LEN, MAX_UTF8_LEN};
+use goxviet_core::engine::{Engine, NormalizationForm};
+
+/// Replay through the UTF-32 `Result`, converting like the platform layer
+fn replay_convert(stream: &[(u16, bool)]) -> usize {
+    let mut e = Engine::new();
+    e.set_method(0);
+    let mut units = 0;
+    for &(key, caps) in stream {
+        let r = e.on_key(key, caps, false);
+        if r.count > 0 {
+            let s: String = r
+                .as_slice()
+                .iter()
+                .filter_map(|&c| char::from_u32(c))
+                .collect();
+            let utf16: Vec<u16> = s.encode_utf16().collect();
+            units += black_box(utf16).len();
+        }
+        r.release();
+    }
+    units
+}
+
+/// Replay encoding each edit straight into a reused buffer
+fn replay_into<T: Copy + Default>(
+    stream: &[(u16, bool)],
+    form: NormalizationForm,
+    out: &mut [T],
+    encode: fn(&[u32], NormalizationForm, &mut [T]) -> Option<usize>,
+) -> usize {
+    let mut e = Engine::new();
+    e.set_method(0);
+    let mut units = 0;
+    for &(key, caps) in stream {
+        let r = e.on_key(key, caps, false);
+        units += encode(r.as_slice(), form, out).unwrap_or(0);
+        black_box(&out[..]);
+        r.release();
+    }
+    units
+}
+
+/// Emitted edits of a replay, for the encoding-only benchmark
+fn collect_edits(stream: &[(u16, bool)]) -> Vec<Vec<u32>> {
+    let mut e = Engine::new();
+    e.set_method(0);
+    let mut edits = Vec::new();
+    for &(key, caps) in stream {
+        let r = e.on_key(key, caps, false);
+        if r.count > 0 {
+            edits.push(r.as_slice().to_vec());
+        }
+        r.release();
+    }
+    edits
+}
+
+fn bench_output(c: &mut Criterion) {
+    let stream = corpus::load_stream(corpus::VIETNAMESE, 2_000);
+    let mut out16 = [0u16; MAX_UTF16_LEN];
+    let mut out8 = [0u8; MAX_UTF8_LEN];
+
+    let mut group = c.benchmark_group("output_replay");
+    group.throughput(Throughput::Elements(stream.len() as u64));
+    group.bench_function("utf32_then_convert", |b| {
+        b.iter(|| black_box(replay_convert(&stream)))
+    });
+    group.bench_function("into_utf16_nfc", |b| {
+        b.iter(|| {
+            black_box(replay_into(
+                &stream,
+                NormalizationForm::Nfc,
+                &mut out16,
+                output::encode_utf16,
+            ))
+        })
+    });
+    group.bench_function("into_utf16_nfd", |b| {
+        b.iter(|| {
+            black_box(replay_into(
+                &stream,
+                NormalizationForm::Nfd,
+                &mut out16,
+                output::encode_utf16,
+            ))
+        })
+    });
+    group.bench_function("into_utf8_nfc", |b| {
+        b.iter(|| {
+            black_box(replay_into(
+                &stream,
+                NormalizationForm::Nfc,
+                &mut out8,
+                output::encode_utf8,
+            ))
+        })
+    });
+    group.finish();
+
+    let edits = collect_edits(&stream);
+    let mut group = c.benchmark_group("output_encode");
+    group.throughput(Throughput::Elements(edits.len() as u64));
+    group.bench_function("string_then_utf16_vec", |b| {
+        b.iter(|| {
+            edits
+                .iter()
+                .map(|e| {
+                    let s: String = e.iter().filter_map(|&c| char::from_u32(c)).collect();
+                    black_box(s.encode_utf16().collect::<Vec<u16>>()).len()
+                })
+                .sum::<usize>()
+        })
+    });
+    for (name, form) in [
+        ("utf16_nfc", NormalizationForm::Nfc),
+        ("utf16_nfd", NormalizationForm::Nfd),
+    ] {
+        group.bench_function(name, |b| {
+            b.iter(|| {
+                edits
+                    .iter()
+                    .map(|e| {
+                        let n = output::encode_utf16(e, form, &mut out16).unwrap_or(0);
+                        black_box(&out16[..n]).len()
+                    })
+                    .sum::<usize>()
+            })
+        });
+    }
+    group.finish();
+}
+
+criterion_group!(benches, bench_output);
+criterion_main!(benches);
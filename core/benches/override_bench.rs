@@ -0,0 +1,106 @@
+//! Override List Benchmarks
+//!
+//! Builds always-English / always-Vietnamese sets with 100k entries and measures:
+//! - Build time (done outside the engine lock)
+//! - Lookup hit/miss cost (O(1) bucket scan)
+//! - Per-keystroke engine overhead with 2 × 100k override lists installed
+
+use criterion::{black_box, criterion_group, criterion_main, Criterion};
+use goxviet_core::data::keys;
+use goxviet_core::engine::overrides::pack_word;
+use goxviet_core::engine::{Engine, LanguageBias, OverrideSet};
+
+/// 100k distinct lowercase words from the English corpus, padded with
+/// synthetic entries if the corpus is shorter
+fn word_list(n: usize) -> Vec<String> {
+    let text = std::fs::read_to_string("tests/data/english_100k.txt").unwrap_or_default();
+    let mut words: Vec<String> = text
+        .lines()
+        .filter_map(|l| l.split_whitespace().next())
+        .filter(|w| w.bytes().all(|b| b.is_ascii_alphabetic()) && w.len() <= 25)
+        .map(|w| w.to_ascii_lowercase())
+        .take(n)
+        .collect();
+    let mut i = 0u32;
+    while words.len() < n {
+        words.push(
+            (0..6)
+                .map(|j| (b'a' + ((i >> (j * 4)) % 26) as u8) as char)
+                .collect(),
+        );
+        i += 1;
+    }
+    words
+}
+
+fn bench_overrides(c: &mut Criterion) {
+    let words = word_list(100_000);
+    let text = words.join("\n");
+
+    let (set, _) = OverrideSet::parse(&text);
+    println!(
+        "override set: {} entries, {:.1} KB",
+        set.len(),
+        set.size_bytes() as f64 / 1024.0
+    );
+
+    c.bench_function("override_build_100k", |b| {
+        b.iter(|| black_box(OverrideSet::parse(black_box(&text))))
+    });
+
+    let hits: Vec<u128> = words
+        .iter()
+        .step_by(97)
+        .filter_map(|w| pack_word(w))
+        .collect();
+    let misses: Vec<u128> = (0..hits.len())
+        .filter_map(|i| pack_word(&format!("qqzx{}", (b'a' + (i % 26) as u8) as char)))
+        .collect();
+
+    c.bench_function("override_lookup_hit", |b| {
+        let mut i = 0;
+        b.iter(|| {
+            i = (i + 1) % hits.len();
+            black_box(set.contains(hits[i]))
+        })
+    });
+    c.bench_function("override_lookup_miss", |b| {
+        let mut i = 0;
+        b.iter(|| {
+            i = (i + 1) % misses.len();
+            black_box(set.contains(misses[i]))
+        })
+    });
+
+    // Engine keystroke cost with and without 2 × 100k lists
+    let word = [
+        keys::C,
+        keys::O,
+        keys::N,
+        keys::S,
+        keys::O,
+        keys::L,
+        keys::E,
+    ];
+    let mut group = c.benchmark_group("override_engine_word");
+    for installed in [false, true] {
+        let mut e = Engine::new();
+        if installed {
+            e.set_override_list(LanguageBias::English, Some(set.clone()));
+            e.set_override_list(LanguageBias::Vietnamese, Some(set.clone()));
+        }
+        let name = if installed { "lists_100k" } else { "no_lists" };
+        group.bench_function(name, |b| {
+            b.iter(|| {
+                for &k in &word {
+                    black_box(e.on_key(k, false, false));
+                }
+                e.clear_all();
+            })
+        });
+    }
+    group.finish();
+}
+
+criterion_group!(benches, bench_overrides);
+criterion_main!(benches);
@@ -0,0 +1,75 @@
+//! Next-Word Prediction Benchmarks
+//!
+//! Builds a bigram/trigram model from the multi-word phrases in
+//! `tests/data/vietnamese_22k.txt` and measures:
+//! - Model size (printed once, target: < 4MB)
+//! - Per-commit cost: word → ID lookup + context shift + top-5 prediction
+//! - Raw prediction lookup for a known context
+
+use criterion::{black_box, criterion_group, criterion_main, Criterion};
+use goxviet_core::engine::prediction::{NgramModel, NgramModelBuilder, Prediction, NO_WORD};
+
+fn build_model() -> (NgramModel, Vec<Vec<String>>) {
+    let text = std::fs::read_to_string("tests/data/vietnamese_22k.txt")
+        .expect("Could not open vietnamese_22k.txt");
+    let phrases: Vec<Vec<String>> = text
+        .lines()
+        .filter(|l| l.contains(' '))
+        .map(|l| l.split_whitespace().map(|w| w.to_lowercase()).collect())
+        .collect();
+
+    let mut builder = NgramModelBuilder::new();
+    for p in &phrases {
+        builder.add_sentence(p.iter().map(String::as_str));
+    }
+    let bytes = builder.build(16);
+    let model = NgramModel::from_bytes(bytes.into()).expect("valid model");
+    println!(
+        "prediction model: {} words, {} bigrams, {} trigrams, {:.1} KB",
+        model.vocab_len(),
+        model.bigram_len(),
+        model.trigram_len(),
+        model.size_bytes() as f64 / 1024.0
+    );
+    (model, phrases)
+}
+
+fn bench_prediction(c: &mut Criterion) {
+    let (model, phrases) = build_model();
+    let mut group = c.benchmark_group("prediction");
+
+    // Per-commit cost over a stream of committed words
+    let words: Vec<&str> = phrases
+        .iter()
+        .take(2000)
+        .flat_map(|p| p.iter().map(String::as_str))
+        .collect();
+    group.bench_function("commit_and_predict_top5", |b| {
+        let mut i = 0usize;
+        let mut ctx = [NO_WORD; 2];
+        let mut out = [Prediction::default(); 5];
+        b.iter(|| {
+            let w = words[i % words.len()];
+            i += 1;
+            let id = model.word_id(black_box(w)).unwrap_or(NO_WORD);
+            ctx = [ctx[1], id];
+            black_box(model.predict(ctx, &mut out))
+        });
+    });
+
+    let w1 = model.word_id("xin").unwrap_or(NO_WORD);
+    let w2 = model.word_id("chào").unwrap_or(NO_WORD);
+    group.bench_function("predict_known_context", |b| {
+        let mut out = [Prediction::default(); 5];
+        b.iter(|| black_box(model.predict(black_box([w1, w2]), &mut out)));
+    });
+
+    group.bench_function("word_id_lookup", |b| {
+        b.iter(|| black_box(model.word_id(black_box("nghiêng"))));
+    });
+
+    group.finish();
+}
+
+criterion_group!(benches, bench_prediction);
+criterion_main!(benches);
@@ -0,0 +1,99 @@
+//! Per-App Profile Benchmarks
+//!
+//! Cost of an app switch through the FFI, alternating between two apps
+//! with different settings:
+//! - `switch/profile`: `ime_activate_profile`
+//! - `switch/calls`: the platform's sequence before profiles, one locked
+//!   call per setting plus a re-sync of the app's shortcuts
+//!   (`SHORTCUTS` entries)
+
+use criterion::{criterion_group, criterion_main, Criterion};
+use goxviet_core::*;
+use std::ffi::CString;
+
+const SHORTCUTS: usize = 20;
+
+/// Per-app settings pushed by the platform on every switch
+struct AppSettings {
+    method: u8,
+    enabled: bool,
+    modern: bool,
+    free_tone: bool,
+    esc_restore: bool,
+    skip_w: bool,
+    instant_restore: bool,
+}
+
+const APPS: [AppSettings; 2] = [
+    AppSettings {
+        method: 0,
+        enabled: true,
+        modern: true,
+        free_tone: false,
+        esc_restore: true,
+        skip_w: false,
+        instant_restore: true,
+    },
+    AppSettings {
+        method: 1,
+        enabled: false,
+        modern: false,
+        free_tone: true,
+        esc_restore: false,
+        skip_w: true,
+        instant_restore: false,
+    },
+];
+
+fn apply_calls(app: &AppSettings, shortcuts: &[(CString, CString)]) {
+    ime_clear();
+    ime_method(app.method);
+    ime_enabled(app.enabled);
+    ime_modern(app.modern);
+    ime_free_tone(app.free_tone);
+    ime_esc_restore(app.esc_restore);
+    ime_skip_w_shortcut(app.skip_w);
+    ime_instant_restore(app.instant_restore);
+    ime_clear_shortcuts();
+    for (trigger, text) in shortcuts {
+        unsafe { ime_add_shortcut(trigger.as_ptr(), text.as_ptr()) };
+    }
+}
+
+fn bench_switch(c: &mut Criterion) {
+    let shortcuts: Vec<_> = (0..SHORTCUTS)
+        .map(|i| {
+            (
+                CString::new(format!("sc{i}")).unwrap(),
+                CString::new(format!("shortcut number {i}")).unwrap(),
+            )
+        })
+        .collect();
+    let mut group = c.benchmark_group("switch");
+
+    ime_init();
+    let ids = [0, unsafe { ime_profile_id(c"com.example.editor".as_ptr()) }];
+    for (id, app) in ids.iter().zip(&APPS) {
+        ime_activate_profile(*id);
+        apply_calls(app, &shortcuts);
+    }
+    let mut turn = 0;
+    group.bench_function("profile", |b| {
+        b.iter(|| {
+            turn ^= 1;
+            ime_activate_profile(ids[turn])
+        })
+    });
+
+    ime_init();
+    group.bench_function("calls", |b| {
+        b.iter(|| {
+            turn ^= 1;
+            apply_calls(&APPS[turn], &shortcuts)
+        })
+    });
+    group.finish();
+}
+
+criterion_group!(benches, bench_switch);
+criterion_main!(benches);
@@ -0,0 +1,78 @@
+//! Render Cache Benchmarks
+//!
+//! Rebuild cost by word length: a keystroke changes one position near the
+//! end of the word (a mark moving onto the last vowel), then the whole
+//! word is rebuilt (rendered text plus screen length):
+//! - `uncached`: every position goes through `render_char` again and the
+//!   screen length is counted by another walk (the old rebuild path)
+//! - `cached`: the buffer's render cache re-renders from the changed
+//!   position and the screen length is an offset difference
+
+use criterion::{black_box, criterion_group, criterion_main, BenchmarkId, Criterion};
+use goxviet_core::data::keys;
+use goxviet_core::engine::buffer::{Buffer, Char, MAX};
+use goxviet_core::engine::rebuild;
+
+/// "người" repeated up to `len` positions, with diacritics on the vowels
+fn word(len: usize) -> Buffer {
+    const SYLLABLE: [(u16, u8, u8); 5] = [
+        (keys::N, 0, 0),
+        (keys::G, 0, 0),
+        (keys::U, 2, 0),
+        (keys::O, 2, 2),
+        (keys::I, 0, 0),
+    ];
+    let mut buf = Buffer::new();
+    for &(key, tone, mark) in SYLLABLE.iter().cycle().take(len) {
+        let mut c = Char::new(key, false);
+        c.tone = tone;
+        c.mark = mark;
+        buf.push(c);
+    }
+    buf
+}
+
+/// The keystroke: toggle the mark on the position before last
+fn change(buf: &mut Buffer) {
+    let pos = buf.len().saturating_sub(2);
+    if let Some(c) = buf.get_mut(pos) {
+        c.mark = if c.mark == 1 { 5 } else { 1 };
+    }
+}
+
+fn bench_rebuild(c: &mut Criterion) {
+    let mut group = c.benchmark_group("rebuild_word");
+    for len in [2usize, 4, 8, 16, 32, 64] {
+        group.bench_with_input(BenchmarkId::new("uncached", len), &len, |b, &len| {
+            let mut buf = word(len);
+            let mut out = ['\0'; MAX];
+            b.iter(|| {
+                change(&mut buf);
+                let mut n = 0;
+                for c in buf.iter() {
+                    if let Some(ch) = rebuild::render_char(c) {
+                        out[n] = ch;
+                        n += 1;
+                    }
+                }
+                let screen = buf
+                    .iter()
+                    .filter(|c| rebuild::render_char(c).is_some())
+                    .count();
+                black_box((&out[..n], screen));
+            })
+        });
+        group.bench_with_input(BenchmarkId::new("cached", len), &len, |b, &len| {
+            let mut buf = word(len);
+            b.iter(|| {
+                change(&mut buf);
+                let screen = rebuild::count_screen_chars(&mut buf, 0, len);
+                black_box((rebuild::render_all(&mut buf), screen));
+            })
+        });
+    }
+    group.finish();
+}
+
+criterion_group!(benches, bench_rebuild);
+criterion_main!(benches);
@@ -0,0 +1,74 @@
+//! Transient Allocation Benchmarks
+//!
+//! Replays the Vietnamese (Telex) and English corpora word by word with a
+//! counting global allocator and reports heap allocations per keystroke:
+//! - `result`: the `Result` output buffer (part of the FFI contract, freed
+//!   by `ime_free`)
+//! - `transient`: everything else the engine allocates while processing
+//!   (should be ~0 once the word scratch arena is warm)
+//!
+//! Then times per-key processing over the same streams.
+
+#[allow(dead_code)]
+#[path = "../tests/support/counting_alloc.rs"]
+mod counting_alloc;
+
+#[allow(dead_code)]
+#[path = "support/corpus.rs"]
+mod corpus;
+
+use criterion::{black_box, criterion_group, criterion_main, Criterion, Throughput};
+use goxviet_core::engine::Engine;
+
+#[global_allocator]
+static ALLOC: counting_alloc::CountingAlloc = counting_alloc::CountingAlloc;
+
+fn report(name: &str, stream: &[(u16, bool)]) {
+    let mut e = Engine::new();
+    // Warm up: lazily created subsystems and the arena's first chunk
+    for &(key, caps) in stream.iter().take(2_000) {
+        e.on_key(key, caps, false).release();
+    }
+
+    let (mut total, mut results) = (0u64, 0u64);
+    for &(key, caps) in stream {
+        let before = counting_alloc::allocations();
+        let r = e.on_key(key, caps, false);
+        total += (counting_alloc::allocations() - before) as u64;
+        results += (r.capacity > 0) as u64;
+        r.release();
+    }
+    let keys = stream.len().max(1) as f64;
+    println!(
+        "{name}: {} keystrokes | allocations/key {:.3} (result {:.3}, transient {:.3})",
+        stream.len(),
+        total as f64 / keys,
+        results as f64 / keys,
+        total.saturating_sub(results) as f64 / keys,
+    );
+}
+
+fn bench_scratch(c: &mut Criterion) {
+    let vietnamese = corpus::load_stream(corpus::VIETNAMESE, usize::MAX);
+    let english = corpus::load_stream(corpus::ENGLISH, 20_000);
+    report("vietnamese_22k", &vietnamese);
+    report("english_100k (first 20k)", &english);
+
+    let mut group = c.benchmark_group("per_key");
+    for (name, stream) in [("vietnamese", &vietnamese), ("english", &english)] {
+        let sample = &stream[..stream.len().min(10_000)];
+        group.throughput(Throughput::Elements(sample.len() as u64));
+        let mut e = Engine::new();
+        group.bench_function(name, |b| {
+            b.iter(|| {
+                for &(key, caps) in sample {
+                    black_box(e.on_key(key, caps, false)).release();
+                }
+            })
+        });
+    }
+    group.finish();
+}
+
+criterion_group!(benches, bench_scratch);
+criterion_main!(benches);
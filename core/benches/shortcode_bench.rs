@@ -0,0 +1,89 @@
+//! Shortcode Completion Benchmarks
+//!
+//! Measures `:code` completion latency over the full built-in table:
+//! - Incremental session (one narrow + top-8 candidates per keystroke)
+//! - Full prefix search from scratch for comparison
+//! - End-to-end engine typing of `:code:`
+
+use criterion::{black_box, criterion_group, criterion_main, BenchmarkId, Criterion, Throughput};
+use goxviet_core::data::keys;
+use goxviet_core::engine::shortcode::{ShortcodeSession, ShortcodeTable};
+use goxviet_core::engine::Engine;
+
+fn bench_completion(c: &mut Criterion) {
+    let table = ShortcodeTable::builtin();
+    println!(
+        "shortcodes: {} entries, index {:.1} KB",
+        table.len(),
+        table.index_bytes() as f64 / 1024.0
+    );
+    let codes: Vec<&str> = (0..table.len()).map(|i| table.code(i)).collect();
+    let keystrokes: u64 = codes.iter().map(|c| c.len() as u64).sum();
+
+    let mut group = c.benchmark_group("shortcode_completion");
+    group.throughput(Throughput::Elements(keystrokes));
+
+    // Type every code one byte at a time, fetching candidates after each byte
+    group.bench_function("incremental_all_codes", |b| {
+        let mut best = [0usize; 8];
+        b.iter(|| {
+            let mut total = 0usize;
+            for code in &codes {
+                let mut s = ShortcodeSession::new(table);
+                for &byte in code.as_bytes() {
+                    s.push(table, byte);
+                    total += table.best_in(s.range(), &mut best);
+                }
+            }
+            black_box(total)
+        });
+    });
+
+    // Same keystrokes, but searching the whole table for each prefix
+    group.bench_function("full_search_all_codes", |b| {
+        let mut best = [0usize; 8];
+        b.iter(|| {
+            let mut total = 0usize;
+            for code in &codes {
+                for end in 1..=code.len() {
+                    let range = table.prefix_range(&code[..end]);
+                    total += table.best_in(range, &mut best);
+                }
+            }
+            black_box(total)
+        });
+    });
+    group.finish();
+
+    // Worst case per keystroke: the first byte (widest range)
+    let mut group = c.benchmark_group("shortcode_keystroke");
+    for prefix in ["s", "sm", "smi", "smile"] {
+        group.bench_with_input(BenchmarkId::from_parameter(prefix), &prefix, |b, p| {
+            let mut best = [0usize; 8];
+            b.iter(|| {
+                let range = table.prefix_range(black_box(p));
+                black_box(table.best_in(range, &mut best))
+            });
+        });
+    }
+    group.finish();
+}
+
+fn bench_engine_session(c: &mut Criterion) {
+    let mut engine = Engine::new();
+    engine.set_shortcodes_enabled(true);
+    let smile = [keys::S, keys::M, keys::I, keys::L, keys::E];
+
+    c.bench_function("shortcode_engine_smile", |b| {
+        b.iter(|| {
+            engine.on_key_ext(keys::SEMICOLON, false, false, true);
+            for &k in &smile {
+                engine.on_key_ext(k, false, false, false);
+            }
+            black_box(engine.on_key_ext(keys::SEMICOLON, false, false, true))
+        });
+    });
+}
+
+criterion_group!(benches, bench_completion, bench_engine_session);
+criterion_main!(benches);
@@ -0,0 +1,87 @@
+//! Corpus Replay Helpers
+//!
+//! Shared by the benches that replay `tests/data` as Telex keystrokes.
+//! Include this file with `#[path]`:
+//!
+//! ```ignore
+//! #[allow(dead_code)]
+//! #[path = "support/corpus.rs"]
+//! mod corpus;
+//! ```
+
+use goxviet_core::data::chars::parse_char;
+use goxviet_core::data::keys;
+
+pub const VIETNAMESE: &str = "tests/data/vietnamese_22k.txt";
+pub const ENGLISH: &str = "tests/data/english_100k.txt";
+
+/// Convert a word to Telex keystrokes (plain ASCII words map to letters)
+pub fn telex(word: &str) -> Option<Vec<(u16, bool)>> {
+    let mut out = Vec::new();
+    for c in word.chars() {
+        let p = parse_char(c)?;
+        out.push((p.key, p.caps));
+        let modifier = match (p.key, p.tone) {
+            (keys::A, 1) => Some(keys::A),
+            (keys::E, 1) => Some(keys::E),
+            (keys::O, 1) => Some(keys::O),
+            (keys::A | keys::O | keys::U, 2) => Some(keys::W),
+            _ => None,
+        };
+        out.extend(modifier.map(|k| (k, false)));
+        if p.stroke {
+            out.push((keys::D, false));
+        }
+        let mark = match p.mark {
+            1 => Some(keys::S),
+            2 => Some(keys::F),
+            3 => Some(keys::R),
+            4 => Some(keys::X),
+            5 => Some(keys::J),
+            _ => None,
+        };
+        out.extend(mark.map(|k| (k, false)));
+    }
+    Some(out)
+}
+
+/// Keystroke streams: one word per entry, each followed by SPACE when typed
+pub fn load_words(path: &str, limit: usize) -> Vec<Vec<(u16, bool)>> {
+    let text = std::fs::read_to_string(path).unwrap_or_default();
+    text.split(|c: char| c.is_whitespace() || c == '-')
+        .filter(|w| !w.is_empty() && w.chars().all(char::is_alphabetic))
+        .filter_map(telex)
+        .take(limit)
+        .collect()
+}
+
+/// One keystroke stream: each word followed by SPACE
+pub fn load_stream(path: &str, limit: usize) -> Vec<(u16, bool)> {
+    load_words(path, limit)
+        .into_iter()
+        .flat_map(|mut word| {
+            word.push((keys::SPACE, false));
+            word
+        })
+        .collect()
+}
+
+/// Interleave four Vietnamese words with one English word
+pub fn mixed(vi: &[Vec<(u16, bool)>], en: &[Vec<(u16, bool)>]) -> Vec<Vec<(u16, bool)>> {
+    let mut out = Vec::new();
+    for (chunk, e) in vi.chunks(4).zip(en.iter()) {
+        out.extend(chunk.iter().cloned());
+        out.push(e.clone());
+    }
+    out
+}
+
+/// Keystrokes of a word-by-word replay (SPACE after each word)
+pub fn keystrokes(words: &[Vec<(u16, bool)>]) -> u64 {
+    words.iter().map(|w| w.len() as u64 + 1).sum()
+}
+
+/// Words that end with different text in two replays of the same corpus
+pub fn words_differ(a: &[String], b: &[String]) -> usize {
+    a.iter().zip(b).filter(|(x, y)| x != y).count()
+}
@@ -0,0 +1,116 @@
+//! Syllable ID Codec Benchmarks
+//!
+//! Encodes the syllables of the Vietnamese corpus (from text and from
+//! buffer chars, as the engine holds them) and decodes them to UTF-32.
+//! Reports corpus coverage and what the words take in `WordHistory`-style
+//! storage (`Buffer` + `RawInputBuffer` per word), as `String`s and as IDs.
+
+use criterion::{black_box, criterion_group, criterion_main, Criterion, Throughput};
+use goxviet_core::data::chars::parse_char;
+use goxviet_core::engine::buffer::{Buffer, Char, RawInputBuffer};
+use goxviet_core::engine::syllable_id::{
+    decode, encode, encode_str, ID_COUNT, MAX_SYLLABLE_LEN, SYLLABLES,
+};
+use std::collections::HashSet;
+use std::mem::size_of;
+
+fn load_syllables() -> Vec<String> {
+    let text = std::fs::read_to_string("tests/data/vietnamese_22k.txt").unwrap_or_default();
+    text.split(|c: char| c.is_whitespace() || c == '-')
+        .filter(|w| !w.is_empty() && w.chars().all(char::is_alphabetic))
+        .map(str::to_string)
+        .collect()
+}
+
+/// A word as buffer chars
+fn to_chars(word: &str) -> Option<Vec<Char>> {
+    word.chars()
+        .map(|c| {
+            let p = parse_char(c)?;
+            Some(Char {
+                key: p.key,
+                caps: p.caps,
+                tone: p.tone,
+                mark: p.mark,
+                stroke: p.stroke,
+            })
+        })
+        .collect()
+}
+
+fn report(words: &[String]) {
+    let ids: Vec<u16> = words.iter().filter_map(|w| encode_str(w)).collect();
+    let distinct: HashSet<&String> = words.iter().collect();
+    let distinct_ids: HashSet<u16> = ids.iter().copied().collect();
+    println!(
+        "vietnamese_22k: {} syllables ({} distinct), {} encode ({:.2}%), {} distinct IDs",
+        words.len(),
+        distinct.len(),
+        ids.len(),
+        100.0 * ids.len() as f64 / words.len().max(1) as f64,
+        distinct_ids.len(),
+    );
+    println!("  tables: {SYLLABLES} syllables per case, {ID_COUNT} IDs of 65536");
+
+    let n = ids.len();
+    let history = size_of::<Buffer>() + size_of::<RawInputBuffer>();
+    let strings: usize = words
+        .iter()
+        .filter(|w| encode_str(w).is_some())
+        .map(|w| size_of::<String>() + w.len())
+        .sum();
+    let kib = |bytes: usize| bytes as f64 / 1024.0;
+    println!(
+        "  storage for {n} words: Buffer+RawInputBuffer {:.0} KiB ({history} B/word) | \
+         String {:.0} KiB ({:.1} B/word) | u16 ID {:.0} KiB (2 B/word, {:.0}x / {:.0}x smaller)",
+        kib(n * history),
+        kib(strings),
+        strings as f64 / n.max(1) as f64,
+        kib(n * 2),
+        history as f64 / 2.0,
+        strings as f64 / (2 * n.max(1)) as f64,
+    );
+}
+
+fn bench_syllable_id(c: &mut Criterion) {
+    let words = load_syllables();
+    report(&words);
+
+    let words: Vec<String> = words
+        .into_iter()
+        .filter(|w| encode_str(w).is_some())
+        .collect();
+    let chars: Vec<Vec<Char>> = words.iter().filter_map(|w| to_chars(w)).collect();
+    let ids: Vec<u16> = words.iter().filter_map(|w| encode_str(w)).collect();
+
+    let mut group = c.benchmark_group("syllable_id");
+    group.throughput(Throughput::Elements(words.len() as u64));
+    group.bench_function("encode_str", |b| {
+        b.iter(|| {
+            words
+                .iter()
+                .map(|w| encode_str(w).unwrap_or(0) as u64)
+                .sum::<u64>()
+        })
+    });
+    group.bench_function("encode_chars", |b| {
+        b.iter(|| {
+            chars
+                .iter()
+                .map(|w| encode(black_box(w)).unwrap_or(0) as u64)
+                .sum::<u64>()
+        })
+    });
+    group.bench_function("decode_utf32", |b| {
+        let mut out = [0u32; MAX_SYLLABLE_LEN];
+        b.iter(|| {
+            ids.iter()
+                .map(|&id| decode(black_box(id), true, &mut out))
+                .sum::<usize>()
+        })
+    });
+    group.finish();
+}
+
+criterion_group!(benches, bench_syllable_id);
+criterion_main!(benches);
@@ -0,0 +1,12 @@
+//! Key codes, character tables and phonology
+//!
+//! The std-free part of goxviet-core's `data` module, from the same files.
+
+#[path = "../../src/data/chars.rs"]
+pub mod chars;
+#[path = "../../src/data/constants.rs"]
+pub mod constants;
+#[path = "../../src/data/keys.rs"]
+pub mod keys;
+#[path = "../../src/data/vowel.rs"]
+pub mod vowel;
@@ -0,0 +1,28 @@
+//! Gõ Việt embedded core
+//!
+//! `#![no_std]` build of the heap-free composer (`goxviet_core::embedded`)
+//! for firmware keyboards, WASM and other targets without `std` or a heap.
+//! The sources are shared with goxviet-core; this crate compiles them
+//! without `std` and without `alloc`, so nothing in them can allocate.
+//!
+//! goxviet-core itself cannot gain a `no_std` feature: Cargo builds every
+//! declared crate type, and its `staticlib` / `cdylib` need `std`.
+//!
+//! ```ignore
+//! use goxviet_embedded::{Composer, Letter, WORD_CAPACITY};
+//!
+//! let mut storage = [Letter::EMPTY; WORD_CAPACITY];
+//! let mut out = [0u32; WORD_CAPACITY];
+//! let mut ime = Composer::new(&mut storage);
+//! let edit = ime.on_key(keycode, caps, &mut out);
+//! ```
+
+#![no_std]
+
+pub mod data;
+#[path = "../../src/embedded/mod.rs"]
+pub mod embedded;
+#[path = "../../src/input/mod.rs"]
+pub mod input;
+
+pub use embedded::{Composer, Edit, Letter, Syllable, WORD_CAPACITY};
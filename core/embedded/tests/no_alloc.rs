@@ -0,0 +1,76 @@
+//! Typing performs no heap allocation
+//!
+//! The crate is `#![no_std]` without `alloc`, so this holds by
+//! construction; the counting allocator checks it end to end.
+
+#[allow(dead_code)]
+#[path = "../../tests/support/counting_alloc.rs"]
+mod counting_alloc;
+
+use goxviet_embedded::data::keys;
+use goxviet_embedded::{Composer, Letter, WORD_CAPACITY};
+
+#[global_allocator]
+static ALLOC: counting_alloc::CountingAlloc = counting_alloc::CountingAlloc;
+
+#[test]
+fn test_typing_does_not_allocate() {
+    // "Tieengs Vieetj ddaay" with backspaces, then VNI "nu7o71c"
+    let telex = [
+        keys::T,
+        keys::I,
+        keys::E,
+        keys::E,
+        keys::N,
+        keys::G,
+        keys::S,
+        keys::SPACE,
+        keys::V,
+        keys::I,
+        keys::E,
+        keys::E,
+        keys::T,
+        keys::J,
+        keys::DELETE,
+        keys::T,
+        keys::SPACE,
+        keys::D,
+        keys::D,
+        keys::A,
+        keys::A,
+        keys::Y,
+    ];
+    let vni = [
+        keys::N,
+        keys::U,
+        keys::N7,
+        keys::O,
+        keys::N7,
+        keys::N1,
+        keys::C,
+    ];
+
+    let before = counting_alloc::allocations();
+    let mut storage = [Letter::EMPTY; WORD_CAPACITY];
+    let mut out = [0u32; WORD_CAPACITY];
+    let mut utf8 = [0u8; WORD_CAPACITY * 4];
+    let mut ime = Composer::new(&mut storage);
+    let mut sent = 0;
+    for round in 0..1000 {
+        ime.set_method(0);
+        for &key in &telex {
+            sent += ime.on_key(key, round % 2 == 0, &mut out).count as usize;
+        }
+        ime.clear();
+        ime.set_method(1);
+        for &key in &vni {
+            sent += ime.on_key(key, false, &mut out).count as usize;
+        }
+        sent += ime.render_utf8(&mut utf8).unwrap_or(0);
+        ime.clear();
+    }
+    let after = counting_alloc::allocations();
+
+    assert!(sent > 0);
+    assert_eq!(after - before, 0, "typing allocated");
+}
@@ -0,0 +1,193 @@
+//! Core typing tests against the no_std build
+//!
+//! Telex/VNI words, tone placement, backspace and undo, plus the
+//! Vietnamese corpus typed as Telex (mark key last, like most typists).
+
+use goxviet_embedded::data::chars::{mark, parse_char, tone};
+use goxviet_embedded::data::keys;
+use goxviet_embedded::{Composer, Letter, WORD_CAPACITY};
+
+fn key_for(c: char) -> u16 {
+    match c.to_ascii_lowercase() {
+        '<' => keys::DELETE,
+        ' ' => keys::SPACE,
+        '0' => keys::N0,
+        '1' => keys::N1,
+        '2' => keys::N2,
+        '3' => keys::N3,
+        '4' => keys::N4,
+        '5' => keys::N5,
+        '6' => keys::N6,
+        '7' => keys::N7,
+        '8' => keys::N8,
+        '9' => keys::N9,
+        c => (0..128)
+            .find(|&k| keys::key_to_char(k, false) == Some(c))
+            .unwrap_or_else(|| panic!("no key for {c:?}")),
+    }
+}
+
+/// Screen after typing `keys` ((keycode, caps) pairs) like a host would
+fn type_keys(method: u8, keys: &[(u16, bool)]) -> String {
+    let mut storage = [Letter::EMPTY; WORD_CAPACITY];
+    let mut out = [0u32; WORD_CAPACITY];
+    let mut ime = Composer::new(&mut storage);
+    ime.set_method(method);
+    let mut screen: Vec<char> = Vec::new();
+    for &(key, caps) in keys {
+        let edit = ime.on_key(key, caps, &mut out);
+        if edit.is_send() {
+            screen.truncate(screen.len().saturating_sub(edit.backspace as usize));
+            screen.extend(
+                out[..edit.count as usize]
+                    .iter()
+                    .filter_map(|&cp| char::from_u32(cp)),
+            );
+        } else if key == keys::DELETE {
+            screen.pop();
+        } else if key == keys::SPACE {
+            screen.push(' ');
+        } else {
+            let c = keys::key_to_char(key, caps).unwrap();
+            screen.push(c);
+        }
+    }
+    screen.into_iter().collect()
+}
+
+fn type_str(method: u8, input: &str) -> String {
+    let keys: Vec<(u16, bool)> = input
+        .chars()
+        .map(|c| (key_for(c), c.is_ascii_uppercase()))
+        .collect();
+    type_keys(method, &keys)
+}
+
+#[test]
+fn test_telex_sentence() {
+    assert_eq!(
+        type_str(
+            0,
+            "Tieengs Vieetj laf ngoon ngwx chinhs thuwcs cuar nuwowcs Coongj hoaf xax hooij"
+        ),
+        "Tiếng Việt là ngôn ngữ chính thức của nước Cộng hoà xã hội"
+    );
+}
+
+#[test]
+fn test_vni_sentence() {
+    assert_eq!(
+        type_str(
+            1,
+            "Tie61ng Vie65t la2 ngo6n ngu74 chi1nh thu71c cu3a nu7o71c"
+        ),
+        "Tiếng Việt là ngôn ngữ chính thức của nước"
+    );
+}
+
+#[test]
+fn test_tone_placement() {
+    for (input, expected) in [
+        ("hoaf", "hoà"),
+        ("thuyr", "thuỷ"),
+        ("kiaf", "kìa"),
+        ("giaf", "già"),
+        ("quaf", "quà"),
+        ("muaf", "mùa"),
+        ("ngoaif", "ngoài"),
+        ("khuyur", "khuyur"), // not a syllable: mark key stays a letter
+        ("nguowif", "người"),
+        ("tieeus", "tiếu"),
+    ] {
+        assert_eq!(type_str(0, input), expected, "{input}");
+    }
+}
+
+#[test]
+fn test_old_style_placement() {
+    let mut storage = [Letter::EMPTY; WORD_CAPACITY];
+    let mut out = [0u32; WORD_CAPACITY];
+    let mut ime = Composer::new(&mut storage);
+    ime.set_modern_tone(false);
+    for c in "hoaf".chars() {
+        ime.on_key(key_for(c), false, &mut out);
+    }
+    let n = ime.render(&mut out);
+    let word: String = out[..n].iter().filter_map(|&c| char::from_u32(c)).collect();
+    assert_eq!(word, "hòa");
+}
+
+#[test]
+fn test_backspace() {
+    assert_eq!(type_str(0, "vieetj<"), "việ");
+    assert_eq!(type_str(0, "hoaf<"), "hò");
+    assert_eq!(type_str(0, "as<<b"), "b");
+    assert_eq!(type_str(0, "dd<a"), "a");
+}
+
+#[test]
+fn test_undo_modifiers() {
+    assert_eq!(type_str(0, "ass"), "as");
+    assert_eq!(type_str(0, "uww"), "uw");
+    assert_eq!(type_str(0, "ddd"), "dd");
+    assert_eq!(type_str(0, "asz"), "a");
+    assert_eq!(type_str(1, "a11"), "a1");
+}
+
+/// Telex keys for a Vietnamese word, mark key typed last
+fn telex(word: &str) -> Option<Vec<(u16, bool)>> {
+    let mut out = Vec::new();
+    let mut word_mark = mark::NONE;
+    for c in word.chars() {
+        let p = parse_char(c)?;
+        out.push((p.key, p.caps));
+        if p.stroke {
+            out.push((keys::D, false));
+        }
+        match p.tone {
+            tone::CIRCUMFLEX => out.push((p.key, false)),
+            tone::HORN => out.push((keys::W, false)),
+            _ => {}
+        }
+        if p.mark != mark::NONE {
+            word_mark = p.mark;
+        }
+    }
+    let mark_key = match word_mark {
+        mark::SAC => Some(keys::S),
+        mark::HUYEN => Some(keys::F),
+        mark::HOI => Some(keys::R),
+        mark::NGA => Some(keys::X),
+        mark::NANG => Some(keys::J),
+        _ => None,
+    };
+    out.extend(mark_key.map(|k| (k, false)));
+    Some(out)
+}
+
+#[test]
+fn test_vietnamese_corpus() {
+    let text = std::fs::read_to_string(concat!(
+        env!("CARGO_MANIFEST_DIR"),
+        "/../tests/data/vietnamese_22k.txt"
+    ))
+    .expect("corpus");
+    let mut total = 0;
+    let mut failures = Vec::new();
+    for word in text.split(|c: char| c.is_whitespace() || c == '-') {
+        let Some(keys) = telex(word).filter(|k| !k.is_empty()) else {
+            continue;
+        };
+        total += 1;
+        let typed = type_keys(0, &keys);
+        if typed != word {
+            failures.push((word, typed));
+        }
+    }
+    let rate = 100.0 * (total - failures.len()) as f64 / total as f64;
+    println!("corpus: {total} words, {rate:.2}% typed exactly");
+    for (word, typed) in failures.iter().take(20) {
+        println!("  {word} -> {typed}");
+    }
+    assert!(rate > 99.0, "pass rate {rate:.2}%");
+}
@@ -0,0 +1,10 @@
+//! Key, modifier and config sequences through `Engine::on_key_ext`
+#![no_main]
+
+use goxviet_fuzz::{check, CountingAlloc, Target};
+use libfuzzer_sys::fuzz_target;
+
+#[global_allocator]
+static ALLOC: CountingAlloc = CountingAlloc;
+
+fuzz_target!(|data: &[u8]| check(Target::Keys, data));
@@ -0,0 +1,10 @@
+//! `restore_word` strings, then keys that edit the restored word
+#![no_main]
+
+use goxviet_fuzz::{check, CountingAlloc, Target};
+use libfuzzer_sys::fuzz_target;
+
+#[global_allocator]
+static ALLOC: CountingAlloc = CountingAlloc;
+
+fuzz_target!(|data: &[u8]| check(Target::RestoreWord, data));
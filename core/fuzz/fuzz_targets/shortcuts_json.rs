@@ -0,0 +1,10 @@
+//! Shortcut JSON import, then typing the imported triggers
+#![no_main]
+
+use goxviet_fuzz::{check, CountingAlloc, Target};
+use libfuzzer_sys::fuzz_target;
+
+#[global_allocator]
+static ALLOC: CountingAlloc = CountingAlloc;
+
+fuzz_target!(|data: &[u8]| check(Target::ShortcutsJson, data));
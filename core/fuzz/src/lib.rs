@@ -0,0 +1,656 @@
+//! Fuzz Harness - inputs, oracles and saved cases
+//!
+//! Shared by the `cargo fuzz` targets (`fuzz_targets/`), the fuzz
+//! regression test (`tests/fuzz_regression_test.rs`) and the replay bench
+//! (`benches/fuzz_replay_bench.rs`), which include this file directly.
+//!
+//! Inputs are plain bytes decoded into engine operations, so libFuzzer's
+//! mutations become key, modifier and config changes:
+//! - `keys`: 2 bytes per operation (key + modifiers, config change, clear)
+//!   driven through `Engine::on_key_ext`
+//! - `shortcuts_json`: a document for `ShortcutTable::from_json` (and
+//!   `ime_import_shortcuts_json`), then every imported trigger is typed
+//! - `restore_word`: a word for `Engine::restore_word` (and
+//!   `ime_restore_word`), then `keys` operations that edit it
+//!
+//! Every result is applied to a model of the screen. Oracles, per step (a
+//! key, an import or a restore):
+//! - Overflow: a `u8` count saturated (255: the text was cut) or wrapped
+//!   (backspaces past the start of the screen)
+//! - Slow: the step took longer than `Limits::slow_key_ns`
+//! - Allocation spike: the step allocated more than `Limits::alloc_bytes`
+//!   (counted when `CountingAlloc` is the global allocator)
+//!
+//! `check` (the fuzz targets) panics on overflows. Slow steps and spikes
+//! must show up again on a second run, then the input is saved to
+//! `fuzz/slow/` where the replay bench picks it up as a benchmark case.
+
+use goxviet_core::data::keys;
+use goxviet_core::engine::edit_plan::{typed_char, COST_UNSUPPORTED};
+use goxviet_core::engine::shortcut::{Shortcut, ShortcutTable};
+use goxviet_core::engine::{Action, EditCosts, Engine, Result};
+use goxviet_core::input::layout::translate_char;
+use std::ffi::CString;
+use std::path::{Path, PathBuf};
+use std::sync::Once;
+use std::time::Instant;
+
+// ============================================================
+// Allocation counting
+// ============================================================
+
+// The allocator itself is shared with the allocation tests
+#[allow(dead_code)]
+#[path = "../../tests/support/counting_alloc.rs"]
+mod counting_alloc;
+
+/// Global allocator that counts the bytes each thread allocates
+pub use counting_alloc::CountingAlloc;
+
+fn allocated() -> usize {
+    counting_alloc::allocated_bytes()
+}
+
+// ============================================================
+// Limits and findings
+// ============================================================
+
+/// Thresholds for the slow-step and allocation oracles
+#[derive(Clone, Copy, Debug)]
+pub struct Limits {
+    pub slow_key_ns: u64,
+    pub alloc_bytes: usize,
+}
+
+impl Limits {
+    /// 1 ms per key, 256 KiB per key
+    pub const DEFAULT: Limits = Limits {
+        slow_key_ns: 1_000_000,
+        alloc_bytes: 256 * 1024,
+    };
+
+    /// Overflow oracle only (unoptimized builds, benchmarks)
+    pub const NONE: Limits = Limits {
+        slow_key_ns: u64::MAX,
+        alloc_bytes: usize::MAX,
+    };
+
+    /// `DEFAULT`, overridden by `GOXVIET_FUZZ_SLOW_US` and
+    /// `GOXVIET_FUZZ_ALLOC_KB`
+    pub fn from_env() -> Self {
+        let var = |name: &str| std::env::var(name).ok()?.parse::<u64>().ok();
+        let mut limits = Self::DEFAULT;
+        if let Some(us) = var("GOXVIET_FUZZ_SLOW_US") {
+            limits.slow_key_ns = us.saturating_mul(1000);
+        }
+        if let Some(kb) = var("GOXVIET_FUZZ_ALLOC_KB") {
+            limits.alloc_bytes = kb.saturating_mul(1024) as usize;
+        }
+        limits
+    }
+}
+
+/// Fuzz target
+#[derive(Clone, Copy, Debug, PartialEq, Eq)]
+pub enum Target {
+    Keys,
+    ShortcutsJson,
+    RestoreWord,
+}
+
+impl Target {
+    pub const ALL: [Target; 3] = [Target::Keys, Target::ShortcutsJson, Target::RestoreWord];
+
+    pub fn name(self) -> &'static str {
+        match self {
+            Target::Keys => "keys",
+            Target::ShortcutsJson => "shortcuts_json",
+            Target::RestoreWord => "restore_word",
+        }
+    }
+
+    pub fn from_name(name: &str) -> Option<Self> {
+        Self::ALL.into_iter().find(|t| t.name() == name)
+    }
+}
+
+/// What an oracle flagged, at which step of the input
+#[derive(Clone, Debug, PartialEq)]
+pub enum Finding {
+    Overflow { step: usize, detail: String },
+    Slow { step: usize, ns: u64 },
+    AllocSpike { step: usize, bytes: usize },
+}
+
+impl Finding {
+    /// Same oracle at the same step (timings differ between runs)
+    fn repeats(&self, other: &Finding) -> bool {
+        match (self, other) {
+            (Finding::Slow { step: a, .. }, Finding::Slow { step: b, .. }) => a == b,
+            (Finding::AllocSpike { step: a, .. }, Finding::AllocSpike { step: b, .. }) => a == b,
+            _ => self == other,
+        }
+    }
+}
+
+/// Measurements and findings of one input
+#[derive(Debug, Default)]
+pub struct Run {
+    /// Steps measured (keys, imports, restores)
+    pub steps: usize,
+    pub total_ns: u64,
+    pub max_step_ns: u64,
+    pub max_step_alloc: usize,
+    pub findings: Vec<Finding>,
+}
+
+impl Run {
+    /// Record a step that took `ns` and allocated `bytes`, against a
+    /// budget of `budget` × the limits
+    fn measure(&mut self, ns: u64, bytes: usize, limits: &Limits, budget: u64) {
+        let step = self.steps;
+        self.steps += 1;
+        self.total_ns += ns;
+        self.max_step_ns = self.max_step_ns.max(ns);
+        self.max_step_alloc = self.max_step_alloc.max(bytes);
+        if ns > limits.slow_key_ns.saturating_mul(budget) {
+            self.findings.push(Finding::Slow { step, ns });
+        }
+        if bytes > limits.alloc_bytes.saturating_mul(budget as usize) {
+            self.findings.push(Finding::AllocSpike { step, bytes });
+        }
+    }
+
+    fn overflow(&mut self, detail: String) {
+        let step = self.steps.saturating_sub(1);
+        self.findings.push(Finding::Overflow { step, detail });
+    }
+
+    pub fn overflows(&self) -> impl Iterator<Item = &Finding> {
+        self.findings
+            .iter()
+            .filter(|f| matches!(f, Finding::Overflow { .. }))
+    }
+}
+
+// ============================================================
+// Operations
+// ============================================================
+
+/// Keys an operation byte selects from (letters twice as likely)
+const KEY_POOL: [u16; 72] = {
+    use keys::*;
+    const LETTERS: [u16; 26] = [
+        A, B, C, D, E, F, G, H, I, J, K, L, M, N, O, P, Q, R, S, T, U, V, W, X, Y, Z,
+    ];
+    const OTHER: [u16; 20] = [
+        N0, N1, N2, N3, N4, N5, N6, N7, N8, N9, SPACE, DELETE, RETURN, ESC, TAB, LEFT, DOT, COMMA,
+        LBRACKET, RBRACKET,
+    ];
+    let mut pool = [0u16; 72];
+    let mut i = 0;
+    while i < 26 {
+        pool[i] = LETTERS[i];
+        pool[26 + i] = LETTERS[i];
+        i += 1;
+    }
+    let mut j = 0;
+    while j < 20 {
+        pool[52 + j] = OTHER[j];
+        j += 1;
+    }
+    pool
+};
+
+/// Injection cost models for config changes (see `EditCosts`)
+const COST_MODELS: [EditCosts; 3] = [
+    EditCosts {
+        per_edit: 20,
+        per_backspace: 30,
+        per_char: 10,
+        per_replace: 25,
+        per_deferred_key: COST_UNSUPPORTED,
+    },
+    EditCosts {
+        per_edit: 2000,
+        per_backspace: 1,
+        per_char: 1,
+        per_replace: 0,
+        per_deferred_key: 50,
+    },
+    EditCosts::BACKSPACE,
+];
+
+/// Shortcuts a config change adds
+const SHORTCUTS: [(&str, &str); 4] = [
+    ("vn", "Việt Nam"),
+    ("ko", "không"),
+    ("hcm", "Thành phố Hồ Chí Minh"),
+    (
+        "ddc",
+        "địa chỉ: số 1 đường Nguyễn Trãi, phường Bến Thành, quận 1",
+    ),
+];
+
+/// First config operation byte (`0xF0 + n` sets option `n`)
+const CONFIG: u8 = 0xF0;
+/// `Engine::clear` / `Engine::clear_all`
+const CLEAR: u8 = 0xFE;
+const CLEAR_ALL: u8 = 0xFF;
+
+/// One engine operation
+#[derive(Clone, Copy, Debug)]
+pub enum Op {
+    Key {
+        key: u16,
+        caps: bool,
+        ctrl: bool,
+        shift: bool,
+    },
+    Config(u8, u8),
+    Clear {
+        all: bool,
+    },
+}
+
+/// Decode `keys` operations, 2 bytes each
+pub fn ops(data: &[u8]) -> impl Iterator<Item = Op> + '_ {
+    data.chunks_exact(2).map(|op| match op[0] {
+        CLEAR => Op::Clear { all: false },
+        CLEAR_ALL => Op::Clear { all: true },
+        b if b >= CONFIG => Op::Config(b - CONFIG, op[1]),
+        b => Op::Key {
+            key: KEY_POOL[b as usize % KEY_POOL.len()],
+            caps: op[1] & 1 != 0,
+            shift: op[1] & 2 != 0,
+            // Rare: most Ctrl keys just end the word
+            ctrl: op[1] & 0x1C == 0x1C,
+        },
+    })
+}
+
+/// Encode text as `keys` operations (characters without a key are skipped)
+pub fn text_ops(text: &str) -> Vec<u8> {
+    let mut out = Vec::new();
+    for c in text.chars() {
+        let Some(k) = translate_char(c) else {
+            continue;
+        };
+        let Some(i) = KEY_POOL.iter().position(|&key| key == k.key) else {
+            continue;
+        };
+        out.extend([i as u8, k.caps as u8 | (k.shift as u8) << 1]);
+    }
+    out
+}
+
+/// Encode a config change as a `keys` operation
+pub fn config_op(option: u8, value: u8) -> [u8; 2] {
+    [CONFIG + option, value]
+}
+
+fn configure(e: &mut Engine, option: u8, value: u8) {
+    let on = value & 1 != 0;
+    match option {
+        0 => e.set_method(value % 2),
+        1 => e.set_enabled(on),
+        2 => e.set_modern_tone(on),
+        3 => e.set_free_tone(on),
+        4 => e.set_esc_restore(on),
+        5 => e.set_skip_w_shortcut(on),
+        6 => e.set_english_auto_restore(on),
+        7 => e.set_low_amplification(on),
+        8 => e.set_shortcodes_enabled(on),
+        9 => match value as usize % (COST_MODELS.len() + 1) {
+            0 => e.clear_edit_costs(),
+            n => e.set_edit_costs(COST_MODELS[n - 1]),
+        },
+        10 => {
+            let (trigger, text) = SHORTCUTS[value as usize % SHORTCUTS.len()];
+            e.shortcuts_mut().add(Shortcut::new(trigger, text));
+        }
+        11 => e.set_adaptive_learning(on),
+        _ => {}
+    }
+}
+
+// ============================================================
+// Screen model and drivers
+// ============================================================
+
+/// Text the application would show for a key the engine passes through
+fn pass_through(screen: &mut Vec<char>, key: u16, caps: bool, ctrl: bool, shift: bool) {
+    if key == keys::DELETE && !ctrl {
+        screen.pop();
+    } else if let Some(c) = typed_char(key, caps, ctrl, shift) {
+        screen.push(c);
+    }
+}
+
+/// Apply a result to the screen; the overflow it shows, if any
+fn apply(screen: &mut Vec<char>, op: (u16, bool, bool, bool), r: &Result) -> Option<String> {
+    let (key, caps, ctrl, shift) = op;
+    if r.action == Action::None as u8 {
+        pass_through(screen, key, caps, ctrl, shift);
+        return None;
+    }
+    if r.count == u8::MAX || r.backspace == u8::MAX {
+        return Some(format!(
+            "saturated count: backspace {} count {}",
+            r.backspace, r.count
+        ));
+    }
+    let bs = r.backspace as usize;
+    let keep = if r.action == Action::ReplaceRange as u8 {
+        r.keep as usize
+    } else {
+        0
+    };
+    if bs + keep > screen.len() {
+        return Some(format!(
+            "{bs} backspaces ({keep} kept) past a screen of {}",
+            screen.len()
+        ));
+    }
+    let end = screen.len() - keep;
+    let chars = r.as_slice().iter().filter_map(|&c| char::from_u32(c));
+    screen.splice(end - bs..end, chars);
+    if r.action == Action::CommitPassThrough as u8 {
+        pass_through(screen, key, caps, ctrl, shift);
+    }
+    None
+}
+
+/// Time, count and apply one key
+fn key(
+    e: &mut Engine,
+    screen: &mut Vec<char>,
+    op: (u16, bool, bool, bool),
+    limits: &Limits,
+    run: &mut Run,
+) {
+    let before = allocated();
+    let start = Instant::now();
+    let r = e.on_key_ext(op.0, op.1, op.2, op.3);
+    let ns = start.elapsed().as_nanos() as u64;
+    run.measure(ns, allocated().wrapping_sub(before), limits, 1);
+    if let Some(detail) = apply(screen, op, &r) {
+        run.overflow(detail);
+    }
+    r.release();
+}
+
+fn drive(e: &mut Engine, screen: &mut Vec<char>, data: &[u8], limits: &Limits, run: &mut Run) {
+    for op in ops(data) {
+        match op {
+            Op::Key {
+                key: k,
+                caps,
+                ctrl,
+                shift,
+            } => key(e, screen, (k, caps, ctrl, shift), limits, run),
+            Op::Config(option, value) => configure(e, option, value),
+            Op::Clear { all: true } => e.clear_all(),
+            Op::Clear { all: false } => e.clear(),
+        }
+    }
+}
+
+/// Load what the engine initializes once per process (dictionaries,
+/// tables) so it does not count as a spike in the first input
+fn warm_up() {
+    static WARM: Once = Once::new();
+    WARM.call_once(|| {
+        goxviet_core::ime_init();
+        let mut e = Engine::new();
+        let mut screen = Vec::new();
+        let mut run = Run::default();
+        let session = text_ops("tieengs vieejt the restore process vn ");
+        drive(&mut e, &mut screen, &session, &Limits::NONE, &mut run);
+    });
+}
+
+/// Run one input of `target` against fresh engines
+pub fn run(target: Target, data: &[u8], limits: &Limits) -> Run {
+    warm_up();
+    let mut run = Run::default();
+    let mut e = Engine::new();
+    let mut screen = Vec::new();
+    match target {
+        Target::Keys => drive(&mut e, &mut screen, data, limits, &mut run),
+        Target::ShortcutsJson => shortcuts_json(&mut e, &mut screen, data, limits, &mut run),
+        Target::RestoreWord => restore_word(&mut e, &mut screen, data, limits, &mut run),
+    }
+    run
+}
+
+/// Budget for a step over `len` bytes of input, in keys
+fn budget(len: usize) -> u64 {
+    1 + len as u64 / 256
+}
+
+fn shortcuts_json(
+    e: &mut Engine,
+    screen: &mut Vec<char>,
+    data: &[u8],
+    limits: &Limits,
+    run: &mut Run,
+) {
+    let json = String::from_utf8_lossy(data);
+
+    // FFI path: null/UTF-8 checks and the global engine
+    if let Ok(c) = CString::new(data.iter().copied().filter(|&b| b != 0).collect::<Vec<_>>()) {
+        unsafe {
+            goxviet_core::ime_import_shortcuts_json(c.as_ptr());
+        }
+        goxviet_core::ime_clear_shortcuts();
+    }
+
+    let before = allocated();
+    let start = Instant::now();
+    let imported = e.shortcuts_mut().from_json(&json);
+    let ns = start.elapsed().as_nanos() as u64;
+    run.measure(
+        ns,
+        allocated().wrapping_sub(before),
+        limits,
+        budget(data.len()),
+    );
+    if imported.is_err() {
+        return;
+    }
+
+    // Type each trigger (and the word boundary that expands it)
+    let triggers: Vec<String> = e
+        .shortcuts()
+        .iter()
+        .take(16)
+        .map(|s| s.trigger.clone())
+        .collect();
+    for trigger in triggers {
+        let mut typed = text_ops(&trigger);
+        typed.extend(text_ops(" "));
+        drive(e, screen, &typed, limits, run);
+    }
+}
+
+/// Letters a restored word is made of (byte % len; bit 7 capitalizes)
+const WORD_LETTERS: &str = "abcdeghiklmnopqrstuvxyđăâêôơưáàảãạấầẩẫậắằẳẵặéèẻẽẹếềểễệíìỉĩị\
+                            óòỏõọốồổỗộớờởỡợúùủũụứừửữựýỳỷỹỵfjwz";
+
+/// Encode a word as the start of a `restore_word` input
+pub fn restore_input(word: &str, then: &[u8]) -> Vec<u8> {
+    let letters: Vec<char> = WORD_LETTERS.chars().collect();
+    let mut out = vec![0];
+    for c in word.chars() {
+        let lower = c.to_lowercase().next().unwrap_or(c);
+        if let Some(i) = letters.iter().position(|&l| l == lower) {
+            out.push(i as u8 | if c.is_uppercase() { 0x80 } else { 0 });
+        }
+    }
+    out[0] = (out.len() - 1) as u8;
+    out.extend_from_slice(then);
+    out
+}
+
+fn restore_word(
+    e: &mut Engine,
+    screen: &mut Vec<char>,
+    data: &[u8],
+    limits: &Limits,
+    run: &mut Run,
+) {
+    let Some((&len, rest)) = data.split_first() else {
+        return;
+    };
+    let (word_bytes, ops) = rest.split_at((len as usize).min(rest.len()));
+    let letters: Vec<char> = WORD_LETTERS.chars().collect();
+    let word: String = word_bytes
+        .iter()
+        .map(|&b| {
+            let c = letters[(b & 0x7F) as usize % letters.len()];
+            if b & 0x80 != 0 {
+                c.to_uppercase().next().unwrap_or(c)
+            } else {
+                c
+            }
+        })
+        .collect();
+
+    // FFI path with the raw bytes (any UTF-8, or not)
+    if let Ok(c) = CString::new(
+        word_bytes
+            .iter()
+            .copied()
+            .filter(|&b| b != 0)
+            .collect::<Vec<_>>(),
+    ) {
+        unsafe {
+            goxviet_core::ime_restore_word(c.as_ptr());
+        }
+    }
+
+    // The word is on screen when the platform restores it
+    screen.extend(word.chars());
+    let before = allocated();
+    let start = Instant::now();
+    e.restore_word(&word);
+    let ns = start.elapsed().as_nanos() as u64;
+    run.measure(
+        ns,
+        allocated().wrapping_sub(before),
+        limits,
+        budget(word.len()),
+    );
+    drive(e, screen, ops, limits, run);
+}
+
+// ============================================================
+// Fuzz target entry and saved cases
+// ============================================================
+
+/// Fuzz target body: panics on overflows; saves inputs whose slow steps
+/// or allocation spikes repeat (and panics too with `GOXVIET_FUZZ_STRICT`)
+pub fn check(target: Target, data: &[u8]) {
+    let limits = Limits::from_env();
+    let first = run(target, data, &limits);
+    if let Some(f) = first.overflows().next() {
+        panic!("{}: {f:?}", target.name());
+    }
+    if first.findings.is_empty() {
+        return;
+    }
+    let again = run(target, data, &limits);
+    let repeated: Vec<&Finding> = first
+        .findings
+        .iter()
+        .filter(|f| again.findings.iter().any(|g| f.repeats(g)))
+        .collect();
+    if repeated.is_empty() {
+        return;
+    }
+    match save_case(target, data) {
+        Ok(path) => eprintln!(
+            "{}: {repeated:?} saved to {}",
+            target.name(),
+            path.display()
+        ),
+        Err(err) => eprintln!("{}: {repeated:?} (not saved: {err})", target.name()),
+    }
+    if std::env::var_os("GOXVIET_FUZZ_STRICT").is_some() {
+        panic!("{}: {repeated:?}", target.name());
+    }
+}
+
+/// Saved slow inputs: `GOXVIET_FUZZ_SLOW_DIR`, else `core/fuzz/slow`
+pub fn slow_dir() -> PathBuf {
+    if let Some(dir) = std::env::var_os("GOXVIET_FUZZ_SLOW_DIR") {
+        return dir.into();
+    }
+    let manifest = Path::new(env!("CARGO_MANIFEST_DIR"));
+    if env!("CARGO_PKG_NAME") == "goxviet-fuzz" {
+        manifest.join("slow")
+    } else {
+        manifest.join("fuzz").join("slow")
+    }
+}
+
+/// FNV-1a, names saved inputs by content
+fn fnv1a(data: &[u8]) -> u64 {
+    data.iter().fold(0xcbf2_9ce4_8422_2325, |h, &b| {
+        (h ^ b as u64).wrapping_mul(0x0100_0000_01b3)
+    })
+}
+
+/// Save an input as `<target>-<hash>.bin`
+pub fn save_case(target: Target, data: &[u8]) -> std::io::Result<PathBuf> {
+    let dir = slow_dir();
+    std::fs::create_dir_all(&dir)?;
+    let path = dir.join(format!("{}-{:016x}.bin", target.name(), fnv1a(data)));
+    std::fs::write(&path, data)?;
+    Ok(path)
+}
+
+/// Saved inputs, sorted by name: (name, target, bytes)
+pub fn saved_cases() -> Vec<(String, Target, Vec<u8>)> {
+    let Ok(entries) = std::fs::read_dir(slow_dir()) else {
+        return Vec::new();
+    };
+    let mut cases: Vec<_> = entries
+        .filter_map(|entry| {
+            let path = entry.ok()?.path();
+            let name = path.file_stem()?.to_str()?.to_string();
+            let target = Target::from_name(name.rsplit_once('-')?.0)?;
+            let data = std::fs::read(&path).ok()?;
+            Some((name, target, data))
+        })
+        .collect();
+    cases.sort_by(|a, b| a.0.cmp(&b.0));
+    cases
+}
+
+/// Representative inputs of each target (fuzzing seeds, bench baseline)
+pub fn seeds() -> Vec<(String, Target, Vec<u8>)> {
+    let prose = "tieengs vieejt laf ngoon nguwx cuar nguwowif vieejt nam. \
+                 the restore process should keep english words intact, \
+                 vn oke! hoaf\x08\x08af nguoiwf\x08\x08\x08 @home 100% ";
+    let mut keys = text_ops(prose);
+    for (option, value) in [(0, 1), (2, 0), (9, 1), (10, 0)] {
+        keys.extend(config_op(option, value));
+    }
+    keys.extend(text_ops("vie65t na1m vn d9a61t nu7o71c "));
+
+    let mut table = ShortcutTable::new();
+    for (trigger, text) in SHORTCUTS {
+        table.add(Shortcut::new(trigger, text));
+    }
+    let json = table.to_json().into_bytes();
+
+    let restore = restore_input("Nguyễn", &text_ops("\x08\x08\x08eenx vieejt"));
+
+    vec![
+        ("seed-keys".into(), Target::Keys, keys),
+        ("seed-shortcuts_json".into(), Target::ShortcutsJson, json),
+        ("seed-restore_word".into(), Target::RestoreWord, restore),
+    ]
+}
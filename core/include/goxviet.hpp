@@ -0,0 +1,414 @@
+/*
+ * goxviet.hpp - Header-only C++ wrapper for the GoxViet C ABI
+ *
+ * - Engine: move-only owner of the core engine (ime_init / ime_shutdown)
+ * - KeyResult / KeyResult16: reusable result storage with an inline
+ *   buffer; ime_key_into_utf32 / _utf16 write the edit into it. Once the
+ *   engine is warm, neither the wrapper nor the core allocates per key,
+ *   with low amplification and edit costs too (tests/scratch_arena_test.rs)
+ * - String / Bytes / ResultPtr: RAII owners of what the core returns
+ *   (ime_free_string, ime_free_bytes, ime_free)
+ *
+ * The core holds one engine per process, so keep one owning Engine.
+ * Requires C++17; std::span accessors are available with C++20.
+ *
+ *   goxviet::Engine ime;
+ *   ime.set_method(goxviet::Method::Telex);
+ *   goxviet::KeyResult r;              // reuse across keys
+ *   if (ime.key(keycode, caps, ctrl, shift, r) && r.handled()) {
+ *       delete_chars(r.backspace());
+ *       insert(r.text());              // std::u32string_view into r
+ *   }
+ */
+
+#ifndef GOXVIET_HPP
+#define GOXVIET_HPP
+
+#include "goxviet.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string_view>
+#include <utility>
+
+#if __has_include(<version>)
+#include <version>
+#endif
+#ifdef __cpp_lib_span
+#include <span>
+#endif
+
+namespace goxviet {
+
+/// What the platform should do with a key (`ImeResult.action`)
+enum class Action : std::uint8_t {
+    None = 0,
+    Send = 1,
+    Restore = 2,
+    Preedit = 3,
+    Commit = 4,
+    CommitPassThrough = 5,
+    ReplaceRange = 6,
+};
+
+enum class Method : std::uint8_t { Telex = 0, Vni = 1 };
+
+enum class NormalizationForm : std::uint8_t { Nfc = 0, Nfd = 1 };
+
+enum class ScancodeSet : std::uint8_t { MacOs = 0, Evdev = 1, WindowsVk = 2 };
+
+enum class Layout : std::uint8_t { Us = 0, Dvorak = 1, Colemak = 2, Azerty = 3 };
+
+/// What to do with a key offered to burst mode (`Engine::burst_key`)
+enum class BurstKey : std::uint8_t { Pass = 0, Queued = 1, Flush = 2 };
+
+class Engine;
+
+namespace detail {
+
+template <class Char, class Unit, std::size_t N,
+          std::int32_t (*Into)(std::uint16_t, bool, bool, bool, Unit*, std::size_t,
+                               std::uint8_t*, std::uint8_t*)>
+class BasicKeyResult {
+    static_assert(sizeof(Char) == sizeof(Unit) && alignof(Char) == alignof(Unit),
+                  "inline buffer is passed to the C ABI as Unit*");
+
+public:
+    /// Inline buffer size (covers the longest edit, NFD included)
+    static constexpr std::size_t capacity = N;
+
+    Action action() const noexcept { return static_cast<Action>(action_); }
+    /// True if the key was consumed / produced an edit
+    bool handled() const noexcept { return action_ != 0; }
+    /// Characters to delete before inserting `text()`
+    std::uint8_t backspace() const noexcept { return backspace_; }
+    /// Code units in `text()`
+    std::size_t size() const noexcept { return len_; }
+    bool empty() const noexcept { return len_ == 0; }
+
+    /// Inserted text; valid until this result is reused
+    std::basic_string_view<Char> text() const noexcept { return {buf_, len_}; }
+#ifdef __cpp_lib_span
+    std::span<const Char> chars() const noexcept { return {buf_, len_}; }
+#endif
+
+    void reset() noexcept {
+        len_ = 0;
+        action_ = 0;
+        backspace_ = 0;
+    }
+
+private:
+    friend class goxviet::Engine;
+
+    bool process(std::uint16_t key, bool caps, bool ctrl, bool shift) noexcept {
+        const std::int32_t n = Into(key, caps, ctrl, shift, reinterpret_cast<Unit*>(buf_), N,
+                                    &action_, &backspace_);
+        if (n < 0) {
+            reset();
+            return false;
+        }
+        len_ = static_cast<std::size_t>(n);
+        return true;
+    }
+
+    // Left uninitialized: only the first `len_` units are ever read
+    Char buf_[N];
+    std::size_t len_ = 0;
+    std::uint8_t action_ = 0;
+    std::uint8_t backspace_ = 0;
+};
+
+struct ResultDeleter {
+    void operator()(ImeResult* r) const noexcept { ime_free(r); }
+};
+
+struct WideResultDeleter {
+    void operator()(ImeWideResult* r) const noexcept { ime_free_wide(r); }
+};
+
+}  // namespace detail
+
+/// Reusable UTF-32 key result (`ime_key_into_utf32`)
+using KeyResult = detail::BasicKeyResult<char32_t, std::uint32_t, IME_MAX_UTF32_LEN,
+                                         &ime_key_into_utf32>;
+/// Reusable UTF-16 key result (`ime_key_into_utf16`)
+using KeyResult16 = detail::BasicKeyResult<char16_t, std::uint16_t, IME_MAX_UTF16_LEN,
+                                           &ime_key_into_utf16>;
+
+/// Owned `ImeResult` from the calls that still return one
+/// (`commit_preedit`, `select_shortcode`)
+using ResultPtr = std::unique_ptr<ImeResult, detail::ResultDeleter>;
+
+/// Owned `ImeWideResult` (`burst_end`)
+using WideResultPtr = std::unique_ptr<ImeWideResult, detail::WideResultDeleter>;
+
+/// Owned string returned by the core (freed with `ime_free_string`)
+class String {
+public:
+    String() noexcept = default;
+    explicit String(char* p) noexcept : p_(p) {}
+    String(String&& o) noexcept : p_(std::exchange(o.p_, nullptr)) {}
+    String& operator=(String&& o) noexcept {
+        if (this != &o) {
+            reset();
+            p_ = std::exchange(o.p_, nullptr);
+        }
+        return *this;
+    }
+    String(const String&) = delete;
+    String& operator=(const String&) = delete;
+    ~String() { reset(); }
+
+    void reset() noexcept {
+        if (p_ != nullptr) {
+            ime_free_string(p_);
+            p_ = nullptr;
+        }
+    }
+
+    explicit operator bool() const noexcept { return p_ != nullptr; }
+    const char* c_str() const noexcept { return p_ != nullptr ? p_ : ""; }
+    std::string_view view() const noexcept {
+        return p_ != nullptr ? std::string_view(p_) : std::string_view();
+    }
+
+private:
+    char* p_ = nullptr;
+};
+
+/// Owned byte buffer returned by the core (freed with `ime_free_bytes`)
+class Bytes {
+public:
+    Bytes() noexcept = default;
+    Bytes(std::uint8_t* p, std::size_t n) noexcept : p_(p), n_(p != nullptr ? n : 0) {}
+    Bytes(Bytes&& o) noexcept
+        : p_(std::exchange(o.p_, nullptr)), n_(std::exchange(o.n_, 0)) {}
+    Bytes& operator=(Bytes&& o) noexcept {
+        if (this != &o) {
+            reset();
+            p_ = std::exchange(o.p_, nullptr);
+            n_ = std::exchange(o.n_, 0);
+        }
+        return *this;
+    }
+    Bytes(const Bytes&) = delete;
+    Bytes& operator=(const Bytes&) = delete;
+    ~Bytes() { reset(); }
+
+    void reset() noexcept {
+        if (p_ != nullptr) {
+            ime_free_bytes(p_, n_);
+            p_ = nullptr;
+            n_ = 0;
+        }
+    }
+
+    explicit operator bool() const noexcept { return p_ != nullptr; }
+    const std::uint8_t* data() const noexcept { return p_; }
+    std::size_t size() const noexcept { return n_; }
+#ifdef __cpp_lib_span
+    std::span<const std::uint8_t> bytes() const noexcept { return {p_, n_}; }
+#endif
+
+private:
+    std::uint8_t* p_ = nullptr;
+    std::size_t n_ = 0;
+};
+
+/// Owner of the process-wide core engine
+///
+/// Constructing initializes the engine, destroying the owning handle shuts
+/// it down. Moved-from handles own nothing.
+class Engine {
+public:
+    Engine() noexcept { ime_init(); }
+    Engine(Engine&& o) noexcept : owner_(std::exchange(o.owner_, false)) {}
+    Engine& operator=(Engine&& o) noexcept {
+        if (this != &o) {
+            // Both handles refer to the same process-wide engine
+            const bool incoming = std::exchange(o.owner_, false);
+            if (owner_ && !incoming) {
+                ime_shutdown();
+            }
+            owner_ = incoming;
+        }
+        return *this;
+    }
+    Engine(const Engine&) = delete;
+    Engine& operator=(const Engine&) = delete;
+    ~Engine() {
+        if (owner_) {
+            ime_shutdown();
+        }
+    }
+
+    bool owns() const noexcept { return owner_; }
+
+    // ---- Key processing ----
+
+    /// Process a key into reusable storage (no allocation); false if not
+    /// processed
+    template <class Result>
+    bool key(std::uint16_t key, bool caps, bool ctrl, bool shift, Result& out) noexcept {
+        return out.process(key, caps, ctrl, shift);
+    }
+
+    /// Process a Unicode character (IME text events)
+    ResultPtr key_char(char32_t c, bool ctrl = false) noexcept {
+        return ResultPtr(ime_key_char(static_cast<std::uint32_t>(c), ctrl));
+    }
+
+    /// Process a platform scancode under a keyboard layout
+    ResultPtr key_scancode(ScancodeSet set, Layout layout, std::uint16_t code, bool caps,
+                           bool ctrl, bool shift) noexcept {
+        return ResultPtr(ime_key_scancode(static_cast<std::uint8_t>(set),
+                                          static_cast<std::uint8_t>(layout), code, caps, ctrl,
+                                          shift));
+    }
+
+    /// Commit marked text (composition mode)
+    ResultPtr commit_preedit() noexcept { return ResultPtr(ime_commit_preedit()); }
+
+    /// Settle a deferred edit (edit planner with deferral on)
+    ResultPtr settle_edit() noexcept { return ResultPtr(ime_settle_edit()); }
+
+    /// Replace the typed :code with a shortcode candidate
+    ResultPtr select_shortcode(std::uint32_t index) noexcept {
+        return ResultPtr(ime_select_shortcode(index));
+    }
+
+    /// Current buffer (UTF-8); valid until the next call
+    std::string_view buffer() const noexcept {
+        const char* s = ime_get_buffer();
+        return s != nullptr ? std::string_view(s) : std::string_view();
+    }
+
+    void clear() noexcept { ime_clear(); }
+    void clear_all() noexcept { ime_clear_all(); }
+    void restore_word(const char* word) noexcept { ime_restore_word(word); }
+
+    // ---- Configuration ----
+
+    void set_method(Method m) noexcept { ime_method(static_cast<std::uint8_t>(m)); }
+    /// 0 on success, else the line of the first error (or -1)
+    std::int32_t load_method(const char* definition) noexcept {
+        return ime_load_method(definition);
+    }
+
+    void set_enabled(bool enabled) noexcept { ime_enabled(enabled); }
+    void set_modern_tone(bool modern) noexcept { ime_modern(modern); }
+    void set_free_tone(bool enabled) noexcept { ime_free_tone(enabled); }
+    void set_esc_restore(bool enabled) noexcept { ime_esc_restore(enabled); }
+    void set_instant_restore(bool enabled) noexcept { ime_instant_restore(enabled); }
+    void set_skip_w_shortcut(bool skip) noexcept { ime_skip_w_shortcut(skip); }
+    void set_composition_mode(bool enabled) noexcept { ime_set_composition_mode(enabled); }
+    void set_low_amplification(bool enabled) noexcept { ime_set_low_amplification(enabled); }
+    /// Plan edits for the injection costs (UINT32_MAX: not supported)
+    bool set_edit_costs(std::uint32_t per_edit, std::uint32_t per_backspace,
+                        std::uint32_t per_char, std::uint32_t per_replace,
+                        std::uint32_t per_deferred_key) noexcept {
+        return ime_set_edit_costs(per_edit, per_backspace, per_char, per_replace,
+                                  per_deferred_key);
+    }
+    void clear_edit_costs() noexcept { ime_clear_edit_costs(); }
+    bool set_output_form(NormalizationForm form) noexcept {
+        return ime_set_output_form(static_cast<std::uint8_t>(form));
+    }
+
+    // ---- Per-App Profiles ----
+
+    static std::uint64_t profile_id(const char* app) noexcept { return ime_profile_id(app); }
+    bool activate_profile(std::uint64_t id) noexcept { return ime_activate_profile(id); }
+    void set_profile_own_shortcuts(bool own) noexcept { ime_profile_own_shortcuts(own); }
+    bool remove_profile(std::uint64_t id) noexcept { return ime_remove_profile(id); }
+
+    // ---- Committed-Word Events ----
+
+    void set_commit_events(bool enabled) noexcept { ime_commit_events(enabled); }
+    /// Records written, 0 while another thread drains, -1 for null `out`
+    std::int32_t drain_commits(ImeCommitRecord* out, std::size_t capacity) noexcept {
+        return ime_drain_commits(out, capacity);
+    }
+    static std::uint32_t commits_dropped() noexcept { return ime_commits_dropped(); }
+
+    // ---- Latency Attribution ----
+
+    /// `ime_key_ext` with latency recording (`ime_key_timed`)
+    ResultPtr key_timed(std::uint16_t key, bool caps, bool ctrl, bool shift,
+                        std::uint64_t event_ns, std::uint64_t received_ns) noexcept {
+        return ResultPtr(ime_key_timed(key, caps, ctrl, shift, event_ns, received_ns));
+    }
+    bool key_injected(std::uint64_t done_ns) noexcept { return ime_key_injected(done_ns); }
+    static bool latency_stats(std::uint8_t stage, ImeLatencyStats& out) noexcept {
+        return ime_latency_stats(stage, &out);
+    }
+    static void reset_latency() noexcept { ime_latency_reset(); }
+
+    // ---- Burst Mode ----
+
+    bool burst_begin() noexcept { return ime_burst_begin(); }
+    /// Call before `key` for every key; see `BurstKey`
+    BurstKey burst_key(std::uint16_t key, bool caps, bool ctrl, bool shift,
+                       std::uint64_t event_ns) noexcept {
+        return static_cast<BurstKey>(ime_burst_key(key, caps, ctrl, shift, event_ns));
+    }
+    /// Coalesced edit; past `inline_limit` chars read it with `ime_read_expansion`
+    WideResultPtr burst_end(std::uint32_t inline_limit) noexcept {
+        return WideResultPtr(ime_burst_end(inline_limit));
+    }
+    void set_burst_detection(std::uint64_t gap_ns, std::uint32_t min_keys) noexcept {
+        ime_set_burst_detection(gap_ns, min_keys);
+    }
+
+    // ---- Shortcuts ----
+
+    bool add_shortcut(const char* trigger, const char* replacement) noexcept {
+        return ime_add_shortcut(trigger, replacement);
+    }
+    bool add_snippet(const char* trigger, const char* replacement) noexcept {
+        return ime_add_snippet(trigger, replacement);
+    }
+    void remove_shortcut(const char* trigger) noexcept { ime_remove_shortcut(trigger); }
+    void clear_shortcuts() noexcept { ime_clear_shortcuts(); }
+    void set_shortcuts_enabled(bool enabled) noexcept { ime_set_shortcuts_enabled(enabled); }
+    std::size_t shortcuts_count() const noexcept { return ime_shortcuts_count(); }
+    String export_shortcuts_json() const noexcept { return String(ime_export_shortcuts_json()); }
+    std::int32_t import_shortcuts_json(const char* json) noexcept {
+        return ime_import_shortcuts_json(json);
+    }
+
+private:
+    bool owner_ = true;
+};
+
+/// Whether the library was built with a subsystem (IME_FEATURE_* bit)
+inline bool has_feature(std::uint32_t feature) noexcept { return (ime_features() & feature) != 0; }
+
+/// Scancode to engine key for Engine::key (nullopt if none)
+inline std::optional<std::uint16_t> translate_scancode(ScancodeSet set, Layout layout,
+                                                       std::uint16_t code) noexcept {
+    const std::uint16_t key = ime_translate_scancode(static_cast<std::uint8_t>(set),
+                                                     static_cast<std::uint8_t>(layout), code);
+    return key != IME_NO_KEY ? std::optional<std::uint16_t>(key) : std::nullopt;
+}
+
+/// Page in the English dictionaries on a background thread (call at startup)
+inline bool prefetch_dictionaries() noexcept { return ime_prefetch_dictionaries(); }
+
+// ---- Legacy encodings (process-wide, independent of the engine) ----
+
+inline void set_encoding(std::uint8_t encoding) noexcept { ime_set_encoding(encoding); }
+
+/// Convert UTF-8 text to the current encoding (empty Bytes on error)
+inline Bytes convert_encoding(const char* utf8) noexcept {
+    std::size_t len = 0;
+    std::uint8_t* p = ime_convert_encoding_ext(utf8, &len);
+    return Bytes(p, len);
+}
+
+}  // namespace goxviet
+
+#endif /* GOXVIET_HPP */
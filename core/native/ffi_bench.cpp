@@ -0,0 +1,273 @@
+// ffi_bench.cpp - Per-call latency of the C ABI from a foreign caller
+//
+// Replays the test corpora (Vietnamese words as Telex, English words as
+// typed, SPACE after each word) through the functions the platform layer
+// calls, declared by goxviet-Bridging-Header.h:
+//
+//   key_ext   ime_key_ext -> read chars -> ime_free   (production path:
+//             heap Result allocated in Rust, freed across the boundary)
+//   into16    ime_key_into_utf16 into a stack buffer (no allocation)
+//
+// Every call is timed individually; the report gives mean and p50/p90/
+// p99/p99.9/max in ns, plus the split between ime_key_ext and ime_free.
+//
+// Build and run with CMake (see CMakeLists.txt):
+//   cmake -S native -B native/build && cmake --build native/build
+//   native/build/ffi_bench [--rounds N] [--limit WORDS] [--data DIR]
+
+extern "C" {
+#include "goxviet-Bridging-Header.h"
+}
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#ifndef GOXVIET_DATA_DIR
+#define GOXVIET_DATA_DIR "tests/data"
+#endif
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Key {
+    std::uint16_t code;
+    bool caps;
+};
+
+// macOS virtual keycodes for 'a'..'z' (see core/src/data/keys.rs)
+constexpr std::uint16_t kLetterKeys[26] = {
+    0, 11, 8, 2, 14, 3, 5, 4, 34, 38, 40, 37, 46,
+    45, 31, 35, 12, 15, 1, 17, 32, 9, 13, 7, 16, 6,
+};
+constexpr std::uint16_t kSpace = 49;
+
+// ---- UTF-8 → Telex ----
+
+/// How a Vietnamese letter is typed in Telex
+struct Telex {
+    char base;         // lowercase base letter
+    const char* mod;   // modifier keys ("a", "w", "d", ...)
+    char tone;         // tone key (f s r x j) or 0
+    bool caps;
+};
+
+std::vector<char32_t> decode_utf8(std::string_view s) {
+    std::vector<char32_t> out;
+    for (std::size_t i = 0; i < s.size();) {
+        const auto b = static_cast<unsigned char>(s[i]);
+        const int len = b < 0x80 ? 1 : b < 0xE0 ? 2 : b < 0xF0 ? 3 : 4;
+        char32_t cp = len == 1 ? b : len == 2 ? b & 0x1F : len == 3 ? b & 0x0F : b & 0x07;
+        for (int k = 1; k < len && i + k < s.size(); ++k) {
+            cp = (cp << 6) | (static_cast<unsigned char>(s[i + k]) & 0x3F);
+        }
+        out.push_back(cp);
+        i += len;
+    }
+    return out;
+}
+
+std::unordered_map<char32_t, Telex> telex_table() {
+    // Rows in tone order: none, huyền (f), sắc (s), hỏi (r), ngã (x), nặng (j)
+    struct Row {
+        const char* lower;
+        const char* upper;
+        char base;
+        const char* mod;
+    };
+    static const Row rows[] = {
+        {"aàáảãạ", "AÀÁẢÃẠ", 'a', ""},  {"ăằắẳẵặ", "ĂẰẮẲẴẶ", 'a', "w"},
+        {"âầấẩẫậ", "ÂẦẤẨẪẬ", 'a', "a"}, {"eèéẻẽẹ", "EÈÉẺẼẸ", 'e', ""},
+        {"êềếểễệ", "ÊỀẾỂỄỆ", 'e', "e"}, {"iìíỉĩị", "IÌÍỈĨỊ", 'i', ""},
+        {"oòóỏõọ", "OÒÓỎÕỌ", 'o', ""},  {"ôồốổỗộ", "ÔỒỐỔỖỘ", 'o', "o"},
+        {"ơờớởỡợ", "ƠỜỚỞỠỢ", 'o', "w"}, {"uùúủũụ", "UÙÚỦŨỤ", 'u', ""},
+        {"ưừứửữự", "ƯỪỨỬỮỰ", 'u', "w"}, {"yỳýỷỹỵ", "YỲÝỶỸỴ", 'y', ""},
+    };
+    static const char tones[] = {0, 'f', 's', 'r', 'x', 'j'};
+    std::unordered_map<char32_t, Telex> table;
+    for (const Row& row : rows) {
+        const auto lower = decode_utf8(row.lower);
+        const auto upper = decode_utf8(row.upper);
+        for (int t = 0; t < 6; ++t) {
+            table[lower[t]] = {row.base, row.mod, tones[t], false};
+            table[upper[t]] = {row.base, row.mod, tones[t], true};
+        }
+    }
+    table[U'đ'] = {'d', "d", 0, false};
+    table[U'Đ'] = {'d', "d", 0, true};
+    for (char c = 'a'; c <= 'z'; ++c) {
+        table[static_cast<char32_t>(c)] = {c, "", 0, false};
+        table[static_cast<char32_t>(c - 'a' + 'A')] = {c, "", 0, true};
+    }
+    return table;
+}
+
+/// Telex keystrokes for a word, or empty if it has non-letters
+std::vector<Key> to_telex(std::string_view word, const std::unordered_map<char32_t, Telex>& table) {
+    std::vector<Key> keys;
+    for (char32_t cp : decode_utf8(word)) {
+        const auto it = table.find(cp);
+        if (it == table.end()) return {};
+        const Telex& t = it->second;
+        keys.push_back({kLetterKeys[t.base - 'a'], t.caps});
+        for (const char* m = t.mod; *m != '\0'; ++m) keys.push_back({kLetterKeys[*m - 'a'], false});
+        if (t.tone != 0) keys.push_back({kLetterKeys[t.tone - 'a'], false});
+    }
+    return keys;
+}
+
+/// Keystroke stream of up to `limit` words, SPACE after each
+std::vector<Key> load_corpus(const std::string& path, std::size_t limit,
+                             const std::unordered_map<char32_t, Telex>& table) {
+    std::ifstream in(path);
+    std::stringstream ss;
+    ss << in.rdbuf();
+    std::string text = ss.str();
+    std::replace(text.begin(), text.end(), '-', ' ');
+
+    std::vector<Key> stream;
+    std::istringstream words(text);
+    std::string word;
+    std::size_t count = 0;
+    while (count < limit && words >> word) {
+        std::vector<Key> keys = to_telex(word, table);
+        if (keys.empty()) continue;
+        stream.insert(stream.end(), keys.begin(), keys.end());
+        stream.push_back({kSpace, false});
+        ++count;
+    }
+    return stream;
+}
+
+// ---- Measurement ----
+
+std::int64_t ns_between(Clock::time_point a, Clock::time_point b) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(b - a).count();
+}
+
+struct Stats {
+    double mean;
+    std::int64_t p50, p90, p99, p999, max;
+};
+
+Stats summarize(std::vector<std::int64_t>& samples) {
+    Stats s{};
+    if (samples.empty()) return s;
+    std::sort(samples.begin(), samples.end());
+    double sum = 0;
+    for (std::int64_t v : samples) sum += static_cast<double>(v);
+    const auto at = [&](double q) {
+        return samples[std::min(samples.size() - 1, static_cast<std::size_t>(q * samples.size()))];
+    };
+    s.mean = sum / static_cast<double>(samples.size());
+    s.p50 = at(0.50);
+    s.p90 = at(0.90);
+    s.p99 = at(0.99);
+    s.p999 = at(0.999);
+    s.max = samples.back();
+    return s;
+}
+
+void print_row(const char* name, Stats s) {
+    std::printf("  %-10s mean %7.0f  p50 %6lld  p90 %6lld  p99 %6lld  p99.9 %7lld  max %8lld\n", name,
+                s.mean, static_cast<long long>(s.p50), static_cast<long long>(s.p90),
+                static_cast<long long>(s.p99), static_cast<long long>(s.p999),
+                static_cast<long long>(s.max));
+}
+
+void bench_corpus(const char* name, const std::vector<Key>& stream, int rounds) {
+    std::vector<std::int64_t> total, key_only, free_only, into;
+    total.reserve(stream.size() * rounds);
+    key_only.reserve(stream.size() * rounds);
+    free_only.reserve(stream.size() * rounds);
+    into.reserve(stream.size() * rounds);
+    std::uint64_t sink = 0;
+
+    for (int r = 0; r < rounds; ++r) {
+        ime_clear_all();
+        for (const Key& k : stream) {
+            const auto t0 = Clock::now();
+            ImeResult* res = ime_key_ext(k.code, k.caps, false, false);
+            const auto t1 = Clock::now();
+            if (res != nullptr) {
+                for (std::uint8_t i = 0; i < res->count; ++i) sink += res->chars[i];
+                ime_free(res);
+            }
+            const auto t2 = Clock::now();
+            total.push_back(ns_between(t0, t2));
+            key_only.push_back(ns_between(t0, t1));
+            free_only.push_back(ns_between(t1, t2));
+        }
+    }
+
+    std::uint16_t out[IME_MAX_UTF16_LEN];
+    std::uint8_t action = 0, backspace = 0;
+    for (int r = 0; r < rounds; ++r) {
+        ime_clear_all();
+        for (const Key& k : stream) {
+            const auto t0 = Clock::now();
+            const std::int32_t n = ime_key_into_utf16(k.code, k.caps, false, false, out,
+                                                      IME_MAX_UTF16_LEN, &action, &backspace);
+            const auto t1 = Clock::now();
+            sink += static_cast<std::uint64_t>(n) + backspace;
+            into.push_back(ns_between(t0, t1));
+        }
+    }
+
+    std::printf("%s: %zu keys x %d rounds (ns per call)%s\n", name, stream.size(), rounds,
+                sink == 0 ? " [no output]" : "");
+    print_row("key_ext", summarize(total));
+    print_row(" ime_key", summarize(key_only));
+    print_row(" ime_free", summarize(free_only));
+    print_row("into16", summarize(into));
+}
+
+std::int64_t timer_overhead() {
+    std::vector<std::int64_t> samples(100000);
+    for (auto& s : samples) {
+        const auto t0 = Clock::now();
+        const auto t1 = Clock::now();
+        s = ns_between(t0, t1);
+    }
+    return summarize(samples).p50;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    int rounds = 3;
+    std::size_t limit = 20000;
+    std::string data = GOXVIET_DATA_DIR;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (std::strcmp(argv[i], "--rounds") == 0) rounds = std::atoi(argv[i + 1]);
+        else if (std::strcmp(argv[i], "--limit") == 0) limit = std::strtoull(argv[i + 1], nullptr, 10);
+        else if (std::strcmp(argv[i], "--data") == 0) data = argv[i + 1];
+    }
+
+    const auto table = telex_table();
+    const auto vietnamese = load_corpus(data + "/vietnamese_22k.txt", limit, table);
+    const auto english = load_corpus(data + "/english_100k.txt", limit, table);
+    if (vietnamese.empty() || english.empty()) {
+        std::fprintf(stderr, "corpus not found under %s\n", data.c_str());
+        return 1;
+    }
+
+    ime_init();
+    ime_method(0);
+    std::printf("timer overhead p50: %lld ns (included in every sample)\n",
+                static_cast<long long>(timer_overhead()));
+    bench_corpus("vietnamese_22k", vietnamese, rounds);
+    bench_corpus("english_100k", english, rounds);
+    ime_shutdown();
+    return 0;
+}
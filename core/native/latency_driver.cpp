@@ -0,0 +1,175 @@
+// latency_driver.cpp - Checks latency attribution with synthetic timestamps
+//
+// Plays a typing session through ime_key_timed / ime_key_injected the way
+// the platform layer does, but with generated timestamps: each key gets a
+// known queue delay (event -> received) and injection delay (received ->
+// injected), with occasional stalls. The engine's per-stage histograms
+// (ime_latency_stats) must then report the same distribution:
+//
+//   queue      generated delay plus the engine lock wait (measured by the
+//              engine, at most kLockSlack here): max within the slack,
+//              p50/p90/p99 within one bucket of the true value
+//   total      queue + injection delay: max exact, same percentiles
+//   processing measured by the engine; lock wait + processing + injection
+//              must add up to the generated injection delay (injection
+//              counts 0 when a processing spike outlasts it)
+//
+// Build and run with CMake (see CMakeLists.txt):
+//   cmake -S native -B native/build && cmake --build native/build
+//   native/build/latency_driver [--keys N] [--seed S]
+//
+// Exits 1 if a stage does not match.
+
+#include "goxviet.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+// macOS virtual keycodes for 'a'..'z' (see core/src/data/keys.rs)
+constexpr std::uint16_t kLetterKeys[26] = {
+    0, 11, 8, 2, 14, 3, 5, 4, 34, 38, 40, 37, 46,
+    45, 31, 35, 12, 15, 1, 17, 32, 9, 13, 7, 16, 6,
+};
+constexpr std::uint16_t kSpace = 49;
+constexpr const char* kText = "tieengs vieejt laf ngoon nguwx cuar nguwowif vieejt nam ";
+
+constexpr std::uint64_t kUs = 1000;
+constexpr std::uint64_t kMs = 1000 * kUs;
+
+/// Most an uncontended engine lock wait may add to a key's queue time
+constexpr std::uint64_t kLockSlack = 50 * kUs;
+
+const char* const kStageNames[] = {"queue", "processing", "injection", "total"};
+
+/// Deterministic generator (64-bit LCG), so failures reproduce by seed
+struct Rng {
+    std::uint64_t state;
+    std::uint64_t below(std::uint64_t n) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        return (state >> 33) % n;
+    }
+};
+
+/// Queue or injection delay: mostly 50-400 us, 1% stalls of 5-40 ms
+std::uint64_t delay(Rng& rng) {
+    if (rng.below(100) == 0) return 5 * kMs + rng.below(35 * kMs);
+    return 50 * kUs + rng.below(350 * kUs);
+}
+
+std::uint64_t percentile(std::vector<std::uint64_t> v, double pct) {
+    std::sort(v.begin(), v.end());
+    const auto rank = static_cast<std::size_t>(pct / 100.0 * static_cast<double>(v.size()) + 0.999999);
+    return v[std::min(v.size(), std::max<std::size_t>(rank, 1)) - 1];
+}
+
+/// Upper bound of the bucket holding `ns`
+std::uint64_t bucket_bound(std::uint64_t ns) {
+    for (std::uint32_t i = 0;; ++i) {
+        const std::uint64_t upper = ime_latency_bucket_upper_ns(i);
+        if (ns < upper) return upper;
+    }
+}
+
+void print_stats(const char* name, const ImeLatencyStats& s) {
+    std::printf("  %-10s n %6llu  mean %9llu  p50 %9llu  p90 %9llu  p99 %9llu  max %9llu\n", name,
+                static_cast<unsigned long long>(s.count), static_cast<unsigned long long>(s.mean_ns),
+                static_cast<unsigned long long>(s.p50_ns), static_cast<unsigned long long>(s.p90_ns),
+                static_cast<unsigned long long>(s.p99_ns), static_cast<unsigned long long>(s.max_ns));
+}
+
+/// Reported stats against the generated samples, each of which the engine
+/// may have measured up to `slack` longer; prints mismatches
+bool check(const char* name, const ImeLatencyStats& s, const std::vector<std::uint64_t>& truth,
+           std::uint64_t slack = 0) {
+    const std::uint64_t max = *std::max_element(truth.begin(), truth.end());
+    bool ok = s.count == truth.size() && s.max_ns >= max && s.max_ns <= max + slack;
+    const std::uint64_t reported[] = {s.p50_ns, s.p90_ns, s.p99_ns};
+    const double pcts[] = {50, 90, 99};
+    for (int i = 0; i < 3; ++i) {
+        const std::uint64_t expected = percentile(truth, pcts[i]);
+        if (reported[i] < expected || reported[i] > bucket_bound(expected + slack)) {
+            std::printf("  %s p%.0f: reported %llu, true %llu\n", name, pcts[i],
+                        static_cast<unsigned long long>(reported[i]),
+                        static_cast<unsigned long long>(expected));
+            ok = false;
+        }
+    }
+    if (!ok) std::printf("  %s: MISMATCH\n", name);
+    return ok;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    std::size_t keys = 20000;
+    Rng rng{1};
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (std::strcmp(argv[i], "--keys") == 0) keys = std::strtoull(argv[i + 1], nullptr, 10);
+        else if (std::strcmp(argv[i], "--seed") == 0) rng.state = std::strtoull(argv[i + 1], nullptr, 10);
+    }
+    if (keys == 0) keys = 1;
+
+    ime_init();
+    ime_method(0);
+    // Warm up: the first key pays for lazy initialization
+    for (const char* c = kText; *c != '\0'; ++c) {
+        ime_free(ime_key_ext(*c == ' ' ? kSpace : kLetterKeys[*c - 'a'], false, false, false));
+    }
+    ime_clear_all();
+    ime_latency_reset();
+
+    std::vector<std::uint64_t> queue, total;
+    std::uint64_t queue_sum = 0, injection_sum = 0;
+    std::uint64_t clock = 1000 * kMs;  // arbitrary epoch
+    const std::size_t text_len = std::strlen(kText);
+    for (std::size_t i = 0; i < keys; ++i) {
+        const char c = kText[i % text_len];
+        const std::uint16_t key = c == ' ' ? kSpace : kLetterKeys[c - 'a'];
+        const std::uint64_t q = delay(rng), inj = delay(rng);
+        const std::uint64_t event = clock, received = clock + q;
+
+        ImeResult* r = ime_key_timed(key, false, false, false, event, received);
+        if (r == nullptr) {
+            std::fprintf(stderr, "engine not initialized\n");
+            return 1;
+        }
+        ime_free(r);
+        ime_key_injected(received + inj);
+
+        queue.push_back(q);
+        total.push_back(q + inj);
+        queue_sum += q;
+        injection_sum += inj;
+        clock += 80 * kMs + rng.below(80 * kMs);  // ~8 keys per second
+    }
+
+    ImeLatencyStats stats[4];
+    for (std::uint8_t stage = 0; stage < 4; ++stage) ime_latency_stats(stage, &stats[stage]);
+    ime_shutdown();
+
+    std::printf("latency_driver: %zu keys (ns)\n", keys);
+    for (int stage = 0; stage < 4; ++stage) print_stats(kStageNames[stage], stats[stage]);
+
+    bool ok = check("queue", stats[0], queue, kLockSlack);
+    ok = check("total", stats[3], total) && ok;
+    // Means are rounded down per stage; processing spikes longer than the
+    // injection delay add at most the processing mean
+    const std::uint64_t expected_mean = injection_sum / keys;
+    const std::uint64_t queue_mean = queue_sum / keys;
+    const std::uint64_t lock_mean = stats[0].mean_ns > queue_mean ? stats[0].mean_ns - queue_mean : 0;
+    const std::uint64_t split = lock_mean + stats[1].mean_ns + stats[2].mean_ns;
+    if (split + 3 < expected_mean || split > expected_mean + stats[1].mean_ns + 3) {
+        std::printf("  lock wait + processing + injection mean %llu, generated %llu: MISMATCH\n",
+                    static_cast<unsigned long long>(split),
+                    static_cast<unsigned long long>(expected_mean));
+        ok = false;
+    }
+    std::printf("%s\n", ok ? "OK" : "FAILED");
+    return ok ? 0 : 1;
+}
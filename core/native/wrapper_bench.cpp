@@ -0,0 +1,160 @@
+// wrapper_bench.cpp - goxviet.hpp overhead against raw C ABI calls
+//
+// Replays a fixed Telex sentence through four paths and reports ns/key:
+//   c_key_ext    ime_key_ext + copy chars + ime_free   (heap result per key)
+//   c_into32     ime_key_into_utf32 into a stack buffer
+//   cpp_key      goxviet::Engine::key into a reused KeyResult
+//   cpp_key16    goxviet::Engine::key into a reused KeyResult16
+//
+// Build and run with CMake (see CMakeLists.txt):
+//   cmake -S native -B native/build && cmake --build native/build
+//   native/build/wrapper_bench [rounds]
+//
+// stdout/stderr are silenced while timing in case the core was built
+// with the `debug-log` feature.
+
+#include "goxviet.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string_view>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+
+// Redirect stdout/stderr to /dev/null for the lifetime of the object
+class Quiet {
+public:
+    Quiet() {
+        std::fflush(stdout);
+        std::fflush(stderr);
+        out_ = dup(STDOUT_FILENO);
+        err_ = dup(STDERR_FILENO);
+        const int null = open("/dev/null", O_WRONLY);
+        dup2(null, STDOUT_FILENO);
+        dup2(null, STDERR_FILENO);
+        close(null);
+    }
+    ~Quiet() {
+        dup2(out_, STDOUT_FILENO);
+        dup2(err_, STDERR_FILENO);
+        close(out_);
+        close(err_);
+    }
+    Quiet(const Quiet&) = delete;
+    Quiet& operator=(const Quiet&) = delete;
+
+private:
+    int out_;
+    int err_;
+};
+
+// macOS virtual keycodes for 'a'..'z' (see core/src/data/keys.rs)
+constexpr std::uint16_t kLetterKeys[26] = {
+    0, 11, 8, 2, 14, 3, 5, 4, 34, 38, 40, 37, 46,
+    45, 31, 35, 12, 15, 1, 17, 32, 9, 13, 7, 16, 6,
+};
+constexpr std::uint16_t kSpace = 49;
+
+constexpr std::string_view kTelex =
+    "Tieengs Vieetj laf ngoon ngwx chinhs thuwcs cuar nuwowcs Coong hoaf xax hooij "
+    "chur nghiax Vieetj Nam the software release uses console output for testing "
+    "nguwowif dduowcj hojc sinh truwowngf ddaij hocj quoocs gia";
+
+std::vector<std::uint16_t> keystrokes() {
+    std::vector<std::uint16_t> keys;
+    for (char c : kTelex) {
+        if (c == ' ') {
+            keys.push_back(kSpace);
+        } else if (c >= 'a' && c <= 'z') {
+            keys.push_back(kLetterKeys[c - 'a']);
+        } else if (c >= 'A' && c <= 'Z') {
+            keys.push_back(kLetterKeys[c - 'A']);
+        }
+    }
+    keys.push_back(kSpace);
+    return keys;
+}
+
+template <class F>
+double ns_per_key(const std::vector<std::uint16_t>& keys, int rounds, F&& f) {
+    std::uint64_t sink = 0;
+    for (int i = 0; i < rounds / 10; ++i) {  // warm-up
+        for (std::uint16_t k : keys) sink += f(k);
+    }
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < rounds; ++i) {
+        for (std::uint16_t k : keys) sink += f(k);
+    }
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    if (sink == 42) std::puts("");  // keep results observable
+    const double ns = std::chrono::duration<double, std::nano>(elapsed).count();
+    return ns / (static_cast<double>(keys.size()) * rounds);
+}
+
+struct Timings {
+    double c_key_ext, c_into32, cpp_key, cpp_key16;
+};
+
+Timings run(goxviet::Engine& ime, const std::vector<std::uint16_t>& keys, int rounds) {
+    Timings t{};
+    std::uint32_t copy[IME_MAX_UTF32_LEN];
+    t.c_key_ext = ns_per_key(keys, rounds, [&](std::uint16_t k) -> std::uint64_t {
+        ImeResult* r = ime_key_ext(k, false, false, false);
+        std::uint64_t n = 0;
+        if (r != nullptr) {
+            for (std::uint8_t i = 0; i < r->count; ++i) copy[i] = r->chars[i];
+            n = r->count + r->backspace;
+            ime_free(r);
+        }
+        return n;
+    });
+
+    std::uint8_t action = 0, backspace = 0;
+    t.c_into32 = ns_per_key(keys, rounds, [&](std::uint16_t k) -> std::uint64_t {
+        const std::int32_t n = ime_key_into_utf32(k, false, false, false, copy, IME_MAX_UTF32_LEN,
+                                                  &action, &backspace);
+        return static_cast<std::uint64_t>(n) + backspace;
+    });
+
+    goxviet::KeyResult r32;
+    t.cpp_key = ns_per_key(keys, rounds, [&](std::uint16_t k) -> std::uint64_t {
+        ime.key(k, false, false, false, r32);
+        return r32.text().size() + r32.backspace();
+    });
+
+    goxviet::KeyResult16 r16;
+    t.cpp_key16 = ns_per_key(keys, rounds, [&](std::uint16_t k) -> std::uint64_t {
+        ime.key(k, false, false, false, r16);
+        return r16.text().size() + r16.backspace();
+    });
+    return t;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    const int rounds = argc > 1 ? std::atoi(argv[1]) : 2000;
+    const std::vector<std::uint16_t> keys = keystrokes();
+
+    goxviet::Engine ime;
+    ime.set_method(goxviet::Method::Telex);
+    Timings t{};
+    {
+        Quiet quiet;
+        t = run(ime, keys, rounds);
+    }
+
+    std::printf("%zu keys x %d rounds\n", keys.size(), rounds);
+    std::printf("c_key_ext   %8.1f ns/key (heap result + ime_free)\n", t.c_key_ext);
+    std::printf("c_into32    %8.1f ns/key\n", t.c_into32);
+    std::printf("cpp_key     %8.1f ns/key (%+.1f%% vs c_into32)\n", t.cpp_key,
+                100.0 * (t.cpp_key / t.c_into32 - 1.0));
+    std::printf("cpp_key16   %8.1f ns/key\n", t.cpp_key16);
+    return 0;
+}
@@ -0,0 +1,51 @@
+//! goxviet-daemon: headless engine host for local frontends
+//!
+//! Usage: goxviet-daemon [--socket PATH] [--max-clients N]
+//!
+//! Serves `goxviet_core::daemon` clients on a Unix domain socket until
+//! killed. See `.docs/features/core-engine/daemon.md`.
+
+#[cfg(unix)]
+fn main() {
+    use goxviet_core::daemon::{self, Daemon};
+    use std::process::exit;
+
+    let mut socket = daemon::default_socket_path();
+    let mut max_clients = daemon::server::DEFAULT_MAX_CLIENTS;
+    let mut args = std::env::args().skip(1);
+    while let Some(arg) = args.next() {
+        match (arg.as_str(), args.next()) {
+            ("--socket", Some(path)) => socket = path.into(),
+            ("--max-clients", Some(n)) => match n.parse() {
+                Ok(n) => max_clients = n,
+                Err(_) => {
+                    eprintln!("goxviet-daemon: invalid --max-clients value: {n}");
+                    exit(2);
+                }
+            },
+            _ => {
+                eprintln!("usage: goxviet-daemon [--socket PATH] [--max-clients N]");
+                exit(2);
+            }
+        }
+    }
+
+    let daemon = match Daemon::bind(&socket) {
+        Ok(d) => d.with_max_clients(max_clients),
+        Err(e) => {
+            eprintln!("goxviet-daemon: cannot bind {}: {e}", socket.display());
+            exit(1);
+        }
+    };
+    eprintln!("goxviet-daemon: listening on {}", daemon.path().display());
+    if let Err(e) = daemon.serve() {
+        eprintln!("goxviet-daemon: {e}");
+        exit(1);
+    }
+}
+
+#[cfg(not(unix))]
+fn main() {
+    eprintln!("goxviet-daemon: Unix domain sockets are not supported on this platform");
+    std::process::exit(1);
+}
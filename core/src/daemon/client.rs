@@ -0,0 +1,102 @@
+//! Daemon client: what a frontend process links against
+//!
+//! Blocking request/reply over one connection. Buffers are reused across
+//! calls; `keys` replies borrow the client until the next request.
+
+use super::protocol::{self, ConfigOption, KeyEvent, KeyReplies};
+use std::io::{self, BufReader, ErrorKind, Read, Write};
+use std::os::unix::net::UnixStream;
+use std::path::Path;
+
+pub struct Client {
+    reader: BufReader<UnixStream>,
+    writer: UnixStream,
+    request: Vec<u8>,
+    reply: Vec<u8>,
+}
+
+fn invalid(msg: &'static str) -> io::Error {
+    io::Error::new(ErrorKind::InvalidData, msg)
+}
+
+impl Client {
+    pub fn connect(path: impl AsRef<Path>) -> io::Result<Self> {
+        let stream = UnixStream::connect(path)?;
+        Ok(Self {
+            reader: BufReader::new(stream.try_clone()?),
+            writer: stream,
+            request: Vec::new(),
+            reply: Vec::new(),
+        })
+    }
+
+    /// Process a batch of key events in `context`, one round trip
+    ///
+    /// Batches larger than `MAX_BATCH` are rejected; split them instead.
+    pub fn keys(&mut self, context: u16, keys: &[KeyEvent]) -> io::Result<KeyReplies<'_>> {
+        if keys.len() > protocol::MAX_BATCH {
+            return Err(io::Error::new(ErrorKind::InvalidInput, "batch too large"));
+        }
+        protocol::encode_keys(&mut self.request, context, keys);
+        self.round_trip()?;
+        protocol::decode_keys_reply(&self.reply).map_err(invalid)
+    }
+
+    /// Change one setting of `context`
+    pub fn configure(&mut self, context: u16, option: ConfigOption, value: u8) -> io::Result<()> {
+        protocol::encode_config(&mut self.request, context, option, value);
+        self.expect_ok()
+    }
+
+    /// Clear the current word (`all` = false) or all state of `context`
+    pub fn clear(&mut self, context: u16, all: bool) -> io::Result<()> {
+        protocol::encode_clear(&mut self.request, context, all);
+        self.expect_ok()
+    }
+
+    /// Drop `context` on the daemon; the id may be reused afterwards
+    pub fn close_context(&mut self, context: u16) -> io::Result<()> {
+        protocol::encode_close(&mut self.request, context);
+        self.expect_ok()
+    }
+
+    /// The daemon's `ime_features` bits
+    pub fn features(&mut self) -> io::Result<u32> {
+        protocol::encode_simple(&mut self.request, protocol::OP_FEATURES);
+        self.round_trip()?;
+        protocol::decode_features(&self.reply).map_err(invalid)
+    }
+
+    pub fn ping(&mut self) -> io::Result<()> {
+        protocol::encode_simple(&mut self.request, protocol::OP_PING);
+        self.round_trip()?;
+        protocol::decode_status(&self.reply, protocol::OP_PING).map_err(invalid)
+    }
+
+    /// Send a raw frame payload (tests and protocol probes)
+    pub fn raw(&mut self, payload: &[u8]) -> io::Result<&[u8]> {
+        self.request.clear();
+        self.request
+            .extend_from_slice(&(payload.len() as u32).to_le_bytes());
+        self.request.extend_from_slice(payload);
+        self.round_trip()?;
+        Ok(&self.reply)
+    }
+
+    fn expect_ok(&mut self) -> io::Result<()> {
+        self.round_trip()?;
+        protocol::decode_status(&self.reply, protocol::OP_OK).map_err(invalid)
+    }
+
+    fn round_trip(&mut self) -> io::Result<()> {
+        self.writer.write_all(&self.request)?;
+        let mut len = [0u8; 4];
+        self.reader.read_exact(&mut len)?;
+        let len = u32::from_le_bytes(len) as usize;
+        if len > protocol::MAX_FRAME {
+            return Err(invalid("reply frame too large"));
+        }
+        self.reply.resize(len, 0);
+        self.reader.read_exact(&mut self.reply)
+    }
+}
@@ -0,0 +1,38 @@
+//! Local daemon mode
+//!
+//! Runs one engine host (`goxviet-daemon`) that several frontend processes
+//! share over a Unix domain socket, instead of each loading the engine and
+//! its word lists. Every connection owns its engine contexts, so clients
+//! never see each other's typing state; the static dictionaries live once
+//! in the daemon and are shared read-only.
+//!
+//! - `protocol`: compact binary framing with batched key events (portable)
+//! - `server`: `Daemon`, the socket host (Unix only)
+//! - `client`: `Client`, blocking request/reply for frontends (Unix only)
+
+pub mod protocol;
+
+#[cfg(unix)]
+pub mod client;
+#[cfg(unix)]
+pub mod server;
+
+#[cfg(unix)]
+pub use self::client::Client;
+pub use self::protocol::{ConfigOption, KeyEvent, KeyReply};
+#[cfg(unix)]
+pub use self::server::{Daemon, StopHandle};
+
+use std::path::PathBuf;
+
+/// Socket the daemon listens on unless told otherwise
+///
+/// `$XDG_RUNTIME_DIR/goxviet.sock` (per-user, private), falling back to
+/// `/tmp/goxviet-$USER.sock`.
+pub fn default_socket_path() -> PathBuf {
+    if let Some(dir) = std::env::var_os("XDG_RUNTIME_DIR").filter(|d| !d.is_empty()) {
+        return PathBuf::from(dir).join("goxviet.sock");
+    }
+    let user = std::env::var("USER").unwrap_or_else(|_| "default".into());
+    std::env::temp_dir().join(format!("goxviet-{user}.sock"))
+}
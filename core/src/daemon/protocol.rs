@@ -0,0 +1,500 @@
+//! Daemon wire protocol
+//!
+//! Every message is a frame: `u32` payload length (little-endian), then
+//! the payload. All integers are little-endian.
+//!
+//! ```text
+//! Request payload: op: u8, context: u16, body
+//!   KEYS      n: u16, n × (key: u16, flags: u8)    flags: 1=caps 2=ctrl 4=shift
+//!   CONFIG    option: u8, value: u8                 see `ConfigOption`
+//!   CLEAR     all: u8                               0=current word, 1=all state
+//!   CLOSE     -                                     drop the context
+//!   FEATURES  -                                     context ignored
+//!   PING      -                                     context ignored
+//!
+//! Reply payload: op: u8, body
+//!   KEYS      n: u16, n × (action: u8, backspace: u8, len: u16, len bytes UTF-8)
+//!   FEATURES  bits: u32                             `ime_features` bits
+//!   OK / PING -
+//!   ERROR     code: u8                              see `ERR_*`
+//! ```
+//!
+//! A client may pipeline requests on one connection; replies come back in
+//! order. Decoding borrows from the frame buffer (no per-key allocation).
+
+/// Largest accepted payload
+pub const MAX_FRAME: usize = 128 * 1024;
+/// Most key events in one KEYS request
+pub const MAX_BATCH: usize = 64;
+/// Bytes per key event on the wire
+pub const KEY_EVENT_LEN: usize = 3;
+
+pub const OP_KEYS: u8 = 1;
+pub const OP_CONFIG: u8 = 2;
+pub const OP_CLEAR: u8 = 3;
+pub const OP_CLOSE: u8 = 4;
+pub const OP_FEATURES: u8 = 5;
+pub const OP_PING: u8 = 6;
+pub const OP_OK: u8 = 0x80;
+pub const OP_ERROR: u8 = 0xFF;
+
+/// Malformed request (unknown op, bad length, batch too large)
+pub const ERR_MALFORMED: u8 = 1;
+/// Unknown config option or value
+pub const ERR_CONFIG: u8 = 2;
+/// Client already has `MAX_CONTEXTS` contexts
+pub const ERR_CONTEXTS: u8 = 3;
+
+const FLAG_CAPS: u8 = 1;
+const FLAG_CTRL: u8 = 2;
+const FLAG_SHIFT: u8 = 4;
+
+/// One key event, as passed to `Engine::on_key_ext`
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct KeyEvent {
+    pub key: u16,
+    pub caps: bool,
+    pub ctrl: bool,
+    pub shift: bool,
+}
+
+impl KeyEvent {
+    pub fn new(key: u16, caps: bool) -> Self {
+        Self {
+            key,
+            caps,
+            ..Self::default()
+        }
+    }
+
+    fn flags(&self) -> u8 {
+        (self.caps as u8 * FLAG_CAPS)
+            | (self.ctrl as u8 * FLAG_CTRL)
+            | (self.shift as u8 * FLAG_SHIFT)
+    }
+}
+
+/// Per-context settings (CONFIG option byte)
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+#[repr(u8)]
+pub enum ConfigOption {
+    /// 0=Telex, 1=VNI
+    Method = 0,
+    Enabled = 1,
+    ModernTone = 2,
+    EscRestore = 3,
+    FreeTone = 4,
+    SkipWShortcut = 5,
+    EnglishAutoRestore = 6,
+    /// 0=NFC, 1=NFD for the UTF-8 text in KEYS replies
+    OutputForm = 7,
+}
+
+impl ConfigOption {
+    pub fn from_u8(value: u8) -> Option<Self> {
+        Some(match value {
+            0 => Self::Method,
+            1 => Self::Enabled,
+            2 => Self::ModernTone,
+            3 => Self::EscRestore,
+            4 => Self::FreeTone,
+            5 => Self::SkipWShortcut,
+            6 => Self::EnglishAutoRestore,
+            7 => Self::OutputForm,
+            _ => return None,
+        })
+    }
+}
+
+/// Decoded request, borrowing the frame payload
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum Request<'a> {
+    Keys { context: u16, keys: KeyEvents<'a> },
+    Config { context: u16, option: u8, value: u8 },
+    Clear { context: u16, all: bool },
+    Close { context: u16 },
+    Features,
+    Ping,
+}
+
+/// Key events of a KEYS request
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct KeyEvents<'a> {
+    data: &'a [u8],
+}
+
+impl<'a> KeyEvents<'a> {
+    pub fn len(&self) -> usize {
+        self.data.len() / KEY_EVENT_LEN
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.data.is_empty()
+    }
+
+    pub fn iter(&self) -> impl Iterator<Item = KeyEvent> + 'a {
+        self.data.chunks_exact(KEY_EVENT_LEN).map(|c| KeyEvent {
+            key: u16::from_le_bytes([c[0], c[1]]),
+            caps: c[2] & FLAG_CAPS != 0,
+            ctrl: c[2] & FLAG_CTRL != 0,
+            shift: c[2] & FLAG_SHIFT != 0,
+        })
+    }
+}
+
+/// Parse a request payload (without the length prefix)
+pub fn decode_request(payload: &[u8]) -> Result<Request<'_>, &'static str> {
+    let (&op, rest) = payload.split_first().ok_or("Empty request")?;
+    if matches!(op, OP_FEATURES | OP_PING) {
+        return Ok(if op == OP_FEATURES {
+            Request::Features
+        } else {
+            Request::Ping
+        });
+    }
+    if rest.len() < 2 {
+        return Err("Missing context");
+    }
+    let context = u16::from_le_bytes([rest[0], rest[1]]);
+    let body = &rest[2..];
+    match (op, body) {
+        (OP_KEYS, [n0, n1, events @ ..]) => {
+            let n = u16::from_le_bytes([*n0, *n1]) as usize;
+            if n > MAX_BATCH {
+                return Err("Batch too large");
+            }
+            if events.len() != n * KEY_EVENT_LEN {
+                return Err("Key batch length mismatch");
+            }
+            Ok(Request::Keys {
+                context,
+                keys: KeyEvents { data: events },
+            })
+        }
+        (OP_CONFIG, [option, value]) => Ok(Request::Config {
+            context,
+            option: *option,
+            value: *value,
+        }),
+        (OP_CLEAR, [all]) => Ok(Request::Clear {
+            context,
+            all: *all != 0,
+        }),
+        (OP_CLOSE, []) => Ok(Request::Close { context }),
+        _ => Err("Malformed request"),
+    }
+}
+
+/// Start a frame in `out` (cleared) with a placeholder length
+fn begin_frame(out: &mut Vec<u8>, op: u8) {
+    out.clear();
+    out.extend_from_slice(&[0; 4]);
+    out.push(op);
+}
+
+/// Patch the length prefix once the payload is written
+pub fn end_frame(out: &mut [u8]) {
+    let len = (out.len() - 4) as u32;
+    out[..4].copy_from_slice(&len.to_le_bytes());
+}
+
+/// KEYS request frame; `keys` must not exceed `MAX_BATCH`
+pub fn encode_keys(out: &mut Vec<u8>, context: u16, keys: &[KeyEvent]) {
+    begin_frame(out, OP_KEYS);
+    out.extend_from_slice(&context.to_le_bytes());
+    out.extend_from_slice(&(keys.len() as u16).to_le_bytes());
+    for k in keys {
+        out.extend_from_slice(&k.key.to_le_bytes());
+        out.push(k.flags());
+    }
+    end_frame(out);
+}
+
+pub fn encode_config(out: &mut Vec<u8>, context: u16, option: ConfigOption, value: u8) {
+    begin_frame(out, OP_CONFIG);
+    out.extend_from_slice(&context.to_le_bytes());
+    out.extend_from_slice(&[option as u8, value]);
+    end_frame(out);
+}
+
+pub fn encode_clear(out: &mut Vec<u8>, context: u16, all: bool) {
+    begin_frame(out, OP_CLEAR);
+    out.extend_from_slice(&context.to_le_bytes());
+    out.push(all as u8);
+    end_frame(out);
+}
+
+pub fn encode_close(out: &mut Vec<u8>, context: u16) {
+    begin_frame(out, OP_CLOSE);
+    out.extend_from_slice(&context.to_le_bytes());
+    end_frame(out);
+}
+
+/// FEATURES or PING request (no context)
+pub fn encode_simple(out: &mut Vec<u8>, op: u8) {
+    begin_frame(out, op);
+    end_frame(out);
+}
+
+/// Start a KEYS reply; push results with `push_key_reply`, then `end_frame`
+pub fn begin_keys_reply(out: &mut Vec<u8>, count: usize) {
+    begin_frame(out, OP_KEYS);
+    out.extend_from_slice(&(count as u16).to_le_bytes());
+}
+
+/// Append one key result; `write_text` fills up to `max_len` bytes of
+/// UTF-8 and returns how many it wrote
+pub fn push_key_reply(
+    out: &mut Vec<u8>,
+    action: u8,
+    backspace: u8,
+    max_len: usize,
+    write_text: impl FnOnce(&mut [u8]) -> usize,
+) {
+    out.extend_from_slice(&[action, backspace, 0, 0]);
+    let start = out.len();
+    out.resize(start + max_len, 0);
+    let len = write_text(&mut out[start..]).min(max_len);
+    out.truncate(start + len);
+    out[start - 2..start].copy_from_slice(&(len as u16).to_le_bytes());
+}
+
+/// Reply with no body (OK, PING) or an error code
+pub fn encode_status(out: &mut Vec<u8>, op: u8, code: Option<u8>) {
+    begin_frame(out, op);
+    out.extend(code);
+    end_frame(out);
+}
+
+pub fn encode_features(out: &mut Vec<u8>, bits: u32) {
+    begin_frame(out, OP_FEATURES);
+    out.extend_from_slice(&bits.to_le_bytes());
+    end_frame(out);
+}
+
+/// One result of a KEYS reply
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct KeyReply<'a> {
+    /// `Action` value, as in `ImeResult`
+    pub action: u8,
+    pub backspace: u8,
+    /// Text to insert
+    pub text: &'a str,
+}
+
+/// Results of a KEYS reply, validated up front by `decode_keys_reply`
+#[derive(Debug, Clone, Copy)]
+pub struct KeyReplies<'a> {
+    data: &'a [u8],
+    remaining: usize,
+}
+
+impl<'a> Iterator for KeyReplies<'a> {
+    type Item = KeyReply<'a>;
+
+    fn next(&mut self) -> Option<KeyReply<'a>> {
+        if self.remaining == 0 {
+            return None;
+        }
+        let (reply, rest) = split_key_reply(self.data)?;
+        self.data = rest;
+        self.remaining -= 1;
+        Some(reply)
+    }
+
+    fn size_hint(&self) -> (usize, Option<usize>) {
+        (self.remaining, Some(self.remaining))
+    }
+}
+
+impl ExactSizeIterator for KeyReplies<'_> {}
+
+fn split_key_reply(data: &[u8]) -> Option<(KeyReply<'_>, &[u8])> {
+    let [action, backspace, l0, l1, rest @ ..] = data else {
+        return None;
+    };
+    let len = u16::from_le_bytes([*l0, *l1]) as usize;
+    let text = std::str::from_utf8(rest.get(..len)?).ok()?;
+    Some((
+        KeyReply {
+            action: *action,
+            backspace: *backspace,
+            text,
+        },
+        &rest[len..],
+    ))
+}
+
+/// Parse a KEYS reply payload
+pub fn decode_keys_reply(payload: &[u8]) -> Result<KeyReplies<'_>, &'static str> {
+    match payload {
+        [OP_KEYS, n0, n1, data @ ..] => {
+            let count = u16::from_le_bytes([*n0, *n1]) as usize;
+            let mut rest = data;
+            for _ in 0..count {
+                rest = split_key_reply(rest).ok_or("Truncated key reply")?.1;
+            }
+            if !rest.is_empty() {
+                return Err("Trailing bytes in key reply");
+            }
+            Ok(KeyReplies {
+                data,
+                remaining: count,
+            })
+        }
+        [OP_ERROR, ..] => Err(error_message(payload)),
+        _ => Err("Unexpected reply"),
+    }
+}
+
+/// Check an OK / PING reply
+pub fn decode_status(payload: &[u8], expected: u8) -> Result<(), &'static str> {
+    match payload {
+        [op] if *op == expected => Ok(()),
+        [OP_ERROR, ..] => Err(error_message(payload)),
+        _ => Err("Unexpected reply"),
+    }
+}
+
+pub fn decode_features(payload: &[u8]) -> Result<u32, &'static str> {
+    match payload {
+        [OP_FEATURES, a, b, c, d] => Ok(u32::from_le_bytes([*a, *b, *c, *d])),
+        [OP_ERROR, ..] => Err(error_message(payload)),
+        _ => Err("Unexpected reply"),
+    }
+}
+
+fn error_message(payload: &[u8]) -> &'static str {
+    match payload.get(1) {
+        Some(&ERR_CONFIG) => "Daemon rejected config option",
+        Some(&ERR_CONTEXTS) => "Too many contexts on this connection",
+        _ => "Daemon rejected malformed request",
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn payload(frame: &[u8]) -> &[u8] {
+        let len = u32::from_le_bytes([frame[0], frame[1], frame[2], frame[3]]) as usize;
+        assert_eq!(len, frame.len() - 4);
+        &frame[4..]
+    }
+
+    #[test]
+    fn test_keys_request_roundtrip() {
+        let keys = [
+            KeyEvent::new(1, false),
+            KeyEvent {
+                key: 300,
+                caps: true,
+                ctrl: true,
+                shift: true,
+            },
+        ];
+        let mut out = Vec::new();
+        encode_keys(&mut out, 7, &keys);
+        assert_eq!(out.len(), 4 + 1 + 2 + 2 + 2 * KEY_EVENT_LEN);
+        match decode_request(payload(&out)).unwrap() {
+            Request::Keys { context, keys: ev } => {
+                assert_eq!(context, 7);
+                assert_eq!(ev.iter().collect::<Vec<_>>(), keys);
+            }
+            r => panic!("unexpected {r:?}"),
+        }
+    }
+
+    #[test]
+    fn test_other_requests_roundtrip() {
+        let mut out = Vec::new();
+        encode_config(&mut out, 2, ConfigOption::Method, 1);
+        assert_eq!(
+            decode_request(payload(&out)),
+            Ok(Request::Config {
+                context: 2,
+                option: 0,
+                value: 1
+            })
+        );
+        encode_clear(&mut out, 3, true);
+        assert_eq!(
+            decode_request(payload(&out)),
+            Ok(Request::Clear {
+                context: 3,
+                all: true
+            })
+        );
+        encode_close(&mut out, 4);
+        assert_eq!(
+            decode_request(payload(&out)),
+            Ok(Request::Close { context: 4 })
+        );
+        encode_simple(&mut out, OP_PING);
+        assert_eq!(decode_request(payload(&out)), Ok(Request::Ping));
+        encode_simple(&mut out, OP_FEATURES);
+        assert_eq!(decode_request(payload(&out)), Ok(Request::Features));
+    }
+
+    #[test]
+    fn test_malformed_requests() {
+        assert!(decode_request(&[]).is_err());
+        assert!(decode_request(&[OP_KEYS, 0]).is_err());
+        // Count says 2 events, body has 1
+        assert!(decode_request(&[OP_KEYS, 0, 0, 2, 0, 1, 0, 0]).is_err());
+        // Batch above MAX_BATCH
+        let n = (MAX_BATCH as u16 + 1).to_le_bytes();
+        let mut big = vec![OP_KEYS, 0, 0, n[0], n[1]];
+        big.resize(big.len() + (MAX_BATCH + 1) * KEY_EVENT_LEN, 0);
+        assert!(decode_request(&big).is_err());
+        assert!(decode_request(&[OP_CONFIG, 0, 0, 1]).is_err());
+        assert!(decode_request(&[42, 0, 0]).is_err());
+    }
+
+    #[test]
+    fn test_keys_reply_roundtrip() {
+        let mut out = Vec::new();
+        begin_keys_reply(&mut out, 2);
+        push_key_reply(&mut out, 1, 2, 16, |buf| {
+            let text = "việt".as_bytes();
+            buf[..text.len()].copy_from_slice(text);
+            text.len()
+        });
+        push_key_reply(&mut out, 0, 0, 16, |_| 0);
+        end_frame(&mut out);
+        let replies: Vec<_> = decode_keys_reply(payload(&out)).unwrap().collect();
+        assert_eq!(
+            replies,
+            [
+                KeyReply {
+                    action: 1,
+                    backspace: 2,
+                    text: "việt"
+                },
+                KeyReply {
+                    action: 0,
+                    backspace: 0,
+                    text: ""
+                },
+            ]
+        );
+    }
+
+    #[test]
+    fn test_truncated_reply_rejected() {
+        let mut out = Vec::new();
+        begin_keys_reply(&mut out, 1);
+        push_key_reply(&mut out, 1, 0, 8, |buf| {
+            buf[..3].copy_from_slice(b"abc");
+            3
+        });
+        end_frame(&mut out);
+        let p = payload(&out);
+        assert!(decode_keys_reply(&p[..p.len() - 1]).is_err());
+        assert_eq!(
+            decode_status(&[OP_ERROR, ERR_CONFIG], OP_OK),
+            Err("Daemon rejected config option")
+        );
+        assert_eq!(decode_features(&[OP_FEATURES, 1, 0, 0, 0]), Ok(1));
+    }
+}
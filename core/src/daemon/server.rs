@@ -0,0 +1,285 @@
+//! Daemon server: one engine host for many client processes
+//!
+//! Each connection gets its own thread and its own engine contexts
+//! (`u16` ids chosen by the client, created on first use). The word lists,
+//! shortcode table and other static data are process-wide and read-only,
+//! so every context on every connection shares one copy of them.
+
+use super::protocol::{self, ConfigOption, KeyEvents, Request};
+use crate::engine::output::encode_utf8;
+use crate::engine::{Dictionary, Engine, NormalizationForm};
+use std::collections::HashMap;
+use std::io::{self, BufReader, BufWriter, ErrorKind, Read, Write};
+use std::os::unix::fs::FileTypeExt;
+use std::os::unix::net::{UnixListener, UnixStream};
+use std::path::{Path, PathBuf};
+use std::sync::atomic::{AtomicBool, AtomicUsize, Ordering};
+use std::sync::Arc;
+
+/// Most engine contexts one connection may hold
+pub const MAX_CONTEXTS: usize = 64;
+/// Default cap on simultaneous connections
+pub const DEFAULT_MAX_CLIENTS: usize = 256;
+
+pub struct Daemon {
+    listener: UnixListener,
+    path: PathBuf,
+    max_clients: usize,
+    clients: Arc<AtomicUsize>,
+    stopping: Arc<AtomicBool>,
+}
+
+/// Makes a serving `Daemon` return from `serve()` (`Daemon::stop_handle`)
+#[derive(Clone)]
+pub struct StopHandle {
+    stopping: Arc<AtomicBool>,
+    path: PathBuf,
+}
+
+impl StopHandle {
+    /// Stop accepting connections: `serve()` returns, and dropping the
+    /// `Daemon` then removes its socket file. Connections already being
+    /// served go on until their clients disconnect.
+    pub fn stop(&self) {
+        if !self.stopping.swap(true, Ordering::AcqRel) {
+            // Wake the accept loop so it sees the flag
+            let _ = UnixStream::connect(&self.path);
+        }
+    }
+}
+
+impl Daemon {
+    /// Bind the socket at `path`
+    ///
+    /// A leftover socket file from a daemon that is no longer running is
+    /// replaced; a live one makes this fail with `AddrInUse`. Anything
+    /// else at `path` (a regular file, directory or symlink) is left
+    /// alone and makes this fail with `AlreadyExists`.
+    pub fn bind(path: impl AsRef<Path>) -> io::Result<Self> {
+        let path = path.as_ref();
+        match std::fs::symlink_metadata(path) {
+            Ok(meta) if !meta.file_type().is_socket() => {
+                return Err(io::Error::new(
+                    ErrorKind::AlreadyExists,
+                    "socket path exists and is not a socket",
+                ));
+            }
+            Ok(_) => {
+                if UnixStream::connect(path).is_ok() {
+                    return Err(io::Error::new(
+                        ErrorKind::AddrInUse,
+                        "another goxviet daemon is listening on this socket",
+                    ));
+                }
+                std::fs::remove_file(path)?;
+            }
+            Err(e) if e.kind() == ErrorKind::NotFound => {}
+            Err(e) => return Err(e),
+        }
+        Ok(Self {
+            listener: UnixListener::bind(path)?,
+            path: path.to_path_buf(),
+            max_clients: DEFAULT_MAX_CLIENTS,
+            clients: Arc::new(AtomicUsize::new(0)),
+            stopping: Arc::new(AtomicBool::new(false)),
+        })
+    }
+
+    pub fn with_max_clients(mut self, max_clients: usize) -> Self {
+        self.max_clients = max_clients.max(1);
+        self
+    }
+
+    pub fn path(&self) -> &Path {
+        &self.path
+    }
+
+    /// Connections currently being served
+    pub fn client_count(&self) -> usize {
+        self.clients.load(Ordering::Relaxed)
+    }
+
+    /// Handle that stops `serve()` from another thread
+    pub fn stop_handle(&self) -> StopHandle {
+        StopHandle {
+            stopping: Arc::clone(&self.stopping),
+            path: self.path.clone(),
+        }
+    }
+
+    /// Accept connections until stopped (`StopHandle::stop`) or the
+    /// listener fails
+    ///
+    /// Connections beyond `max_clients` are closed immediately.
+    pub fn serve(&self) -> io::Result<()> {
+        // Fault the word lists in once, off the first client's keystrokes
+        Dictionary::prefetch_in_background();
+        for stream in self.listener.incoming() {
+            if self.stopping.load(Ordering::Acquire) {
+                return Ok(());
+            }
+            let stream = match stream {
+                Ok(s) => s,
+                Err(e) if e.kind() == ErrorKind::Interrupted => continue,
+                Err(e) => return Err(e),
+            };
+            if self.clients.fetch_add(1, Ordering::Relaxed) >= self.max_clients {
+                self.clients.fetch_sub(1, Ordering::Relaxed);
+                continue;
+            }
+            let clients = Arc::clone(&self.clients);
+            let spawned = std::thread::Builder::new()
+                .name("goxviet-client".into())
+                .spawn(move || {
+                    // A client vanishing mid-frame is routine, not a daemon error
+                    let _ = serve_connection(stream);
+                    clients.fetch_sub(1, Ordering::Relaxed);
+                });
+            if spawned.is_err() {
+                self.clients.fetch_sub(1, Ordering::Relaxed);
+            }
+        }
+        Ok(())
+    }
+}
+
+impl Drop for Daemon {
+    fn drop(&mut self) {
+        let _ = std::fs::remove_file(&self.path);
+    }
+}
+
+/// Request/reply loop for one connection
+///
+/// Frame and reply buffers are reused, so steady-state typing allocates
+/// only what the engine itself does per key.
+fn serve_connection(stream: UnixStream) -> io::Result<()> {
+    let mut reader = BufReader::new(stream.try_clone()?);
+    let mut writer = BufWriter::new(stream);
+    let mut contexts: HashMap<u16, Box<Engine>> = HashMap::new();
+    let mut frame = Vec::new();
+    let mut reply = Vec::new();
+
+    while read_frame(&mut reader, &mut frame)? {
+        match protocol::decode_request(&frame) {
+            Ok(request) => handle(request, &mut contexts, &mut reply),
+            Err(_) => protocol::encode_status(
+                &mut reply,
+                protocol::OP_ERROR,
+                Some(protocol::ERR_MALFORMED),
+            ),
+        }
+        writer.write_all(&reply)?;
+        // Only flush once the client has no more pipelined requests queued
+        if reader.buffer().is_empty() {
+            writer.flush()?;
+        }
+    }
+    writer.flush()
+}
+
+/// Read one frame payload into `frame`; false on clean end of stream
+fn read_frame(reader: &mut impl Read, frame: &mut Vec<u8>) -> io::Result<bool> {
+    let mut len = [0u8; 4];
+    match reader.read_exact(&mut len) {
+        Ok(()) => {}
+        Err(e) if e.kind() == ErrorKind::UnexpectedEof => return Ok(false),
+        Err(e) => return Err(e),
+    }
+    let len = u32::from_le_bytes(len) as usize;
+    if len > protocol::MAX_FRAME {
+        return Err(io::Error::new(ErrorKind::InvalidData, "frame too large"));
+    }
+    frame.resize(len, 0);
+    reader.read_exact(frame)?;
+    Ok(true)
+}
+
+fn handle(request: Request<'_>, contexts: &mut HashMap<u16, Box<Engine>>, reply: &mut Vec<u8>) {
+    match request {
+        Request::Ping => protocol::encode_status(reply, protocol::OP_PING, None),
+        Request::Features => protocol::encode_features(reply, crate::compiled_features()),
+        Request::Close { context } => {
+            contexts.remove(&context);
+            protocol::encode_status(reply, protocol::OP_OK, None);
+        }
+        Request::Keys { context, keys } => match context_engine(contexts, context) {
+            Some(engine) => process_keys(engine, keys, reply),
+            None => too_many_contexts(reply),
+        },
+        Request::Config {
+            context,
+            option,
+            value,
+        } => match context_engine(contexts, context) {
+            Some(engine) => match configure(engine, option, value) {
+                Ok(()) => protocol::encode_status(reply, protocol::OP_OK, None),
+                Err(_) => {
+                    protocol::encode_status(reply, protocol::OP_ERROR, Some(protocol::ERR_CONFIG))
+                }
+            },
+            None => too_many_contexts(reply),
+        },
+        Request::Clear { context, all } => match context_engine(contexts, context) {
+            Some(engine) => {
+                if all {
+                    engine.clear_all();
+                } else {
+                    engine.clear();
+                }
+                protocol::encode_status(reply, protocol::OP_OK, None);
+            }
+            None => too_many_contexts(reply),
+        },
+    }
+}
+
+/// Engine for `context`, created on first use; None past `MAX_CONTEXTS`
+fn context_engine(contexts: &mut HashMap<u16, Box<Engine>>, context: u16) -> Option<&mut Engine> {
+    if !contexts.contains_key(&context) && contexts.len() >= MAX_CONTEXTS {
+        return None;
+    }
+    Some(
+        contexts
+            .entry(context)
+            .or_insert_with(|| Box::new(Engine::new())),
+    )
+}
+
+fn too_many_contexts(reply: &mut Vec<u8>) {
+    protocol::encode_status(reply, protocol::OP_ERROR, Some(protocol::ERR_CONTEXTS));
+}
+
+fn process_keys(engine: &mut Engine, keys: KeyEvents<'_>, reply: &mut Vec<u8>) {
+    let form = engine.output_form();
+    protocol::begin_keys_reply(reply, keys.len());
+    for k in keys.iter() {
+        let r = engine.on_key_ext(k.key, k.caps, k.ctrl, k.shift);
+        // NFD: at most 3 code points (5 UTF-8 bytes) per character
+        let max_len = r.as_slice().len() * 5;
+        protocol::push_key_reply(reply, r.action, r.backspace, max_len, |out| {
+            encode_utf8(r.as_slice(), form, out).unwrap_or(0)
+        });
+        r.release();
+    }
+    protocol::end_frame(reply);
+}
+
+/// Apply one CONFIG option, mirroring the `ime_*` setters
+fn configure(engine: &mut Engine, option: u8, value: u8) -> Result<(), &'static str> {
+    let on = value != 0;
+    match ConfigOption::from_u8(option).ok_or("Unknown config option")? {
+        ConfigOption::Method if value <= 1 => engine.set_method(value),
+        ConfigOption::Method => return Err("Unknown input method"),
+        ConfigOption::Enabled => engine.set_enabled(on),
+        ConfigOption::ModernTone => engine.set_modern_tone(on),
+        ConfigOption::EscRestore => engine.set_esc_restore(on),
+        ConfigOption::FreeTone => engine.set_free_tone(on),
+        ConfigOption::SkipWShortcut => engine.set_skip_w_shortcut(on),
+        ConfigOption::EnglishAutoRestore => engine.set_english_auto_restore(on),
+        ConfigOption::OutputForm => {
+            engine.set_output_form(NormalizationForm::from_u8(value).ok_or("Unknown output form")?)
+        }
+    }
+    Ok(())
+}
@@ -148,3 +148,47 @@ pub fn is_consonant(key: u16) -> bool {
 pub fn is_number(key: u16) -> bool {
     matches!(key, N0 | N1 | N2 | N3 | N4 | N5 | N6 | N7 | N8 | N9)
 }
+
+/// Convert key code to character
+pub fn key_to_char(key: u16, caps: bool) -> Option<char> {
+    let ch = match key {
+        A => 'a',
+        B => 'b',
+        C => 'c',
+        D => 'd',
+        E => 'e',
+        F => 'f',
+        G => 'g',
+        H => 'h',
+        I => 'i',
+        J => 'j',
+        K => 'k',
+        L => 'l',
+        M => 'm',
+        N => 'n',
+        O => 'o',
+        P => 'p',
+        Q => 'q',
+        R => 'r',
+        S => 's',
+        T => 't',
+        U => 'u',
+        V => 'v',
+        W => 'w',
+        X => 'x',
+        Y => 'y',
+        Z => 'z',
+        N0 => return Some('0'),
+        N1 => return Some('1'),
+        N2 => return Some('2'),
+        N3 => return Some('3'),
+        N4 => return Some('4'),
+        N5 => return Some('5'),
+        N6 => return Some('6'),
+        N7 => return Some('7'),
+        N8 => return Some('8'),
+        N9 => return Some('9'),
+        _ => return None,
+    };
+    Some(if caps { ch.to_ascii_uppercase() } else { ch })
+}
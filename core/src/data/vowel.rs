@@ -243,6 +243,39 @@ pub const TRIPHTHONG_PATTERNS: &[TriphthongTonePattern] = &[
     }, // uyê: khuyến, quyền
 ];
 
+/// Horn/breve targets: at most two positions (both vowels of ươ)
+///
+/// Fixed-size so horn placement never allocates; derefs to `&[usize]`.
+#[derive(Clone, Copy, Debug, Default, PartialEq, Eq)]
+pub struct HornPositions {
+    pos: [usize; 2],
+    len: usize,
+}
+
+impl HornPositions {
+    /// Add a position (at most two)
+    pub fn push(&mut self, pos: usize) {
+        self.pos[self.len] = pos;
+        self.len += 1;
+    }
+
+    /// Shift all positions by `by` (results found in a sub-slice)
+    pub fn offset(mut self, by: usize) -> Self {
+        for p in &mut self.pos[..self.len] {
+            *p += by;
+        }
+        self
+    }
+}
+
+impl core::ops::Deref for HornPositions {
+    type Target = [usize];
+
+    fn deref(&self) -> &[usize] {
+        &self.pos[..self.len]
+    }
+}
+
 /// Vietnamese vowel phonology analyzer
 pub struct Phonology;
 
@@ -433,8 +466,8 @@ impl Phonology {
     /// Special "ua" handling (inferred from buffer context):
     /// - C+ua (mua, chua): horn on u → "mưa"
     /// - ua, qua: breve on a → "uă", "quă"
-    pub fn find_horn_positions(buffer_keys: &[u16], vowel_positions: &[usize]) -> Vec<usize> {
-        let mut result = Vec::new();
+    pub fn find_horn_positions(buffer_keys: &[u16], vowel_positions: &[usize]) -> HornPositions {
+        let mut result = HornPositions::default();
         let len = vowel_positions.len();
 
         if len == 0 {
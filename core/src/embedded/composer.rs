@@ -0,0 +1,495 @@
+//! Composer - Telex/VNI state machine over caller storage
+//!
+//! Keys are applied to the letters of the current word; the tone mark is
+//! kept per word and its position recomputed after every change, so
+//! `hoa` + `s` + `n` moves the mark as the syllable grows. Each key yields
+//! an `Edit` covering the first changed letter to the end of the word.
+
+use super::syllable::Syllable;
+use super::Letter;
+use crate::data::chars::{self, mark, tone};
+use crate::data::keys;
+use crate::input::{self, ToneType};
+
+/// Edit for one key (same action values as the engine `Result`)
+#[derive(Clone, Copy, Debug, Default, PartialEq, Eq)]
+pub struct Edit {
+    /// 0 = pass the key through, 1 = apply this edit instead of the key
+    pub action: u8,
+    /// Characters to delete before inserting
+    pub backspace: u8,
+    /// Code points written to the output buffer
+    pub count: u8,
+}
+
+impl Edit {
+    pub const NONE: Self = Self {
+        action: 0,
+        backspace: 0,
+        count: 0,
+    };
+
+    const fn send(backspace: usize, count: usize) -> Self {
+        Self {
+            action: 1,
+            backspace: backspace as u8,
+            count: count as u8,
+        }
+    }
+
+    pub const fn is_send(&self) -> bool {
+        self.action == 1
+    }
+}
+
+/// Word composer over caller-supplied letter storage
+pub struct Composer<'a> {
+    letters: &'a mut [Letter],
+    len: usize,
+    /// Tone mark of the word (`mark::NONE`..`mark::NANG`)
+    mark: u8,
+    /// 0 = Telex, 1 = VNI
+    method: u8,
+    /// Modern tone placement (hoà, thuý)
+    modern: bool,
+    /// A modifier was undone ("ass" → "as"): rest of the word is literal
+    literal: bool,
+}
+
+impl<'a> Composer<'a> {
+    /// Compose into `storage` (at most 255 letters are used)
+    pub fn new(storage: &'a mut [Letter]) -> Self {
+        let capacity = storage.len().min(u8::MAX as usize);
+        Self {
+            letters: &mut storage[..capacity],
+            len: 0,
+            mark: mark::NONE,
+            method: 0,
+            modern: true,
+            literal: false,
+        }
+    }
+
+    /// 0 = Telex, 1 = VNI
+    pub fn set_method(&mut self, method: u8) {
+        self.method = method;
+    }
+
+    pub fn set_modern_tone(&mut self, modern: bool) {
+        self.modern = modern;
+    }
+
+    /// Longest word tracked; also the output buffer size `on_key` needs
+    pub fn capacity(&self) -> usize {
+        self.letters.len()
+    }
+
+    pub fn len(&self) -> usize {
+        self.len
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.len == 0
+    }
+
+    pub fn letters(&self) -> &[Letter] {
+        &self.letters[..self.len]
+    }
+
+    /// Tone mark of the current word
+    pub fn mark(&self) -> u8 {
+        self.mark
+    }
+
+    /// Start a new word (cursor moved, focus changed, ...)
+    pub fn clear(&mut self) {
+        self.len = 0;
+        self.mark = mark::NONE;
+        self.literal = false;
+    }
+
+    /// Process a key; a send edit's text is written to `out`
+    ///
+    /// `out` must hold `capacity()` code points, otherwise every key
+    /// passes through. Non-letter keys end the word and pass through.
+    pub fn on_key(&mut self, key: u16, caps: bool, out: &mut [u32]) -> Edit {
+        if out.len() < self.letters.len() {
+            return Edit::NONE;
+        }
+        if key == keys::DELETE {
+            return self.on_delete(out);
+        }
+        let word_key = keys::is_letter(key) || (self.method == 1 && keys::is_number(key));
+        if !word_key || self.len == self.letters.len() {
+            // Word boundary, or a word too long to be Vietnamese
+            self.clear();
+            return Edit::NONE;
+        }
+
+        let old_len = self.len;
+        let old_mark = self.mark_state();
+        let changed = if self.literal {
+            None
+        } else {
+            self.apply_modifier(key, caps)
+        };
+        let first = changed.unwrap_or_else(|| {
+            self.push(key, caps);
+            old_len
+        });
+
+        let dirty = self.dirty_from(first, old_mark);
+        if dirty == old_len && self.len == old_len + 1 && self.is_plain(old_len) {
+            // Plain letter appended: the host types it
+            return Edit::NONE;
+        }
+        self.emit(dirty, old_len, out)
+    }
+
+    fn on_delete(&mut self, out: &mut [u32]) -> Edit {
+        if self.len == 0 {
+            return Edit::NONE;
+        }
+        let old_len = self.len;
+        let old_mark = self.mark_state();
+        self.len -= 1;
+        if self.len == 0 {
+            self.clear();
+            return Edit::NONE;
+        }
+        if !Syllable::parse(self.letters()).has_vowel() {
+            self.mark = mark::NONE;
+        }
+
+        let dirty = self.dirty_from(self.len, old_mark);
+        if dirty == self.len {
+            // Only the last character goes: the host deletes it
+            return Edit::NONE;
+        }
+        self.emit(dirty, old_len, out)
+    }
+
+    /// Write letters from `dirty` to the end and build the edit
+    fn emit(&self, dirty: usize, old_len: usize, out: &mut [u32]) -> Edit {
+        let mark_pos = self.mark_position();
+        let mut count = 0;
+        for i in dirty..self.len {
+            out[count] = self.render_letter(i, mark_pos) as u32;
+            count += 1;
+        }
+        Edit::send(old_len - dirty, count)
+    }
+
+    // ---- Modifiers ----
+
+    /// Apply `key` as a modifier; returns the first changed letter
+    fn apply_modifier(&mut self, key: u16, caps: bool) -> Option<usize> {
+        let action = input::get(self.method).action(key);
+        let syllable = Syllable::parse(self.letters());
+        if let Some(m) = action.mark() {
+            return self.apply_mark(m, key, caps, &syllable);
+        }
+        if action.remove() {
+            return self.apply_remove();
+        }
+        if let Some(t) = action.tone() {
+            return self.apply_tone(key, caps, t, action.tone_targets(), &syllable);
+        }
+        if action.stroke() {
+            return self.apply_stroke(key, caps, &syllable);
+        }
+        None
+    }
+
+    fn apply_mark(&mut self, m: u8, key: u16, caps: bool, syl: &Syllable) -> Option<usize> {
+        if !syl.has_vowel() || !syl.is_valid(self.letters()) {
+            return None;
+        }
+        if self.mark == m {
+            self.mark = mark::NONE;
+            return Some(self.undo(key, caps));
+        }
+        self.mark = m;
+        Some(self.len)
+    }
+
+    fn apply_remove(&mut self) -> Option<usize> {
+        if self.mark != mark::NONE {
+            self.mark = mark::NONE;
+            return Some(self.len);
+        }
+        let i = self.letters().iter().rposition(|l| l.tone != tone::NONE)?;
+        self.letters[i].tone = tone::NONE;
+        Some(i)
+    }
+
+    fn apply_tone(
+        &mut self,
+        key: u16,
+        caps: bool,
+        t: ToneType,
+        targets: &[u16],
+        syl: &Syllable,
+    ) -> Option<usize> {
+        if !syl.has_vowel() {
+            return self.apply_standalone_horn(key, caps, t);
+        }
+        if !syl.is_valid(self.letters()) {
+            return None;
+        }
+
+        let mut positions = [0usize; 2];
+        let mut n = 0;
+        if t == ToneType::Horn {
+            for &pos in syl.horn_positions(self.letters()).iter() {
+                if targets.contains(&self.letters[pos].key) {
+                    positions[n] = pos;
+                    n += 1;
+                }
+            }
+        } else if let Some(pos) = (syl.vowel_start..syl.vowel_end)
+            .rev()
+            .find(|&i| targets.contains(&self.letters[i].key))
+        {
+            positions[0] = pos;
+            n = 1;
+        }
+        let positions = &positions[..n];
+        let first = *positions.first()?;
+
+        let value = t.value();
+        if positions.iter().all(|&p| self.letters[p].tone == value) {
+            for &p in positions {
+                self.letters[p].tone = tone::NONE;
+            }
+            self.undo(key, caps);
+            return Some(first);
+        }
+        for &p in positions {
+            self.letters[p].tone = value;
+        }
+        Some(first)
+    }
+
+    /// Telex `w` with no vowel yet types ư ("tw" → "tư")
+    fn apply_standalone_horn(&mut self, key: u16, caps: bool, t: ToneType) -> Option<usize> {
+        if self.method != 0 || key != keys::W || t != ToneType::Horn {
+            return None;
+        }
+        let pos = self.len;
+        self.letters[pos] = Letter {
+            tone: tone::HORN,
+            ..Letter::new(keys::U, caps)
+        };
+        self.len += 1;
+        if !Syllable::parse(self.letters()).is_valid(self.letters()) {
+            self.len -= 1;
+            return None;
+        }
+        Some(pos)
+    }
+
+    /// d → đ on the initial d ("dd", "did" → "đi", VNI "d9")
+    fn apply_stroke(&mut self, key: u16, caps: bool, syl: &Syllable) -> Option<usize> {
+        if self.len == 0 || self.letters[0].key != keys::D || !syl.is_valid(self.letters()) {
+            return None;
+        }
+        if self.letters[0].stroke {
+            self.letters[0].stroke = false;
+            self.undo(key, caps);
+        } else {
+            self.letters[0].stroke = true;
+        }
+        Some(0)
+    }
+
+    /// Type the modifier key itself and stop composing this word
+    fn undo(&mut self, key: u16, caps: bool) -> usize {
+        self.literal = true;
+        self.push(key, caps);
+        self.len - 1
+    }
+
+    fn push(&mut self, key: u16, caps: bool) {
+        self.letters[self.len] = Letter::new(key, caps);
+        self.len += 1;
+    }
+
+    // ---- Rendering ----
+
+    fn mark_position(&self) -> Option<usize> {
+        if self.mark == mark::NONE {
+            return None;
+        }
+        Syllable::parse(self.letters()).mark_position(self.letters(), self.modern)
+    }
+
+    fn mark_state(&self) -> (u8, Option<usize>) {
+        (self.mark, self.mark_position())
+    }
+
+    /// First letter whose rendering may differ from before the key
+    fn dirty_from(&self, first: usize, old: (u8, Option<usize>)) -> usize {
+        let mut dirty = first;
+        let new = self.mark_state();
+        if new != old {
+            for pos in [old.1, new.1].into_iter().flatten() {
+                dirty = dirty.min(pos);
+            }
+        }
+        dirty.min(self.len)
+    }
+
+    fn render_letter(&self, i: usize, mark_pos: Option<usize>) -> char {
+        let l = self.letters[i];
+        if l.stroke {
+            return chars::get_d(l.caps);
+        }
+        let m = if mark_pos == Some(i) {
+            self.mark
+        } else {
+            mark::NONE
+        };
+        if keys::is_vowel(l.key) {
+            if let Some(c) = chars::to_char(l.key, l.caps, l.tone, m) {
+                return c;
+            }
+        }
+        keys::key_to_char(l.key, l.caps).unwrap_or('?')
+    }
+
+    /// Letter `i` renders exactly as its key
+    fn is_plain(&self, i: usize) -> bool {
+        let l = self.letters[i];
+        l.tone == tone::NONE && !l.stroke && self.mark_position() != Some(i)
+    }
+
+    /// Current word as UTF-32; returns the code points written
+    ///
+    /// `out` must hold `len()` code points.
+    pub fn render(&self, out: &mut [u32]) -> usize {
+        let mark_pos = self.mark_position();
+        let n = self.len.min(out.len());
+        for (i, slot) in out.iter_mut().take(n).enumerate() {
+            *slot = self.render_letter(i, mark_pos) as u32;
+        }
+        n
+    }
+
+    /// Current word as UTF-8; None if `out` is too small
+    pub fn render_utf8(&self, out: &mut [u8]) -> Option<usize> {
+        let mark_pos = self.mark_position();
+        let mut n = 0;
+        for i in 0..self.len {
+            let c = self.render_letter(i, mark_pos);
+            if n + c.len_utf8() > out.len() {
+                return None;
+            }
+            n += c.encode_utf8(&mut out[n..]).len();
+        }
+        Some(n)
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::embedded::WORD_CAPACITY;
+    use crate::utils::{char_to_key, keys_from_str};
+
+    /// Type `input` as a host would, applying each edit to a screen
+    fn type_screen(method: u8, input: &str) -> String {
+        let mut storage = [Letter::EMPTY; WORD_CAPACITY];
+        let mut out = [0u32; WORD_CAPACITY];
+        let mut ime = Composer::new(&mut storage);
+        ime.set_method(method);
+        let mut screen: Vec<char> = Vec::new();
+        for c in input.chars() {
+            let key = char_to_key(c);
+            let edit = ime.on_key(key, c.is_ascii_uppercase(), &mut out);
+            if edit.is_send() {
+                for _ in 0..edit.backspace {
+                    screen.pop();
+                }
+                screen.extend(
+                    out[..edit.count as usize]
+                        .iter()
+                        .filter_map(|&cp| char::from_u32(cp)),
+                );
+            } else if key == keys::DELETE {
+                screen.pop();
+            } else {
+                screen.push(c);
+            }
+        }
+        screen.into_iter().collect()
+    }
+
+    #[test]
+    fn test_telex_words() {
+        for (input, expected) in [
+            ("vieetj", "việt"),
+            ("tieengs", "tiếng"),
+            ("dduowcj", "được"),
+            ("nguwowif", "người"),
+            ("hoaf", "hoà"),
+            ("quys", "quý"),
+            ("giaf", "già"),
+            ("muaw", "mưa"),
+            ("Ddaau", "Đâu"),
+            ("tw", "tư"),
+            ("khuyeens", "khuyến"),
+        ] {
+            assert_eq!(type_screen(0, input), expected, "{input}");
+        }
+    }
+
+    #[test]
+    fn test_vni_words() {
+        assert_eq!(type_screen(1, "vie65t"), "việt");
+        assert_eq!(type_screen(1, "d9uo7c5"), "được");
+        assert_eq!(type_screen(1, "a8"), "ă");
+    }
+
+    #[test]
+    fn test_mark_moves_with_syllable() {
+        // Mark placed on an open syllable, then repositioned
+        assert_eq!(type_screen(0, "hoas"), "hoá");
+        assert_eq!(type_screen(0, "hoasn"), "hoán");
+        assert_eq!(type_screen(0, "muaf"), "mùa");
+        assert_eq!(type_screen(0, "hoaf<"), "hò");
+    }
+
+    #[test]
+    fn test_undo_and_invalid() {
+        assert_eq!(type_screen(0, "ass"), "as");
+        assert_eq!(type_screen(0, "aaa"), "aa");
+        assert_eq!(type_screen(0, "ddd"), "dd");
+        // Not a Vietnamese syllable: modifiers stay letters
+        assert_eq!(type_screen(0, "clears"), "clears");
+        assert_eq!(type_screen(0, "as bs"), "á bs");
+    }
+
+    #[test]
+    fn test_short_output_buffer_passes_through() {
+        let mut storage = [Letter::EMPTY; 8];
+        let mut out = [0u32; 4];
+        let mut ime = Composer::new(&mut storage);
+        assert_eq!(ime.on_key(keys::A, false, &mut out), Edit::NONE);
+        assert!(ime.is_empty());
+    }
+
+    #[test]
+    fn test_render_utf8() {
+        let mut storage = [Letter::EMPTY; 8];
+        let mut out = [0u32; 8];
+        let mut ime = Composer::new(&mut storage);
+        for key in keys_from_str("vieetj") {
+            ime.on_key(key, false, &mut out);
+        }
+        let mut utf8 = [0u8; 16];
+        let n = ime.render_utf8(&mut utf8).unwrap();
+        assert_eq!(core::str::from_utf8(&utf8[..n]).unwrap(), "việt");
+        assert_eq!(ime.render_utf8(&mut utf8[..3]), None);
+    }
+}
@@ -0,0 +1,69 @@
+//! Embedded Engine - heap-free Telex/VNI composition
+//!
+//! A compact composer for targets without a heap or `std` (firmware
+//! keyboards, WASM, kernel-adjacent input stacks). It shares the key
+//! mappings (`input`), character tables (`data::chars`) and phonology
+//! rules (`data::vowel`, `data::constants`) with the full engine, but:
+//!
+//! - the word lives in caller-supplied storage (`&mut [Letter]`)
+//! - edits are written into a caller-supplied `&mut [u32]`
+//! - only `core` is used: no `Vec`, `String`, `HashMap` or thread-locals
+//!
+//! `core/embedded` builds these modules as a `#![no_std]` crate without
+//! `alloc`, which is what guarantees the above.
+//!
+//! ```ignore
+//! let mut storage = [Letter::EMPTY; WORD_CAPACITY];
+//! let mut out = [0u32; WORD_CAPACITY];
+//! let mut ime = Composer::new(&mut storage);
+//! let edit = ime.on_key(keycode, caps, &mut out);
+//! if edit.is_send() {
+//!     // delete edit.backspace chars, insert out[..edit.count]
+//! }
+//! ```
+//!
+//! Full engine only: English detection and auto-restore, shortcuts,
+//! ESC restore, legacy encodings, composition (preedit) mode.
+
+mod composer;
+mod syllable;
+
+pub use composer::{Composer, Edit};
+pub use syllable::Syllable;
+
+/// Recommended word storage (longest Vietnamese syllable is 7 letters;
+/// extra room keeps long non-Vietnamese words in sync)
+pub const WORD_CAPACITY: usize = 32;
+
+/// One letter of the word being composed
+///
+/// The tone mark is kept per word (see `Composer`), so a letter only
+/// stores its base key and diacritic.
+#[derive(Clone, Copy, Debug, Default, PartialEq, Eq)]
+pub struct Letter {
+    /// Virtual keycode (`data::keys`)
+    pub key: u16,
+    pub caps: bool,
+    /// Diacritic: `tone::NONE`, `tone::CIRCUMFLEX` or `tone::HORN`
+    pub tone: u8,
+    /// d → đ
+    pub stroke: bool,
+}
+
+impl Letter {
+    pub const EMPTY: Self = Self {
+        key: 0,
+        caps: false,
+        tone: 0,
+        stroke: false,
+    };
+
+    pub const fn new(key: u16, caps: bool) -> Self {
+        Self {
+            key,
+            caps,
+            tone: 0,
+            stroke: false,
+        }
+    }
+}
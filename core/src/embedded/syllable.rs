@@ -0,0 +1,167 @@
+//! Syllable analysis over a letter slice
+//!
+//! Splits a word into initial / vowel nucleus / final, validates it against
+//! the phonology tables in `data::constants` and finds where the tone mark
+//! goes (`Phonology::find_tone_position`). Everything works on the
+//! caller's letters plus small fixed arrays on the stack.
+
+use super::Letter;
+use crate::data::chars::tone;
+use crate::data::constants::{
+    SPELLING_RULES, VALID_DIPHTHONGS, VALID_FINALS_1, VALID_FINALS_2, VALID_INITIALS_1,
+    VALID_INITIALS_2, VALID_TRIPHTHONGS,
+};
+use crate::data::keys;
+use crate::data::vowel::{HornPositions, Modifier, Phonology, Vowel};
+
+/// Longest vowel nucleus handled (triphthongs plus a gi/qu glide)
+const MAX_NUCLEUS: usize = 4;
+
+/// Positions of the syllable parts within the word
+#[derive(Clone, Copy, Debug, PartialEq, Eq)]
+pub struct Syllable {
+    /// First vowel (== len if there is none)
+    pub vowel_start: usize,
+    /// One past the last vowel of the nucleus
+    pub vowel_end: usize,
+    /// Initial is "qu" (u belongs to the consonant)
+    pub has_qu: bool,
+    /// Initial is "gi" (i belongs to the consonant)
+    pub has_gi: bool,
+}
+
+impl Syllable {
+    pub fn parse(letters: &[Letter]) -> Self {
+        let vowel_start = letters
+            .iter()
+            .position(|l| keys::is_vowel(l.key))
+            .unwrap_or(letters.len());
+        let vowel_end = letters[vowel_start..]
+            .iter()
+            .position(|l| !keys::is_vowel(l.key))
+            .map_or(letters.len(), |n| vowel_start + n);
+        let glide = |first: u16, second: u16| {
+            vowel_start == 1 && vowel_end > 1 && letters[0].key == first && letters[1].key == second
+        };
+        Self {
+            vowel_start,
+            vowel_end,
+            has_qu: glide(keys::Q, keys::U),
+            has_gi: glide(keys::G, keys::I),
+        }
+    }
+
+    pub fn has_vowel(&self) -> bool {
+        self.vowel_start < self.vowel_end
+    }
+
+    /// Whether `letters` spell a (possibly unfinished) Vietnamese syllable
+    ///
+    /// Checks base keys only: initial, nucleus pattern, final and the c/k,
+    /// g/gh, ng/ngh spelling rules. Diacritics are not required yet, so
+    /// "tieng" is valid on its way to "tiếng".
+    pub fn is_valid(&self, letters: &[Letter]) -> bool {
+        let (mut start, end) = (self.vowel_start, self.vowel_end);
+        if (self.has_qu || self.has_gi) && end - start > 1 {
+            start += 1;
+        }
+        let mut initial = [0u16; 3];
+        if start > initial.len() {
+            return false;
+        }
+        for (slot, l) in initial.iter_mut().zip(&letters[..start]) {
+            *slot = l.key;
+        }
+        let initial = &initial[..start];
+
+        let initial_ok = match *initial {
+            [] => true,
+            [k] => VALID_INITIALS_1.contains(&k),
+            [a, b] => VALID_INITIALS_2.contains(&[a, b]),
+            [a, b, c] => [a, b, c] == [keys::N, keys::G, keys::H],
+            _ => false,
+        };
+        if !initial_ok {
+            return false;
+        }
+
+        let mut nucleus = [0u16; 3];
+        if end - start > nucleus.len() {
+            return false;
+        }
+        for (slot, l) in nucleus.iter_mut().zip(&letters[start..end]) {
+            *slot = l.key;
+        }
+        let nucleus = &nucleus[..end - start];
+        let nucleus_ok = match *nucleus {
+            [] => end == letters.len(),
+            [_] => true,
+            [a, b] => VALID_DIPHTHONGS.contains(&[a, b]),
+            [a, b, c] => VALID_TRIPHTHONGS.contains(&[a, b, c]),
+            _ => false,
+        };
+        if !nucleus_ok {
+            return false;
+        }
+
+        let final_ok = match letters[end..] {
+            [] => true,
+            [a] => keys::is_consonant(a.key) && VALID_FINALS_1.contains(&a.key),
+            [a, b] => VALID_FINALS_2.contains(&[a.key, b.key]),
+            _ => false,
+        };
+        if !final_ok {
+            return false;
+        }
+
+        match nucleus.first() {
+            Some(first) => !SPELLING_RULES
+                .iter()
+                .any(|(cons, vowels, _)| *cons == initial && vowels.contains(first)),
+            None => true,
+        }
+    }
+
+    /// Position of the tone mark, None without a vowel
+    pub fn mark_position(&self, letters: &[Letter], modern: bool) -> Option<usize> {
+        if !self.has_vowel() {
+            return None;
+        }
+        let mut vowels = [Vowel::new(0, Modifier::None, 0); MAX_NUCLEUS];
+        let n = (self.vowel_end - self.vowel_start).min(MAX_NUCLEUS);
+        for (i, v) in vowels.iter_mut().take(n).enumerate() {
+            let pos = self.vowel_start + i;
+            let modifier = match letters[pos].tone {
+                tone::CIRCUMFLEX => Modifier::Circumflex,
+                tone::HORN => Modifier::Horn,
+                _ => Modifier::None,
+            };
+            *v = Vowel::new(letters[pos].key, modifier, pos);
+        }
+        let has_final = self.vowel_end < letters.len();
+        Some(Phonology::find_tone_position(
+            &vowels[..n],
+            has_final,
+            modern,
+            self.has_qu,
+            self.has_gi,
+        ))
+    }
+
+    /// Horn/breve targets in the nucleus (ươ takes both)
+    pub fn horn_positions(&self, letters: &[Letter]) -> HornPositions {
+        // Keys from the consonant before the nucleus (for the "mua" rule)
+        let from = self.vowel_start.saturating_sub(1);
+        let mut window = [0u16; MAX_NUCLEUS + 1];
+        let mut vowel_pos = [0usize; MAX_NUCLEUS];
+        let n = (self.vowel_end - self.vowel_start).min(MAX_NUCLEUS);
+        for (i, l) in letters[from..self.vowel_start + n].iter().enumerate() {
+            window[i] = l.key;
+        }
+        let offset = self.vowel_start - from;
+        for (i, p) in vowel_pos.iter_mut().take(n).enumerate() {
+            *p = offset + i;
+        }
+        Phonology::find_horn_positions(&window[..offset + n], &vowel_pos[..n]).offset(from)
+    }
+}
@@ -2,6 +2,7 @@
 
 pub const MAX: usize = 256;
 
+use super::scratch::Scratch;
 use crate::utils;
 
 /// Single character in buffer
@@ -43,10 +44,23 @@ impl Char {
 }
 
 /// Typing buffer
+///
+/// Keeps the rendered text of the word (one `char` per displayable
+/// position) alongside the entries. Mutators only lower the `clean`
+/// watermark; the next `rendered*`/`screen_len` call re-renders the
+/// positions from there, so a keystroke renders what it changed and
+/// rebuilds hand out slices of `text`.
 #[derive(Clone)]
 pub struct Buffer {
     data: [Char; MAX],
     len: usize,
+    /// Rendered chars of `data[..clean]`
+    text: [char; MAX],
+    /// Index in `text` where position `i` starts (`starts[clean]` is the
+    /// rendered length)
+    starts: [u16; MAX + 1],
+    /// Positions below this are rendered and unchanged since (`<= len`)
+    clean: usize,
 }
 
 impl Default for Buffer {
@@ -61,6 +75,9 @@ impl Buffer {
         Self {
             data: [Char::default(); MAX],
             len: 0,
+            text: ['\0'; MAX],
+            starts: [0; MAX + 1],
+            clean: 0,
         }
     }
 
@@ -76,6 +93,7 @@ impl Buffer {
     pub fn pop(&mut self) -> Option<Char> {
         if self.len > 0 {
             self.len -= 1;
+            self.clean = self.clean.min(self.len);
             Some(self.data[self.len])
         } else {
             None
@@ -85,6 +103,7 @@ impl Buffer {
     #[inline(always)]
     pub fn clear(&mut self) {
         self.len = 0;
+        self.clean = 0;
     }
 
     #[inline(always)]
@@ -109,6 +128,7 @@ impl Buffer {
     #[inline]
     pub fn get_mut(&mut self, i: usize) -> Option<&mut Char> {
         if i < self.len {
+            self.clean = self.clean.min(i);
             Some(&mut self.data[i])
         } else {
             None
@@ -135,6 +155,7 @@ impl Buffer {
                 self.data.copy_within(index + 1..self.len, index);
             }
             self.len -= 1;
+            self.clean = self.clean.min(index);
         }
     }
 
@@ -151,6 +172,18 @@ impl Buffer {
         positions
     }
 
+    /// Keys of the buffer, in the word's scratch arena
+    #[inline]
+    pub fn keys_in<'a>(&self, scratch: &'a Scratch) -> &'a [u16] {
+        scratch.collect(self.iter().map(|c| c.key))
+    }
+
+    /// Tones of the buffer, in the word's scratch arena
+    #[inline]
+    pub fn tones_in<'a>(&self, scratch: &'a Scratch) -> &'a [u8] {
+        scratch.collect(self.iter().map(|c| c.tone))
+    }
+
     /// Find vowel position by key (from end)
     #[inline]
     pub fn find_vowel_by_key(&self, key: u16) -> Option<usize> {
@@ -202,26 +235,112 @@ impl Buffer {
     /// and stroked consonants (đ). Use this for shortcut matching to ensure exact comparison.
     #[inline]
     pub fn to_full_string(&self) -> String {
-        use crate::data::{chars, keys};
         let mut out = String::with_capacity(self.len);
         for c in &self.data[..self.len] {
-            // Handle đ/Đ (stroked D)
-            if c.key == keys::D && c.stroke {
-                out.push(chars::get_d(c.caps));
-                continue;
-            }
-            // Try to get full Vietnamese character with diacritics
-            if let Some(ch) = chars::to_char(c.key, c.caps, c.tone, c.mark) {
-                out.push(ch);
-                continue;
-            }
-            // Fallback to basic character
-            if let Some(ch) = utils::key_to_char(c.key, c.caps) {
+            if let Some(ch) = Self::render_char(c) {
                 out.push(ch);
             }
         }
         out
     }
+
+    /// `to_full_string` in the word's scratch arena
+    #[inline]
+    pub fn full_str_in<'a>(&self, scratch: &'a Scratch) -> &'a str {
+        if let Some(text) = self.fresh_text() {
+            return scratch.string(text.len(), text.iter().copied());
+        }
+        scratch.string(self.len, self.iter().filter_map(Self::render_char))
+    }
+
+    /// Number of displayed chars (`to_full_string().chars().count()`)
+    #[inline]
+    pub fn display_len(&self) -> usize {
+        if let Some(text) = self.fresh_text() {
+            return text.len();
+        }
+        self.iter()
+            .filter(|c| Self::render_char(c).is_some())
+            .count()
+    }
+
+    /// Bring the rendered text up to date (positions `clean..len`)
+    #[inline]
+    fn refresh(&mut self) {
+        let mut n = self.starts[self.clean] as usize;
+        for i in self.clean..self.len {
+            self.starts[i] = n as u16;
+            if let Some(ch) = Self::render_char(&self.data[i]) {
+                self.text[n] = ch;
+                n += 1;
+            }
+        }
+        self.starts[self.len] = n as u16;
+        self.clean = self.len;
+    }
+
+    /// Rendered text if nothing changed since the last refresh
+    #[inline]
+    fn fresh_text(&self) -> Option<&[char]> {
+        (self.clean == self.len).then(|| &self.text[..self.starts[self.len] as usize])
+    }
+
+    /// Rendered text of the whole buffer
+    #[inline]
+    pub fn rendered(&mut self) -> &[char] {
+        let len = self.len;
+        self.rendered_range(0, len)
+    }
+
+    /// Rendered text of positions `start..end` (clamped to the buffer)
+    #[inline]
+    pub fn rendered_range(&mut self, start: usize, end: usize) -> &[char] {
+        self.refresh();
+        let end = end.min(self.len);
+        let start = start.min(end);
+        &self.text[self.starts[start] as usize..self.starts[end] as usize]
+    }
+
+    /// Number of displayed chars for positions `start..end`
+    #[inline]
+    pub fn screen_len(&mut self, start: usize, end: usize) -> usize {
+        self.rendered_range(start, end).len()
+    }
+
+    /// Render the buffer into a caller-provided slice (no allocation)
+    ///
+    /// Returns the number of chars written (truncated to `out.len()`).
+    pub fn render_into(&self, out: &mut [char]) -> usize {
+        if let Some(text) = self.fresh_text() {
+            let n = text.len().min(out.len());
+            out[..n].copy_from_slice(&text[..n]);
+            return n;
+        }
+        let mut n = 0;
+        for c in &self.data[..self.len] {
+            if n == out.len() {
+                break;
+            }
+            if let Some(ch) = Self::render_char(c) {
+                out[n] = ch;
+                n += 1;
+            }
+        }
+        n
+    }
+
+    /// Displayed character for a buffer entry
+    #[inline]
+    fn render_char(c: &Char) -> Option<char> {
+        use crate::data::{chars, keys};
+        // Handle đ/Đ (stroked D)
+        if c.key == keys::D && c.stroke {
+            return Some(chars::get_d(c.caps));
+        }
+        // Try to get full Vietnamese character with diacritics,
+        // falling back to the basic character
+        chars::to_char(c.key, c.caps, c.tone, c.mark).or_else(|| utils::key_to_char(c.key, c.caps))
+    }
 }
 
 #[cfg(test)]
@@ -244,4 +363,67 @@ mod tests {
         buf.clear();
         assert!(buf.is_empty());
     }
+
+    fn word(keys: &[u16]) -> Buffer {
+        let mut buf = Buffer::new();
+        for &k in keys {
+            buf.push(Char::new(k, false));
+        }
+        buf
+    }
+
+    #[test]
+    fn test_rendered_follows_changes() {
+        use crate::data::keys;
+        let mut buf = word(&[keys::V, keys::I, keys::E, keys::T]);
+        assert_eq!(buf.rendered(), ['v', 'i', 'e', 't']);
+
+        // Mid-word change: the tail is re-rendered too
+        let e = buf.get_mut(2).unwrap();
+        e.tone = 1;
+        e.mark = 5;
+        assert_eq!(buf.rendered_range(2, 4), ['ệ', 't']);
+        assert_eq!(buf.rendered(), ['v', 'i', 'ệ', 't']);
+
+        buf.remove(1);
+        assert_eq!(buf.rendered(), ['v', 'ệ', 't']);
+        buf.pop();
+        buf.push(Char::new(keys::N, true));
+        assert_eq!(buf.rendered(), ['v', 'ệ', 'N']);
+        assert_eq!(buf.screen_len(1, 3), 2);
+
+        // Clones carry the cache; the copy stays independent
+        let mut copy = buf.clone();
+        copy.get_mut(0).unwrap().stroke = true;
+        assert_eq!(copy.rendered(), ['v', 'ệ', 'N']);
+        copy.get_mut(0).unwrap().key = keys::D;
+        assert_eq!(copy.rendered(), ['đ', 'ệ', 'N']);
+        assert_eq!(buf.rendered(), ['v', 'ệ', 'N']);
+
+        buf.clear();
+        assert!(buf.rendered().is_empty());
+    }
+
+    #[test]
+    fn test_cached_matches_uncached() {
+        use crate::data::keys;
+        let mut buf = word(&[keys::N, keys::G, keys::U, keys::O, keys::I]);
+        buf.get_mut(2).unwrap().tone = 2;
+        buf.get_mut(3).unwrap().tone = 2;
+        buf.get_mut(3).unwrap().mark = 2;
+        // Unknown keys render nothing and take no screen space
+        buf.push(Char::new(0xFFFF, false));
+        let expected = buf.to_full_string();
+        let mut out = ['\0'; MAX];
+
+        let uncached = buf.render_into(&mut out);
+        assert_eq!(String::from_iter(&out[..uncached]), expected);
+        assert_eq!(String::from_iter(buf.rendered()), expected);
+        assert_eq!(buf.display_len(), 5);
+        assert_eq!(buf.screen_len(4, 6), 1);
+        // Fresh cache serves the `&self` renderers
+        assert_eq!(buf.render_into(&mut out), uncached);
+        assert_eq!(String::from_iter(&out[..uncached]), expected);
+        assert_eq!(buf.full_str_in(&Scratch::new()), expected);
+    }
 }
@@ -1,10 +1,13 @@
 //! Buffer management for Vietnamese IME
 //!
-//! Handles typing buffer, raw input tracking, and output generation.
+//! Handles typing buffer, raw input tracking, output generation and the
+//! per-word scratch arena.
 
 pub mod buffer;
 pub mod raw_input_buffer;
 pub mod rebuild;
+pub mod scratch;
 
 pub use buffer::{Buffer, Char, MAX};
 pub use raw_input_buffer::RawInputBuffer;
+pub use scratch::Scratch;
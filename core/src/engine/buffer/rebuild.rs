@@ -16,7 +16,8 @@
 //!
 //! These functions are called frequently during Vietnamese typing, so they
 //! are optimized for:
-//! - Minimal allocations (reuse buffers where possible)
+//! - No allocations and no re-rendering: output is a slice of the buffer's
+//!   render cache, which only re-renders positions changed since last use
 //! - O(1) operations for simple cases
 //! - O(syllable) for complex transformations (not O(buffer))
 //!
@@ -24,12 +25,12 @@
 //!
 //! ```ignore
 //! // After applying a transformation at position 2
-//! let result = rebuild_from(&buffer, 2);
+//! let result = rebuild_from(&mut buffer, 2);
 //! // result.backspace = number of chars to delete from position 2 to end
 //! // result.chars = new characters to insert
 //! ```
 
-use super::buffer::{Buffer, Char};
+use super::buffer::{Buffer, Char, MAX};
 use crate::data::{chars, keys};
 use crate::engine::types::Result;
 
@@ -63,7 +64,7 @@ pub fn render_char(c: &Char) -> Option<char> {
     crate::utils::key_to_char(c.key, c.caps)
 }
 
-/// Render buffer contents to a character vector
+/// Render buffer contents to characters
 ///
 /// Converts the buffer from the given start position to end into
 /// displayable characters.
@@ -74,24 +75,16 @@ pub fn render_char(c: &Char) -> Option<char> {
 /// * `end` - Ending position (exclusive)
 ///
 /// # Returns
-/// Vector of rendered characters
+/// Rendered characters (a slice of the buffer's render cache)
 #[inline]
-pub fn render_range(buf: &Buffer, start: usize, end: usize) -> Vec<char> {
-    let mut result = Vec::with_capacity(end - start);
-    for i in start..end.min(buf.len()) {
-        if let Some(c) = buf.get(i) {
-            if let Some(ch) = render_char(c) {
-                result.push(ch);
-            }
-        }
-    }
-    result
+pub fn render_range(buf: &mut Buffer, start: usize, end: usize) -> &[char] {
+    buf.rendered_range(start, end)
 }
 
-/// Render entire buffer to a character vector
+/// Render entire buffer to characters (from the render cache)
 #[inline]
-pub fn render_all(buf: &Buffer) -> Vec<char> {
-    render_range(buf, 0, buf.len())
+pub fn render_all(buf: &mut Buffer) -> &[char] {
+    buf.rendered()
 }
 
 // ============================================================
@@ -114,20 +107,10 @@ pub fn render_all(buf: &Buffer) -> Vec<char> {
 /// Number of displayable characters in the range
 ///
 /// # Performance
-/// O(n) where n = end - start
+/// O(1) once the render cache is up to date (difference of two offsets)
 #[inline]
-pub fn count_screen_chars(buf: &Buffer, start: usize, end: usize) -> usize {
-    let mut count = 0;
-    for i in start..end.min(buf.len()) {
-        if let Some(c) = buf.get(i) {
-            // Each buffer position maps to one screen character
-            // (Vietnamese diacritics are combined with base characters)
-            if render_char(c).is_some() {
-                count += 1;
-            }
-        }
-    }
-    count
+pub fn count_screen_chars(buf: &mut Buffer, start: usize, end: usize) -> usize {
+    buf.screen_len(start, end)
 }
 
 // ============================================================
@@ -218,22 +201,22 @@ pub fn find_syllable_boundary(buf: &Buffer) -> usize {
 /// ```ignore
 /// // Buffer: "việt" (4 chars), transformation at position 2
 /// // Old screen: "việt", new buffer: "việt"
-/// let result = rebuild_from(&buf, 2);
+/// let result = rebuild_from(&mut buf, 2);
 /// // result.backspace = 2 (delete "ệt")
 /// // result.chars = ['ệ', 't'] (insert new "ệt")
 /// ```
 #[inline]
-pub fn rebuild_from(buf: &Buffer, from_pos: usize) -> Result {
-    // Count how many screen chars from position to end
-    let screen_chars = count_screen_chars(buf, from_pos, buf.len());
-
+pub fn rebuild_from(buf: &mut Buffer, from_pos: usize) -> Result {
     // Render the characters from position to end
-    let new_chars = render_range(buf, from_pos, buf.len());
+    let new_chars = render_range(buf, from_pos, MAX);
+
+    // Screen chars from position to end (one per rendered char)
+    let screen_chars = new_chars.len();
 
     // Backspace count = number of old screen chars at and after position
     // Since we're rebuilding from the same buffer, this equals the new count
     // SAFETY: Clamp to u8::MAX to prevent overflow
-    Result::send(screen_chars.min(u8::MAX as usize) as u8, &new_chars)
+    Result::send(screen_chars.min(u8::MAX as usize) as u8, new_chars)
 }
 
 /// Rebuild displayed text with explicit backspace count
@@ -253,19 +236,19 @@ pub fn rebuild_from(buf: &Buffer, from_pos: usize) -> Result {
 /// ```ignore
 /// // User deleted a character: old screen had 4 chars, now buffer has 3
 /// let old_len = 4;
-/// let result = rebuild_from_with_backspace(&buf, 0, old_len);
+/// let result = rebuild_from_with_backspace(&mut buf, 0, old_len);
 /// // result.backspace = 4 (delete all old chars)
 /// // result.chars = new 3-char content
 /// ```
 #[inline]
 pub fn rebuild_from_with_backspace(
-    buf: &Buffer,
+    buf: &mut Buffer,
     from_pos: usize,
     old_screen_length: usize,
 ) -> Result {
-    let new_chars = render_range(buf, from_pos, buf.len());
+    let new_chars = render_range(buf, from_pos, MAX);
     // SAFETY: Clamp to u8::MAX to prevent overflow
-    Result::send(old_screen_length.min(u8::MAX as usize) as u8, &new_chars)
+    Result::send(old_screen_length.min(u8::MAX as usize) as u8, new_chars)
 }
 
 /// Rebuild entire buffer and return the result
@@ -276,7 +259,7 @@ pub fn rebuild_from_with_backspace(
 /// * `buf` - The buffer to rebuild
 /// * `old_screen_length` - Number of screen chars to delete
 #[inline]
-pub fn rebuild_all(buf: &Buffer, old_screen_length: usize) -> Result {
+pub fn rebuild_all(buf: &mut Buffer, old_screen_length: usize) -> Result {
     rebuild_from_with_backspace(buf, 0, old_screen_length)
 }
 
@@ -434,24 +417,24 @@ mod tests {
 
     #[test]
     fn test_render_range() {
-        let buf = make_buffer("viet");
-        let chars = render_range(&buf, 0, buf.len());
+        let mut buf = make_buffer("viet");
+        let chars = render_range(&mut buf, 0, MAX);
         assert_eq!(chars, vec!['v', 'i', 'e', 't']);
     }
 
     #[test]
     fn test_render_range_partial() {
-        let buf = make_buffer("vietnam");
-        let chars = render_range(&buf, 2, 5);
+        let mut buf = make_buffer("vietnam");
+        let chars = render_range(&mut buf, 2, 5);
         assert_eq!(chars, vec!['e', 't', 'n']);
     }
 
     #[test]
     fn test_count_screen_chars() {
-        let buf = make_buffer("viet");
-        assert_eq!(count_screen_chars(&buf, 0, buf.len()), 4);
-        assert_eq!(count_screen_chars(&buf, 2, buf.len()), 2);
-        assert_eq!(count_screen_chars(&buf, 0, 2), 2);
+        let mut buf = make_buffer("viet");
+        assert_eq!(count_screen_chars(&mut buf, 0, 4), 4);
+        assert_eq!(count_screen_chars(&mut buf, 2, 4), 2);
+        assert_eq!(count_screen_chars(&mut buf, 0, 2), 2);
     }
 
     #[test]
@@ -474,8 +457,8 @@ mod tests {
 
     #[test]
     fn test_rebuild_from() {
-        let buf = make_buffer("viet");
-        let result = rebuild_from(&buf, 2);
+        let mut buf = make_buffer("viet");
+        let result = rebuild_from(&mut buf, 2);
         assert!(result.is_send());
         assert_eq!(result.count, 2);
         unsafe {
@@ -486,17 +469,32 @@ mod tests {
 
     #[test]
     fn test_rebuild_from_with_backspace() {
-        let buf = make_buffer("vie");
-        let result = rebuild_from_with_backspace(&buf, 0, 4);
+        let mut buf = make_buffer("vie");
+        let result = rebuild_from_with_backspace(&mut buf, 0, 4);
         assert!(result.is_send());
         assert_eq!(result.backspace, 4);
         assert_eq!(result.count, 3);
     }
 
+    #[test]
+    fn test_rebuild_after_mid_word_change() {
+        let mut buf = make_buffer("viet");
+        rebuild_from(&mut buf, 0).release();
+        buf.get_mut(2).unwrap().tone = tone::CIRCUMFLEX;
+        let result = rebuild_from(&mut buf, 2);
+        assert_eq!(result.backspace, 2);
+        unsafe {
+            assert_eq!(*result.chars.offset(0), 'ê' as u32);
+            assert_eq!(*result.chars.offset(1), 't' as u32);
+        }
+        result.release();
+        assert_eq!(render_all(&mut buf), ['v', 'i', 'ê', 't']);
+    }
+
     #[test]
     fn test_rebuild_all() {
-        let buf = make_buffer("test");
-        let result = rebuild_all(&buf, 5);
+        let mut buf = make_buffer("test");
+        let result = rebuild_all(&mut buf, 5);
         assert!(result.is_send());
         assert_eq!(result.backspace, 5);
         assert_eq!(result.count, 4);
@@ -0,0 +1,266 @@
+//! Per-Word Scratch Arena
+//!
+//! Transient per-key data (key and tone lists, rendered output, vowel
+//! positions, lowercase words for lookups) is bump-allocated here instead
+//! of in short-lived `Vec`s and `String`s. The engine resets the arena at
+//! word boundaries (`Engine::clear`), so after the first words typing
+//! allocates nothing for this data:
+//! - Allocation: align, bump an offset in the current chunk
+//! - Full chunk: a new, larger chunk is added for the rest of the word
+//! - Reset: the chunks are merged into one sized for the busiest word so
+//!   far (capped at `SCRATCH_MAX_RETAINED`)
+//!
+//! Allocating takes `&self` and hands out disjoint slices that live as long
+//! as that borrow; `reset` takes `&mut self`, so no slice can outlive it.
+//! Only `Copy` types with alignment up to 8 are stored (nothing to drop).
+
+use std::cell::{Cell, UnsafeCell};
+use std::mem::{align_of, size_of, MaybeUninit};
+use std::ptr::NonNull;
+
+/// First chunk, allocated on the first use (bytes)
+pub const SCRATCH_CHUNK: usize = 4096;
+
+/// Largest chunk kept across words (bytes)
+pub const SCRATCH_MAX_RETAINED: usize = 64 * 1024;
+
+type Word = MaybeUninit<u64>;
+
+/// Bump arena for per-word transient data (see module docs)
+#[derive(Default)]
+pub struct Scratch {
+    /// Chunks in allocation order (owned, from `new_chunk`); only the
+    /// last one has free space. Raw pointers, so growing the list never
+    /// asserts uniqueness over memory that slices still point into.
+    chunks: UnsafeCell<Vec<NonNull<[Word]>>>,
+    /// Bytes used in the last chunk
+    used: Cell<usize>,
+    /// Bytes in the chunks before the last one
+    filled: Cell<usize>,
+}
+
+// SAFETY: the chunks are owned by the arena alone
+unsafe impl Send for Scratch {}
+
+impl Drop for Scratch {
+    fn drop(&mut self) {
+        for chunk in self.chunks.get_mut().drain(..) {
+            free_chunk(chunk);
+        }
+    }
+}
+
+impl Scratch {
+    /// Empty arena (allocates nothing until first used)
+    pub const fn new() -> Self {
+        Self {
+            chunks: UnsafeCell::new(Vec::new()),
+            used: Cell::new(0),
+            filled: Cell::new(0),
+        }
+    }
+
+    /// Bytes handed out since the last reset
+    pub fn allocated(&self) -> usize {
+        self.filled.get() + self.used.get()
+    }
+
+    /// Bytes held (all chunks)
+    pub fn capacity(&self) -> usize {
+        // SAFETY: shared read; chunks are only pushed by `reserve` on this
+        // thread (`Scratch` is `!Sync`) and never while this runs
+        let chunks = unsafe { &*self.chunks.get() };
+        chunks.iter().map(|c| c.len() * size_of::<Word>()).sum()
+    }
+
+    /// Free everything allocated since the last reset, keeping one chunk
+    /// large enough for it
+    pub fn reset(&mut self) {
+        let chunks = self.chunks.get_mut();
+        if chunks.len() > 1 {
+            let need = self.filled.get() + self.used.get();
+            let size = need.next_power_of_two().min(SCRATCH_MAX_RETAINED);
+            chunks.drain(..).for_each(free_chunk);
+            chunks.push(new_chunk(size));
+        } else if chunks
+            .first()
+            .is_some_and(|c| c.len() * size_of::<Word>() > SCRATCH_MAX_RETAINED)
+        {
+            free_chunk(std::mem::replace(
+                &mut chunks[0],
+                new_chunk(SCRATCH_MAX_RETAINED),
+            ));
+        }
+        self.used.set(0);
+        self.filled.set(0);
+    }
+
+    /// Reserve `len` values of `T`; returns uninitialized storage
+    fn reserve<T: Copy>(&self, len: usize) -> &mut [MaybeUninit<T>] {
+        const { assert!(align_of::<T>() <= align_of::<Word>()) };
+        let bytes = len * size_of::<T>();
+        // SAFETY: `Scratch` is `!Sync` and nothing else borrows the list
+        // during this call; chunk storage never moves, so slices handed
+        // out earlier stay valid when the list grows
+        let chunks = unsafe { &mut *self.chunks.get() };
+        let mut start = self.used.get().next_multiple_of(align_of::<T>());
+        let fits = |c: &NonNull<[Word]>| start + bytes <= c.len() * size_of::<Word>();
+        if !chunks.last().is_some_and(fits) {
+            let last = chunks.last().map_or(0, |c| c.len() * size_of::<Word>());
+            let size = (2 * last).max(bytes).max(SCRATCH_CHUNK).next_power_of_two();
+            self.filled.set(self.filled.get() + self.used.get());
+            chunks.push(new_chunk(size));
+            start = 0;
+        }
+        self.used.set(start + bytes);
+        let base = chunks
+            .last()
+            .map_or(NonNull::dangling(), |c| c.cast::<u8>());
+        // SAFETY: [start, start + bytes) lies in the last chunk (or is
+        // empty), is aligned for `T` (chunks are 8-aligned) and was handed
+        // out to no one else
+        unsafe {
+            let ptr = base.as_ptr().add(start).cast::<MaybeUninit<T>>();
+            std::slice::from_raw_parts_mut(ptr, len)
+        }
+    }
+
+    /// Give back the unused tail of the last reservation
+    fn shrink_last(&self, reserved_end: usize, actual_end: usize) {
+        if self.used.get() == reserved_end {
+            self.used.set(actual_end);
+        }
+    }
+
+    /// Copy `iter` into the arena
+    pub fn collect<T, I>(&self, iter: I) -> &mut [T]
+    where
+        T: Copy,
+        I: IntoIterator<Item = T>,
+        I::IntoIter: ExactSizeIterator,
+    {
+        let iter = iter.into_iter();
+        let slots = self.reserve::<T>(iter.len());
+        let mut n = 0;
+        for (slot, value) in slots.iter_mut().zip(iter) {
+            slot.write(value);
+            n += 1;
+        }
+        // SAFETY: the first `n` slots were written
+        unsafe { std::slice::from_raw_parts_mut(slots.as_mut_ptr().cast::<T>(), n) }
+    }
+
+    /// Copy up to `max` items of `iter` into the arena (the unused part
+    /// of the reservation is given back)
+    pub fn collect_at_most<T, I>(&self, max: usize, iter: I) -> &mut [T]
+    where
+        T: Copy,
+        I: IntoIterator<Item = T>,
+    {
+        let slots = self.reserve::<T>(max);
+        let reserved_end = self.used.get();
+        let mut n = 0;
+        for (slot, value) in slots.iter_mut().zip(iter) {
+            slot.write(value);
+            n += 1;
+        }
+        self.shrink_last(reserved_end, reserved_end - (max - n) * size_of::<T>());
+        // SAFETY: the first `n` slots were written
+        unsafe { std::slice::from_raw_parts_mut(slots.as_mut_ptr().cast::<T>(), n) }
+    }
+
+    /// UTF-8 string of up to `max_chars` chars of `chars` in the arena
+    pub fn string<I>(&self, max_chars: usize, chars: I) -> &mut str
+    where
+        I: IntoIterator<Item = char>,
+    {
+        let slots = self.reserve::<u8>(max_chars * 4);
+        let reserved_end = self.used.get();
+        let mut len = 0;
+        let mut utf8 = [0u8; 4];
+        for c in chars.into_iter().take(max_chars) {
+            for &b in c.encode_utf8(&mut utf8).as_bytes() {
+                slots[len].write(b);
+                len += 1;
+            }
+        }
+        self.shrink_last(reserved_end, reserved_end - (slots.len() - len));
+        // SAFETY: the first `len` bytes were written, as whole UTF-8
+        // encoded chars
+        unsafe {
+            let bytes = std::slice::from_raw_parts_mut(slots.as_mut_ptr().cast::<u8>(), len);
+            std::str::from_utf8_unchecked_mut(bytes)
+        }
+    }
+}
+
+fn new_chunk(bytes: usize) -> NonNull<[Word]> {
+    let chunk = vec![MaybeUninit::uninit(); bytes.div_ceil(size_of::<Word>())].into_boxed_slice();
+    NonNull::from(Box::leak(chunk))
+}
+
+fn free_chunk(chunk: NonNull<[Word]>) {
+    // SAFETY: chunks come from `new_chunk` and are freed once
+    drop(unsafe { Box::from_raw(chunk.as_ptr()) });
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_collect_and_reset() {
+        let mut s = Scratch::new();
+        assert_eq!(s.capacity(), 0);
+        {
+            let keys = s.collect([1u16, 2, 3]);
+            let text = s.string(8, "việt".chars());
+            let wide = s.collect([7usize, 8]);
+            keys[0] = 9;
+            assert_eq!(keys, &[9, 2, 3]);
+            assert_eq!(text, "việt");
+            assert_eq!(wide, &[7, 8]);
+            let odd = s.collect_at_most(10, (1u8..=10).filter(|v| v % 2 == 1));
+            assert_eq!(odd, &[1, 3, 5, 7, 9]);
+            // Unused reservations are given back
+            let used = s.allocated();
+            let none = s.collect_at_most(100, std::iter::empty::<u8>());
+            assert!(none.is_empty());
+            assert_eq!(s.allocated(), used);
+        }
+        assert_eq!(s.capacity(), SCRATCH_CHUNK);
+        s.reset();
+        assert_eq!((s.allocated(), s.capacity()), (0, SCRATCH_CHUNK));
+    }
+
+    #[test]
+    fn test_growth_merges_on_reset() {
+        let mut s = Scratch::new();
+        let mut slices = Vec::new();
+        for i in 0..100u32 {
+            slices.push(s.collect(std::iter::repeat_n(i, 100)));
+        }
+        // Earlier slices are intact after the arena grew
+        for (i, slice) in slices.iter().enumerate() {
+            assert!(slice.iter().all(|&v| v == i as u32));
+        }
+        assert_eq!(s.allocated(), 100 * 100 * 4);
+        drop(slices);
+
+        s.reset();
+        assert_eq!(s.capacity(), (100 * 100 * 4usize).next_power_of_two());
+        // Same load again fits the merged chunk
+        for i in 0..100u32 {
+            s.collect(std::iter::repeat_n(i, 100));
+        }
+        assert_eq!(s.capacity(), (100 * 100 * 4usize).next_power_of_two());
+    }
+
+    #[test]
+    fn test_retained_size_is_capped() {
+        let mut s = Scratch::new();
+        s.collect(std::iter::repeat_n(0u64, SCRATCH_MAX_RETAINED));
+        s.reset();
+        assert_eq!(s.capacity(), SCRATCH_MAX_RETAINED);
+    }
+}
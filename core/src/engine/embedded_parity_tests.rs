@@ -0,0 +1,230 @@
+//! Embedded Composer Parity Tests
+//!
+//! `embedded::Composer` is a separate, heap-free implementation of Telex
+//! and VNI. This module types the inputs of the engine's vector tables
+//! through both and requires the composer to give exactly the engine's
+//! output, so the two cannot drift apart unnoticed. The tables' expected
+//! values are checked by the engine tests, not here.
+//!
+//! Known differences are listed in `DIVERGENCES`. The list is exhaustive:
+//! an unlisted mismatch fails, and so does a listed entry that agrees.
+
+use super::edge_cases_tests::tests as edge;
+use super::tests as engine;
+use super::Engine;
+use crate::data::keys;
+use crate::embedded::{Composer, Letter, WORD_CAPACITY};
+use crate::utils::{char_to_key, type_word};
+
+/// One vector table with the settings its engine test uses
+struct Table {
+    name: &'static str,
+    method: u8,
+    modern: bool,
+    cases: &'static [(&'static str, &'static str)],
+}
+
+const fn table(
+    name: &'static str,
+    method: u8,
+    modern: bool,
+    cases: &'static [(&'static str, &'static str)],
+) -> Table {
+    Table {
+        name,
+        method,
+        modern,
+        cases,
+    }
+}
+
+/// Every Telex/VNI table of the engine tests
+///
+/// `RAW_MODE_PREFIX` is left out: it needs shifted keys (`@`, `#`, `:`)
+/// and `Composer::on_key` has no shift parameter.
+const TABLES: &[Table] = &[
+    table("TELEX_BASIC", 0, true, engine::TELEX_BASIC),
+    table(
+        "TELEX_CIRCUMFLEX_WITH_NANG",
+        0,
+        true,
+        engine::TELEX_CIRCUMFLEX_WITH_NANG,
+    ),
+    table("VNI_BASIC", 1, true, engine::VNI_BASIC),
+    table("TELEX_COMPOUND", 0, true, engine::TELEX_COMPOUND),
+    table(
+        "TELEX_TONE_REPOSITION",
+        0,
+        true,
+        engine::TELEX_TONE_REPOSITION,
+    ),
+    table("TELEX_ESC_RESTORE", 0, true, engine::TELEX_ESC_RESTORE),
+    table(
+        "VIETNAMESE_SHORT_WORDS",
+        0,
+        true,
+        engine::VIETNAMESE_SHORT_WORDS,
+    ),
+    table("VNI_ESC_RESTORE", 1, true, engine::VNI_ESC_RESTORE),
+    table("RAW_MODE_NORMAL", 0, true, engine::RAW_MODE_NORMAL),
+    table(
+        "ENGLISH_MULTI_SYLLABLE",
+        2,
+        true,
+        engine::ENGLISH_MULTI_SYLLABLE,
+    ),
+    table("ENGLISH_SHORT_WORDS", 2, true, engine::ENGLISH_SHORT_WORDS),
+    table("TH_TR_TONE_CASES", 0, true, edge::TH_TR_TONE_CASES),
+    table("UO_COMPOUND_BASIC", 0, true, edge::UO_COMPOUND_BASIC),
+    table("UO_COMPOUND_COMPLEX", 0, true, edge::UO_COMPOUND_COMPLEX),
+    table(
+        "UO_COMPOUND_TONE_POSITIONING",
+        0,
+        true,
+        edge::UO_COMPOUND_TONE_POSITIONING,
+    ),
+    table(
+        "UO_COMPOUND_WITH_FINALS",
+        0,
+        true,
+        edge::UO_COMPOUND_WITH_FINALS,
+    ),
+    table("MODERN_TONE_OA", 0, true, edge::MODERN_TONE_OA),
+    table("MODERN_TONE_OE", 0, true, edge::MODERN_TONE_OE),
+    table("MODERN_TONE_UY", 0, true, edge::MODERN_TONE_UY),
+    table(
+        "MODERN_TONE_UYE_TRIPHTHONG",
+        0,
+        true,
+        edge::MODERN_TONE_UYE_TRIPHTHONG,
+    ),
+    table(
+        "MODERN_TONE_UY_QU_INITIAL",
+        0,
+        true,
+        edge::MODERN_TONE_UY_QU_INITIAL,
+    ),
+    table("TRADITIONAL_TONE_OA", 0, false, edge::TRADITIONAL_TONE_OA),
+    table("TRADITIONAL_TONE_OE", 0, false, edge::TRADITIONAL_TONE_OE),
+    table("TRADITIONAL_TONE_UY", 0, false, edge::TRADITIONAL_TONE_UY),
+    table("OEO_PATTERN", 0, true, edge::OEO_PATTERN),
+    table("OEO_WITH_FINALS", 0, true, edge::OEO_WITH_FINALS),
+    table(
+        "AUTORESTORE_VIETNAMESE_WORDS",
+        0,
+        true,
+        edge::AUTORESTORE_VIETNAMESE_WORDS,
+    ),
+];
+
+// Reasons for `DIVERGENCES`
+const ESC_RESTORE: &str = "ESC restore is full engine only; ESC ends the word";
+const ENGLISH: &str = "English detection is full engine only";
+const OE_MARK: &str = "the composer marks ôe; the engine rejects the mark and types the key";
+
+/// Known differences: (table, input, composer output, reason)
+const DIVERGENCES: &[(&str, &str, &str, &str)] = &[
+    ("TELEX_ESC_RESTORE", "text\x1b", "tẽt", ESC_RESTORE),
+    ("TELEX_ESC_RESTORE", "user\x1b", "uẻ", ESC_RESTORE),
+    ("TELEX_ESC_RESTORE", "esc\x1b", "éc", ESC_RESTORE),
+    ("TELEX_ESC_RESTORE", "dd\x1b", "đ", ESC_RESTORE),
+    ("TELEX_ESC_RESTORE", "vieejt\x1b", "việt", ESC_RESTORE),
+    ("TELEX_ESC_RESTORE", "Vieejt\x1b", "Việt", ESC_RESTORE),
+    ("VNI_ESC_RESTORE", "a1\x1b", "á", ESC_RESTORE),
+    ("VNI_ESC_RESTORE", "vie65t\x1b", "việt", ESC_RESTORE),
+    ("VNI_ESC_RESTORE", "d9\x1b", "đ", ESC_RESTORE),
+    ("ENGLISH_MULTI_SYLLABLE", "reflex", "rèlex", ENGLISH),
+    ("ENGLISH_MULTI_SYLLABLE", "export", "ẽport", ENGLISH),
+    ("ENGLISH_MULTI_SYLLABLE", "express", "êps", ENGLISH),
+    ("ENGLISH_SHORT_WORDS", "text", "tẽt", ENGLISH),
+    ("ENGLISH_SHORT_WORDS", "next", "nẽt", ENGLISH),
+    ("ENGLISH_SHORT_WORDS", "sexy", "seỹ", ENGLISH),
+    ("OEO_PATTERN", "khoeof", "khồe", OE_MARK),
+    ("OEO_PATTERN", "khoeos", "khốe", OE_MARK),
+    ("OEO_PATTERN", "ngoeof", "ngồe", OE_MARK),
+    ("OEO_PATTERN", "ngoeos", "ngốe", OE_MARK),
+];
+
+/// Type `input` through the engine with the table's settings
+fn type_engine(t: &Table, input: &str) -> String {
+    let mut e = Engine::new();
+    e.set_method(t.method);
+    e.set_modern_tone(t.modern);
+    e.set_esc_restore(true);
+    type_word(&mut e, input)
+}
+
+/// Type `input` through the composer, applying edits like `type_word`
+fn type_composer(method: u8, modern: bool, input: &str) -> String {
+    let mut storage = [Letter::EMPTY; WORD_CAPACITY];
+    let mut out = [0u32; WORD_CAPACITY];
+    let mut ime = Composer::new(&mut storage);
+    ime.set_method(method);
+    ime.set_modern_tone(modern);
+
+    let mut screen: Vec<char> = Vec::new();
+    for c in input.chars() {
+        let key = char_to_key(c);
+        let edit = ime.on_key(key, c.is_uppercase(), &mut out);
+        if edit.is_send() {
+            for _ in 0..edit.backspace {
+                screen.pop();
+            }
+            screen.extend(
+                out[..edit.count as usize]
+                    .iter()
+                    .filter_map(|&cp| char::from_u32(cp)),
+            );
+        } else if key == keys::DELETE {
+            screen.pop();
+        } else if key != keys::ESC {
+            screen.push(c);
+        }
+    }
+    screen.into_iter().collect()
+}
+
+#[test]
+fn test_composer_matches_engine_vectors() {
+    let mut unexpected = Vec::new();
+    let mut seen = vec![false; DIVERGENCES.len()];
+
+    for t in TABLES {
+        for &(input, _) in t.cases {
+            let expected = type_engine(t, input);
+            let got = type_composer(t.method, t.modern, input);
+            let known = DIVERGENCES
+                .iter()
+                .position(|&(name, i, _, _)| name == t.name && i == input);
+            match known {
+                Some(k) => {
+                    seen[k] = true;
+                    let (_, _, listed, _) = DIVERGENCES[k];
+                    if got == expected {
+                        unexpected.push(format!(
+                            "{}: '{}' now agrees ('{}'), drop it from DIVERGENCES",
+                            t.name, input, got
+                        ));
+                    } else if got != listed {
+                        unexpected.push(format!(
+                            "{}: '{}' → '{}', listed as '{}'",
+                            t.name, input, got, listed
+                        ));
+                    }
+                }
+                None if got != expected => unexpected.push(format!(
+                    "{}: '{}' → '{}', engine gives '{}'",
+                    t.name, input, got, expected
+                )),
+                None => {}
+            }
+        }
+    }
+    for (k, &(name, input, _, _)) in DIVERGENCES.iter().enumerate() {
+        if !seen[k] {
+            unexpected.push(format!("{}: '{}' is not a vector", name, input));
+        }
+    }
+
+    assert!(unexpected.is_empty(), "\n{}", unexpected.join("\n"));
+}
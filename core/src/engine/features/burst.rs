@@ -0,0 +1,294 @@
+//! Burst Mode - one coalesced edit for machine-speed input
+//!
+//! Autotype tools, remote desktop replay and key-repeat storms deliver
+//! keys far faster than anyone types. Handled one by one, every key costs
+//! the platform an edit (backspaces + text injection). In a burst the
+//! engine queues the keys instead and returns a single edit at the end:
+//! - Start: explicitly (`Engine::burst_begin`, e.g. the host knows it is
+//!   replaying), or detected when `min_keys` key events in a row arrive
+//!   less than `gap_ns` apart
+//! - Keys: text keys (letters, digits, punctuation, space, backspace) are
+//!   queued; a full queue is processed in one batch and the burst goes on
+//! - End: `Engine::burst_end` processes the rest of the queue and returns
+//!   the coalesced edit. A detected burst also ends at the first slow key,
+//!   and any burst ends at a key that cannot be queued (Ctrl shortcuts,
+//!   arrows, return, ...), which the host handles normally after the edit
+//!
+//! Each batched key still goes through the full engine path; its edit is
+//! applied to `BurstEdit`, a model of the text the burst has touched. The
+//! coalesced edit is the difference between the screen before the burst
+//! and that model, so it leaves the same text as the per-key edits would.
+
+use crate::data::keys;
+use crate::input::layout;
+
+/// Keys queued before a batch is processed
+pub const BURST_QUEUE: usize = 256;
+
+/// Default detection threshold: key events closer than this are "fast"
+pub const DEFAULT_BURST_GAP_NS: u64 = 5_000_000;
+
+/// Default number of fast key events in a row that start a burst
+pub const DEFAULT_BURST_MIN_KEYS: u32 = 8;
+
+/// What the host does with a key offered to burst mode (`ime_burst_key`)
+#[repr(u8)]
+#[derive(Clone, Copy, Debug, PartialEq, Eq)]
+pub enum BurstKey {
+    /// No burst: handle the key as usual (`ime_key_*`)
+    Pass = 0,
+    /// Queued: consume the key, inject nothing
+    Queued = 1,
+    /// The burst is over: take the edit (`ime_burst_end`), inject it, then
+    /// handle this key as usual
+    Flush = 2,
+}
+
+/// A key waiting in the burst queue
+#[derive(Clone, Copy, Default)]
+pub struct QueuedKey {
+    pub key: u16,
+    pub caps: bool,
+    pub shift: bool,
+}
+
+impl QueuedKey {
+    /// Text the application inserts for this key when the engine passes
+    /// it through (None for backspace)
+    #[inline]
+    pub fn text(&self) -> Option<char> {
+        if self.key == keys::SPACE {
+            return Some(' ');
+        }
+        layout::key_char(self.key, self.caps, self.shift)
+    }
+}
+
+/// Text touched by a burst: `deleted` characters that were on screen
+/// before it started are gone, followed by `text`
+#[derive(Default)]
+pub struct BurstEdit {
+    deleted: usize,
+    text: Vec<u32>,
+}
+
+impl BurstEdit {
+    /// Apply one per-key edit: delete `backspace` characters, insert `chars`
+    #[inline]
+    pub fn apply(&mut self, backspace: usize, chars: &[u32]) {
+        let kept = self.text.len().saturating_sub(backspace);
+        self.deleted += backspace - (self.text.len() - kept);
+        self.text.truncate(kept);
+        self.text.extend_from_slice(chars);
+    }
+
+    /// Characters deleted from before the burst
+    #[inline]
+    pub fn deleted(&self) -> usize {
+        self.deleted
+    }
+
+    /// Text typed by the burst (after `deleted`)
+    #[inline]
+    pub fn text(&self) -> &[u32] {
+        &self.text
+    }
+
+    /// Hand over the edit and start a new one
+    pub fn take(&mut self) -> (usize, Vec<u32>) {
+        (
+            std::mem::take(&mut self.deleted),
+            std::mem::take(&mut self.text),
+        )
+    }
+}
+
+/// Burst state: detection, key queue and the edit so far
+pub struct Burst {
+    queue: [QueuedKey; BURST_QUEUE],
+    queued: usize,
+    active: bool,
+    /// Started by detection (ends at the first slow key)
+    detected: bool,
+    pub edit: BurstEdit,
+    /// Detection threshold (0 = detection off)
+    gap_ns: u64,
+    min_keys: u32,
+    last_event_ns: u64,
+    /// Fast key events in a row, including the first of the run
+    run: u32,
+}
+
+impl Default for Burst {
+    fn default() -> Self {
+        Self::new()
+    }
+}
+
+impl Burst {
+    pub const fn new() -> Self {
+        Self {
+            queue: [QueuedKey {
+                key: 0,
+                caps: false,
+                shift: false,
+            }; BURST_QUEUE],
+            queued: 0,
+            active: false,
+            detected: false,
+            edit: BurstEdit {
+                deleted: 0,
+                text: Vec::new(),
+            },
+            gap_ns: DEFAULT_BURST_GAP_NS,
+            min_keys: DEFAULT_BURST_MIN_KEYS,
+            last_event_ns: 0,
+            run: 0,
+        }
+    }
+
+    /// Set the detection threshold (`gap_ns` 0 turns detection off)
+    pub fn set_detection(&mut self, gap_ns: u64, min_keys: u32) {
+        self.gap_ns = gap_ns;
+        self.min_keys = min_keys.max(2);
+        self.run = 0;
+    }
+
+    /// Detection threshold: (`gap_ns`, `min_keys`)
+    pub fn detection(&self) -> (u64, u32) {
+        (self.gap_ns, self.min_keys)
+    }
+
+    #[inline]
+    pub fn is_active(&self) -> bool {
+        self.active
+    }
+
+    /// Start a burst (explicit bursts ignore timing)
+    pub fn begin(&mut self, detected: bool) {
+        if !self.active {
+            self.active = true;
+            self.detected = detected;
+        }
+    }
+
+    /// Record a key event time. Returns (fast, starts): whether the key
+    /// followed the previous one within `gap_ns`, and whether it completes
+    /// a run of `min_keys` fast keys. Timestamp 0 is ignored.
+    pub fn observe(&mut self, event_ns: u64) -> (bool, bool) {
+        if self.gap_ns == 0 || event_ns == 0 {
+            return (false, false);
+        }
+        let fast =
+            self.last_event_ns != 0 && event_ns.saturating_sub(self.last_event_ns) < self.gap_ns;
+        self.last_event_ns = event_ns;
+        self.run = if fast { self.run.saturating_add(1) } else { 1 };
+        (fast, self.run >= self.min_keys)
+    }
+
+    /// A detected burst ends at the first slow key
+    #[inline]
+    pub fn ends_on_slow_key(&self) -> bool {
+        self.detected
+    }
+
+    /// Queue a key; returns false when the queue is full (process it first)
+    #[inline]
+    pub fn push(&mut self, key: QueuedKey) -> bool {
+        if self.queued == BURST_QUEUE {
+            return false;
+        }
+        self.queue[self.queued] = key;
+        self.queued += 1;
+        true
+    }
+
+    /// Take the queued keys for processing
+    #[inline]
+    pub fn take_queue(&mut self) -> ([QueuedKey; BURST_QUEUE], usize) {
+        (self.queue, std::mem::take(&mut self.queued))
+    }
+
+    /// End the burst (the queue must be processed)
+    pub fn finish(&mut self) -> (usize, Vec<u32>) {
+        debug_assert_eq!(self.queued, 0);
+        self.active = false;
+        self.detected = false;
+        self.run = 0;
+        self.edit.take()
+    }
+}
+
+/// Whether a key can join a burst: its effect is text (or deleting it)
+#[inline]
+pub fn queueable(key: u16, caps: bool, ctrl: bool, shift: bool) -> bool {
+    !ctrl && (key == keys::DELETE || QueuedKey { key, caps, shift }.text().is_some())
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_edit_model() {
+        let mut edit = BurstEdit::default();
+        // "a" then "â" (replace), then two backspaces reach before the burst
+        edit.apply(0, &['a' as u32]);
+        edit.apply(1, &['â' as u32]);
+        assert_eq!((edit.deleted(), edit.text()), (0, &['â' as u32][..]));
+        edit.apply(2, &[]);
+        edit.apply(0, &['b' as u32]);
+        assert_eq!((edit.deleted(), edit.text()), (1, &['b' as u32][..]));
+        assert_eq!(edit.take(), (1, vec!['b' as u32]));
+        assert_eq!(edit.deleted(), 0);
+    }
+
+    #[test]
+    fn test_detection() {
+        let mut b = Burst::new();
+        b.set_detection(1_000, 3);
+        assert_eq!(b.observe(10_000), (false, false));
+        assert_eq!(b.observe(10_500), (true, false));
+        assert_eq!(b.observe(11_000), (true, true));
+        // A slow key starts a new run
+        assert_eq!(b.observe(20_000), (false, false));
+        // Unknown timestamps and detection off are ignored
+        assert_eq!(b.observe(0), (false, false));
+        b.set_detection(0, 3);
+        assert_eq!(b.observe(20_001), (false, false));
+    }
+
+    #[test]
+    fn test_queue_and_finish() {
+        let mut b = Burst::new();
+        b.begin(false);
+        let key = QueuedKey {
+            key: keys::A,
+            caps: false,
+            shift: false,
+        };
+        for _ in 0..BURST_QUEUE {
+            assert!(b.push(key));
+        }
+        assert!(!b.push(key));
+        let (_, n) = b.take_queue();
+        assert_eq!(n, BURST_QUEUE);
+        assert!(b.push(key));
+        b.take_queue();
+        b.edit.apply(0, &['a' as u32]);
+        assert_eq!(b.finish(), (0, vec!['a' as u32]));
+        assert!(!b.is_active());
+    }
+
+    #[test]
+    fn test_queueable() {
+        assert!(queueable(keys::A, false, false, false));
+        assert!(queueable(keys::N2, false, false, true)); // '@'
+        assert!(queueable(keys::SPACE, false, false, false));
+        assert!(queueable(keys::DELETE, false, false, false));
+        assert!(!queueable(keys::A, false, true, false));
+        assert!(!queueable(keys::RETURN, false, false, false));
+        assert!(!queueable(keys::LEFT, false, false, false));
+        assert!(!queueable(keys::ESC, false, false, false));
+    }
+}
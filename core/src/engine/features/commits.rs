@@ -0,0 +1,286 @@
+//! Committed-Word Events
+//!
+//! An engine with a `CommitRing` attached (`Engine::set_commit_ring`)
+//! publishes one `CommitRecord` per committed word: the word as shown,
+//! how it was committed (Vietnamese, English, shortcut trigger) and the
+//! key that ended it. Consumers (prediction, learning, analytics, the
+//! platform's session buffer) drain the ring from any thread.
+//!
+//! The ring is a fixed single-producer / single-consumer queue:
+//! - Producer: the engine, on each word commit. A few uncontended atomics
+//!   around a 64-byte slot write; no allocation, no lock.
+//! - Consumer: `drain`, from any thread; it never touches the engine.
+//! - Full ring: new records are dropped and counted (`dropped`); `seq`
+//!   numbers every commit, so gaps are visible.
+//!
+//! A second concurrent producer or consumer is refused by a flag (the
+//! record is dropped / `drain` returns 0) rather than corrupting the ring.
+
+use std::cell::UnsafeCell;
+use std::sync::atomic::{AtomicBool, AtomicU32, Ordering};
+
+/// Records held before the consumer must drain (power of two)
+pub const COMMIT_RING_CAPACITY: usize = 256;
+
+/// UTF-8 bytes of word text per record (longer words are truncated at a
+/// character boundary)
+pub const COMMIT_TEXT_LEN: usize = 56;
+
+/// How a word was committed
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+#[repr(u8)]
+pub enum CommitKind {
+    /// Composed word (with or without diacritics)
+    Vietnamese = 0,
+    /// Detected as English (auto-restored to raw keys if it was transformed)
+    English = 1,
+    /// Shortcut trigger, replaced by its expansion
+    Shortcut = 2,
+}
+
+impl CommitKind {
+    pub fn from_u8(value: u8) -> Option<Self> {
+        match value {
+            0 => Some(Self::Vietnamese),
+            1 => Some(Self::English),
+            2 => Some(Self::Shortcut),
+            _ => None,
+        }
+    }
+}
+
+/// One committed word (64 bytes, C layout: `ImeCommitRecord`)
+#[repr(C)]
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct CommitRecord {
+    /// Commit number (wrapping); a gap means records were dropped
+    pub seq: u32,
+    /// Engine key that ended the word (SPACE, punctuation, …)
+    pub key: u16,
+    /// `CommitKind`
+    pub kind: u8,
+    /// Bytes used in `text`
+    pub len: u8,
+    /// Word text, UTF-8
+    pub text: [u8; COMMIT_TEXT_LEN],
+}
+
+impl CommitRecord {
+    pub const EMPTY: Self = Self {
+        seq: 0,
+        key: 0,
+        kind: 0,
+        len: 0,
+        text: [0; COMMIT_TEXT_LEN],
+    };
+
+    /// Build a record, truncating `word` to whole characters
+    pub fn new(seq: u32, key: u16, kind: CommitKind, word: &[char]) -> Self {
+        let mut record = Self {
+            seq,
+            key,
+            kind: kind as u8,
+            ..Self::EMPTY
+        };
+        let mut len = 0;
+        for &c in word {
+            let n = c.len_utf8();
+            if len + n > COMMIT_TEXT_LEN {
+                break;
+            }
+            c.encode_utf8(&mut record.text[len..]);
+            len += n;
+        }
+        record.len = len as u8;
+        record
+    }
+
+    pub fn text(&self) -> &str {
+        std::str::from_utf8(&self.text[..self.len as usize]).unwrap_or("")
+    }
+
+    pub fn kind(&self) -> Option<CommitKind> {
+        CommitKind::from_u8(self.kind)
+    }
+}
+
+/// Fixed-size SPSC queue of commit records (see module docs)
+pub struct CommitRing {
+    slots: [UnsafeCell<CommitRecord>; COMMIT_RING_CAPACITY],
+    /// Next slot to write (producer)
+    head: AtomicU32,
+    /// Next slot to read (consumer)
+    tail: AtomicU32,
+    /// Commits offered, including dropped ones
+    seq: AtomicU32,
+    dropped: AtomicU32,
+    producing: AtomicBool,
+    consuming: AtomicBool,
+}
+
+// Slots are only written by the producer between its `tail` check and
+// `head` release, and only read by the consumer between its `head` check
+// and `tail` release; the flags keep each side single.
+unsafe impl Sync for CommitRing {}
+
+impl Default for CommitRing {
+    fn default() -> Self {
+        Self::new()
+    }
+}
+
+impl CommitRing {
+    /// Empty ring (const: usable as a `static`, no allocation)
+    pub const fn new() -> Self {
+        Self {
+            slots: [const { UnsafeCell::new(CommitRecord::EMPTY) }; COMMIT_RING_CAPACITY],
+            head: AtomicU32::new(0),
+            tail: AtomicU32::new(0),
+            seq: AtomicU32::new(0),
+            dropped: AtomicU32::new(0),
+            producing: AtomicBool::new(false),
+            consuming: AtomicBool::new(false),
+        }
+    }
+
+    /// Publish a committed word; false if it was dropped (ring full)
+    #[inline]
+    pub fn push(&self, key: u16, kind: CommitKind, word: &[char]) -> bool {
+        let seq = self.seq.fetch_add(1, Ordering::Relaxed);
+        if self.producing.swap(true, Ordering::Acquire) {
+            self.dropped.fetch_add(1, Ordering::Relaxed);
+            return false;
+        }
+        let head = self.head.load(Ordering::Relaxed);
+        let tail = self.tail.load(Ordering::Acquire);
+        let stored = (head.wrapping_sub(tail) as usize) < COMMIT_RING_CAPACITY;
+        if stored {
+            let slot = &self.slots[head as usize % COMMIT_RING_CAPACITY];
+            // SAFETY: single producer (flag), and the consumer is done with
+            // this slot (it is behind `tail`)
+            unsafe { *slot.get() = CommitRecord::new(seq, key, kind, word) };
+            self.head.store(head.wrapping_add(1), Ordering::Release);
+        } else {
+            self.dropped.fetch_add(1, Ordering::Relaxed);
+        }
+        self.producing.store(false, Ordering::Release);
+        stored
+    }
+
+    /// Move up to `out.len()` records into `out`, oldest first; returns the
+    /// count (0 while another thread is draining)
+    pub fn drain(&self, out: &mut [CommitRecord]) -> usize {
+        if self.consuming.swap(true, Ordering::Acquire) {
+            return 0;
+        }
+        let tail = self.tail.load(Ordering::Relaxed);
+        let head = self.head.load(Ordering::Acquire);
+        let n = (head.wrapping_sub(tail) as usize).min(out.len());
+        for (i, record) in out[..n].iter_mut().enumerate() {
+            let slot = &self.slots[tail.wrapping_add(i as u32) as usize % COMMIT_RING_CAPACITY];
+            // SAFETY: single consumer (flag), and the producer published
+            // this slot (it is before `head`)
+            *record = unsafe { *slot.get() };
+        }
+        self.tail
+            .store(tail.wrapping_add(n as u32), Ordering::Release);
+        self.consuming.store(false, Ordering::Release);
+        n
+    }
+
+    /// Records waiting to be drained
+    pub fn len(&self) -> usize {
+        let head = self.head.load(Ordering::Acquire);
+        head.wrapping_sub(self.tail.load(Ordering::Acquire)) as usize
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.len() == 0
+    }
+
+    /// Records dropped because the ring was full
+    pub fn dropped(&self) -> u32 {
+        self.dropped.load(Ordering::Relaxed)
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn chars(s: &str) -> Vec<char> {
+        s.chars().collect()
+    }
+
+    #[test]
+    fn test_record_text() {
+        let r = CommitRecord::new(3, 49, CommitKind::Vietnamese, &chars("việt"));
+        assert_eq!(
+            (r.seq, r.key, r.kind()),
+            (3, 49, Some(CommitKind::Vietnamese))
+        );
+        assert_eq!(r.text(), "việt");
+        assert_eq!(std::mem::size_of::<CommitRecord>(), 64);
+
+        // Truncated at a character boundary (ệ is 3 bytes)
+        let long = chars(&"ệ".repeat(20));
+        let r = CommitRecord::new(0, 0, CommitKind::English, &long);
+        assert_eq!(r.text(), "ệ".repeat(18));
+    }
+
+    #[test]
+    fn test_push_drain_and_overflow() {
+        let ring = Box::new(CommitRing::new());
+        let mut out = [CommitRecord::EMPTY; 8];
+        assert_eq!(ring.drain(&mut out), 0);
+
+        for _ in 0..COMMIT_RING_CAPACITY + 2 {
+            ring.push(49, CommitKind::Vietnamese, &chars("a"));
+        }
+        assert_eq!(ring.len(), COMMIT_RING_CAPACITY);
+        assert_eq!(ring.dropped(), 2);
+
+        assert_eq!(ring.drain(&mut out), 8);
+        assert_eq!(out[7].seq, 7);
+        let mut rest = vec![CommitRecord::EMPTY; COMMIT_RING_CAPACITY];
+        assert_eq!(ring.drain(&mut rest), COMMIT_RING_CAPACITY - 8);
+        assert!(ring.is_empty());
+
+        // Space again: numbering continues past the dropped records
+        assert!(ring.push(49, CommitKind::Shortcut, &chars("vn")));
+        assert_eq!(ring.drain(&mut out), 1);
+        assert_eq!(out[0].seq, COMMIT_RING_CAPACITY as u32 + 2);
+        assert_eq!(out[0].kind(), Some(CommitKind::Shortcut));
+    }
+
+    #[test]
+    fn test_concurrent_consumer() {
+        static RING: CommitRing = CommitRing::new();
+        static DONE: AtomicBool = AtomicBool::new(false);
+        const WORDS: u32 = 20_000;
+        let consumer = std::thread::spawn(|| {
+            let mut out = [CommitRecord::EMPTY; 32];
+            let (mut next, mut seen) = (0u32, 0u32);
+            loop {
+                let done = DONE.load(Ordering::Acquire);
+                let n = RING.drain(&mut out);
+                for r in &out[..n] {
+                    assert!(r.seq >= next, "records out of order");
+                    assert_eq!(r.text(), if r.seq % 2 == 0 { "một" } else { "hai" });
+                    next = r.seq + 1;
+                    seen += 1;
+                }
+                if done && n == 0 {
+                    return seen;
+                }
+            }
+        });
+        let words = [chars("một"), chars("hai")];
+        for i in 0..WORDS {
+            RING.push(49, CommitKind::Vietnamese, &words[i as usize % 2]);
+        }
+        DONE.store(true, Ordering::Release);
+        let seen = consumer.join().unwrap();
+        assert_eq!(seen + RING.dropped(), WORDS);
+    }
+}
@@ -0,0 +1,375 @@
+//! Edit Planner - cost-aware edits for the platform's injection method
+//!
+//! Platforms inject edits in very different ways: synthetic backspaces and
+//! typing, Shift+Left selection, autocomplete-safe sequences or the
+//! accessibility API. Each has its own price per backspace, per typed
+//! character and per edit. Once the platform registers those prices
+//! (`EditCosts`), the engine plans each edit against the tracked on-screen
+//! word and emits the cheapest of:
+//! - Backspace: delete back to the first changed character and type the
+//!   rest (`Action::Send`)
+//! - Replace range: replace only the changed middle and keep the unchanged
+//!   characters on both sides (`Action::ReplaceRange`, with `keep`
+//!   characters left after the range)
+//! - Deferred commit: let the word's keys pass through as typed, then fix
+//!   the whole word with one edit at its boundary
+//!
+//! Deferring pays off when a word needs several edits and each edit has a
+//! high fixed price. The planner cannot see the rest of the word, so it
+//! decides from recent words: on average, how many edits and keys followed
+//! a word's first edit.
+
+use crate::data::keys;
+use crate::engine::{Action, Preedit, Result};
+use crate::input::layout;
+
+/// Price that marks an operation as unavailable (`per_replace`,
+/// `per_deferred_key`)
+pub const COST_UNSUPPORTED: u32 = u32::MAX;
+
+/// Longest on-screen word that is still deferred (the settling edit must
+/// fit a `Result`)
+pub const MAX_DEFERRED_LEN: usize = 128;
+
+/// Initial averages, in sixteenths: half an edit and two keys after the
+/// first edit of a word (typical Telex typing)
+const INITIAL_EDITS: u32 = 8;
+const INITIAL_KEYS: u32 = 32;
+
+/// Prices of the platform's injection method, in any unit (e.g. µs)
+#[repr(C)]
+#[derive(Clone, Copy, Debug, PartialEq, Eq)]
+pub struct EditCosts {
+    /// Fixed price of one injected edit (event round trip, AX call)
+    pub per_edit: u32,
+    /// One synthetic backspace
+    pub per_backspace: u32,
+    /// One inserted character
+    pub per_char: u32,
+    /// Selecting and replacing a range, on top of `per_edit`
+    /// (`COST_UNSUPPORTED`: the method cannot replace a range)
+    pub per_replace: u32,
+    /// Each key shown as typed while the word's edit is deferred
+    /// (`COST_UNSUPPORTED`: never defer)
+    pub per_deferred_key: u32,
+}
+
+impl EditCosts {
+    /// Prices of the default "N backspaces + text" injection
+    pub const BACKSPACE: Self = Self {
+        per_edit: 1,
+        per_backspace: 1,
+        per_char: 1,
+        per_replace: COST_UNSUPPORTED,
+        per_deferred_key: COST_UNSUPPORTED,
+    };
+
+    /// Price of one edit as emitted (`Result` action and counts)
+    ///
+    /// Deferral penalties are not included: a passed-through key has no
+    /// injection cost of its own.
+    pub fn edit_cost(&self, action: u8, backspace: usize, count: usize) -> u64 {
+        if backspace == 0 && count == 0 {
+            return 0;
+        }
+        let chars = count as u64 * self.per_char as u64;
+        if action == Action::ReplaceRange as u8 {
+            self.per_edit as u64 + self.per_replace as u64 + chars
+        } else {
+            self.per_edit as u64 + backspace as u64 * self.per_backspace as u64 + chars
+        }
+    }
+
+    /// The same prices without range replacement, for callers that only
+    /// apply backspaces + text
+    #[inline]
+    pub fn without_ranges(self) -> Self {
+        Self {
+            per_replace: COST_UNSUPPORTED,
+            ..self
+        }
+    }
+
+    /// The cheapest edit turning `shown` into `target`, as a `Result`
+    /// (`Send` or `ReplaceRange`)
+    pub fn edit(&self, shown: &[char], target: &[char]) -> Result {
+        let plan = self.plan(shown, target);
+        let end = target.len() - plan.suffix;
+        let range = (shown.len() - plan.prefix - plan.suffix).min(u8::MAX as usize) as u8;
+        match plan.kind {
+            PlanKind::Backspace => Result::send(range, &target[plan.prefix..]),
+            PlanKind::Replace => {
+                Result::replace_range(range, plan.suffix as u8, &target[plan.prefix..end])
+            }
+        }
+    }
+
+    /// Cheapest edit turning `shown` into `target`
+    ///
+    /// A range replacement is only chosen when it is strictly cheaper, as
+    /// backspaces work everywhere.
+    pub fn plan(&self, shown: &[char], target: &[char]) -> EditPlan {
+        let prefix = shown.iter().zip(target).take_while(|(a, b)| a == b).count();
+        let backspace = EditPlan {
+            kind: PlanKind::Backspace,
+            prefix,
+            suffix: 0,
+            cost: self.edit_cost(0, shown.len() - prefix, target.len() - prefix),
+        };
+        if self.per_replace == COST_UNSUPPORTED || backspace.cost == 0 {
+            return backspace;
+        }
+        let suffix = shown[prefix..]
+            .iter()
+            .rev()
+            .zip(target[prefix..].iter().rev())
+            .take_while(|(a, b)| a == b)
+            .count();
+        let inserted = target.len() - prefix - suffix;
+        let replace = EditPlan {
+            kind: PlanKind::Replace,
+            prefix,
+            suffix,
+            cost: self.edit_cost(
+                Action::ReplaceRange as u8,
+                shown.len() - prefix - suffix,
+                inserted,
+            ),
+        };
+        if replace.cost < backspace.cost {
+            replace
+        } else {
+            backspace
+        }
+    }
+}
+
+/// How an edit is injected
+#[derive(Clone, Copy, Debug, PartialEq, Eq)]
+pub enum PlanKind {
+    /// Backspaces from the caret, then the new text
+    Backspace,
+    /// Replace a range before the caret, keeping `suffix` characters
+    Replace,
+}
+
+/// One planned edit of the on-screen word
+#[derive(Clone, Copy, Debug, PartialEq, Eq)]
+pub struct EditPlan {
+    pub kind: PlanKind,
+    /// Leading characters left on screen
+    pub prefix: usize,
+    /// Trailing characters left on screen (`Replace` only)
+    pub suffix: usize,
+    /// Price under the costs it was planned with
+    pub cost: u64,
+}
+
+/// Planner state for the word being typed
+pub struct EditPlanner {
+    costs: EditCosts,
+    /// The word as the engine sees it; engine edits are relative to this.
+    /// Same as the tracked screen unless the word is deferred
+    pub target: Preedit,
+    deferred: bool,
+    /// Current word: engine edits, and keys since its first edit
+    word_edits: u32,
+    word_keys: u32,
+    /// Moving averages over words with an edit, in sixteenths: edits and
+    /// keys that followed the first edit
+    avg_edits: u32,
+    avg_keys: u32,
+}
+
+impl EditPlanner {
+    pub fn new(costs: EditCosts) -> Self {
+        Self {
+            costs,
+            target: Preedit::new(),
+            deferred: false,
+            word_edits: 0,
+            word_keys: 0,
+            avg_edits: INITIAL_EDITS,
+            avg_keys: INITIAL_KEYS,
+        }
+    }
+
+    #[inline]
+    pub fn costs(&self) -> &EditCosts {
+        &self.costs
+    }
+
+    /// Switch to another injection method (the averages are kept)
+    pub fn set_costs(&mut self, costs: EditCosts) {
+        self.costs = costs;
+        self.reset();
+    }
+
+    /// Whether the screen shows the word as typed, pending one fix-up edit
+    #[inline]
+    pub fn is_deferred(&self) -> bool {
+        self.deferred
+    }
+
+    #[inline]
+    pub fn set_deferred(&mut self, deferred: bool) {
+        self.deferred = deferred;
+    }
+
+    /// Count a key of the current word (`edit`: the engine edited the word)
+    #[inline]
+    pub fn record_key(&mut self, edit: bool) {
+        if self.word_edits > 0 {
+            self.word_keys += 1;
+        }
+        if edit {
+            self.word_edits += 1;
+        }
+    }
+
+    /// Whether deferring the current edit is expected to cost less than
+    /// injecting it: the fixed price of the edits the rest of the word
+    /// usually needs, against the penalty and what each key left on screen
+    /// as typed adds to the settling edit (measured on the corpora: about
+    /// two backspaces and one character)
+    pub fn should_defer(&self) -> bool {
+        let c = &self.costs;
+        if c.per_deferred_key == COST_UNSUPPORTED || c.per_edit == 0 {
+            return false;
+        }
+        // The current edit is already counted in `word_edits`
+        let seen = self.word_edits.saturating_sub(1).saturating_mul(16);
+        let edits = self.avg_edits.saturating_sub(seen);
+        let keys = self
+            .avg_keys
+            .saturating_sub(self.word_keys.saturating_mul(16))
+            .max(16);
+        let per_key = c.per_deferred_key as u64 + 2 * c.per_backspace as u64 + c.per_char as u64;
+        c.per_edit as u64 * edits as u64 > per_key * keys as u64
+    }
+
+    /// Word boundary: update the averages and start over
+    pub fn end_word(&mut self) {
+        if self.word_edits > 0 {
+            let edits = (self.word_edits - 1).min(u16::MAX as u32);
+            let keys = self.word_keys.min(u16::MAX as u32);
+            self.avg_edits = self.avg_edits - self.avg_edits.div_ceil(8) + edits * 2;
+            self.avg_keys = self.avg_keys - self.avg_keys.div_ceil(8) + keys * 2;
+        }
+        self.reset();
+    }
+
+    /// Forget the current word (the caret moved elsewhere)
+    pub fn reset(&mut self) {
+        self.word_edits = 0;
+        self.word_keys = 0;
+        self.deferred = false;
+        self.target.clear();
+    }
+}
+
+/// Text the application types for a key it receives (None for backspace
+/// and keys that type nothing)
+#[inline]
+pub fn typed_char(key: u16, caps: bool, ctrl: bool, shift: bool) -> Option<char> {
+    if ctrl {
+        return None;
+    }
+    if key == keys::SPACE {
+        return Some(' ');
+    }
+    layout::key_char(key, caps, shift)
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn chars(s: &str) -> Vec<char> {
+        s.chars().collect()
+    }
+
+    #[test]
+    fn test_backspace_plan_keeps_prefix() {
+        let c = EditCosts::BACKSPACE;
+        let p = c.plan(&chars("tiêng"), &chars("tiếng"));
+        assert_eq!((p.kind, p.prefix, p.suffix), (PlanKind::Backspace, 2, 0));
+        // 3 backspaces + "ếng"
+        assert_eq!(p.cost, 1 + 3 + 3);
+        // Nothing to change costs nothing
+        assert_eq!(c.plan(&chars("a"), &chars("a")).cost, 0);
+    }
+
+    #[test]
+    fn test_replace_plan_when_cheaper() {
+        let mut c = EditCosts::BACKSPACE;
+        c.per_backspace = 10;
+        c.per_replace = 5;
+        let p = c.plan(&chars("tiêng"), &chars("tiếng"));
+        assert_eq!((p.kind, p.prefix, p.suffix), (PlanKind::Replace, 2, 2));
+        assert_eq!(p.cost, 1 + 5 + 1);
+        // A pricey range replacement loses to backspaces
+        c.per_backspace = 1;
+        c.per_replace = 100;
+        assert_eq!(
+            c.plan(&chars("tiêng"), &chars("tiếng")).kind,
+            PlanKind::Backspace
+        );
+    }
+
+    #[test]
+    fn test_edit_cost() {
+        let c = EditCosts {
+            per_edit: 100,
+            per_backspace: 3,
+            per_char: 2,
+            per_replace: 7,
+            per_deferred_key: 1,
+        };
+        assert_eq!(c.edit_cost(Action::Send as u8, 2, 3), 100 + 6 + 6);
+        assert_eq!(c.edit_cost(Action::ReplaceRange as u8, 2, 3), 100 + 7 + 6);
+        assert_eq!(c.edit_cost(Action::Send as u8, 0, 0), 0);
+    }
+
+    #[test]
+    fn test_deferral_follows_costs_and_history() {
+        let mut cheap = EditPlanner::new(EditCosts::BACKSPACE);
+        cheap.record_key(true);
+        assert!(!cheap.should_defer());
+
+        let slow = EditCosts {
+            per_edit: 1000,
+            per_backspace: 1,
+            per_char: 1,
+            per_replace: COST_UNSUPPORTED,
+            per_deferred_key: 10,
+        };
+        let mut p = EditPlanner::new(slow);
+        p.record_key(true);
+        assert!(p.should_defer());
+        // Words that never need a second edit make deferring pointless
+        for _ in 0..40 {
+            p.end_word();
+            p.record_key(true);
+            p.record_key(false);
+        }
+        p.end_word();
+        p.record_key(true);
+        assert!(!p.should_defer());
+
+        let mut off = EditPlanner::new(EditCosts {
+            per_deferred_key: COST_UNSUPPORTED,
+            ..slow
+        });
+        off.record_key(true);
+        assert!(!off.should_defer());
+    }
+
+    #[test]
+    fn test_typed_char() {
+        assert_eq!(typed_char(keys::A, false, false, false), Some('a'));
+        assert_eq!(typed_char(keys::SPACE, false, false, false), Some(' '));
+        assert_eq!(typed_char(keys::A, false, true, false), None);
+        assert_eq!(typed_char(keys::DELETE, false, false, false), None);
+    }
+}
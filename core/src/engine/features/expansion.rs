@@ -0,0 +1,142 @@
+//! Long Expansions - wide results and chunked delivery
+//!
+//! `Result` counts are `u8`, so one edit carries at most 255 characters.
+//! Snippet shortcuts (`Shortcut::snippet`) may expand to up to
+//! `MAX_SNIPPET_LEN` characters. On the wide path (`Engine::on_key_wide`)
+//! the matched expansion is written as UTF-32 straight into one exactly
+//! sized allocation and held here, then either handed over whole in a
+//! `WideResult` (the Vec moves, no copy) or read by the platform in
+//! chunks into its own buffer.
+//!
+//! A pending expansion is dropped when the next key is processed.
+
+/// Expansion text pending delivery to the platform
+#[derive(Debug, Default)]
+pub struct Expansion {
+    /// UTF-32 expansion (allocated once per expansion)
+    chars: Vec<u32>,
+    /// Next character to deliver
+    pos: usize,
+    /// Characters to delete before inserting (the trigger)
+    backspace: usize,
+}
+
+impl Expansion {
+    pub fn new() -> Self {
+        Self::default()
+    }
+
+    /// Start delivering `text` after deleting `backspace` characters
+    ///
+    /// `text` is walked twice, to size the buffer exactly and then to fill
+    /// it, so collecting the expansion never reallocates.
+    pub fn start(&mut self, backspace: usize, text: impl Iterator<Item = char> + Clone) {
+        self.chars.clear();
+        self.chars.reserve_exact(text.clone().count());
+        self.chars.extend(text.map(|c| c as u32));
+        self.pos = 0;
+        self.backspace = backspace;
+    }
+
+    /// Start delivering UTF-32 `chars` (taken over, no copy) after
+    /// deleting `backspace` characters
+    pub fn start_chars(&mut self, backspace: usize, chars: Vec<u32>) {
+        self.chars = chars;
+        self.pos = 0;
+        self.backspace = backspace;
+    }
+
+    /// Backspace count of the pending expansion
+    #[inline]
+    pub fn backspace(&self) -> usize {
+        self.backspace
+    }
+
+    /// Change the backspace count (the trigger is shown differently)
+    #[inline]
+    pub fn set_backspace(&mut self, backspace: usize) {
+        self.backspace = backspace;
+    }
+
+    /// Characters not yet delivered
+    #[inline]
+    pub fn remaining(&self) -> usize {
+        self.chars.len() - self.pos
+    }
+
+    #[inline]
+    pub fn is_empty(&self) -> bool {
+        self.remaining() == 0
+    }
+
+    /// Hand over all undelivered characters (no copy if none were read)
+    pub fn take(&mut self) -> Vec<u32> {
+        let mut chars = std::mem::take(&mut self.chars);
+        chars.drain(..self.pos);
+        self.pos = 0;
+        chars
+    }
+
+    /// Copy the next chunk into `out`, returning the number of characters
+    pub fn read(&mut self, out: &mut [u32]) -> usize {
+        let n = self.remaining().min(out.len());
+        out[..n].copy_from_slice(&self.chars[self.pos..self.pos + n]);
+        self.pos += n;
+        n
+    }
+
+    /// Drop the pending expansion (releases its memory)
+    pub fn clear(&mut self) {
+        self.chars = Vec::new();
+        self.pos = 0;
+        self.backspace = 0;
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_take_whole() {
+        let mut e = Expansion::new();
+        e.start(3, "Việt Nam".chars());
+        assert_eq!(e.backspace(), 3);
+        assert_eq!(e.remaining(), 8);
+        let chars = e.take();
+        assert_eq!(chars.len(), 8);
+        // Sized exactly: one allocation, no growth
+        assert_eq!(chars.capacity(), 8);
+        assert_eq!(chars[1], 'i' as u32);
+        assert!(e.is_empty());
+    }
+
+    #[test]
+    fn test_read_chunks() {
+        let text = "ậ".repeat(1000);
+        let mut e = Expansion::new();
+        e.start(1, text.chars());
+        let mut out = [0u32; 256];
+        let mut total = 0;
+        loop {
+            let n = e.read(&mut out);
+            if n == 0 {
+                break;
+            }
+            assert!(out[..n].iter().all(|&c| c == 'ậ' as u32));
+            total += n;
+        }
+        assert_eq!(total, 1000);
+        assert!(e.is_empty());
+    }
+
+    #[test]
+    fn test_take_after_read() {
+        let mut e = Expansion::new();
+        e.start(0, "abcdef".chars());
+        let mut out = [0u32; 2];
+        e.read(&mut out);
+        let rest = e.take();
+        assert_eq!(rest, ['c', 'd', 'e', 'f'].map(|c| c as u32));
+    }
+}
@@ -1,10 +1,31 @@
 //! Feature modules for Vietnamese IME
 //!
 //! User-defined shortcuts and abbreviations.
+//! Long snippet expansions (wide results, chunked delivery).
 //! Multi-encoding output support.
+//! Direct UTF-16/UTF-8 (NFC/NFD) output into caller buffers.
+//! Next-word prediction from a quantized n-gram model.
+//! Emoji/symbol shortcode completion.
+//! Committed-word events for consumers on other threads.
+//! Burst mode: queued keys and one coalesced edit for machine-speed input.
+//! Edit planner: cheapest edit for the platform's injection costs.
 
+pub mod burst;
+pub mod commits;
+pub mod edit_plan;
 pub mod encoding;
+pub mod expansion;
+pub mod output;
+pub mod prediction;
+pub mod shortcode;
 pub mod shortcut;
 
+pub use burst::{Burst, BurstKey};
+pub use commits::{CommitKind, CommitRecord, CommitRing};
+pub use edit_plan::{EditCosts, EditPlanner};
 pub use encoding::{EncodingConverter, OutputEncoding};
+pub use expansion::Expansion;
+pub use output::NormalizationForm;
+pub use prediction::{NgramModel, Prediction};
+pub use shortcode::{ShortcodeSession, ShortcodeTable};
 pub use shortcut::Shortcut;
@@ -0,0 +1,272 @@
+//! Direct Output Rendering - UTF-16/UTF-8/UTF-32 into caller buffers
+//!
+//! `Result.chars` is UTF-32. Platforms that need UTF-16 (`SendInput`,
+//! `NSString`) or UTF-8 would otherwise convert and allocate on every key.
+//! These encoders write an edit straight into a caller-provided buffer,
+//! in precomposed (NFC) or decomposed (NFD) form. The UTF-32 variant lets
+//! callers (e.g. `goxviet.hpp`) reuse their own result storage.
+//!
+//! ## NFD
+//!
+//! Vietnamese letters decompose into a base letter plus up to two
+//! combining marks, in canonical order (by combining class):
+//!
+//! ```text
+//! horn U+031B (216) < dot below U+0323 (220) < circumflex/breve/tone (230)
+//! ậ → a U+0323 U+0302     ợ → o U+031B U+0323     ế → e U+0302 U+0301
+//! ```
+//!
+//! `đ`/`Đ` have no decomposition and are emitted as is.
+
+use crate::data::chars::{mark, parse_char, tone};
+use crate::data::keys;
+use crate::utils;
+
+/// Maximum UTF-16 units for one edit (255 chars × 3 code points in NFD)
+pub const MAX_UTF16_LEN: usize = 768;
+/// Maximum UTF-8 bytes for one edit (255 chars × 5 bytes in NFD)
+pub const MAX_UTF8_LEN: usize = 1280;
+/// Maximum UTF-32 code points for one edit (255 chars × 3 in NFD)
+pub const MAX_UTF32_LEN: usize = 768;
+
+/// Unicode normalization form of emitted text
+#[repr(u8)]
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Default)]
+pub enum NormalizationForm {
+    /// Precomposed (ế = U+1EBF), default
+    #[default]
+    Nfc = 0,
+    /// Decomposed (ế = e U+0302 U+0301), for apps that prefer combining marks
+    Nfd = 1,
+}
+
+impl NormalizationForm {
+    /// Convert from integer (for FFI)
+    pub fn from_u8(value: u8) -> Option<Self> {
+        match value {
+            0 => Some(Self::Nfc),
+            1 => Some(Self::Nfd),
+            _ => None,
+        }
+    }
+}
+
+const COMBINING_HORN: char = '\u{031B}';
+const COMBINING_DOT_BELOW: char = '\u{0323}';
+const COMBINING_CIRCUMFLEX: char = '\u{0302}';
+const COMBINING_BREVE: char = '\u{0306}';
+
+/// Combining mark for a tone mark (except nặng, which sorts earlier)
+const fn combining_mark(m: u8) -> Option<char> {
+    match m {
+        mark::SAC => Some('\u{0301}'),
+        mark::HUYEN => Some('\u{0300}'),
+        mark::HOI => Some('\u{0309}'),
+        mark::NGA => Some('\u{0303}'),
+        _ => None,
+    }
+}
+
+/// Decompose one character (NFD) into `out`, returning the count
+///
+/// Characters without a Vietnamese decomposition are copied unchanged.
+#[inline]
+pub fn decompose(c: char, out: &mut [char; 3]) -> usize {
+    let p = match parse_char(c) {
+        Some(p) if !p.stroke && (p.tone != tone::NONE || p.mark != mark::NONE) => p,
+        _ => {
+            out[0] = c;
+            return 1;
+        }
+    };
+    let Some(base) = utils::key_to_char(p.key, p.caps) else {
+        out[0] = c;
+        return 1;
+    };
+
+    out[0] = base;
+    let mut n = 1;
+    let horn = p.tone == tone::HORN && p.key != keys::A;
+    if horn {
+        out[n] = COMBINING_HORN;
+        n += 1;
+    }
+    if p.mark == mark::NANG {
+        out[n] = COMBINING_DOT_BELOW;
+        n += 1;
+    }
+    if p.tone == tone::CIRCUMFLEX {
+        out[n] = COMBINING_CIRCUMFLEX;
+        n += 1;
+    } else if p.tone == tone::HORN && !horn {
+        out[n] = COMBINING_BREVE;
+        n += 1;
+    }
+    if let Some(m) = combining_mark(p.mark) {
+        out[n] = m;
+        n += 1;
+    }
+    n
+}
+
+/// Visit the code points of `chars` in the requested form
+#[inline]
+fn for_each_char(chars: &[u32], form: NormalizationForm, mut f: impl FnMut(char) -> bool) -> bool {
+    let mut parts = ['\0'; 3];
+    for &cp in chars {
+        let Some(c) = char::from_u32(cp) else {
+            continue;
+        };
+        match form {
+            NormalizationForm::Nfc => {
+                if !f(c) {
+                    return false;
+                }
+            }
+            NormalizationForm::Nfd => {
+                let n = decompose(c, &mut parts);
+                if !parts[..n].iter().all(|&p| f(p)) {
+                    return false;
+                }
+            }
+        }
+    }
+    true
+}
+
+/// Encode UTF-32 code points as UTF-16 into `out`
+///
+/// Returns the number of units written, or None if `out` is too small
+/// (nothing meaningful is left in `out` in that case).
+pub fn encode_utf16(chars: &[u32], form: NormalizationForm, out: &mut [u16]) -> Option<usize> {
+    let mut n = 0;
+    let fits = for_each_char(chars, form, |c| {
+        if n + c.len_utf16() > out.len() {
+            return false;
+        }
+        n += c.encode_utf16(&mut out[n..]).len();
+        true
+    });
+    fits.then_some(n)
+}
+
+/// Encode UTF-32 code points as UTF-8 into `out`
+///
+/// Returns the number of bytes written, or None if `out` is too small.
+pub fn encode_utf8(chars: &[u32], form: NormalizationForm, out: &mut [u8]) -> Option<usize> {
+    let mut n = 0;
+    let fits = for_each_char(chars, form, |c| {
+        if n + c.len_utf8() > out.len() {
+            return false;
+        }
+        n += c.encode_utf8(&mut out[n..]).len();
+        true
+    });
+    fits.then_some(n)
+}
+
+/// Copy UTF-32 code points into `out`, decomposing for NFD
+///
+/// Returns the number of code points written, or None if `out` is too small.
+pub fn encode_utf32(chars: &[u32], form: NormalizationForm, out: &mut [u32]) -> Option<usize> {
+    if form == NormalizationForm::Nfc {
+        let dst = out.get_mut(..chars.len())?;
+        dst.copy_from_slice(chars);
+        return Some(chars.len());
+    }
+    let mut n = 0;
+    let fits = for_each_char(chars, form, |c| {
+        let Some(slot) = out.get_mut(n) else {
+            return false;
+        };
+        *slot = c as u32;
+        n += 1;
+        true
+    });
+    fits.then_some(n)
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn utf32(s: &str) -> Vec<u32> {
+        s.chars().map(|c| c as u32).collect()
+    }
+
+    fn nfd(s: &str) -> String {
+        let mut out = [0u8; 64];
+        let n = encode_utf8(&utf32(s), NormalizationForm::Nfd, &mut out).unwrap();
+        String::from_utf8(out[..n].to_vec()).unwrap()
+    }
+
+    #[test]
+    fn test_decompose_canonical_order() {
+        assert_eq!(nfd("ậ"), "a\u{0323}\u{0302}");
+        assert_eq!(nfd("ợ"), "o\u{031B}\u{0323}");
+        assert_eq!(nfd("ế"), "e\u{0302}\u{0301}");
+        assert_eq!(nfd("ằ"), "a\u{0306}\u{0300}");
+        assert_eq!(nfd("Ữ"), "U\u{031B}\u{0303}");
+        assert_eq!(nfd("ă"), "a\u{0306}");
+        assert_eq!(nfd("ạ"), "a\u{0323}");
+        assert_eq!(nfd("đ"), "đ");
+        assert_eq!(nfd("x😄"), "x😄");
+    }
+
+    #[test]
+    fn test_utf16_nfc_matches_std() {
+        let text = "Tiếng Việt có dấu 😄";
+        let mut out = [0u16; 64];
+        let n = encode_utf16(&utf32(text), NormalizationForm::Nfc, &mut out).unwrap();
+        let expected: Vec<u16> = text.encode_utf16().collect();
+        assert_eq!(&out[..n], &expected[..]);
+    }
+
+    #[test]
+    fn test_utf32() {
+        let mut out = [0u32; 8];
+        assert_eq!(
+            encode_utf32(&utf32("việt"), NormalizationForm::Nfc, &mut out),
+            Some(4)
+        );
+        assert_eq!(&out[..4], &utf32("việt")[..]);
+        assert_eq!(
+            encode_utf32(&utf32("việt"), NormalizationForm::Nfd, &mut out),
+            Some(6)
+        );
+        assert_eq!(&out[..6], &utf32("vie\u{0323}\u{0302}t")[..]);
+        assert_eq!(
+            encode_utf32(&utf32("việt"), NormalizationForm::Nfd, &mut out[..5]),
+            None
+        );
+    }
+
+    #[test]
+    fn test_too_small() {
+        let mut out = [0u16; 2];
+        assert_eq!(
+            encode_utf16(&utf32("abc"), NormalizationForm::Nfc, &mut out),
+            None
+        );
+        let mut out = [0u8; 3];
+        assert_eq!(
+            encode_utf8(&utf32("ế"), NormalizationForm::Nfd, &mut out),
+            None
+        );
+        assert_eq!(
+            encode_utf8(&utf32("ế"), NormalizationForm::Nfc, &mut out),
+            Some(3)
+        );
+    }
+
+    #[test]
+    fn test_max_lengths_cover_worst_case() {
+        let worst = vec!['ậ' as u32; 255];
+        let mut out16 = [0u16; MAX_UTF16_LEN];
+        let mut out8 = [0u8; MAX_UTF8_LEN];
+        let mut out32 = [0u32; MAX_UTF32_LEN];
+        assert!(encode_utf16(&worst, NormalizationForm::Nfd, &mut out16).is_some());
+        assert!(encode_utf32(&worst, NormalizationForm::Nfd, &mut out32).is_some());
+        assert!(encode_utf8(&worst, NormalizationForm::Nfd, &mut out8).is_some());
+    }
+}
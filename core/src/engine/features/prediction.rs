@@ -0,0 +1,691 @@
+//! Next-Word Prediction - Quantized n-gram model
+//!
+//! Predicts the next word from the words the user has just committed
+//! (the SPACE path that pushes to `WordHistory`). The model is a bigram +
+//! trigram table stored in a compact, read-in-place binary layout so it can
+//! be embedded with `include_bytes!`, read from disk, or mapped by the
+//! platform layer without any parsing step.
+//!
+//! # Binary Layout (little endian, all sections 4-byte aligned)
+//!
+//! ```text
+//! ┌──────────────────────────────────────────────────────────────┐
+//! │ header (32 bytes)                                            │
+//! │   magic "GXNG" | version u16 | flags u16                     │
+//! │   vocab_count u32 | bigram_count u32                         │
+//! │   trigram_ctx_count u32 | trigram_count u32                  │
+//! │   vocab_blob_len u32 | reserved u32                          │
+//! │ vocab_offsets  [u32; vocab_count + 1]   (sorted UTF-8 words) │
+//! │ vocab_blob     [u8; vocab_blob_len]     (padded to 4)        │
+//! │ bigram_rows    [u32; vocab_count + 1]   (CSR row offsets)    │
+//! │ bigrams        [u32; bigram_count]      (id:24 | cost:8)     │
+//! │ trigram_ctx    [(w1 u32, w2 u32, start u32); ctx_count]      │
+//! │ trigrams       [u32; trigram_count]     (id:24 | cost:8)     │
+//! └──────────────────────────────────────────────────────────────┘
+//! ```
+//!
+//! Each successor is packed into a single `u32`: a 24-bit vocabulary ID and
+//! an 8-bit quantized cost (`-log2(p) * 16`, lower is more likely). Rows are
+//! sorted by cost so the best candidates are always at the front.
+//!
+//! # Performance
+//!
+//! - Word → ID: binary search over the sorted vocabulary, once per commit
+//! - Prediction: one CSR row read (bigram) + one binary search (trigram)
+//! - No allocation on the lookup path; callers provide the output slice
+
+use std::borrow::Cow;
+use std::collections::HashMap;
+
+/// File magic for the n-gram model format
+pub const MODEL_MAGIC: [u8; 4] = *b"GXNG";
+
+/// Current model format version
+pub const MODEL_VERSION: u16 = 1;
+
+/// Size of the fixed header in bytes
+const HEADER_LEN: usize = 32;
+
+/// Maximum vocabulary size addressable by the 24-bit packed IDs
+pub const MAX_VOCAB: usize = (1 << 24) - 1;
+
+/// Sentinel for "no word in this context slot"
+pub const NO_WORD: u32 = u32::MAX;
+
+/// Cost penalty added to bigram candidates when backing off from a trigram
+const BACKOFF_PENALTY: u16 = 24;
+
+/// Quantization scale: cost = -log2(p) * QUANT_SCALE
+const QUANT_SCALE: f64 = 16.0;
+
+/// A single predicted word
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Default)]
+pub struct Prediction {
+    /// Vocabulary ID (resolve with `NgramModel::word`)
+    pub word_id: u32,
+    /// Quantized cost (lower is more likely)
+    pub cost: u16,
+}
+
+// ============================================================
+// Model (read side)
+// ============================================================
+
+/// Read-only n-gram model backed by a byte slice in the GXNG layout
+///
+/// The model never copies or re-parses its tables; all lookups read
+/// directly from `data`, so a `'static` slice (embedded or mapped) costs
+/// nothing beyond header validation.
+#[derive(Debug, Clone)]
+pub struct NgramModel {
+    data: Cow<'static, [u8]>,
+    vocab_count: usize,
+    bigram_count: usize,
+    trigram_ctx_count: usize,
+    trigram_count: usize,
+    vocab_offsets_at: usize,
+    vocab_blob_at: usize,
+    bigram_rows_at: usize,
+    bigrams_at: usize,
+    trigram_ctx_at: usize,
+    trigrams_at: usize,
+}
+
+#[inline(always)]
+fn read_u32(data: &[u8], at: usize) -> u32 {
+    u32::from_le_bytes([data[at], data[at + 1], data[at + 2], data[at + 3]])
+}
+
+#[inline(always)]
+fn align4(n: usize) -> usize {
+    (n + 3) & !3
+}
+
+#[inline(always)]
+fn unpack(entry: u32) -> (u32, u16) {
+    (entry & 0x00FF_FFFF, (entry >> 24) as u16)
+}
+
+impl NgramModel {
+    /// Validate the header and section bounds of a GXNG model
+    ///
+    /// Returns an error if the magic, version or any section length is
+    /// inconsistent with the slice length.
+    pub fn from_bytes(data: Cow<'static, [u8]>) -> Result<Self, &'static str> {
+        let bytes: &[u8] = &data;
+        if bytes.len() < HEADER_LEN {
+            return Err("Invalid model: truncated header");
+        }
+        if bytes[0..4] != MODEL_MAGIC {
+            return Err("Invalid model: bad magic");
+        }
+        if u16::from_le_bytes([bytes[4], bytes[5]]) != MODEL_VERSION {
+            return Err("Invalid model: unsupported version");
+        }
+
+        let vocab_count = read_u32(bytes, 8) as usize;
+        let bigram_count = read_u32(bytes, 12) as usize;
+        let trigram_ctx_count = read_u32(bytes, 16) as usize;
+        let trigram_count = read_u32(bytes, 20) as usize;
+        let vocab_blob_len = read_u32(bytes, 24) as usize;
+
+        if vocab_count > MAX_VOCAB {
+            return Err("Invalid model: vocabulary too large");
+        }
+
+        // Section offsets (checked arithmetic: sizes come from untrusted input)
+        let vocab_offsets_at = HEADER_LEN;
+        let vocab_blob_at = (vocab_count + 1)
+            .checked_mul(4)
+            .and_then(|n| n.checked_add(vocab_offsets_at))
+            .ok_or("Invalid model: overflow")?;
+        let bigram_rows_at = vocab_blob_at
+            .checked_add(align4(vocab_blob_len))
+            .ok_or("Invalid model: overflow")?;
+        let bigrams_at = (vocab_count + 1)
+            .checked_mul(4)
+            .and_then(|n| n.checked_add(bigram_rows_at))
+            .ok_or("Invalid model: overflow")?;
+        let trigram_ctx_at = bigram_count
+            .checked_mul(4)
+            .and_then(|n| n.checked_add(bigrams_at))
+            .ok_or("Invalid model: overflow")?;
+        let trigrams_at = trigram_ctx_count
+            .checked_mul(12)
+            .and_then(|n| n.checked_add(trigram_ctx_at))
+            .ok_or("Invalid model: overflow")?;
+        let end = trigram_count
+            .checked_mul(4)
+            .and_then(|n| n.checked_add(trigrams_at))
+            .ok_or("Invalid model: overflow")?;
+
+        if end > bytes.len() {
+            return Err("Invalid model: truncated sections");
+        }
+
+        let model = Self {
+            data,
+            vocab_count,
+            bigram_count,
+            trigram_ctx_count,
+            trigram_count,
+            vocab_offsets_at,
+            vocab_blob_at,
+            bigram_rows_at,
+            bigrams_at,
+            trigram_ctx_at,
+            trigrams_at,
+        };
+
+        // Offsets must be monotonic and in range, otherwise lookups could
+        // slice out of bounds. Checked once here so the hot path can't panic.
+        let mut prev = 0u32;
+        for i in 0..=vocab_count {
+            let off = read_u32(&model.data, vocab_offsets_at + i * 4);
+            if off < prev || off as usize > vocab_blob_len {
+                return Err("Invalid model: bad vocabulary offsets");
+            }
+            prev = off;
+        }
+        let mut prev = 0u32;
+        for i in 0..=vocab_count {
+            let off = read_u32(&model.data, bigram_rows_at + i * 4);
+            if off < prev || off as usize > bigram_count {
+                return Err("Invalid model: bad bigram rows");
+            }
+            prev = off;
+        }
+        // Contexts are binary searched: strictly sorted (w1, w2) keys
+        let mut prev = 0u32;
+        let mut prev_key = None;
+        for i in 0..trigram_ctx_count {
+            let at = trigram_ctx_at + i * 12;
+            let (w1, w2) = (read_u32(&model.data, at), read_u32(&model.data, at + 4));
+            let start = read_u32(&model.data, at + 8);
+            if start < prev || start as usize > trigram_count {
+                return Err("Invalid model: bad trigram contexts");
+            }
+            if w1 as usize >= vocab_count || w2 as usize >= vocab_count {
+                return Err("Invalid model: bad trigram contexts");
+            }
+            if prev_key.is_some_and(|k| k >= (w1, w2)) {
+                return Err("Invalid model: trigram contexts not sorted");
+            }
+            prev = start;
+            prev_key = Some((w1, w2));
+        }
+        // Successor IDs are returned to callers as vocabulary IDs
+        for i in 0..bigram_count {
+            if unpack(read_u32(&model.data, bigrams_at + i * 4)).0 as usize >= vocab_count {
+                return Err("Invalid model: bad bigram successor");
+            }
+        }
+        for i in 0..trigram_count {
+            if unpack(read_u32(&model.data, trigrams_at + i * 4)).0 as usize >= vocab_count {
+                return Err("Invalid model: bad trigram successor");
+            }
+        }
+        // The vocabulary is binary searched too: strictly sorted, UTF-8
+        for i in 0..vocab_count {
+            let (s, e) = model.word_span(i);
+            if std::str::from_utf8(&model.data[s..e]).is_err() {
+                return Err("Invalid model: vocabulary is not UTF-8");
+            }
+            if i > 0 {
+                let (ps, pe) = model.word_span(i - 1);
+                if model.data[ps..pe] >= model.data[s..e] {
+                    return Err("Invalid model: vocabulary not sorted");
+                }
+            }
+        }
+
+        Ok(model)
+    }
+
+    /// Load a model from a `'static` slice (e.g. `include_bytes!`)
+    pub fn from_static(data: &'static [u8]) -> Result<Self, &'static str> {
+        Self::from_bytes(Cow::Borrowed(data))
+    }
+
+    /// Number of words in the vocabulary
+    #[inline]
+    pub fn vocab_len(&self) -> usize {
+        self.vocab_count
+    }
+
+    /// Number of stored bigram entries
+    #[inline]
+    pub fn bigram_len(&self) -> usize {
+        self.bigram_count
+    }
+
+    /// Number of stored trigram entries
+    #[inline]
+    pub fn trigram_len(&self) -> usize {
+        self.trigram_count
+    }
+
+    /// Total size of the model in bytes
+    #[inline]
+    pub fn size_bytes(&self) -> usize {
+        self.data.len()
+    }
+
+    #[inline]
+    fn word_span(&self, id: usize) -> (usize, usize) {
+        let s = read_u32(&self.data, self.vocab_offsets_at + id * 4) as usize;
+        let e = read_u32(&self.data, self.vocab_offsets_at + (id + 1) * 4) as usize;
+        (self.vocab_blob_at + s, self.vocab_blob_at + e)
+    }
+
+    /// Get the word for a vocabulary ID
+    #[inline]
+    pub fn word(&self, id: u32) -> Option<&str> {
+        let id = id as usize;
+        if id >= self.vocab_count {
+            return None;
+        }
+        let (s, e) = self.word_span(id);
+        // SAFETY: every vocabulary entry was UTF-8 validated in from_bytes
+        Some(unsafe { std::str::from_utf8_unchecked(&self.data[s..e]) })
+    }
+
+    /// Look up the vocabulary ID of a (lowercase) word
+    ///
+    /// # Performance
+    /// O(log V) string comparisons, no allocation
+    pub fn word_id(&self, word: &str) -> Option<u32> {
+        let target = word.as_bytes();
+        let (mut lo, mut hi) = (0usize, self.vocab_count);
+        while lo < hi {
+            let mid = lo + (hi - lo) / 2;
+            let (s, e) = self.word_span(mid);
+            match self.data[s..e].cmp(target) {
+                std::cmp::Ordering::Equal => return Some(mid as u32),
+                std::cmp::Ordering::Less => lo = mid + 1,
+                std::cmp::Ordering::Greater => hi = mid,
+            }
+        }
+        None
+    }
+
+    /// Packed successor row for a single previous word
+    #[inline]
+    fn bigram_row(&self, prev: u32) -> (usize, usize) {
+        let prev = prev as usize;
+        if prev >= self.vocab_count {
+            return (0, 0);
+        }
+        let s = read_u32(&self.data, self.bigram_rows_at + prev * 4) as usize;
+        let e = read_u32(&self.data, self.bigram_rows_at + (prev + 1) * 4) as usize;
+        (s, e)
+    }
+
+    /// Packed successor row for a two-word context
+    fn trigram_row(&self, w1: u32, w2: u32) -> (usize, usize) {
+        let key = ((w1 as u64) << 32) | w2 as u64;
+        let (mut lo, mut hi) = (0usize, self.trigram_ctx_count);
+        while lo < hi {
+            let mid = lo + (hi - lo) / 2;
+            let at = self.trigram_ctx_at + mid * 12;
+            let k = ((read_u32(&self.data, at) as u64) << 32) | read_u32(&self.data, at + 4) as u64;
+            match k.cmp(&key) {
+                std::cmp::Ordering::Equal => {
+                    let s = read_u32(&self.data, at + 8) as usize;
+                    let e = if mid + 1 < self.trigram_ctx_count {
+                        read_u32(&self.data, at + 12 + 8) as usize
+                    } else {
+                        self.trigram_count
+                    };
+                    return (s, e);
+                }
+                std::cmp::Ordering::Less => lo = mid + 1,
+                std::cmp::Ordering::Greater => hi = mid,
+            }
+        }
+        (0, 0)
+    }
+
+    /// Predict the most likely next words for a context
+    ///
+    /// # Arguments
+    /// * `context` - `[w1, w2]` where `w2` is the most recently committed
+    ///   word; use `NO_WORD` for unknown slots
+    /// * `out` - Caller-provided output, filled best-first
+    ///
+    /// # Returns
+    /// Number of predictions written to `out`
+    ///
+    /// Trigram candidates come first; remaining slots back off to the
+    /// bigram row of `w2` with a fixed cost penalty, skipping duplicates.
+    pub fn predict(&self, context: [u32; 2], out: &mut [Prediction]) -> usize {
+        let [w1, w2] = context;
+        if w2 == NO_WORD || out.is_empty() {
+            return 0;
+        }
+
+        let mut n = 0;
+        if w1 != NO_WORD {
+            let (s, e) = self.trigram_row(w1, w2);
+            for i in s..e {
+                if n == out.len() {
+                    return n;
+                }
+                let (word_id, cost) = unpack(read_u32(&self.data, self.trigrams_at + i * 4));
+                out[n] = Prediction { word_id, cost };
+                n += 1;
+            }
+        }
+
+        let trigram_hits = n;
+        let (s, e) = self.bigram_row(w2);
+        for i in s..e {
+            if n == out.len() {
+                break;
+            }
+            let (word_id, cost) = unpack(read_u32(&self.data, self.bigrams_at + i * 4));
+            if out[..trigram_hits].iter().any(|p| p.word_id == word_id) {
+                continue;
+            }
+            let cost = if trigram_hits > 0 {
+                cost + BACKOFF_PENALTY
+            } else {
+                cost
+            };
+            out[n] = Prediction { word_id, cost };
+            n += 1;
+        }
+        n
+    }
+}
+
+// ============================================================
+// Model Builder
+// ============================================================
+
+/// Builds a GXNG model from tokenized sentences
+///
+/// Words are lowercased. Each context keeps at most `max_successors`
+/// candidates (highest count first), which bounds the model size
+/// independently of the training corpus.
+#[derive(Debug, Default)]
+pub struct NgramModelBuilder {
+    vocab: HashMap<String, u32>,
+    words: Vec<String>,
+    bigrams: HashMap<(u32, u32), u32>,
+    trigrams: HashMap<(u32, u32, u32), u32>,
+}
+
+impl NgramModelBuilder {
+    pub fn new() -> Self {
+        Self::default()
+    }
+
+    fn intern(&mut self, word: &str) -> u32 {
+        let lower = word.to_lowercase();
+        if let Some(&id) = self.vocab.get(&lower) {
+            return id;
+        }
+        let id = self.words.len() as u32;
+        self.vocab.insert(lower.clone(), id);
+        self.words.push(lower);
+        id
+    }
+
+    /// Add one sentence (sequence of words) to the counts
+    pub fn add_sentence<'a, I>(&mut self, words: I)
+    where
+        I: IntoIterator<Item = &'a str>,
+    {
+        let ids: Vec<u32> = words
+            .into_iter()
+            .filter(|w| !w.is_empty())
+            .map(|w| self.intern(w))
+            .collect();
+        for w in ids.windows(2) {
+            *self.bigrams.entry((w[0], w[1])).or_insert(0) += 1;
+        }
+        for w in ids.windows(3) {
+            *self.trigrams.entry((w[0], w[1], w[2])).or_insert(0) += 1;
+        }
+    }
+
+    /// Serialize the model into the GXNG layout
+    ///
+    /// # Arguments
+    /// * `max_successors` - Maximum candidates kept per context (>= 1)
+    pub fn build(&self, max_successors: usize) -> Vec<u8> {
+        let max_successors = max_successors.max(1);
+
+        // Vocabulary sorted by UTF-8 bytes; remap builder IDs to sorted IDs
+        let mut order: Vec<u32> = (0..self.words.len() as u32).collect();
+        order.sort_by(|&a, &b| self.words[a as usize].cmp(&self.words[b as usize]));
+        order.truncate(MAX_VOCAB);
+        let mut remap = vec![NO_WORD; self.words.len()];
+        for (new_id, &old_id) in order.iter().enumerate() {
+            remap[old_id as usize] = new_id as u32;
+        }
+
+        let quantize = |count: u32, total: u32| -> u32 {
+            let p = count as f64 / total.max(1) as f64;
+            ((-p.log2()) * QUANT_SCALE).round().clamp(0.0, 255.0) as u32
+        };
+
+        // Bigram rows (CSR over sorted vocabulary)
+        let mut rows: Vec<Vec<(u32, u32)>> = vec![Vec::new(); order.len()];
+        for (&(a, b), &count) in &self.bigrams {
+            let (a, b) = (remap[a as usize], remap[b as usize]);
+            if a != NO_WORD && b != NO_WORD {
+                rows[a as usize].push((b, count));
+            }
+        }
+
+        // Trigram contexts sorted by (w1, w2)
+        let mut tri: HashMap<(u32, u32), Vec<(u32, u32)>> = HashMap::new();
+        for (&(a, b, c), &count) in &self.trigrams {
+            let (a, b, c) = (remap[a as usize], remap[b as usize], remap[c as usize]);
+            if a != NO_WORD && b != NO_WORD && c != NO_WORD {
+                tri.entry((a, b)).or_default().push((c, count));
+            }
+        }
+        let mut tri_ctx: Vec<((u32, u32), Vec<(u32, u32)>)> = tri.into_iter().collect();
+        tri_ctx.sort_by_key(|(k, _)| *k);
+
+        let finish_row = |row: &mut Vec<(u32, u32)>| -> Vec<u32> {
+            let total: u32 = row.iter().map(|(_, c)| *c).sum();
+            row.sort_by(|a, b| b.1.cmp(&a.1).then(a.0.cmp(&b.0)));
+            row.truncate(max_successors);
+            row.iter()
+                .map(|&(id, count)| (quantize(count, total) << 24) | id)
+                .collect()
+        };
+
+        let mut vocab_blob = Vec::new();
+        let mut vocab_offsets = Vec::with_capacity(order.len() + 1);
+        for &old_id in &order {
+            vocab_offsets.push(vocab_blob.len() as u32);
+            vocab_blob.extend_from_slice(self.words[old_id as usize].as_bytes());
+        }
+        vocab_offsets.push(vocab_blob.len() as u32);
+
+        let mut bigram_rows = Vec::with_capacity(order.len() + 1);
+        let mut bigrams = Vec::new();
+        for row in rows.iter_mut() {
+            bigram_rows.push(bigrams.len() as u32);
+            bigrams.extend(finish_row(row));
+        }
+        bigram_rows.push(bigrams.len() as u32);
+
+        let mut trigram_ctx = Vec::with_capacity(tri_ctx.len());
+        let mut trigrams = Vec::new();
+        for ((a, b), mut row) in tri_ctx {
+            trigram_ctx.push((a, b, trigrams.len() as u32));
+            trigrams.extend(finish_row(&mut row));
+        }
+
+        let mut out = Vec::new();
+        out.extend_from_slice(&MODEL_MAGIC);
+        out.extend_from_slice(&MODEL_VERSION.to_le_bytes());
+        out.extend_from_slice(&0u16.to_le_bytes());
+        for v in [
+            order.len() as u32,
+            bigrams.len() as u32,
+            trigram_ctx.len() as u32,
+            trigrams.len() as u32,
+            vocab_blob.len() as u32,
+            0,
+        ] {
+            out.extend_from_slice(&v.to_le_bytes());
+        }
+        for v in &vocab_offsets {
+            out.extend_from_slice(&v.to_le_bytes());
+        }
+        out.extend_from_slice(&vocab_blob);
+        out.resize(align4(out.len()), 0);
+        for v in bigram_rows.iter().chain(bigrams.iter()) {
+            out.extend_from_slice(&v.to_le_bytes());
+        }
+        for (a, b, start) in &trigram_ctx {
+            out.extend_from_slice(&a.to_le_bytes());
+            out.extend_from_slice(&b.to_le_bytes());
+            out.extend_from_slice(&start.to_le_bytes());
+        }
+        for v in &trigrams {
+            out.extend_from_slice(&v.to_le_bytes());
+        }
+        out
+    }
+}
+
+// ============================================================
+// Tests
+// ============================================================
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn sample_model() -> NgramModel {
+        let mut b = NgramModelBuilder::new();
+        b.add_sentence("xin chào việt nam".split(' '));
+        b.add_sentence("xin chào bạn".split(' '));
+        b.add_sentence("xin chào việt nam".split(' '));
+        b.add_sentence("chào buổi sáng".split(' '));
+        NgramModel::from_bytes(Cow::Owned(b.build(8))).unwrap()
+    }
+
+    fn predicted_words<'a>(model: &'a NgramModel, ctx: [u32; 2]) -> Vec<&'a str> {
+        let mut out = [Prediction::default(); 4];
+        let n = model.predict(ctx, &mut out);
+        out[..n]
+            .iter()
+            .map(|p| model.word(p.word_id).unwrap())
+            .collect()
+    }
+
+    #[test]
+    fn test_roundtrip_vocab() {
+        let m = sample_model();
+        assert_eq!(m.vocab_len(), 7);
+        for w in ["xin", "chào", "việt", "nam", "bạn", "buổi", "sáng"] {
+            let id = m.word_id(w).unwrap();
+            assert_eq!(m.word(id), Some(w));
+        }
+        assert_eq!(m.word_id("không"), None);
+    }
+
+    #[test]
+    fn test_bigram_prediction_ranked() {
+        let m = sample_model();
+        let chao = m.word_id("chào").unwrap();
+        // "chào việt" seen twice, "chào bạn" and "chào buổi" once each
+        assert_eq!(predicted_words(&m, [NO_WORD, chao])[0], "việt");
+    }
+
+    #[test]
+    fn test_trigram_preferred_over_bigram() {
+        let m = sample_model();
+        let xin = m.word_id("xin").unwrap();
+        let chao = m.word_id("chào").unwrap();
+        let words = predicted_words(&m, [xin, chao]);
+        assert_eq!(words[0], "việt");
+        assert!(words.contains(&"bạn"));
+        // Bigram-only successor appears after trigram hits, without duplicates
+        assert_eq!(words.iter().filter(|w| **w == "việt").count(), 1);
+        assert!(words.contains(&"buổi"));
+    }
+
+    #[test]
+    fn test_unknown_context() {
+        let m = sample_model();
+        let mut out = [Prediction::default(); 4];
+        assert_eq!(m.predict([NO_WORD, NO_WORD], &mut out), 0);
+        assert_eq!(m.predict([NO_WORD, 1_000_000], &mut out), 0);
+    }
+
+    #[test]
+    fn test_rejects_corrupt_models() {
+        assert!(NgramModel::from_static(b"").is_err());
+        assert!(NgramModel::from_static(b"XXXX0000000000000000000000000000").is_err());
+
+        let mut b = NgramModelBuilder::new();
+        b.add_sentence(["a", "b"]);
+        let mut bytes = b.build(4);
+        bytes.truncate(bytes.len() - 1);
+        assert!(NgramModel::from_bytes(Cow::Owned(bytes)).is_err());
+    }
+
+    /// Sample model bytes with `patch` applied at a section offset
+    fn corrupt(patch: impl Fn(&NgramModel, &mut Vec<u8>)) -> Result<NgramModel, &'static str> {
+        let m = sample_model();
+        let mut bytes = m.data.to_vec();
+        patch(&m, &mut bytes);
+        NgramModel::from_bytes(Cow::Owned(bytes))
+    }
+
+    fn write_u32(bytes: &mut [u8], at: usize, v: u32) {
+        bytes[at..at + 4].copy_from_slice(&v.to_le_bytes());
+    }
+
+    #[test]
+    fn test_rejects_out_of_range_successors() {
+        let vocab = sample_model().vocab_len() as u32;
+        let bigram = corrupt(|m, b| write_u32(b, m.bigrams_at, vocab));
+        assert_eq!(bigram.unwrap_err(), "Invalid model: bad bigram successor");
+        let trigram = corrupt(|m, b| write_u32(b, m.trigrams_at, (3 << 24) | vocab));
+        assert_eq!(trigram.unwrap_err(), "Invalid model: bad trigram successor");
+        let context = corrupt(|m, b| write_u32(b, m.trigram_ctx_at, vocab));
+        assert_eq!(context.unwrap_err(), "Invalid model: bad trigram contexts");
+    }
+
+    #[test]
+    fn test_rejects_unsorted_tables() {
+        let m = sample_model();
+        assert!(m.trigram_ctx_count >= 2);
+        // Swap the keys of the first two trigram contexts
+        let swapped = corrupt(|m, b| {
+            let (a, c) = (m.trigram_ctx_at, m.trigram_ctx_at + 12);
+            let first: Vec<u8> = b[a..a + 8].to_vec();
+            b.copy_within(c..c + 8, a);
+            b[c..c + 8].copy_from_slice(&first);
+        });
+        assert_eq!(
+            swapped.unwrap_err(),
+            "Invalid model: trigram contexts not sorted"
+        );
+        // Duplicate a context key
+        let duplicate = corrupt(|m, b| {
+            let a = m.trigram_ctx_at;
+            b.copy_within(a..a + 8, a + 12);
+        });
+        assert_eq!(
+            duplicate.unwrap_err(),
+            "Invalid model: trigram contexts not sorted"
+        );
+        // Swap the first letters of the first and last words
+        let (first, _) = m.word_span(0);
+        let (last, _) = m.word_span(m.vocab_len() - 1);
+        let vocab = corrupt(|_, b| b.swap(first, last));
+        assert_eq!(vocab.unwrap_err(), "Invalid model: vocabulary not sorted");
+    }
+}
@@ -0,0 +1,343 @@
+//! Shortcode Dictionary - `:code` completion for emoji and symbols
+//!
+//! Thousands of `code → value` pairs (e.g. `smile` → 😄, `dong` → ₫) shipped
+//! as embedded data (`data/shortcodes.tsv`, generated by
+//! `scripts/generate_shortcodes.py`). Unlike `ShortcutTable`, which expands
+//! a small set of exact triggers, this table supports prefix completion
+//! while the user is typing a code.
+//!
+//! The data is one `code<TAB>value` line per entry, sorted by code bytes.
+//! The table keeps a compact index (8 bytes per entry) into the embedded
+//! text, so every prefix is a contiguous range found by binary search.
+//! `ShortcodeSession` narrows that range incrementally as keys arrive,
+//! searching only inside the previous range.
+
+use std::ops::Range;
+use std::sync::OnceLock;
+
+/// Maximum code length in bytes (longest built-in code is 78)
+pub const MAX_CODE_LEN: usize = 96;
+
+/// Embedded shortcode data (sorted `code<TAB>value` lines)
+#[cfg(feature = "dictionaries")]
+static BUILTIN_DATA: &str = include_str!("data/shortcodes.tsv");
+/// Built without `dictionaries`: tables can still be loaded with `from_tsv`
+#[cfg(not(feature = "dictionaries"))]
+static BUILTIN_DATA: &str = "";
+
+/// Index entry pointing into the shortcode text
+#[derive(Debug, Clone, Copy)]
+struct Entry {
+    /// Byte offset of the line start
+    start: u32,
+    /// Code length in bytes (value starts after the tab)
+    code_len: u8,
+    /// Value length in bytes
+    value_len: u8,
+}
+
+/// Sorted shortcode store with prefix search
+#[derive(Debug)]
+pub struct ShortcodeTable {
+    data: &'static str,
+    entries: Vec<Entry>,
+}
+
+/// Check if a byte is allowed in a shortcode
+#[inline]
+pub fn is_code_byte(b: u8) -> bool {
+    matches!(b, b'a'..=b'z' | b'0'..=b'9' | b'_' | b'+' | b'-')
+}
+
+impl ShortcodeTable {
+    /// Built-in table, indexed once on first use
+    pub fn builtin() -> &'static ShortcodeTable {
+        static TABLE: OnceLock<ShortcodeTable> = OnceLock::new();
+        TABLE.get_or_init(|| {
+            ShortcodeTable::from_tsv(BUILTIN_DATA).expect("built-in shortcode data is valid")
+        })
+    }
+
+    /// Index `code<TAB>value` lines
+    ///
+    /// Codes must be non-empty, use only `[a-z0-9_+-]`, and be strictly
+    /// sorted (no duplicates) so prefix ranges are contiguous.
+    pub fn from_tsv(data: &'static str) -> Result<Self, &'static str> {
+        if data.len() > u32::MAX as usize {
+            return Err("Shortcode data too large");
+        }
+        let mut entries = Vec::with_capacity(data.len() / 20);
+        let mut start = 0usize;
+        let mut prev: &str = "";
+
+        for line in data.split_terminator('\n') {
+            let line_start = start;
+            start += line.len() + 1;
+            if line.is_empty() {
+                continue;
+            }
+
+            let tab = line.find('\t').ok_or("Missing tab separator")?;
+            let (code, value) = (&line[..tab], &line[tab + 1..]);
+            if code.is_empty() || value.is_empty() {
+                return Err("Empty code or value");
+            }
+            if code.len() > MAX_CODE_LEN || value.len() > u8::MAX as usize {
+                return Err("Code or value too long");
+            }
+            if !code.bytes().all(is_code_byte) {
+                return Err("Invalid character in code");
+            }
+            if !entries.is_empty() && code <= prev {
+                return Err("Codes not sorted or duplicated");
+            }
+            prev = code;
+
+            entries.push(Entry {
+                start: line_start as u32,
+                code_len: code.len() as u8,
+                value_len: value.len() as u8,
+            });
+        }
+
+        Ok(Self { data, entries })
+    }
+
+    /// Number of shortcodes
+    pub fn len(&self) -> usize {
+        self.entries.len()
+    }
+
+    /// Check if the table is empty
+    pub fn is_empty(&self) -> bool {
+        self.entries.is_empty()
+    }
+
+    /// Approximate memory used by the index (excluding embedded text)
+    pub fn index_bytes(&self) -> usize {
+        self.entries.len() * std::mem::size_of::<Entry>()
+    }
+
+    /// Code at index `i`
+    pub fn code(&self, i: usize) -> &'static str {
+        let e = self.entries[i];
+        let s = e.start as usize;
+        &self.data[s..s + e.code_len as usize]
+    }
+
+    /// Value at index `i`
+    pub fn value(&self, i: usize) -> &'static str {
+        let e = self.entries[i];
+        let s = e.start as usize + e.code_len as usize + 1;
+        &self.data[s..s + e.value_len as usize]
+    }
+
+    /// Exact lookup
+    pub fn get(&self, code: &str) -> Option<&'static str> {
+        self.find(code).map(|i| self.value(i))
+    }
+
+    /// Index of an exact code
+    pub fn find(&self, code: &str) -> Option<usize> {
+        self.entries
+            .binary_search_by(|e| {
+                let s = e.start as usize;
+                self.data[s..s + e.code_len as usize].cmp(code)
+            })
+            .ok()
+    }
+
+    /// Range of entries whose code starts with `prefix`
+    pub fn prefix_range(&self, prefix: &str) -> Range<usize> {
+        self.narrow(0..self.entries.len(), prefix)
+    }
+
+    /// Narrow `range` to entries starting with `prefix`
+    ///
+    /// `range` must already contain every match (e.g. the range of a
+    /// shorter prefix), so each keystroke only searches the previous result.
+    pub fn narrow(&self, range: Range<usize>, prefix: &str) -> Range<usize> {
+        let p = prefix.as_bytes();
+        let slice = &self.entries[range.clone()];
+        let code = |e: &Entry| {
+            let s = e.start as usize;
+            &self.data.as_bytes()[s..s + e.code_len as usize]
+        };
+        let lo = slice.partition_point(|e| code(e) < p);
+        let hi = lo + slice[lo..].partition_point(|e| code(e).starts_with(p));
+        range.start + lo..range.start + hi
+    }
+
+    /// Pick the best candidates in `range`, shortest code first
+    ///
+    /// Writes entry indices to `out` and returns how many were written.
+    /// An exact match (shortest possible code) always comes first.
+    pub fn best_in(&self, range: Range<usize>, out: &mut [usize]) -> usize {
+        let mut n = 0;
+        for i in range {
+            let len = self.entries[i].code_len;
+            // Insertion into a fixed-size, length-ordered list (stable by index)
+            let mut pos = n;
+            while pos > 0 && self.entries[out[pos - 1]].code_len > len {
+                pos -= 1;
+            }
+            if pos >= out.len() {
+                continue;
+            }
+            let end = if n < out.len() { n } else { out.len() - 1 };
+            let mut j = end;
+            while j > pos {
+                out[j] = out[j - 1];
+                j -= 1;
+            }
+            out[pos] = i;
+            if n < out.len() {
+                n += 1;
+            }
+        }
+        n
+    }
+}
+
+/// Incremental `:code` completion state
+///
+/// Holds the typed code in a fixed buffer and the matching entry range,
+/// so typing and deleting never allocate.
+#[derive(Debug, Clone)]
+pub struct ShortcodeSession {
+    code: [u8; MAX_CODE_LEN],
+    len: usize,
+    range: Range<usize>,
+}
+
+impl ShortcodeSession {
+    /// Start an empty session (matches every entry)
+    pub fn new(table: &ShortcodeTable) -> Self {
+        Self {
+            code: [0; MAX_CODE_LEN],
+            len: 0,
+            range: 0..table.len(),
+        }
+    }
+
+    /// Typed code so far (without the leading `:`)
+    pub fn code(&self) -> &str {
+        // Only code bytes (ASCII) are ever pushed
+        std::str::from_utf8(&self.code[..self.len]).unwrap_or("")
+    }
+
+    /// Number of typed code bytes
+    pub fn len(&self) -> usize {
+        self.len
+    }
+
+    /// Check if no code has been typed yet
+    pub fn is_empty(&self) -> bool {
+        self.len == 0
+    }
+
+    /// Current matching entry range
+    pub fn range(&self) -> Range<usize> {
+        self.range.clone()
+    }
+
+    /// Append a code byte, narrowing the match range
+    ///
+    /// Returns false if the byte is not a code character or the code is full.
+    pub fn push(&mut self, table: &ShortcodeTable, b: u8) -> bool {
+        if !is_code_byte(b) || self.len >= MAX_CODE_LEN {
+            return false;
+        }
+        self.code[self.len] = b;
+        self.len += 1;
+        self.range = table.narrow(self.range.clone(), self.code());
+        true
+    }
+
+    /// Remove the last code byte, widening the match range
+    ///
+    /// Returns false if the code was already empty.
+    pub fn pop(&mut self, table: &ShortcodeTable) -> bool {
+        if self.len == 0 {
+            return false;
+        }
+        self.len -= 1;
+        self.range = table.prefix_range(self.code());
+        true
+    }
+
+    /// Entry index of an exact match for the typed code
+    pub fn exact(&self, table: &ShortcodeTable) -> Option<usize> {
+        if self.len == 0 || self.range.is_empty() {
+            return None;
+        }
+        // An exact match sorts first within its own prefix range
+        let first = self.range.start;
+        (table.code(first).len() == self.len).then_some(first)
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    #[cfg(feature = "dictionaries")]
+    fn test_builtin_sorted_and_large() {
+        let t = ShortcodeTable::builtin();
+        assert!(t.len() > 2000);
+        assert_eq!(t.get("smile"), Some("😄"));
+        assert_eq!(t.get("dong"), Some("₫"));
+        assert_eq!(t.get("+1"), Some("👍"));
+        assert_eq!(t.get("no_such_code"), None);
+    }
+
+    #[test]
+    fn test_prefix_range() {
+        let t = ShortcodeTable::from_tsv("ab\t1\nabc\t2\nabd\t3\nb\t4\n").unwrap();
+        assert_eq!(t.prefix_range("ab"), 0..3);
+        assert_eq!(t.prefix_range("abc"), 1..2);
+        assert_eq!(t.prefix_range("b"), 3..4);
+        assert!(t.prefix_range("c").is_empty());
+        assert_eq!(t.prefix_range(""), 0..4);
+    }
+
+    #[test]
+    #[cfg(feature = "dictionaries")]
+    fn test_session_incremental_matches_full_search() {
+        let t = ShortcodeTable::builtin();
+        let mut s = ShortcodeSession::new(t);
+        for b in b"smil" {
+            assert!(s.push(t, *b));
+            assert_eq!(s.range(), t.prefix_range(s.code()));
+        }
+        assert!(s.exact(t).is_none());
+        assert!(s.push(t, b'e'));
+        assert_eq!(s.exact(t).map(|i| t.value(i)), Some("😄"));
+        assert!(s.pop(t));
+        assert_eq!(s.code(), "smil");
+        assert!(!s.push(t, b'A'));
+    }
+
+    #[test]
+    #[cfg(feature = "dictionaries")]
+    fn test_best_in_prefers_short_codes() {
+        let t = ShortcodeTable::builtin();
+        let mut out = [0usize; 3];
+        let n = t.best_in(t.prefix_range("smi"), &mut out);
+        assert_eq!(n, 3);
+        assert_eq!(t.code(out[0]), "smile");
+        assert_eq!(t.code(out[1]), "smiley");
+        for w in out[..n].windows(2) {
+            assert!(t.code(w[0]).len() <= t.code(w[1]).len());
+        }
+    }
+
+    #[test]
+    fn test_rejects_invalid_data() {
+        assert!(ShortcodeTable::from_tsv("b\t1\na\t2\n").is_err());
+        assert!(ShortcodeTable::from_tsv("a\t1\na\t2\n").is_err());
+        assert!(ShortcodeTable::from_tsv("A\t1\n").is_err());
+        assert!(ShortcodeTable::from_tsv("a1\n").is_err());
+    }
+}
@@ -11,6 +11,11 @@ use std::collections::HashMap;
 /// Note: Vietnamese characters with diacritics (ồ, ế, ẫ) count as 1 codepoint each.
 pub const MAX_REPLACEMENT_LEN: usize = MAX - 1; // -1 to leave room for trailing space
 
+/// Maximum snippet length in UTF-32 codepoints (`Shortcut::snippet`)
+/// Snippets are delivered whole only through `ime_key_wide`; `ime_key`
+/// receives the first 255 characters.
+pub const MAX_SNIPPET_LEN: usize = 65_536;
+
 /// Input method that shortcut applies to
 #[derive(Debug, Clone, Copy, PartialEq, Default)]
 pub enum InputMethod {
@@ -85,6 +90,22 @@ impl Shortcut {
         }
     }
 
+    /// Create a word-boundary snippet (long text block, all input methods)
+    ///
+    /// Like `new()`, but the replacement may be up to `MAX_SNIPPET_LEN`
+    /// codepoints. Expansions longer than 255 characters need the wide
+    /// result path (`Engine::on_key_wide`).
+    pub fn snippet(trigger: &str, replacement: &str) -> Self {
+        let replacement = match replacement.char_indices().nth(MAX_SNIPPET_LEN) {
+            Some((end, _)) => replacement[..end].to_string(),
+            None => replacement.to_string(),
+        };
+        Self {
+            replacement,
+            ..Self::new(trigger, "")
+        }
+    }
+
     /// Create an immediate trigger shortcut (applies to all input methods).
     /// Replacement is truncated to MAX_REPLACEMENT_LEN (63) codepoints if too long.
     pub fn immediate(trigger: &str, replacement: &str) -> Self {
@@ -326,63 +347,65 @@ impl ShortcutTable {
         is_word_boundary: bool,
         method: InputMethod,
     ) -> Option<ShortcutMatch> {
-        let (trigger, shortcut) = self.lookup_for_method(buffer, method)?;
+        let (backspace_count, include_trigger_key, output) =
+            self.match_chars(buffer, key_char, is_word_boundary, method)?;
+        Some(ShortcutMatch {
+            backspace_count,
+            output: output.collect(),
+            include_trigger_key,
+        })
+    }
 
-        match shortcut.condition {
-            TriggerCondition::Immediate => {
-                let output = self.apply_case(buffer, &shortcut.replacement, shortcut.case_mode);
-                Some(ShortcutMatch {
-                    backspace_count: trigger.len(),
-                    output,
-                    include_trigger_key: false,
-                })
-            }
-            TriggerCondition::OnWordBoundary => {
-                if is_word_boundary {
-                    let mut output =
-                        self.apply_case(buffer, &shortcut.replacement, shortcut.case_mode);
-                    // Append the trigger key (space, etc.)
-                    if let Some(ch) = key_char {
-                        output.push(ch);
-                    }
-                    Some(ShortcutMatch {
-                        backspace_count: trigger.len(),
-                        output,
-                        include_trigger_key: true,
-                    })
-                } else {
-                    None
-                }
-            }
-        }
+    /// `try_match_for_method` without building the output `String`
+    ///
+    /// # Returns
+    /// (backspace count, whether the trigger key is included, output chars)
+    pub fn match_chars<'a>(
+        &'a self,
+        buffer: &'a str,
+        key_char: Option<char>,
+        is_word_boundary: bool,
+        method: InputMethod,
+    ) -> Option<(usize, bool, impl Iterator<Item = char> + Clone + 'a)> {
+        let (trigger, shortcut) = self.lookup_for_method(buffer, method)?;
+        let include_trigger_key = match shortcut.condition {
+            TriggerCondition::Immediate => false,
+            TriggerCondition::OnWordBoundary if is_word_boundary => true,
+            TriggerCondition::OnWordBoundary => return None,
+        };
+        let output = Self::cased_chars(buffer, &shortcut.replacement, shortcut.case_mode)
+            .chain(key_char.filter(|_| include_trigger_key));
+        Some((trigger.len(), include_trigger_key, output))
     }
 
-    /// Apply case transformation based on mode
-    fn apply_case(&self, trigger: &str, replacement: &str, mode: CaseMode) -> String {
-        match mode {
-            CaseMode::Exact => replacement.to_string(),
-            CaseMode::MatchCase => {
-                if trigger.chars().all(|c| c.is_uppercase()) {
-                    // All uppercase → replacement all uppercase
-                    replacement.to_uppercase()
-                } else if trigger
-                    .chars()
-                    .next()
-                    .map(|c| c.is_uppercase())
-                    .unwrap_or(false)
-                {
-                    // First char uppercase → capitalize replacement
-                    let mut chars = replacement.chars();
-                    match chars.next() {
-                        Some(first) => first.to_uppercase().collect::<String>() + chars.as_str(),
-                        None => String::new(),
-                    }
-                } else {
-                    // Lowercase → keep replacement as-is
-                    replacement.to_string()
+    /// Replacement chars with the case of the typed trigger applied
+    ///
+    /// `MatchCase`: all uppercase → replacement all uppercase, first char
+    /// uppercase → replacement capitalized, otherwise as defined.
+    fn cased_chars<'a>(
+        trigger: &str,
+        replacement: &'a str,
+        mode: CaseMode,
+    ) -> impl Iterator<Item = char> + Clone + 'a {
+        let (all, first) = match mode {
+            CaseMode::Exact => (false, false),
+            CaseMode::MatchCase => (
+                trigger.chars().all(|c| c.is_uppercase()),
+                trigger.chars().next().is_some_and(|c| c.is_uppercase()),
+            ),
+        };
+        replacement.chars().enumerate().flat_map(move |(i, c)| {
+            // to_uppercase yields at most 3 chars
+            let mut out = [None; 3];
+            if all || (first && i == 0) {
+                for (slot, u) in out.iter_mut().zip(c.to_uppercase()) {
+                    *slot = Some(u);
                 }
+            } else {
+                out[0] = Some(c);
             }
-        }
+            out.into_iter().flatten()
+        })
     }
 
     /// Rebuild sorted triggers list (longest first)
@@ -983,6 +1006,18 @@ mod tests {
         );
     }
 
+    #[test]
+    fn test_snippet_keeps_long_replacement() {
+        let long_text = "Đây là một đoạn văn bản tiếng Việt. ".repeat(100);
+        let shortcut = Shortcut::snippet("sig", &long_text);
+        assert_eq!(shortcut.replacement, long_text);
+        assert_eq!(shortcut.condition, TriggerCondition::OnWordBoundary);
+
+        let huge = "a".repeat(MAX_SNIPPET_LEN + 10);
+        let shortcut = Shortcut::snippet("huge", &huge);
+        assert_eq!(shortcut.replacement.chars().count(), MAX_SNIPPET_LEN);
+    }
+
     #[test]
     fn test_replacement_validation_vietnamese_diacritics() {
         // Each Vietnamese character with diacritic is 1 codepoint
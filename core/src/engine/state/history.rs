@@ -16,7 +16,8 @@
 //!
 //! # Performance
 //!
-//! - Stack-allocated ring buffer (no heap allocation)
+//! - Ring storage allocated on the first push (one allocation per engine),
+//!   so creating an engine costs nothing until a word is committed
 //! - O(1) push and pop operations
 //! - Fixed capacity of 10 words (configurable via HISTORY_CAPACITY)
 //!
@@ -41,7 +42,8 @@ use crate::engine::buffer::Buffer;
 ///
 /// This value is chosen to balance memory usage with practical needs:
 /// - 3 words covers typical backspace-after-space scenarios
-/// - Total memory: ~3 * (256 + 264) ≈ 1.6KB
+/// - Total memory: 3 * (3096 + 264) ≈ 9.8KB, allocated on first use
+///   (`test_ring_size`)
 /// - Reduced from 10 to optimize memory footprint (70% reduction)
 pub const HISTORY_CAPACITY: usize = 3;
 
@@ -54,12 +56,11 @@ pub const HISTORY_CAPACITY: usize = 3;
 ///
 /// ```text
 /// ┌─────────────────────────────────────────────┐
-/// │ buffers[0..3]      │ ~768 bytes             │
-/// │ raw_inputs[0..3]   │ ~792 bytes             │
+/// │ ring: Option<Box>  │ 8 bytes (None at start)│
 /// │ head: usize        │ 8 bytes                │
 /// │ len: usize         │ 8 bytes                │
 /// └─────────────────────────────────────────────┘
-/// Total: ~1.6KB (stack-allocated)
+/// ring (first push):   buffers[0..3] ~9.1KB + raw_inputs[0..3] 792 bytes
 /// ```
 ///
 /// # Thread Safety
@@ -67,16 +68,22 @@ pub const HISTORY_CAPACITY: usize = 3;
 /// Not thread-safe. Should be owned by a single Engine instance.
 #[derive(Clone)]
 pub struct WordHistory {
-    /// Ring buffer for displayed buffers
-    buffers: [Buffer; HISTORY_CAPACITY],
-    /// Ring buffer for raw keystroke history
-    raw_inputs: [RawInputBuffer; HISTORY_CAPACITY],
+    /// Ring storage, None until the first push
+    ring: Option<Box<Ring>>,
     /// Current head position (next write index)
     head: usize,
     /// Current number of elements (0 to HISTORY_CAPACITY)
     len: usize,
 }
 
+#[derive(Clone)]
+struct Ring {
+    /// Ring buffer for displayed buffers
+    buffers: [Buffer; HISTORY_CAPACITY],
+    /// Ring buffer for raw keystroke history
+    raw_inputs: [RawInputBuffer; HISTORY_CAPACITY],
+}
+
 impl Default for WordHistory {
     fn default() -> Self {
         Self::new()
@@ -87,11 +94,10 @@ impl WordHistory {
     /// Create a new empty word history
     ///
     /// # Performance
-    /// O(1) - arrays are initialized with default values
-    pub fn new() -> Self {
+    /// O(1), no allocation - ring storage is created by the first `push`
+    pub const fn new() -> Self {
         Self {
-            buffers: std::array::from_fn(|_| Buffer::new()),
-            raw_inputs: std::array::from_fn(|_| RawInputBuffer::new()),
+            ring: None,
             head: 0,
             len: 0,
         }
@@ -106,13 +112,17 @@ impl WordHistory {
     /// * `raw` - The raw keystroke history to save
     ///
     /// # Performance
-    /// O(1) - uses `clone_from` to reuse existing memory capacity, preventing new heap allocations.
+    /// O(1) - copies into the ring slot; allocates the ring on first use only
     #[inline]
     pub fn push(&mut self, buf: &Buffer, raw: &RawInputBuffer) {
-        // Optimization: Use clone_from to reuse existing Vec capacity
-        // This avoids syscalls for allocation/deallocation
-        self.buffers[self.head].clone_from(buf);
-        self.raw_inputs[self.head].clone_from(raw);
+        let ring = self.ring.get_or_insert_with(|| {
+            Box::new(Ring {
+                buffers: std::array::from_fn(|_| Buffer::new()),
+                raw_inputs: std::array::from_fn(|_| RawInputBuffer::new()),
+            })
+        });
+        ring.buffers[self.head].clone_from(buf);
+        ring.raw_inputs[self.head].clone_from(raw);
 
         self.head = (self.head + 1) % HISTORY_CAPACITY;
         if self.len < HISTORY_CAPACITY {
@@ -135,11 +145,12 @@ impl WordHistory {
         if self.len == 0 {
             return None;
         }
+        let ring = self.ring.as_mut()?;
         self.head = (self.head + HISTORY_CAPACITY - 1) % HISTORY_CAPACITY;
         self.len -= 1;
         Some((
-            std::mem::take(&mut self.buffers[self.head]),
-            std::mem::take(&mut self.raw_inputs[self.head]),
+            std::mem::take(&mut ring.buffers[self.head]),
+            std::mem::take(&mut ring.raw_inputs[self.head]),
         ))
     }
 
@@ -153,8 +164,9 @@ impl WordHistory {
         if self.len == 0 {
             return None;
         }
+        let ring = self.ring.as_ref()?;
         let index = (self.head + HISTORY_CAPACITY - 1) % HISTORY_CAPACITY;
-        Some((&self.buffers[index], &self.raw_inputs[index]))
+        Some((&ring.buffers[index], &ring.raw_inputs[index]))
     }
 
     /// Clear all entries from history
@@ -224,6 +236,15 @@ mod tests {
         buf
     }
 
+    #[test]
+    #[cfg(target_pointer_width = "64")]
+    fn test_ring_size() {
+        // Keep the figures in the docs above in step with `Buffer`
+        assert_eq!(std::mem::size_of::<Buffer>(), 3096);
+        assert_eq!(std::mem::size_of::<RawInputBuffer>(), 264);
+        assert_eq!(std::mem::size_of::<Ring>(), 10080);
+    }
+
     /// Helper: Create a simple raw input buffer
     fn make_raw_input(letters: &str) -> RawInputBuffer {
         let mut raw = RawInputBuffer::new();
@@ -1,9 +1,14 @@
 //! State management for Vietnamese IME
 //!
-//! Handles word history and raw input restoration.
+//! Handles word history, raw input restoration, composition preedit and
+//! per-application profiles.
 
 pub mod history;
+pub mod preedit;
+pub mod profile;
 pub mod restore;
 
 pub use history::WordHistory;
+pub use preedit::Preedit;
+pub use profile::ProfileRegistry;
 // restore module provides functions for raw input restoration
@@ -0,0 +1,124 @@
+//! Preedit (marked text) state for composition mode
+//!
+//! In composition mode the in-progress word is shown as marked text instead
+//! of being typed into the document and patched with backspaces. This
+//! module holds what the platform currently displays as marked text, so the
+//! engine can commit it at word boundaries.
+//!
+//! # Performance
+//!
+//! - Fixed-size array (no heap allocation while typing)
+//! - O(n) refresh from the engine buffer, n = word length
+
+use crate::engine::buffer::{Buffer, MAX};
+
+/// Marked text currently displayed by the platform
+#[derive(Clone)]
+pub struct Preedit {
+    chars: [char; MAX],
+    len: usize,
+    /// Caret position in chars (always at the end while typing a syllable)
+    caret: usize,
+}
+
+impl Default for Preedit {
+    fn default() -> Self {
+        Self::new()
+    }
+}
+
+impl Preedit {
+    pub fn new() -> Self {
+        Self {
+            chars: ['\0'; MAX],
+            len: 0,
+            caret: 0,
+        }
+    }
+
+    /// Replace contents with the rendered buffer, caret at the end
+    #[inline]
+    pub fn set_from_buffer(&mut self, buf: &Buffer) {
+        self.len = buf.render_into(&mut self.chars);
+        self.caret = self.len;
+    }
+
+    #[inline]
+    pub fn clear(&mut self) {
+        self.len = 0;
+        self.caret = 0;
+    }
+
+    #[inline]
+    pub fn is_empty(&self) -> bool {
+        self.len == 0
+    }
+
+    #[inline]
+    pub fn len(&self) -> usize {
+        self.len
+    }
+
+    #[inline]
+    pub fn caret(&self) -> usize {
+        self.caret
+    }
+
+    #[inline]
+    pub fn as_slice(&self) -> &[char] {
+        &self.chars[..self.len]
+    }
+
+    /// Apply a backspace+insert edit (as produced by `Result::send`)
+    ///
+    /// The edit was computed against the on-screen text, which in
+    /// composition mode is the marked text. Returns the number of
+    /// backspaces that reach past the marked text into the document.
+    pub fn apply_edit(&mut self, backspace: usize, insert: &[u32]) -> usize {
+        let local = backspace.min(self.len);
+        self.len -= local;
+        for &cp in insert {
+            if self.len == MAX {
+                break;
+            }
+            if let Some(ch) = char::from_u32(cp) {
+                self.chars[self.len] = ch;
+                self.len += 1;
+            }
+        }
+        self.caret = self.len;
+        backspace - local
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::data::keys;
+    use crate::engine::buffer::Char;
+
+    #[test]
+    fn test_set_from_buffer() {
+        let mut buf = Buffer::new();
+        buf.push(Char::new(keys::V, false));
+        let mut c = Char::new(keys::A, false);
+        c.mark = 1;
+        buf.push(c);
+
+        let mut p = Preedit::new();
+        p.set_from_buffer(&buf);
+        assert_eq!(p.as_slice(), &['v', 'á']);
+        assert_eq!(p.caret(), 2);
+    }
+
+    #[test]
+    fn test_apply_edit() {
+        let mut p = Preedit::new();
+        assert_eq!(p.apply_edit(0, &['b' as u32, 'a' as u32]), 0);
+        assert_eq!(p.apply_edit(1, &['ả' as u32, ' ' as u32]), 0);
+        assert_eq!(p.as_slice(), &['b', 'ả', ' ']);
+        // Backspaces beyond the marked text reach the document
+        assert_eq!(p.apply_edit(5, &[]), 2);
+        assert!(p.is_empty());
+    }
+}
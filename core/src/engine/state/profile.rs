@@ -0,0 +1,329 @@
+//! Per-Application Profiles
+//!
+//! A profile is a whole parked `Engine`: its settings (method, tone style,
+//! enabled, …) and its typing state. Switching apps swaps the active engine
+//! with the parked one, a fixed-size move instead of one setter call per
+//! setting. User data that is not per app travels with the active engine:
+//! the prediction model, learned corrections, override lists, the commit
+//! event ring, and the shortcut table unless the profile has its own
+//! (`set_own_shortcuts`).
+//!
+//! Profiles are keyed by `profile_id(app identifier)`. The default profile
+//! (`DEFAULT_PROFILE`) always exists; a new profile starts from the default
+//! profile's settings the first time it is activated.
+
+use super::super::Engine;
+use crate::engine::features::shortcut::ShortcutTable;
+use std::cell::OnceCell;
+use std::collections::HashMap;
+
+/// Profile active after `ProfileRegistry::new` (global settings)
+pub const DEFAULT_PROFILE: u64 = 0;
+
+/// Profiles kept, including the default one
+pub const MAX_PROFILES: usize = 128;
+
+/// Profile id of an application identifier (FNV-1a 64; never
+/// `DEFAULT_PROFILE`)
+pub fn profile_id(app: &[u8]) -> u64 {
+    let mut h: u64 = 0xcbf2_9ce4_8422_2325;
+    for &b in app {
+        h ^= b as u64;
+        h = h.wrapping_mul(0x0000_0100_0000_01b3);
+    }
+    h.max(1)
+}
+
+/// An inactive profile
+struct Parked {
+    engine: Box<Engine>,
+    own_shortcuts: bool,
+}
+
+/// Parked profiles and the shared data routing between them
+pub struct ProfileRegistry {
+    active: u64,
+    active_owns_shortcuts: bool,
+    parked: HashMap<u64, Parked>,
+    /// Shared shortcut table while the active profile uses its own
+    shared_shortcuts: OnceCell<ShortcutTable>,
+}
+
+impl Default for ProfileRegistry {
+    fn default() -> Self {
+        Self::new()
+    }
+}
+
+impl ProfileRegistry {
+    pub fn new() -> Self {
+        Self {
+            active: DEFAULT_PROFILE,
+            active_owns_shortcuts: false,
+            // Full capacity up front: switching never rehashes
+            parked: HashMap::with_capacity(MAX_PROFILES),
+            shared_shortcuts: OnceCell::new(),
+        }
+    }
+
+    pub fn active(&self) -> u64 {
+        self.active
+    }
+
+    /// Number of profiles, including the active one
+    pub fn count(&self) -> usize {
+        self.parked.len() + 1
+    }
+
+    pub fn contains(&self, id: u64) -> bool {
+        id == self.active || self.parked.contains_key(&id)
+    }
+
+    /// Make `id` the active profile; `engine` is the active engine.
+    ///
+    /// The active engine is parked under the current id and profile `id`'s
+    /// engine takes its place, created on first use from the default
+    /// profile's settings. Fails past `MAX_PROFILES`.
+    pub fn activate(&mut self, engine: &mut Engine, id: u64) -> Result<(), &'static str> {
+        if id == self.active {
+            return Ok(());
+        }
+        let mut incoming = match self.parked.remove(&id) {
+            Some(parked) => parked,
+            None if self.count() >= MAX_PROFILES => return Err("Too many profiles"),
+            None => {
+                let default = match self.parked.get(&DEFAULT_PROFILE) {
+                    Some(parked) => &parked.engine,
+                    None => &*engine,
+                };
+                let mut fresh = Box::new(Engine::new());
+                copy_settings(default, &mut fresh);
+                Parked {
+                    engine: fresh,
+                    own_shortcuts: false,
+                }
+            }
+        };
+
+        let shared = if self.active_owns_shortcuts {
+            std::mem::take(&mut self.shared_shortcuts)
+        } else {
+            std::mem::take(&mut engine.shortcuts)
+        };
+        std::mem::swap(engine, &mut *incoming.engine);
+        move_user_data(&mut incoming.engine, engine);
+        if incoming.own_shortcuts {
+            self.shared_shortcuts = shared;
+        } else {
+            engine.shortcuts = shared;
+        }
+
+        let outgoing = Parked {
+            engine: incoming.engine,
+            own_shortcuts: self.active_owns_shortcuts,
+        };
+        self.parked.insert(self.active, outgoing);
+        self.active = id;
+        self.active_owns_shortcuts = incoming.own_shortcuts;
+        Ok(())
+    }
+
+    /// Give the active profile its own shortcut table (starting with the
+    /// defaults), or switch it back to the shared one
+    pub fn set_own_shortcuts(&mut self, engine: &mut Engine, own: bool) {
+        if own == self.active_owns_shortcuts {
+            return;
+        }
+        if own {
+            self.shared_shortcuts = std::mem::take(&mut engine.shortcuts);
+        } else {
+            engine.shortcuts = std::mem::take(&mut self.shared_shortcuts);
+        }
+        self.active_owns_shortcuts = own;
+    }
+
+    pub fn owns_shortcuts(&self) -> bool {
+        self.active_owns_shortcuts
+    }
+
+    /// Drop a parked profile (not the active or the default one)
+    pub fn remove(&mut self, id: u64) -> bool {
+        id != DEFAULT_PROFILE && self.parked.remove(&id).is_some()
+    }
+}
+
+/// Copy `from`'s settings onto `to` (not typing state or user data)
+fn copy_settings(from: &Engine, to: &mut Engine) {
+    to.method = from.method;
+    to.method_table = from.method_table.clone();
+    to.enabled = from.enabled;
+    to.shortcuts_enabled = from.shortcuts_enabled;
+    to.skip_w_shortcut = from.skip_w_shortcut;
+    to.esc_restore_enabled = from.esc_restore_enabled;
+    to.free_tone_enabled = from.free_tone_enabled;
+    to.modern_tone = from.modern_tone;
+    to.instant_restore_enabled = from.instant_restore_enabled;
+    to.shortcodes_enabled = from.shortcodes_enabled;
+    to.composition_enabled = from.composition_enabled;
+    to.low_amplification = from.low_amplification;
+    to.output_form = from.output_form;
+    let (gap_ns, min_keys) = from.burst.detection();
+    to.burst.set_detection(gap_ns, min_keys);
+    if let Some(costs) = from.edit_costs() {
+        to.set_edit_costs(costs);
+    }
+}
+
+/// Move the user data shared by all profiles (pointer moves)
+fn move_user_data(from: &mut Engine, to: &mut Engine) {
+    to.prediction = from.prediction.take();
+    to.learning = from.learning.take();
+    to.override_english = from.override_english.take();
+    to.override_vietnamese = from.override_vietnamese.take();
+    // Only the active engine produces commit events
+    to.commits = from.commits.take();
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::data::keys;
+    use crate::engine::features::shortcut::Shortcut;
+    use crate::engine::{Action, BurstKey, EditCosts};
+    use crate::utils::{char_to_key, type_word};
+
+    #[test]
+    fn test_profile_id() {
+        assert_eq!(
+            profile_id(b"com.apple.Terminal"),
+            profile_id(b"com.apple.Terminal")
+        );
+        assert_ne!(
+            profile_id(b"com.apple.Terminal"),
+            profile_id(b"com.apple.Safari")
+        );
+        assert_ne!(profile_id(b""), DEFAULT_PROFILE);
+    }
+
+    #[test]
+    fn test_settings_and_state_follow_profiles() {
+        let mut reg = ProfileRegistry::new();
+        let mut e = Engine::new();
+        e.set_modern_tone(false);
+        type_word(&mut e, "vie");
+
+        reg.activate(&mut e, 7).unwrap();
+        // New profile: default's settings, fresh typing state
+        assert!(!e.modern_tone);
+        assert_eq!(e.get_buffer(), "");
+        e.set_method(1);
+        e.set_enabled(false);
+
+        reg.activate(&mut e, DEFAULT_PROFILE).unwrap();
+        assert_eq!((e.method, e.enabled), (0, true));
+        assert_eq!(e.get_buffer(), "vie");
+        type_word(&mut e, "etj");
+        assert_eq!(e.get_buffer(), "việt");
+
+        reg.activate(&mut e, 7).unwrap();
+        assert_eq!((e.method, e.enabled), (1, false));
+        assert_eq!(reg.count(), 2);
+        assert!(!reg.remove(7) && !reg.remove(DEFAULT_PROFILE));
+    }
+
+    #[test]
+    fn test_new_profile_keeps_burst_detection() {
+        let mut reg = ProfileRegistry::new();
+        let mut e = Engine::new();
+        e.set_burst_detection(0, 2);
+
+        reg.activate(&mut e, 3).unwrap();
+        // Detection off: keys 1 µs apart are not a burst
+        for i in 1..=20 {
+            let key = e.burst_key(keys::A, false, false, false, i * 1_000);
+            assert_eq!(key, BurstKey::Pass);
+        }
+
+        reg.activate(&mut e, DEFAULT_PROFILE).unwrap();
+        e.set_burst_detection(1_000_000, 3);
+        reg.activate(&mut e, 4).unwrap();
+        // The third key in a row less than 1 ms apart starts a burst
+        for i in 1..=2 {
+            let key = e.burst_key(keys::A, false, false, false, i * 1_000);
+            assert_eq!(key, BurstKey::Pass);
+        }
+        let key = e.burst_key(keys::A, false, false, false, 3_000);
+        assert_eq!(key, BurstKey::Queued);
+    }
+
+    #[test]
+    fn test_new_profile_keeps_edit_costs() {
+        // Every edit is a slow round trip: words are deferred to their end
+        let slow = EditCosts {
+            per_edit: 2000,
+            per_backspace: 1,
+            per_char: 1,
+            per_replace: 0,
+            per_deferred_key: 50,
+        };
+        let mut reg = ProfileRegistry::new();
+        let mut e = Engine::new();
+        e.set_edit_costs(slow);
+
+        reg.activate(&mut e, 3).unwrap();
+        assert_eq!(e.edit_costs(), Some(slow));
+        for c in "tieengs".chars() {
+            let r = e.on_key_ext(char_to_key(c), false, false, false);
+            assert_eq!(r.action, Action::None as u8, "'{c}' not deferred");
+            r.release();
+        }
+        assert!(e.edit_deferred());
+
+        reg.activate(&mut e, DEFAULT_PROFILE).unwrap();
+        e.clear_edit_costs();
+        reg.activate(&mut e, 4).unwrap();
+        assert_eq!(e.edit_costs(), None);
+    }
+
+    #[test]
+    fn test_shortcut_tables() {
+        let mut reg = ProfileRegistry::new();
+        let mut e = Engine::new();
+        e.shortcuts_mut().clear();
+        e.shortcuts_mut().add(Shortcut::new("vn", "Việt Nam"));
+
+        // Shared table follows the active profile
+        reg.activate(&mut e, 1).unwrap();
+        assert!(e.shortcuts().lookup("vn").is_some());
+        e.shortcuts_mut().add(Shortcut::new("hn", "Hà Nội"));
+
+        // Own table: separate, and the shared one is kept aside
+        reg.activate(&mut e, 2).unwrap();
+        reg.set_own_shortcuts(&mut e, true);
+        e.shortcuts_mut().clear();
+        assert!(e.shortcuts().lookup("hn").is_none());
+        e.shortcuts_mut().add(Shortcut::new("gg", "Google"));
+
+        reg.activate(&mut e, DEFAULT_PROFILE).unwrap();
+        assert!(e.shortcuts().lookup("hn").is_some());
+        assert!(e.shortcuts().lookup("gg").is_none());
+
+        reg.activate(&mut e, 2).unwrap();
+        assert!(e.shortcuts().lookup("gg").is_some());
+        reg.set_own_shortcuts(&mut e, false);
+        assert!(e.shortcuts().lookup("hn").is_some());
+    }
+
+    #[test]
+    fn test_profile_limit() {
+        let mut reg = ProfileRegistry::new();
+        let mut e = Engine::new();
+        for id in 1..MAX_PROFILES as u64 {
+            reg.activate(&mut e, id).unwrap();
+        }
+        assert_eq!(reg.activate(&mut e, u64::MAX), Err("Too many profiles"));
+        assert!(reg.activate(&mut e, 1).is_ok());
+        assert!(reg.remove(2));
+        assert!(reg.activate(&mut e, u64::MAX).is_ok());
+    }
+}
@@ -4,7 +4,7 @@
 //! used for English word auto-restore and ESC key restoration functionality.
 //!
 //! ## Performance Optimizations (Phase 2)
-//! - Pre-allocated String buffers with capacity
+//! - Output built in the word's scratch arena (no per-restore allocation)
 //! - Reduced redundant transform checks
 //! - Optimized iteration patterns
 //!
@@ -18,40 +18,37 @@
 //!    the original keystrokes (undo all Vietnamese transforms).
 //!    Example: "tẽt" (from typing "text" in Telex) → "text"
 
-use crate::engine::buffer::Buffer;
+use crate::engine::buffer::{Buffer, Scratch};
 use crate::engine::raw_input_buffer::RawInputBuffer;
 use crate::engine::types::Result;
 use crate::utils;
 
+/// ASCII characters of the raw keystrokes from `from_pos` on
+#[inline]
+fn raw_chars(raw_input: &RawInputBuffer, from_pos: usize) -> impl Iterator<Item = char> + '_ {
+    raw_input
+        .iter()
+        .skip(from_pos)
+        .filter_map(|(key, caps)| utils::key_to_char(key, caps))
+}
+
 /// Build raw ASCII output from raw input history (OPTIMIZED)
 ///
 /// Converts the raw keystroke history back to ASCII characters.
 /// Used by both auto_restore_english and restore_to_raw.
 ///
 /// # Performance
-/// Pre-allocates Vec with exact capacity to avoid reallocation.
+/// Written to the word's scratch arena (no allocation once it is warm).
 ///
 /// # Arguments
 /// * `raw_input` - Raw keystroke history buffer
+/// * `scratch` - Arena holding the output
 ///
 /// # Returns
-/// Vector of ASCII characters, empty if no valid characters
+/// ASCII characters, empty if no valid characters
 #[inline]
-pub fn build_raw_output(raw_input: &RawInputBuffer) -> Vec<char> {
-    let len = raw_input.len();
-    if len == 0 {
-        return Vec::new();
-    }
-
-    // OPTIMIZATION: Pre-allocate with exact capacity
-    let mut out = Vec::with_capacity(len);
-    for (key, caps) in raw_input.iter() {
-        if let Some(ch) = utils::key_to_char(key, caps) {
-            out.push(ch);
-        }
-    }
-
-    out
+pub fn build_raw_output<'a>(raw_input: &RawInputBuffer, scratch: &'a Scratch) -> &'a [char] {
+    build_raw_output_from(raw_input, 0, scratch)
 }
 
 /// Build raw ASCII output from a specific position in raw input history (OPTIMIZED)
@@ -59,32 +56,23 @@ pub fn build_raw_output(raw_input: &RawInputBuffer) -> Vec<char> {
 /// Used for incremental restore - only rebuilds from the first transform position.
 ///
 /// # Performance
-/// Pre-allocates Vec with exact capacity for the subset.
+/// Written to the word's scratch arena (no allocation once it is warm).
 ///
 /// # Arguments
 /// * `raw_input` - Raw keystroke history buffer
 /// * `from_pos` - Starting position (0-indexed)
+/// * `scratch` - Arena holding the output
 ///
 /// # Returns
-/// Vector of ASCII characters from position to end
+/// ASCII characters from position to end
 #[inline]
-pub fn build_raw_output_from(raw_input: &RawInputBuffer, from_pos: usize) -> Vec<char> {
-    let len = raw_input.len();
-    if from_pos >= len {
-        return Vec::new();
-    }
-
-    // OPTIMIZATION: Pre-allocate exact size needed
-    let mut out = Vec::with_capacity(len - from_pos);
-
-    // OPTIMIZATION: Use skip() instead of enumerate + continue
-    for (key, caps) in raw_input.iter().skip(from_pos) {
-        if let Some(ch) = utils::key_to_char(key, caps) {
-            out.push(ch);
-        }
-    }
-
-    out
+pub fn build_raw_output_from<'a>(
+    raw_input: &RawInputBuffer,
+    from_pos: usize,
+    scratch: &'a Scratch,
+) -> &'a [char] {
+    let len = raw_input.len().saturating_sub(from_pos);
+    scratch.collect_at_most(len, raw_chars(raw_input, from_pos))
 }
 
 /// Find the position of the first character with Vietnamese transforms
@@ -134,11 +122,12 @@ pub fn has_vietnamese_transforms(buf: &Buffer) -> bool {
 ///
 /// # Performance
 /// - Pre-checks for transforms to avoid unnecessary work
-/// - Pre-allocates Vec with capacity for output + space
+/// - Output (raw + space) in the word's scratch arena
 ///
 /// # Arguments
 /// * `buf` - Current buffer (for backspace count)
 /// * `raw_input` - Raw keystroke history
+/// * `scratch` - Arena holding the output
 ///
 /// # Returns
 /// Result with backspace count and raw ASCII output + space
@@ -146,38 +135,30 @@ pub fn has_vietnamese_transforms(buf: &Buffer) -> bool {
 /// # Example
 /// ```ignore
 /// // "telex" → "tễl" (transform) + space → "telex " (with auto-space)
-/// let result = auto_restore_english(&buf, &raw_input);
+/// let result = auto_restore_english(&buf, &raw_input, &scratch);
 /// // result.backspace = 3 (length of "tễl")
 /// // result.chars = ['t', 'e', 'l', 'e', 'x', ' ']
 /// ```
-pub fn auto_restore_english(buf: &Buffer, raw_input: &RawInputBuffer) -> Result {
+pub fn auto_restore_english(buf: &Buffer, raw_input: &RawInputBuffer, scratch: &Scratch) -> Result {
     // Fast path: empty checks
     if raw_input.is_empty() || buf.is_empty() {
         return Result::none();
     }
 
-    // OPTIMIZATION: Pre-allocate with capacity for raw + space
-    let mut raw_chars = Vec::with_capacity(raw_input.len() + 1);
-
-    for (key, caps) in raw_input.iter() {
-        if let Some(ch) = utils::key_to_char(key, caps) {
-            raw_chars.push(ch);
-        }
-    }
+    // Auto-add space after English word restore
+    // This provides better UX: user types "telex" + space, gets "telex " ready for next word
+    let raw_chars =
+        scratch.collect_at_most(raw_input.len() + 1, raw_chars(raw_input, 0).chain([' ']));
 
-    if raw_chars.is_empty() {
+    if raw_chars.len() == 1 {
         return Result::none();
     }
 
-    // Auto-add space after English word restore
-    // This provides better UX: user types "telex" + space, gets "telex " ready for next word
-    raw_chars.push(' ');
-
     // Backspace count = current buffer length (displayed chars)
     // SAFETY: Clamp to u8::MAX to prevent overflow
     let backspace = buf.len().min(u8::MAX as usize) as u8;
 
-    Result::send(backspace, &raw_chars)
+    Result::send(backspace, raw_chars)
 }
 
 /// Restore buffer to raw ASCII for English words (instant - no space) (OPTIMIZED)
@@ -199,9 +180,13 @@ pub fn auto_restore_english(buf: &Buffer, raw_input: &RawInputBuffer) -> Result
 ///
 /// # Performance Optimizations
 /// - Early exit if no transforms
-/// - Pre-allocated Vec with exact capacity
+/// - Output in the word's scratch arena
 /// - Single-pass transform check
-pub fn instant_restore_english(buf: &Buffer, raw_input: &RawInputBuffer) -> Result {
+pub fn instant_restore_english(
+    buf: &Buffer,
+    raw_input: &RawInputBuffer,
+    scratch: &Scratch,
+) -> Result {
     // Fast path: empty checks
     if raw_input.is_empty() || buf.is_empty() {
         return Result::none();
@@ -212,14 +197,7 @@ pub fn instant_restore_english(buf: &Buffer, raw_input: &RawInputBuffer) -> Resu
         return Result::none();
     }
 
-    // OPTIMIZATION: Pre-allocate with exact capacity
-    let mut raw_chars = Vec::with_capacity(raw_input.len());
-
-    for (key, caps) in raw_input.iter() {
-        if let Some(ch) = utils::key_to_char(key, caps) {
-            raw_chars.push(ch);
-        }
-    }
+    let raw_chars = build_raw_output(raw_input, scratch);
 
     if raw_chars.is_empty() {
         return Result::none();
@@ -233,7 +211,36 @@ pub fn instant_restore_english(buf: &Buffer, raw_input: &RawInputBuffer) -> Resu
     // SAFETY: Also clamp to u8::MAX to prevent overflow
     let backspace = buf.len().min(raw_input.len()).min(u8::MAX as usize) as u8;
 
-    Result::send(backspace, &raw_chars)
+    Result::send(backspace, raw_chars)
+}
+
+/// Drop the part of a restore edit that would retype what is already shown
+///
+/// `deleted` is the on-screen text the edit backspaces over. Leading
+/// characters that the edit would delete and type back unchanged are kept
+/// on screen instead, e.g. "tẽt" → "text" becomes 2 backspaces + "ext"
+/// instead of 3 backspaces + "text".
+pub fn trim_unchanged_prefix(result: Result, deleted: &[char], scratch: &Scratch) -> Result {
+    if result.backspace as usize != deleted.len() {
+        return result;
+    }
+    let chars = result.as_slice();
+    let keep = deleted
+        .iter()
+        .zip(chars)
+        .take_while(|&(&d, &c)| d as u32 == c)
+        .count();
+    if keep == 0 {
+        return result;
+    }
+    let rest = scratch.collect_at_most(
+        chars.len() - keep,
+        chars[keep..].iter().filter_map(|&c| char::from_u32(c)),
+    );
+    // Release first: inside `Result::with_edit_storage` the trimmed result
+    // then reuses the storage instead of allocating
+    result.release();
+    Result::send((deleted.len() - keep) as u8, rest)
 }
 
 /// Restore buffer to raw ASCII (ESC key handler) (OPTIMIZED)
@@ -243,11 +250,12 @@ pub fn instant_restore_english(buf: &Buffer, raw_input: &RawInputBuffer) -> Resu
 ///
 /// # Performance
 /// - Early exit if no transforms
-/// - Pre-allocated Vec with exact capacity
+/// - Output in the word's scratch arena
 ///
 /// # Arguments
 /// * `buf` - Current buffer (for backspace count and transform check)
 /// * `raw_input` - Raw keystroke history
+/// * `scratch` - Arena holding the output
 ///
 /// # Returns
 /// Result with backspace count and raw ASCII output, or none if no transforms
@@ -255,11 +263,11 @@ pub fn instant_restore_english(buf: &Buffer, raw_input: &RawInputBuffer) -> Resu
 /// # Example
 /// ```ignore
 /// // "tẽt" (from typing "text" in Telex) → "text"
-/// let result = restore_to_raw(&buf, &raw_input);
+/// let result = restore_to_raw(&buf, &raw_input, &scratch);
 /// // result.backspace = 3 (length of "tẽt")
 /// // result.chars = ['t', 'e', 'x', 't']
 /// ```
-pub fn restore_to_raw(buf: &Buffer, raw_input: &RawInputBuffer) -> Result {
+pub fn restore_to_raw(buf: &Buffer, raw_input: &RawInputBuffer, scratch: &Scratch) -> Result {
     // Fast path: empty checks
     if raw_input.is_empty() || buf.is_empty() {
         return Result::none();
@@ -270,14 +278,7 @@ pub fn restore_to_raw(buf: &Buffer, raw_input: &RawInputBuffer) -> Result {
         return Result::none();
     }
 
-    // OPTIMIZATION: Pre-allocate with exact capacity
-    let mut raw_chars = Vec::with_capacity(raw_input.len());
-
-    for (key, caps) in raw_input.iter() {
-        if let Some(ch) = utils::key_to_char(key, caps) {
-            raw_chars.push(ch);
-        }
-    }
+    let raw_chars = build_raw_output(raw_input, scratch);
 
     if raw_chars.is_empty() {
         return Result::none();
@@ -287,7 +288,7 @@ pub fn restore_to_raw(buf: &Buffer, raw_input: &RawInputBuffer) -> Result {
     // SAFETY: Clamp to u8::MAX to prevent overflow
     let backspace = buf.len().min(u8::MAX as usize) as u8;
 
-    Result::send(backspace, &raw_chars)
+    Result::send(backspace, raw_chars)
 }
 
 #[cfg(test)]
@@ -324,21 +325,24 @@ mod tests {
             (keys::X, false),
             (keys::T, false),
         ]);
-        let output = build_raw_output(&raw);
+        let scratch = Scratch::new();
+        let output = build_raw_output(&raw, &scratch);
         assert_eq!(output, vec!['t', 'e', 'x', 't']);
     }
 
     #[test]
     fn test_build_raw_output_with_caps() {
         let raw = make_raw_input(&[(keys::T, true), (keys::E, false), (keys::S, false)]);
-        let output = build_raw_output(&raw);
+        let scratch = Scratch::new();
+        let output = build_raw_output(&raw, &scratch);
         assert_eq!(output, vec!['T', 'e', 's']);
     }
 
     #[test]
     fn test_build_raw_output_empty() {
         let raw = RawInputBuffer::new();
-        let output = build_raw_output(&raw);
+        let scratch = Scratch::new();
+        let output = build_raw_output(&raw, &scratch);
         assert!(output.is_empty());
     }
 
@@ -348,7 +352,7 @@ mod tests {
         let buf = make_buffer(&[(keys::T, 0, 0, false), (keys::E, 0, 4, false)]); // mark=4 is ngã
         let raw = make_raw_input(&[(keys::T, false), (keys::E, false), (keys::X, false)]);
 
-        let result = auto_restore_english(&buf, &raw);
+        let result = auto_restore_english(&buf, &raw, &Scratch::new());
 
         assert_eq!(result.action, 1); // Action::Send
         assert_eq!(result.backspace, 2); // "tẽ" length
@@ -360,7 +364,7 @@ mod tests {
         let buf = Buffer::new();
         let raw = make_raw_input(&[(keys::T, false)]);
 
-        let result = auto_restore_english(&buf, &raw);
+        let result = auto_restore_english(&buf, &raw, &Scratch::new());
 
         assert_eq!(result.action, 0); // Action::None
     }
@@ -370,7 +374,7 @@ mod tests {
         let buf = make_buffer(&[(keys::T, 0, 0, false)]);
         let raw = RawInputBuffer::new();
 
-        let result = auto_restore_english(&buf, &raw);
+        let result = auto_restore_english(&buf, &raw, &Scratch::new());
 
         assert_eq!(result.action, 0); // Action::None
     }
@@ -381,7 +385,7 @@ mod tests {
         let buf = make_buffer(&[(keys::D, 0, 0, true)]);
         let raw = make_raw_input(&[(keys::D, false), (keys::D, false)]);
 
-        let result = restore_to_raw(&buf, &raw);
+        let result = restore_to_raw(&buf, &raw, &Scratch::new());
 
         assert_eq!(result.action, 1); // Action::Send
         assert_eq!(result.backspace, 1); // "đ" length
@@ -394,7 +398,7 @@ mod tests {
         let buf = make_buffer(&[(keys::A, 0, 0, false), (keys::B, 0, 0, false)]);
         let raw = make_raw_input(&[(keys::A, false), (keys::B, false)]);
 
-        let result = restore_to_raw(&buf, &raw);
+        let result = restore_to_raw(&buf, &raw, &Scratch::new());
 
         assert_eq!(result.action, 0); // Action::None (no transforms to undo)
     }
@@ -404,7 +408,7 @@ mod tests {
         let buf = Buffer::new();
         let raw = RawInputBuffer::new();
 
-        let result = restore_to_raw(&buf, &raw);
+        let result = restore_to_raw(&buf, &raw, &Scratch::new());
 
         assert_eq!(result.action, 0); // Action::None
     }
@@ -484,21 +488,24 @@ mod tests {
             (keys::E, false),
             (keys::R, false),
         ]);
-        let output = build_raw_output_from(&raw, 2);
+        let scratch = Scratch::new();
+        let output = build_raw_output_from(&raw, 2, &scratch);
         assert_eq!(output, vec!['e', 'r']); // From position 2 onwards
     }
 
     #[test]
     fn test_build_raw_output_from_start() {
         let raw = make_raw_input(&[(keys::T, false), (keys::E, false)]);
-        let output = build_raw_output_from(&raw, 0);
+        let scratch = Scratch::new();
+        let output = build_raw_output_from(&raw, 0, &scratch);
         assert_eq!(output, vec!['t', 'e']); // All characters
     }
 
     #[test]
     fn test_build_raw_output_from_beyond_end() {
         let raw = make_raw_input(&[(keys::A, false)]);
-        let output = build_raw_output_from(&raw, 10);
+        let scratch = Scratch::new();
+        let output = build_raw_output_from(&raw, 10, &scratch);
         assert!(output.is_empty()); // Beyond end = empty
     }
 
@@ -519,7 +526,7 @@ mod tests {
             (keys::R, false),
         ]);
 
-        let result = instant_restore_english(&buf, &raw);
+        let result = instant_restore_english(&buf, &raw, &Scratch::new());
 
         assert_eq!(result.action, 1); // Action::Send
                                       // FIX: Must restore ENTIRE buffer to raw (not just from first transform)
@@ -545,7 +552,7 @@ mod tests {
             (keys::T, false),
         ]);
 
-        let result = instant_restore_english(&buf, &raw);
+        let result = instant_restore_english(&buf, &raw, &Scratch::new());
 
         // No transforms = no restore needed
         assert_eq!(result.action, 0); // Action::None
@@ -557,7 +564,7 @@ mod tests {
         let buf = make_buffer(&[(keys::D, 0, 0, true), (keys::A, 0, 0, false)]);
         let raw = make_raw_input(&[(keys::D, false), (keys::D, false), (keys::A, false)]);
 
-        let result = instant_restore_english(&buf, &raw);
+        let result = instant_restore_english(&buf, &raw, &Scratch::new());
 
         assert_eq!(result.action, 1); // Action::Send
                                       // Backspace entire buffer (transform at start)
@@ -565,4 +572,18 @@ mod tests {
         // Send all raw chars
         assert_eq!(result.count, 3); // "dda"
     }
+
+    #[test]
+    fn test_trim_unchanged_prefix() {
+        let r = Result::send(3, &['t', 'e', 'x', 't']);
+        let r = trim_unchanged_prefix(r, &['t', 'ẽ', 't'], &Scratch::new());
+        assert_eq!(r.backspace, 2);
+        assert_eq!(r.as_slice(), &['e' as u32, 'x' as u32, 't' as u32]);
+
+        // Edit not starting at the deleted text: unchanged
+        let r = Result::send(2, &['a', 'b']);
+        let r = trim_unchanged_prefix(r, &['a', 'b', 'c'], &Scratch::new());
+        assert_eq!(r.backspace, 2);
+        assert_eq!(r.count, 2);
+    }
 }
@@ -5,6 +5,6 @@ pub mod config;
 pub use config::EngineConfig;
 
 // Re-export types from types.rs
-pub use types::{Action, Result, Transform};
+pub use types::{Action, EditCause, Result, Transform, WideResult};
 
 mod types;
@@ -2,13 +2,15 @@
 //!
 //! This module contains the fundamental types used throughout the engine:
 //! - `Action`: Result action type for FFI responses
+//! - `EditCause`: Why the engine emitted an edit (amplification accounting)
 //! - `Result`: FFI-compatible result struct for key processing
+//! - `WideResult`: `Result` with `u32` counts, for long expansions
 //! - `Transform`: Internal transform tracking for undo/revert operations
 //!
 //! These types are extracted from the main engine module for better organization
 //! and to enable reuse across different engine components.
 
-use crate::engine::buffer::MAX;
+use std::cell::{Cell, UnsafeCell};
 
 // ============================================================
 // FFI Result Types
@@ -20,6 +22,10 @@ use crate::engine::buffer::MAX;
 /// - `None`: Pass through the key (no IME processing)
 /// - `Send`: Send replacement text (delete backspace chars, insert new chars)
 /// - `Restore`: Restore raw ASCII input (undo Vietnamese transforms)
+/// - `Preedit` / `Commit` / `CommitPassThrough`: composition mode
+///   (see `Engine::set_composition_mode`); `CommitPassThrough` also
+///   settles a deferred edit (see `Engine::set_edit_costs`)
+/// - `ReplaceRange`: replace text before the caret (edit planner only)
 #[repr(u8)]
 #[derive(Clone, Copy, Debug, PartialEq, Eq)]
 pub enum Action {
@@ -29,12 +35,48 @@ pub enum Action {
     Send = 1,
     /// Restore raw ASCII (legacy, now handled via Send)
     Restore = 2,
+    /// Composition: delete `backspace` document chars, then show `chars`
+    /// as marked (preedit) text with the caret at the end. Key is consumed.
+    Preedit = 3,
+    /// Composition: delete `backspace` document chars, replace the marked
+    /// text with `chars` as committed text. Key is consumed.
+    Commit = 4,
+    /// Composition: like `Commit`, then pass the original key through
+    /// (e.g. SPACE or punctuation ending the word). Direct mode (deferred
+    /// edit): delete `backspace` chars, insert `chars`, pass the key through
+    CommitPassThrough = 5,
+    /// Edit planner: the `backspace` chars that end `keep` chars before the
+    /// caret are replaced by `chars`; the caret stays after the kept chars
+    ReplaceRange = 6,
+}
+
+/// Why the last key produced an edit
+///
+/// Recorded per key by the engine (`Engine::last_edit_cause`) so the
+/// platform and benchmarks can attribute emitted backspaces/chars.
+#[repr(u8)]
+#[derive(Clone, Copy, Debug, PartialEq, Eq)]
+pub enum EditCause {
+    /// No edit (key passed through)
+    None = 0,
+    /// Tone/mark/stroke applied or reverted at its own position
+    Compose = 1,
+    /// Tone mark moved to another vowel by a later key (e.g. "osa" → "oá")
+    ToneReposition = 2,
+    /// Confidence check after a transform restored raw English
+    AutoRestore = 3,
+    /// English detected before/while applying a modifier, restored raw
+    InstantRestore = 4,
+    /// Word-boundary shortcut expansion
+    Shortcut = 5,
+    /// Anything else (ESC restore, shortcodes, backspace handling)
+    Other = 6,
 }
 
 /// FFI-compatible result struct for key processing
 ///
 /// This struct is returned by `ime_key()` and contains:
-/// - `chars`: Heap-allocated UTF-32 codepoints (up to MAX characters)
+/// - `chars`: Heap-allocated UTF-32 codepoints (up to 255 characters)
 /// - `action`: What action to take (None, Send, Restore)
 /// - `backspace`: Number of characters to delete before inserting
 /// - `count`: Number of valid characters in `chars` array
@@ -69,16 +111,18 @@ pub struct Result {
     /// Heap-allocated UTF-32 codepoints
     /// Null if action == None
     pub chars: *mut u32,
-    /// Allocated capacity (for proper Vec reconstruction)
+    /// Allocated capacity (for proper Vec reconstruction); 0 with non-null
+    /// `chars` inside `Result::with_edit_storage` (per-thread storage)
     pub capacity: usize,
-    /// Action type: 0=None, 1=Send, 2=Restore
+    /// Action type: 0=None, 1=Send, 2=Restore, 3=Preedit, 4=Commit,
+    /// 5=CommitPassThrough, 6=ReplaceRange
     pub action: u8,
     /// Number of characters to delete (backspace count)
     pub backspace: u8,
     /// Number of valid characters in `chars` array
     pub count: u8,
-    /// Padding for alignment (unused)
-    pub _pad: u8,
+    /// `ReplaceRange`: characters left after the replaced range (0 otherwise)
+    pub keep: u8,
 }
 
 impl Result {
@@ -96,7 +140,7 @@ impl Result {
             action: Action::None as u8,
             backspace: 0,
             count: 0,
-            _pad: 0,
+            keep: 0,
         }
     }
 
@@ -104,7 +148,7 @@ impl Result {
     ///
     /// # Arguments
     /// * `backspace` - Number of characters to delete before inserting
-    /// * `chars` - Characters to insert (will be truncated to MAX)
+    /// * `chars` - Characters to insert (truncated to 255, the `count` range)
     ///
     /// # Memory
     /// Allocates heap memory via Vec. Caller must call `ime_free()` to avoid leak.
@@ -116,7 +160,7 @@ impl Result {
     /// ```
     #[inline]
     pub fn send(backspace: u8, chars: &[char]) -> Self {
-        let count = chars.len().min(MAX);
+        let count = chars.len().min(u8::MAX as usize);
 
         if count == 0 {
             // No chars to send, use null pointer
@@ -126,7 +170,23 @@ impl Result {
                 action: Action::Send as u8,
                 backspace,
                 count: 0,
-                _pad: 0,
+                keep: 0,
+            };
+        }
+
+        // Inside `with_edit_storage`: the per-thread storage, if free
+        if let Some(ptr) = lend_edit_storage() {
+            for (i, &c) in chars.iter().take(count).enumerate() {
+                // SAFETY: the storage holds u8::MAX chars, count <= u8::MAX
+                unsafe { ptr.add(i).write(c as u32) };
+            }
+            return Self {
+                chars: ptr,
+                capacity: 0,
+                action: Action::Send as u8,
+                backspace,
+                count: count as u8,
+                keep: 0,
             };
         }
 
@@ -147,10 +207,32 @@ impl Result {
             action: Action::Send as u8,
             backspace,
             count: count as u8,
-            _pad: 0,
+            keep: 0,
         }
     }
 
+    /// Create a composition result (`Preedit`, `Commit`, `CommitPassThrough`)
+    ///
+    /// Same memory rules as `send()`; an empty `chars` clears the marked text.
+    #[inline]
+    pub fn compose(action: Action, backspace: u8, chars: &[char]) -> Self {
+        let mut r = Self::send(backspace, chars);
+        r.action = action as u8;
+        r
+    }
+
+    /// Create a `ReplaceRange` result: replace the `range` characters that
+    /// end `keep` characters before the caret with `chars`
+    ///
+    /// Same memory rules as `send()`.
+    #[inline]
+    pub fn replace_range(range: u8, keep: u8, chars: &[char]) -> Self {
+        let mut r = Self::send(range, chars);
+        r.action = Action::ReplaceRange as u8;
+        r.keep = keep;
+        r
+    }
+
     /// Create a result that only deletes characters (no insertion)
     ///
     /// # Arguments
@@ -165,8 +247,46 @@ impl Result {
             action: Action::Send as u8,
             backspace,
             count: 0,
-            _pad: 0,
+            keep: 0,
+        }
+    }
+
+    /// Free the heap chars of a result that never crosses the FFI boundary
+    ///
+    /// Used when the engine post-processes a result internally
+    /// (results returned to the platform are freed by `ime_free`).
+    #[inline]
+    pub fn release(self) {
+        if !self.chars.is_null() && self.capacity > 0 {
+            // SAFETY: chars/capacity come from the Vec built in `send()`
+            unsafe {
+                drop(Vec::from_raw_parts(
+                    self.chars,
+                    self.count as usize,
+                    self.capacity,
+                ));
+            }
+        } else if !self.chars.is_null() {
+            return_edit_storage(self.chars);
+        }
+    }
+
+    /// Run `f` with results built in per-thread storage instead of the heap
+    ///
+    /// For `ime_key_into_*`, which copy the edit into a caller buffer: the
+    /// first result built in `f` borrows the storage until it is released,
+    /// further ones allocate as usual. Results built in `f` must be
+    /// released in `f` and never handed to the platform (`ime_free`).
+    pub fn with_edit_storage<R>(f: impl FnOnce() -> R) -> R {
+        struct Scope;
+        impl Drop for Scope {
+            fn drop(&mut self) {
+                let _ = EDIT_STORAGE.try_with(|s| s.set(Lend::Off));
+            }
         }
+        let _ = EDIT_STORAGE.try_with(|s| s.set(Lend::Free));
+        let _scope = Scope;
+        f()
     }
 
     /// Check if this result requires action (not a pass-through)
@@ -196,12 +316,143 @@ impl Result {
     }
 }
 
+/// State of the per-thread edit storage (`Result::with_edit_storage`)
+#[derive(Clone, Copy, PartialEq, Eq)]
+enum Lend {
+    Off,
+    Free,
+    Lent,
+}
+
+thread_local! {
+    static EDIT_STORAGE: Cell<Lend> = const { Cell::new(Lend::Off) };
+    static EDIT_CHARS: UnsafeCell<[u32; u8::MAX as usize]> =
+        const { UnsafeCell::new([0; u8::MAX as usize]) };
+}
+
+/// Lend the per-thread edit storage if a scope is open and it is free
+#[inline]
+fn lend_edit_storage() -> Option<*mut u32> {
+    let lent = EDIT_STORAGE
+        .try_with(|s| {
+            let free = s.get() == Lend::Free;
+            if free {
+                s.set(Lend::Lent);
+            }
+            free
+        })
+        .unwrap_or(false);
+    if !lent {
+        return None;
+    }
+    EDIT_CHARS.try_with(|c| c.get() as *mut u32).ok()
+}
+
+/// Give the per-thread edit storage back (`Result::release`)
+#[inline]
+fn return_edit_storage(chars: *mut u32) {
+    let _ = EDIT_STORAGE.try_with(|s| {
+        let ours = EDIT_CHARS.try_with(|c| c.get() as *mut u32 == chars);
+        if s.get() == Lend::Lent && ours == Ok(true) {
+            s.set(Lend::Free);
+        }
+    });
+}
+
 impl Default for Result {
     fn default() -> Self {
         Self::none()
     }
 }
 
+/// FFI result with wide counts, returned by `ime_key_wide()`
+///
+/// Same meaning as `Result`, but `backspace`/`count` are `u32` so a long
+/// snippet expansion can be delivered in one edit. When an expansion is
+/// longer than the caller's inline limit, `chars` is empty and `remaining`
+/// characters are read in chunks with `ime_read_expansion()`.
+///
+/// # Memory Management
+/// Free with `ime_free_wide()`.
+#[repr(C)]
+pub struct WideResult {
+    /// Heap-allocated UTF-32 codepoints (null if none)
+    pub chars: *mut u32,
+    /// Allocated capacity (for proper Vec reconstruction)
+    pub capacity: usize,
+    /// Number of characters to delete
+    pub backspace: u32,
+    /// Number of valid characters in `chars`
+    pub count: u32,
+    /// Characters still held by the engine after `chars`
+    pub remaining: u32,
+    /// Action type, as in `Result`
+    pub action: u8,
+    /// Padding for alignment (unused)
+    pub _pad: [u8; 3],
+}
+
+impl WideResult {
+    /// Widen a `Result`, taking over its allocation (no copy)
+    #[inline]
+    pub fn from_result(r: Result) -> Self {
+        Self {
+            chars: r.chars,
+            capacity: r.capacity,
+            backspace: r.backspace as u32,
+            count: r.count as u32,
+            remaining: 0,
+            action: r.action,
+            _pad: [0; 3],
+        }
+    }
+
+    /// Create a "send" result that takes ownership of `chars` (no copy)
+    #[inline]
+    pub fn send(backspace: u32, chars: Vec<u32>, remaining: u32) -> Self {
+        let mut chars = std::mem::ManuallyDrop::new(chars);
+        let (ptr, count, capacity) = if chars.capacity() == 0 {
+            (std::ptr::null_mut(), 0, 0)
+        } else {
+            (chars.as_mut_ptr(), chars.len(), chars.capacity())
+        };
+        Self {
+            chars: ptr,
+            capacity,
+            backspace,
+            count: count as u32,
+            remaining,
+            action: Action::Send as u8,
+            _pad: [0; 3],
+        }
+    }
+
+    /// Get chars as a slice for iteration
+    #[inline]
+    pub fn as_slice(&self) -> &[u32] {
+        if self.chars.is_null() || self.count == 0 {
+            &[]
+        } else {
+            unsafe { std::slice::from_raw_parts(self.chars, self.count as usize) }
+        }
+    }
+
+    /// Free the heap chars of a result that never crosses the FFI boundary
+    #[inline]
+    pub fn release(self) {
+        if !self.chars.is_null() && self.capacity > 0 {
+            // SAFETY: chars/capacity come from a Vec (`Result::send` or `send()`)
+            unsafe {
+                drop(Vec::from_raw_parts(
+                    self.chars,
+                    self.count as usize,
+                    self.capacity,
+                ));
+            }
+        }
+    }
+}
+
 // ============================================================
 // Internal Transform Tracking
 // ============================================================
@@ -310,6 +561,47 @@ mod tests {
         assert_eq!(r.count, 0);
     }
 
+    #[test]
+    fn test_result_compose() {
+        let r = Result::compose(Action::Preedit, 0, &['v', 'i', 'ệ']);
+        assert_eq!(r.action, Action::Preedit as u8);
+        assert_eq!(r.count, 3);
+        assert!(r.requires_action());
+        assert!(!r.is_send());
+
+        let r = Result::compose(Action::Commit, 2, &[]);
+        assert_eq!(r.action, Action::Commit as u8);
+        assert_eq!(r.backspace, 2);
+        assert!(r.chars.is_null());
+    }
+
+    #[test]
+    fn test_result_send_clamps_count() {
+        // 256 chars must not wrap the u8 count to 0
+        let chars = ['a'; 256];
+        let r = Result::send(0, &chars);
+        assert_eq!(r.count, 255);
+        assert_eq!(r.as_slice().len(), 255);
+        r.release();
+    }
+
+    #[test]
+    fn test_wide_result() {
+        let w = WideResult::from_result(Result::send(2, &['v', 'i', 'ệ']));
+        assert_eq!((w.backspace, w.count, w.remaining), (2, 3, 0));
+        assert_eq!(w.as_slice()[2], 'ệ' as u32);
+        w.release();
+
+        let w = WideResult::send(3, vec!['x' as u32; 1000], 24);
+        assert_eq!((w.count, w.remaining), (1000, 24));
+        assert_eq!(w.action, Action::Send as u8);
+        w.release();
+
+        let w = WideResult::send(3, Vec::new(), 5000);
+        assert!(w.chars.is_null());
+        assert_eq!(w.count, 0);
+    }
+
     #[test]
     fn test_result_default() {
         let r = Result::default();
@@ -3,6 +3,7 @@
 //! Handles syllable parsing, tone positioning, transformations, and validation.
 
 pub mod syllable;
+pub mod syllable_id;
 pub mod tone_positioning;
 pub mod transform;
 pub mod validation;
@@ -0,0 +1,735 @@
+//! Syllable IDs - a Vietnamese syllable in two bytes
+//!
+//! Vietnamese is written with about 12k distinct toned syllables, so a
+//! committed word fits in a `u16` instead of a `Buffer` (~3KB) or a
+//! UTF-8 string. The codec is a handful of tables built at compile time:
+//! - Initials (29: none, đ, gi, qu, ngh, kr, ...) × vowel clusters (54,
+//!   diacritics included) give the (initial, cluster) pairs that the
+//!   spelling rules allow (c/k/q, g/gh, ng/ngh, gi, iê/yê)
+//! - Each cluster allows a set of finals. Open syllables and m/n/ng/nh
+//!   take all 6 tones, stop finals (c, ch, p, t, k) only sắc and nặng
+//! - IDs are dense: `case × SYLLABLES + PAIR_BASE[pair] + final + tone`
+//!
+//! Case is part of the ID (lower, Title, UPPER). Mixed case ("iPhone"),
+//! foreign words and syllables outside the tables have no ID. The mark
+//! position is not stored: decoding places it with the engine's tone
+//! rules, old or modern style (`hòa` and `hoà` share an ID).
+//!
+//! # Performance
+//!
+//! - Encode: one pass over the word + two short table scans, no allocation
+//! - Decode: binary search over the pair bases, UTF-32 into a caller slice
+
+use crate::data::chars::{self, mark, tone};
+use crate::data::keys;
+use crate::data::vowel::{Modifier, Phonology, Vowel};
+use crate::engine::buffer::Char;
+
+/// Longest syllable in characters ("nghiêng" is 7)
+pub const MAX_SYLLABLE_LEN: usize = 8;
+
+/// Letter case stored in the ID
+#[repr(u8)]
+#[derive(Clone, Copy, Debug, PartialEq, Eq)]
+pub enum SyllableCase {
+    /// "việt"
+    Lower = 0,
+    /// "Việt" (also one-letter words in capitals: "Á")
+    Title = 1,
+    /// "VIỆT"
+    Upper = 2,
+}
+
+const CASES: [SyllableCase; 3] = [
+    SyllableCase::Lower,
+    SyllableCase::Title,
+    SyllableCase::Upper,
+];
+
+// =============================================================================
+// TABLES
+// =============================================================================
+
+use keys::{A, B, C, D, E, G, H, I, K, L, M, N, O, P, Q, R, S, T, U, V, X, Y};
+const T0: u8 = tone::NONE;
+const CF: u8 = tone::CIRCUMFLEX;
+const HN: u8 = tone::HORN;
+
+/// Initial consonants: keys, and whether the `d` is đ
+const INITIALS: [(&[u16], bool); 29] = [
+    (&[], false),
+    (&[B], false),
+    (&[C], false),
+    (&[C, H], false),
+    (&[D], false),
+    (&[D], true),
+    (&[G], false),
+    (&[G, H], false),
+    (&[G, I], false),
+    (&[H], false),
+    (&[K], false),
+    (&[K, H], false),
+    (&[K, R], false),
+    (&[L], false),
+    (&[M], false),
+    (&[N], false),
+    (&[N, G], false),
+    (&[N, G, H], false),
+    (&[N, H], false),
+    (&[P], false),
+    (&[P, H], false),
+    (&[Q, U], false),
+    (&[R], false),
+    (&[S], false),
+    (&[T], false),
+    (&[T, H], false),
+    (&[T, R], false),
+    (&[V], false),
+    (&[X], false),
+];
+
+/// Final consonants (bit `f` of a cluster's mask allows `FINALS[f]`)
+const FINALS: [&[u16]; 10] = [
+    &[],
+    &[C],
+    &[C, H],
+    &[M],
+    &[N],
+    &[N, G],
+    &[N, H],
+    &[P],
+    &[T],
+    &[K],
+];
+
+const OPEN: u16 = 1 << 0;
+const F_C: u16 = 1 << 1;
+const F_CH: u16 = 1 << 2;
+const F_M: u16 = 1 << 3;
+const F_N: u16 = 1 << 4;
+const F_NG: u16 = 1 << 5;
+const F_NH: u16 = 1 << 6;
+const F_P: u16 = 1 << 7;
+const F_T: u16 = 1 << 8;
+const F_K: u16 = 1 << 9;
+
+/// Stop finals: only sắc and nặng
+const STOPS: u16 = F_C | F_CH | F_P | F_T | F_K;
+
+/// Vowel clusters (key, tone) and the finals they take
+const CLUSTERS: [(&[(u16, u8)], u16); 54] = [
+    // Single vowels
+    (
+        &[(A, T0)],
+        OPEN | F_C | F_CH | F_M | F_N | F_NG | F_NH | F_P | F_T | F_K,
+    ),
+    (&[(A, HN)], F_C | F_M | F_N | F_NG | F_P | F_T | F_K),
+    (&[(A, CF)], F_C | F_M | F_N | F_NG | F_P | F_T | F_K),
+    (
+        &[(E, T0)],
+        OPEN | F_C | F_CH | F_M | F_N | F_NG | F_NH | F_P | F_T,
+    ),
+    (
+        &[(E, CF)],
+        OPEN | F_C | F_CH | F_M | F_N | F_NG | F_NH | F_P | F_T,
+    ),
+    (
+        &[(I, T0)],
+        OPEN | F_C | F_CH | F_M | F_N | F_NG | F_NH | F_P | F_T,
+    ),
+    (
+        &[(O, T0)],
+        OPEN | F_C | F_CH | F_M | F_N | F_NG | F_NH | F_P | F_T | F_K,
+    ),
+    (&[(O, CF)], OPEN | F_C | F_M | F_N | F_NG | F_P | F_T | F_K),
+    (&[(O, HN)], OPEN | F_C | F_M | F_N | F_NG | F_P | F_T),
+    (
+        &[(U, T0)],
+        OPEN | F_C | F_M | F_N | F_NG | F_NH | F_P | F_T | F_K,
+    ),
+    (&[(U, HN)], OPEN | F_C | F_M | F_N | F_NG | F_P | F_T | F_K),
+    (&[(Y, T0)], OPEN | F_CH | F_M | F_N | F_NH | F_P | F_T),
+    // Diphthongs
+    (&[(A, T0), (I, T0)], OPEN),
+    (&[(A, T0), (O, T0)], OPEN),
+    (&[(A, T0), (U, T0)], OPEN),
+    (&[(A, T0), (Y, T0)], OPEN),
+    (&[(A, CF), (U, T0)], OPEN),
+    (&[(A, CF), (Y, T0)], OPEN),
+    (&[(E, T0), (O, T0)], OPEN),
+    (&[(E, CF), (U, T0)], OPEN),
+    (&[(I, T0), (A, T0)], OPEN),
+    (&[(I, T0), (E, CF)], F_C | F_M | F_N | F_NG | F_P | F_T),
+    (&[(I, T0), (U, T0)], OPEN),
+    (
+        &[(O, T0), (A, T0)],
+        OPEN | F_C | F_CH | F_M | F_N | F_NG | F_NH | F_P | F_T,
+    ),
+    (&[(O, T0), (A, HN)], F_C | F_M | F_N | F_NG | F_P | F_T),
+    (&[(O, T0), (E, T0)], OPEN | F_C | F_M | F_N | F_NG | F_T),
+    (&[(O, T0), (I, T0)], OPEN),
+    (&[(O, T0), (O, T0)], F_C | F_NG),
+    (&[(O, CF), (I, T0)], OPEN),
+    (&[(O, HN), (I, T0)], OPEN),
+    (&[(U, T0), (A, T0)], OPEN),
+    (&[(U, T0), (A, CF)], F_C | F_N | F_NG | F_T),
+    (&[(U, T0), (E, CF)], OPEN | F_CH | F_N | F_NH | F_T),
+    (&[(U, T0), (I, T0)], OPEN),
+    (&[(U, T0), (O, CF)], F_C | F_M | F_N | F_NG | F_P | F_T),
+    (&[(U, T0), (O, HN)], OPEN),
+    (&[(U, T0), (Y, T0)], OPEN | F_CH | F_N | F_NH | F_P | F_T),
+    (&[(U, HN), (A, T0)], OPEN),
+    (&[(U, HN), (I, T0)], OPEN),
+    (&[(U, HN), (O, HN)], F_C | F_M | F_N | F_NG | F_P | F_T),
+    (&[(U, HN), (U, T0)], OPEN),
+    (&[(Y, T0), (E, CF)], F_C | F_M | F_N | F_NG | F_P | F_T),
+    // Triphthongs
+    (&[(I, T0), (E, CF), (U, T0)], OPEN),
+    (&[(O, T0), (A, T0), (I, T0)], OPEN),
+    (&[(O, T0), (A, T0), (Y, T0)], OPEN),
+    (&[(O, T0), (E, T0), (O, T0)], OPEN),
+    (&[(U, T0), (A, CF), (Y, T0)], OPEN),
+    (&[(U, T0), (O, CF), (I, T0)], OPEN),
+    (&[(U, HN), (O, HN), (I, T0)], OPEN),
+    (&[(U, HN), (O, HN), (U, T0)], OPEN),
+    (&[(U, T0), (Y, T0), (A, T0)], OPEN),
+    (&[(U, T0), (Y, T0), (E, CF)], F_N | F_T),
+    (&[(U, T0), (Y, T0), (U, T0)], OPEN),
+    (&[(Y, T0), (E, CF), (U, T0)], OPEN),
+];
+
+const NI: usize = INITIALS.len();
+const NC: usize = CLUSTERS.len();
+const NF: usize = FINALS.len();
+
+const fn is_stop(f: usize) -> bool {
+    STOPS >> f & 1 == 1
+}
+
+/// Tones a final takes
+const fn final_width(f: usize) -> u8 {
+    if is_stop(f) {
+        2
+    } else {
+        6
+    }
+}
+
+/// Whether the spelling rules allow `initial` before `cluster`
+const fn pair_allowed(initial: &[u16], cluster: &[(u16, u8)]) -> bool {
+    let first = cluster[0].0;
+    let front = matches!(first, I | E | Y);
+    // yê(u) is spelled iê(u) after a consonant, and only stands alone
+    let ye = first == Y && cluster.len() > 1;
+    let ie = first == I && cluster.len() > 1 && cluster[1].0 == E;
+    match initial {
+        [] => !ie,
+        // k, gh, ngh only before i, e, ê, y; c, g, ng elsewhere
+        [K] | [G, H] | [N, G, H] => front && !ye,
+        [C] | [N, G] => !front,
+        // gì, gìn: g + i (gia, giu are gi + a, gi + u)
+        [G] => !front || (first == I && cluster.len() == 1),
+        [G, I] => first != I && first != Y,
+        [Q, U] => first != U,
+        _ => !ye,
+    }
+}
+
+/// Slot offset of each final inside its cluster (`[NF]`: cluster width)
+const FINAL_OFFSETS: [[u8; NF + 1]; NC] = {
+    let mut table = [[0u8; NF + 1]; NC];
+    let mut c = 0;
+    while c < NC {
+        let mut offset = 0;
+        let mut f = 0;
+        while f < NF {
+            table[c][f] = offset;
+            if CLUSTERS[c].1 >> f & 1 == 1 {
+                offset += final_width(f);
+            }
+            f += 1;
+        }
+        table[c][NF] = offset;
+        c += 1;
+    }
+    table
+};
+
+/// First slot of each (initial, cluster) pair, `initial × NC + cluster`;
+/// pairs the spelling rules forbid get no slots
+const PAIR_BASE: [u16; NI * NC + 1] = {
+    let mut base = [0u16; NI * NC + 1];
+    let mut next = 0u16;
+    let mut i = 0;
+    while i < NI {
+        let mut c = 0;
+        while c < NC {
+            base[i * NC + c] = next;
+            if pair_allowed(INITIALS[i].0, CLUSTERS[c].0) {
+                next += FINAL_OFFSETS[c][NF] as u16;
+            }
+            c += 1;
+        }
+        i += 1;
+    }
+    base[NI * NC] = next;
+    base
+};
+
+/// Syllables per case
+pub const SYLLABLES: usize = PAIR_BASE[NI * NC] as usize;
+
+/// IDs in use: `0..ID_COUNT`
+pub const ID_COUNT: usize = CASES.len() * SYLLABLES;
+
+const _: () = assert!(ID_COUNT <= u16::MAX as usize);
+
+/// 5 bits per vowel: key and tone
+const fn vowel_code(key: u16, t: u8) -> u16 {
+    let v = match key {
+        A => 0,
+        E => 1,
+        I => 2,
+        O => 3,
+        U => 4,
+        _ => 5,
+    };
+    v * 3 + t as u16 + 1
+}
+
+/// Clusters packed for lookup (3 vowels × 5 bits)
+const CLUSTER_CODES: [u16; NC] = {
+    let mut codes = [0u16; NC];
+    let mut c = 0;
+    while c < NC {
+        let letters = CLUSTERS[c].0;
+        let mut code = 0;
+        let mut i = 0;
+        while i < letters.len() {
+            code = code << 5 | vowel_code(letters[i].0, letters[i].1);
+            i += 1;
+        }
+        codes[c] = code;
+        c += 1;
+    }
+    codes
+};
+
+const fn cluster_hash(code: u16) -> usize {
+    ((code as u32).wrapping_mul(0x9E37_79B1) >> 25) as usize
+}
+
+/// Open-addressed lookup of `CLUSTER_CODES` (cluster index + 1, 0 = empty)
+const CLUSTER_TABLE: [u8; 128] = {
+    let mut table = [0u8; 128];
+    let mut c = 0;
+    while c < NC {
+        let mut h = cluster_hash(CLUSTER_CODES[c]);
+        while table[h] != 0 {
+            h = (h + 1) % 128;
+        }
+        table[h] = c as u8 + 1;
+        c += 1;
+    }
+    table
+};
+
+/// First initial starting with each key (0: none). Initials are sorted,
+/// so the ones sharing a first key follow it.
+const INITIAL_RUNS: [u8; 64] = {
+    let mut runs = [0u8; 64];
+    let mut i = NI;
+    while i > 1 {
+        i -= 1;
+        runs[INITIALS[i].0[0] as usize] = i as u8;
+    }
+    runs
+};
+
+// =============================================================================
+// ENCODE
+// =============================================================================
+
+/// Plain consonant (no tone, mark or stroke) with this key
+#[inline]
+fn is_plain(c: &Char, key: u16) -> bool {
+    c.key == key && c.tone == T0 && c.mark == mark::NONE && !c.stroke
+}
+
+/// Longest initial that `chars` starts with: (index, length)
+fn match_initial(chars: &[Char]) -> (usize, usize) {
+    let first = chars[0].key;
+    let mut best = (0, 0);
+    let mut i = INITIAL_RUNS.get(first as usize).copied().unwrap_or(0) as usize;
+    while i != 0 && i < NI && INITIALS[i].0[0] == first {
+        let (initial, stroke) = INITIALS[i];
+        let n = initial.len();
+        let matches = n <= chars.len()
+            && initial.iter().zip(chars).enumerate().all(|(j, (&key, c))| {
+                if stroke {
+                    c.key == key && c.tone == T0 && c.stroke
+                } else if j > 0 && matches!(key, I | U) {
+                    // The vowel of gi/qu (a mark here is placed by decode anyway)
+                    c.key == key && c.tone == T0 && !c.stroke
+                } else {
+                    is_plain(c, key)
+                }
+            });
+        // gi needs a vowel after it, qu anything
+        let follows = match initial {
+            [G, I] => chars.get(2).is_some_and(|c| keys::is_vowel(c.key)),
+            [Q, U] => chars.len() > 2,
+            _ => true,
+        };
+        if matches && follows && n > best.1 {
+            best = (i, n);
+        }
+        i += 1;
+    }
+    best
+}
+
+/// Cluster with this code
+#[inline]
+fn find_cluster(code: u16) -> Option<usize> {
+    let mut h = cluster_hash(code);
+    loop {
+        match CLUSTER_TABLE[h] {
+            0 => return None,
+            c if CLUSTER_CODES[c as usize - 1] == code => return Some(c as usize - 1),
+            _ => h = (h + 1) % CLUSTER_TABLE.len(),
+        }
+    }
+}
+
+/// Encode a word of buffer chars; None if it is not a Vietnamese syllable
+/// in the tables or mixes cases
+pub fn encode(chars: &[Char]) -> Option<u16> {
+    let len = chars.len();
+    if len == 0 || len > MAX_SYLLABLE_LEN {
+        return None;
+    }
+    let caps = chars.iter().filter(|c| c.caps).count();
+    let case = match caps {
+        0 => SyllableCase::Lower,
+        1 if chars[0].caps => SyllableCase::Title,
+        n if n == len => SyllableCase::Upper,
+        _ => return None,
+    };
+
+    // At most one mark, on a vowel
+    let mut m = mark::NONE;
+    for c in chars {
+        if c.mark != mark::NONE {
+            if m != mark::NONE || !keys::is_vowel(c.key) {
+                return None;
+            }
+            m = c.mark;
+        }
+    }
+
+    let (initial, start) = match_initial(chars);
+    let rest = &chars[start..];
+    let vowels = rest
+        .iter()
+        .position(|c| !keys::is_vowel(c.key))
+        .unwrap_or(rest.len());
+    if vowels == 0 || vowels > 3 {
+        return None;
+    }
+    let mut code = 0;
+    for c in &rest[..vowels] {
+        if c.stroke {
+            return None;
+        }
+        code = code << 5 | vowel_code(c.key, c.tone);
+    }
+    let cluster = find_cluster(code)?;
+    let tail = &rest[vowels..];
+    let fin = FINALS.iter().position(|f| {
+        f.len() == tail.len() && f.iter().zip(tail).all(|(&key, c)| is_plain(c, key))
+    })?;
+    if CLUSTERS[cluster].1 >> fin & 1 == 0 {
+        return None;
+    }
+
+    let pair = initial * NC + cluster;
+    if PAIR_BASE[pair + 1] == PAIR_BASE[pair] {
+        return None;
+    }
+    let t = if is_stop(fin) {
+        match m {
+            mark::SAC => 0,
+            mark::NANG => 1,
+            _ => return None,
+        }
+    } else {
+        m
+    };
+    let slot = PAIR_BASE[pair] as usize + FINAL_OFFSETS[cluster][fin] as usize + t as usize;
+    Some((case as usize * SYLLABLES + slot) as u16)
+}
+
+/// Encode a word of text ("Việt")
+pub fn encode_str(word: &str) -> Option<u16> {
+    let mut chars = [Char::default(); MAX_SYLLABLE_LEN];
+    let mut len = 0;
+    for ch in word.chars() {
+        let p = chars::parse_char(ch)?;
+        *chars.get_mut(len)? = Char {
+            key: p.key,
+            caps: p.caps,
+            tone: p.tone,
+            mark: p.mark,
+            stroke: p.stroke,
+        };
+        len += 1;
+    }
+    encode(&chars[..len])
+}
+
+// =============================================================================
+// DECODE
+// =============================================================================
+
+/// Components of an ID
+struct Parts {
+    case: SyllableCase,
+    initial: usize,
+    cluster: usize,
+    fin: usize,
+    mark: u8,
+}
+
+fn parts(id: u16) -> Option<Parts> {
+    let id = id as usize;
+    if id >= ID_COUNT {
+        return None;
+    }
+    let case = CASES[id / SYLLABLES];
+    let slot = id % SYLLABLES;
+    let pair = PAIR_BASE.partition_point(|&b| b as usize <= slot) - 1;
+    let (initial, cluster) = (pair / NC, pair % NC);
+    let k = slot - PAIR_BASE[pair] as usize;
+    let offsets = &FINAL_OFFSETS[cluster];
+    let fin = (0..NF)
+        .rev()
+        .find(|&f| CLUSTERS[cluster].1 >> f & 1 == 1 && offsets[f] as usize <= k)?;
+    let t = (k - offsets[fin] as usize) as u8;
+    let mark = if is_stop(fin) {
+        [mark::SAC, mark::NANG][t as usize]
+    } else {
+        t
+    };
+    // One-letter words in capitals encode as Title
+    let one_letter = initial == 0 && fin == 0 && CLUSTERS[cluster].0.len() == 1;
+    if case == SyllableCase::Upper && one_letter {
+        return None;
+    }
+    Some(Parts {
+        case,
+        initial,
+        cluster,
+        fin,
+        mark,
+    })
+}
+
+/// Case stored in an ID (None for IDs not in use)
+pub fn case_of(id: u16) -> Option<SyllableCase> {
+    parts(id).map(|p| p.case)
+}
+
+/// The same syllable in another case
+pub fn with_case(id: u16, case: SyllableCase) -> Option<u16> {
+    parts(id)?;
+    let slot = id as usize % SYLLABLES;
+    let to = |case: SyllableCase| (case as usize * SYLLABLES + slot) as u16;
+    // One-letter words in capitals are Title
+    Some(match parts(to(case)) {
+        Some(_) => to(case),
+        None => to(SyllableCase::Title),
+    })
+}
+
+/// Write the syllable of `id` as UTF-32 into `out`, placing the mark in
+/// `modern` or old style. Returns the length (0: unknown ID or `out` too
+/// short; `MAX_SYLLABLE_LEN` always fits).
+pub fn decode(id: u16, modern: bool, out: &mut [u32]) -> usize {
+    let Some(p) = parts(id) else {
+        return 0;
+    };
+    let (initial, stroke) = INITIALS[p.initial];
+    let cluster = CLUSTERS[p.cluster].0;
+    let fin = FINALS[p.fin];
+    let len = initial.len() + cluster.len() + fin.len();
+    if out.len() < len {
+        return 0;
+    }
+
+    // Mark position inside the cluster, by the engine's rules
+    let mut vowels = [Vowel::new(A, Modifier::None, 0); 3];
+    for (i, &(key, t)) in cluster.iter().enumerate() {
+        let modifier = match t {
+            CF => Modifier::Circumflex,
+            HN => Modifier::Horn,
+            _ => Modifier::None,
+        };
+        vowels[i] = Vowel::new(key, modifier, i);
+    }
+    let mark_at = Phonology::find_tone_position(
+        &vowels[..cluster.len()],
+        p.fin != 0,
+        modern,
+        initial == [Q, U],
+        initial == [G, I],
+    );
+
+    let caps = |pos: usize| match p.case {
+        SyllableCase::Lower => false,
+        SyllableCase::Title => pos == 0,
+        SyllableCase::Upper => true,
+    };
+    let mut pos = 0;
+    for &key in initial {
+        let c = if stroke {
+            chars::get_d(caps(pos))
+        } else {
+            keys::key_to_char(key, caps(pos)).unwrap_or('?')
+        };
+        out[pos] = c as u32;
+        pos += 1;
+    }
+    for (i, &(key, t)) in cluster.iter().enumerate() {
+        let m = if i == mark_at { p.mark } else { mark::NONE };
+        out[pos] = chars::to_char(key, caps(pos), t, m).unwrap_or('?') as u32;
+        pos += 1;
+    }
+    for &key in fin {
+        out[pos] = keys::key_to_char(key, caps(pos)).unwrap_or('?') as u32;
+        pos += 1;
+    }
+    len
+}
+
+/// Decode to a `String` (not for the hot path)
+pub fn decode_string(id: u16, modern: bool) -> Option<String> {
+    let mut out = [0u32; MAX_SYLLABLE_LEN];
+    let len = decode(id, modern, &mut out);
+    (len > 0).then(|| {
+        out[..len]
+            .iter()
+            .filter_map(|&c| char::from_u32(c))
+            .collect()
+    })
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_round_trips() {
+        for word in [
+            "việt",
+            "Nguyễn",
+            "ĐƯỜNG",
+            "quốc",
+            "gì",
+            "gìn",
+            "giá",
+            "giường",
+            "nghiêng",
+            "khuếch",
+            "yêu",
+            "quyền",
+            "khuỷu",
+            "thuở",
+            "Đắk",
+            "xoong",
+            "a",
+            "Á",
+            "ở",
+        ] {
+            let id = encode_str(word).unwrap_or_else(|| panic!("{word}"));
+            assert_eq!(decode_string(id, true).as_deref(), Some(word));
+        }
+    }
+
+    #[test]
+    fn test_mark_position_is_not_stored() {
+        let id = encode_str("hoà").unwrap();
+        assert_eq!(encode_str("hòa"), Some(id));
+        assert_eq!(decode_string(id, true).unwrap(), "hoà");
+        assert_eq!(decode_string(id, false).unwrap(), "hòa");
+        assert_eq!(
+            decode_string(encode_str("quý").unwrap(), false).unwrap(),
+            "quý"
+        );
+    }
+
+    #[test]
+    fn test_case() {
+        let lower = encode_str("việt").unwrap();
+        let title = encode_str("Việt").unwrap();
+        let upper = encode_str("VIỆT").unwrap();
+        assert_eq!(case_of(lower), Some(SyllableCase::Lower));
+        assert_eq!(case_of(title), Some(SyllableCase::Title));
+        assert_eq!(case_of(upper), Some(SyllableCase::Upper));
+        assert_eq!(with_case(upper, SyllableCase::Lower), Some(lower));
+        assert_eq!(with_case(lower, SyllableCase::Title), Some(title));
+        // One-letter words have no UPPER form
+        let a = encode_str("á").unwrap();
+        assert_eq!(with_case(a, SyllableCase::Upper), encode_str("Á"));
+        assert_eq!(encode_str("vIệt"), None);
+    }
+
+    #[test]
+    fn test_rejects() {
+        for word in [
+            "",
+            "iPhone",
+            "viet",
+            "mat",
+            "mảt",
+            "ka",
+            "ge",
+            "ngi",
+            "iên",
+            "tyên",
+            "quu",
+            "fan",
+            "nghiêngg",
+            "đđ",
+            "xyz",
+        ] {
+            assert_eq!(encode_str(word), None, "{word}");
+        }
+        assert_eq!(decode_string(u16::MAX, true), None);
+        assert_eq!(decode(encode_str("nghiêng").unwrap(), true, &mut [0; 4]), 0);
+    }
+
+    #[test]
+    fn test_every_id_round_trips() {
+        assert!((12_000..=u16::MAX as usize / 3).contains(&SYLLABLES));
+        let mut out = [0u32; MAX_SYLLABLE_LEN];
+        let mut used = 0;
+        for id in 0..=u16::MAX {
+            for modern in [true, false] {
+                let len = decode(id, modern, &mut out);
+                if len == 0 {
+                    continue;
+                }
+                assert!((id as usize) < ID_COUNT);
+                used += modern as usize;
+                let word: String = out[..len]
+                    .iter()
+                    .filter_map(|&c| char::from_u32(c))
+                    .collect();
+                assert_eq!(encode_str(&word), Some(id), "{word}");
+            }
+        }
+        // All but the UPPER forms of the 10 one-letter words × 6 tones
+        assert_eq!(used, ID_COUNT - 60);
+    }
+}
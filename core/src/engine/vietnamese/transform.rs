@@ -152,7 +152,7 @@ fn find_tone_targets(buf: &Buffer, key: u16, tone_value: u8, method: u8) -> Vec<
         }
         // w → horn/breve
         else if tone_value == tone::HORN && key == keys::W {
-            targets = Phonology::find_horn_positions(buffer_keys, &vowel_positions);
+            targets = Phonology::find_horn_positions(buffer_keys, &vowel_positions).to_vec();
         }
     }
     // VNI patterns
@@ -168,7 +168,7 @@ fn find_tone_targets(buf: &Buffer, key: u16, tone_value: u8, method: u8) -> Vec<
         }
         // 7 → horn for o, u
         else if tone_value == tone::HORN && key == keys::N7 {
-            targets = Phonology::find_horn_positions(buffer_keys, &vowel_positions);
+            targets = Phonology::find_horn_positions(buffer_keys, &vowel_positions).to_vec();
         }
         // 8 → breve for a only
         else if tone_value == tone::HORN && key == keys::N8 {
@@ -10,6 +10,30 @@ use crate::engine_v2::english::dictionary_data;
 pub struct Dictionary;
 
 impl Dictionary {
+    /// Fault in the embedded word lists now rather than on the first lookup
+    ///
+    /// Blocks while touching ~1.4MB; see `prefetch_in_background`.
+    /// Returns the bytes covered (0 without the `dictionaries` feature).
+    pub fn prefetch() -> usize {
+        dictionary_data::prefetch()
+    }
+
+    /// Run `prefetch` on a short-lived background thread
+    ///
+    /// Returns false if there is nothing to prefetch (built without
+    /// `dictionaries` or `english-detection`) or the thread could not start.
+    pub fn prefetch_in_background() -> bool {
+        if !cfg!(feature = "dictionaries") || !cfg!(feature = "english-detection") {
+            return false;
+        }
+        std::thread::Builder::new()
+            .name("goxviet-prefetch".into())
+            .spawn(|| {
+                Self::prefetch();
+            })
+            .is_ok()
+    }
+
     /// Check if a sequence of keys is a common English word or programming term
     pub fn is_english(keys: &[u16]) -> bool {
         if keys.len() < 2 {
@@ -477,7 +501,7 @@ fn has_programming_term_pattern(keys: &[u16]) -> bool {
     false
 }
 
-#[cfg(test)]
+#[cfg(all(test, feature = "dictionaries"))]
 mod tests {
     use super::*;
 
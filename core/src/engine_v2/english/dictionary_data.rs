@@ -48,21 +48,53 @@ fn binary_search_in_bytes(data: &[u8], target: &[u16]) -> bool {
     false
 }
 
-static DATA_2: &[u8] = include_bytes!("data/common_2chars.bin");
-static DATA_3: &[u8] = include_bytes!("data/common_3chars.bin");
-static DATA_4: &[u8] = include_bytes!("data/common_4chars.bin");
-static DATA_5: &[u8] = include_bytes!("data/common_5chars.bin");
-static DATA_6: &[u8] = include_bytes!("data/common_6chars.bin");
-static DATA_7: &[u8] = include_bytes!("data/common_7chars.bin");
-static DATA_8: &[u8] = include_bytes!("data/common_8chars.bin");
-static DATA_9: &[u8] = include_bytes!("data/common_9chars.bin");
-static DATA_10: &[u8] = include_bytes!("data/common_10chars.bin");
-static DATA_11: &[u8] = include_bytes!("data/common_11chars.bin");
-static DATA_12: &[u8] = include_bytes!("data/common_12chars.bin");
-static DATA_13: &[u8] = include_bytes!("data/common_13chars.bin");
-static DATA_14: &[u8] = include_bytes!("data/common_14chars.bin");
-static DATA_15: &[u8] = include_bytes!("data/common_15chars.bin");
-static DATA_16: &[u8] = include_bytes!("data/common_16chars.bin");
+/// Word list `data/common_<n>chars.bin`, or empty without the
+/// `dictionaries` feature (lookups then never match)
+macro_rules! word_list {
+    ($name:ident, $file:literal) => {
+        #[cfg(feature = "dictionaries")]
+        static $name: &[u8] = include_bytes!($file);
+        #[cfg(not(feature = "dictionaries"))]
+        static $name: &[u8] = &[];
+    };
+}
+
+word_list!(DATA_2, "data/common_2chars.bin");
+word_list!(DATA_3, "data/common_3chars.bin");
+word_list!(DATA_4, "data/common_4chars.bin");
+word_list!(DATA_5, "data/common_5chars.bin");
+word_list!(DATA_6, "data/common_6chars.bin");
+word_list!(DATA_7, "data/common_7chars.bin");
+word_list!(DATA_8, "data/common_8chars.bin");
+word_list!(DATA_9, "data/common_9chars.bin");
+word_list!(DATA_10, "data/common_10chars.bin");
+word_list!(DATA_11, "data/common_11chars.bin");
+word_list!(DATA_12, "data/common_12chars.bin");
+word_list!(DATA_13, "data/common_13chars.bin");
+word_list!(DATA_14, "data/common_14chars.bin");
+word_list!(DATA_15, "data/common_15chars.bin");
+word_list!(DATA_16, "data/common_16chars.bin");
+
+/// Touch every page of the word lists so later lookups don't fault
+///
+/// Reads one byte per 4 KiB (volatile, so it is not optimized away).
+/// Returns the number of bytes covered; 0 without `dictionaries`.
+pub fn prefetch() -> usize {
+    const PAGE: usize = 4096;
+    let lists = [
+        DATA_2, DATA_3, DATA_4, DATA_5, DATA_6, DATA_7, DATA_8, DATA_9, DATA_10, DATA_11, DATA_12,
+        DATA_13, DATA_14, DATA_15, DATA_16,
+    ];
+    let mut total = 0;
+    for data in lists {
+        for offset in (0..data.len()).step_by(PAGE) {
+            // SAFETY: offset < data.len()
+            unsafe { std::ptr::read_volatile(data.as_ptr().add(offset)) };
+        }
+        total += data.len();
+    }
+    total
+}
 
 #[inline]
 pub fn is_common_2letter_word(word: &[u16; 2]) -> bool {
@@ -7,6 +7,18 @@ pub struct DecisionResult {
     pub confidence: u8,
 }
 
+/// Learned per-word language preference (see `restore_learning`)
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Default)]
+pub enum LanguageBias {
+    /// No learned preference - use the normal decision layers
+    #[default]
+    None,
+    /// User restored this sequence to English before
+    English,
+    /// User undid an English auto-restore of this sequence before
+    Vietnamese,
+}
+
 pub struct LanguageDecisionEngine;
 
 impl LanguageDecisionEngine {
@@ -1,4 +1,6 @@
 pub mod dictionary;
 pub mod dictionary_data;
 pub mod language_decision;
+pub mod overrides;
 pub mod phonotactic;
+pub mod restore_learning;
@@ -0,0 +1,244 @@
+//! User Override Lists - always-English / always-Vietnamese keystroke sequences
+//!
+//! Lets users (or the app) pin specific raw keystroke sequences to a
+//! language at runtime, instead of patching `Dictionary::is_keys_english`.
+//! Entries are the ASCII letters as typed, e.g. `hex` (English) or `mas`
+//! (Vietnamese, Telex for "má").
+//!
+//! ## Storage
+//!
+//! Each sequence of up to 25 letters is packed into a `u128` (5 bits per
+//! letter, `a` = 1 … `z` = 26, so different lengths never collide). Keys are
+//! grouped by hash bucket in one flat array with a CSR offset table:
+//!
+//! ```text
+//! offsets [u32; buckets + 1]   keys[offsets[b]..offsets[b + 1]] = bucket b
+//! keys    [u128; n]            ~2 keys per bucket on average
+//! ```
+//!
+//! Lookup is one hash, one offset pair and a short scan: O(1) with no
+//! pointer chasing and no empty slots (~18 bytes per entry).
+
+use crate::data::keys;
+
+/// Maximum letters per override entry (5 bits each in a u128)
+pub const MAX_OVERRIDE_LEN: usize = 25;
+
+/// Letter index (1..=26) for a macOS keycode, 0 if not a letter
+const fn letter_index(key: u16) -> u8 {
+    match key {
+        keys::A => 1,
+        keys::B => 2,
+        keys::C => 3,
+        keys::D => 4,
+        keys::E => 5,
+        keys::F => 6,
+        keys::G => 7,
+        keys::H => 8,
+        keys::I => 9,
+        keys::J => 10,
+        keys::K => 11,
+        keys::L => 12,
+        keys::M => 13,
+        keys::N => 14,
+        keys::O => 15,
+        keys::P => 16,
+        keys::Q => 17,
+        keys::R => 18,
+        keys::S => 19,
+        keys::T => 20,
+        keys::U => 21,
+        keys::V => 22,
+        keys::W => 23,
+        keys::X => 24,
+        keys::Y => 25,
+        keys::Z => 26,
+        _ => 0,
+    }
+}
+
+/// Pack a keycode sequence (letters only, up to 25)
+#[inline]
+pub fn pack_keys<I: IntoIterator<Item = u16>>(keys: I) -> Option<u128> {
+    let mut packed = 0u128;
+    for (i, key) in keys.into_iter().enumerate() {
+        let idx = letter_index(key);
+        if idx == 0 || i >= MAX_OVERRIDE_LEN {
+            return None;
+        }
+        packed = (packed << 5) | idx as u128;
+    }
+    (packed != 0).then_some(packed)
+}
+
+/// Pack an ASCII word (case-insensitive, letters only, up to 25)
+pub fn pack_word(word: &str) -> Option<u128> {
+    let mut packed = 0u128;
+    for (i, b) in word.bytes().enumerate() {
+        let b = b.to_ascii_lowercase();
+        if !b.is_ascii_lowercase() || i >= MAX_OVERRIDE_LEN {
+            return None;
+        }
+        packed = (packed << 5) | (b - b'a' + 1) as u128;
+    }
+    (packed != 0).then_some(packed)
+}
+
+#[inline]
+fn hash(packed: u128) -> u64 {
+    let x = (packed as u64) ^ ((packed >> 64) as u64).rotate_left(29);
+    // splitmix64 finalizer
+    let x = (x ^ (x >> 30)).wrapping_mul(0xbf58_476d_1ce4_e5b9);
+    let x = (x ^ (x >> 27)).wrapping_mul(0x94d0_49bb_1331_11eb);
+    x ^ (x >> 31)
+}
+
+/// Immutable set of packed keystroke sequences
+#[derive(Debug, Clone)]
+pub struct OverrideSet {
+    /// Number of hash bits used to select a bucket
+    bits: u32,
+    offsets: Vec<u32>,
+    keys: Vec<u128>,
+}
+
+impl OverrideSet {
+    /// Build from packed keys (duplicates are removed)
+    pub fn from_packed(mut packed: Vec<u128>) -> Self {
+        packed.sort_unstable();
+        packed.dedup();
+
+        // ~2 keys per bucket
+        let bits = (packed.len() / 2)
+            .max(1)
+            .next_power_of_two()
+            .trailing_zeros();
+        let buckets = 1usize << bits;
+        let bucket_of = |k: u128| -> usize {
+            if bits == 0 {
+                0
+            } else {
+                (hash(k) >> (64 - bits)) as usize
+            }
+        };
+
+        let mut offsets = vec![0u32; buckets + 1];
+        for &k in &packed {
+            offsets[bucket_of(k) + 1] += 1;
+        }
+        for b in 0..buckets {
+            offsets[b + 1] += offsets[b];
+        }
+        let mut fill = offsets.clone();
+        let mut keys = vec![0u128; packed.len()];
+        for &k in &packed {
+            let b = bucket_of(k);
+            keys[fill[b] as usize] = k;
+            fill[b] += 1;
+        }
+
+        Self {
+            bits,
+            offsets,
+            keys,
+        }
+    }
+
+    /// Parse newline-separated ASCII words
+    ///
+    /// Blank lines and `#` comments are skipped; only the first
+    /// whitespace-separated column is used (so `word\tnote` files work).
+    /// Returns the set and the number of lines rejected (non-letters or
+    /// longer than `MAX_OVERRIDE_LEN`).
+    pub fn parse(text: &str) -> (Self, usize) {
+        let mut packed = Vec::new();
+        let mut rejected = 0;
+        for line in text.lines() {
+            let word = match line.split_whitespace().next() {
+                Some(w) if !w.starts_with('#') => w,
+                _ => continue,
+            };
+            match pack_word(word) {
+                Some(p) => packed.push(p),
+                None => rejected += 1,
+            }
+        }
+        (Self::from_packed(packed), rejected)
+    }
+
+    /// Number of entries
+    pub fn len(&self) -> usize {
+        self.keys.len()
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.keys.is_empty()
+    }
+
+    /// Heap memory used by the set
+    pub fn size_bytes(&self) -> usize {
+        self.keys.len() * 16 + self.offsets.len() * 4
+    }
+
+    /// Check if a packed sequence is in the set
+    #[inline]
+    pub fn contains(&self, packed: u128) -> bool {
+        if self.keys.is_empty() {
+            return false;
+        }
+        let b = if self.bits == 0 {
+            0
+        } else {
+            (hash(packed) >> (64 - self.bits)) as usize
+        };
+        let (lo, hi) = (self.offsets[b] as usize, self.offsets[b + 1] as usize);
+        self.keys[lo..hi].contains(&packed)
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_pack_distinguishes_lengths() {
+        assert_ne!(pack_word("a"), pack_word("aa"));
+        assert_eq!(pack_word("Hex"), pack_keys([keys::H, keys::E, keys::X]));
+        assert_eq!(pack_word(""), None);
+        assert_eq!(pack_word("việt"), None);
+        assert_eq!(pack_word(&"a".repeat(26)), None);
+        assert!(pack_word(&"z".repeat(25)).is_some());
+        assert_eq!(pack_keys([keys::A, keys::N1]), None);
+    }
+
+    #[test]
+    fn test_parse_and_contains() {
+        let (set, rejected) = OverrideSet::parse("# comment\nof\noff\n\nhex\tnote\nOF\nc++\n");
+        assert_eq!(set.len(), 3);
+        assert_eq!(rejected, 1);
+        assert!(set.contains(pack_word("of").unwrap()));
+        assert!(set.contains(pack_keys([keys::H, keys::E, keys::X]).unwrap()));
+        assert!(!set.contains(pack_word("he").unwrap()));
+    }
+
+    #[test]
+    fn test_large_set() {
+        let words: Vec<String> = (0..20_000u32)
+            .map(|i| {
+                (0..5)
+                    .map(|j| (b'a' + ((i / 26u32.pow(j)) % 26) as u8) as char)
+                    .collect()
+            })
+            .collect();
+        let set = OverrideSet::from_packed(words.iter().filter_map(|w| pack_word(w)).collect());
+        assert_eq!(set.len(), 20_000);
+        assert!(words.iter().all(|w| set.contains(pack_word(w).unwrap())));
+        assert!(!set.contains(pack_word("zzzzzz").unwrap()));
+    }
+
+    #[test]
+    fn test_empty_set() {
+        let set = OverrideSet::from_packed(Vec::new());
+        assert!(!set.contains(pack_word("a").unwrap()));
+    }
+}
@@ -241,12 +241,7 @@ impl PhonotacticEngine {
         if keys.len() >= 3 {
             for suffix in SUFFIXES_3 {
                 let start = keys.len() - 3;
-                if &keys[start..start + 3]
-                    .iter()
-                    .map(|k| k.0)
-                    .collect::<Vec<_>>()[..]
-                    == &suffix[..]
-                {
+                if keys[start..].iter().map(|k| k.0).eq(suffix.iter().copied()) {
                     return 90;
                 }
             }
@@ -255,12 +250,7 @@ impl PhonotacticEngine {
         if keys.len() >= 4 {
             for suffix in SUFFIXES_4 {
                 let start = keys.len() - 4;
-                if &keys[start..start + 4]
-                    .iter()
-                    .map(|k| k.0)
-                    .collect::<Vec<_>>()[..]
-                    == &suffix[..]
-                {
+                if keys[start..].iter().map(|k| k.0).eq(suffix.iter().copied()) {
                     return 90;
                 }
             }
@@ -0,0 +1,265 @@
+//! Adaptive Restore Learning - remembers user corrections of language decisions
+//!
+//! When the user undoes a language decision, the correction is recorded
+//! against the raw keystroke sequence:
+//! - ESC restore of a transformed word → prefer English next time
+//! - Backspace right after an auto-restore → prefer Vietnamese next time
+//!
+//! Corrections live in two count-min sketches (one per language) of fixed
+//! size, so memory and lookup cost stay constant no matter how long the
+//! engine has been learning. Counters are saturating `u8`; when one
+//! saturates, every counter is halved so old corrections fade out.
+//!
+//! ## File Layout (little-endian, mmap-friendly)
+//!
+//! ```text
+//! ┌──────────────────────────────────────────────┐
+//! │ magic "GXRL" │ version u16 │ depth u16       │  8 bytes
+//! │ width u32    │ reserved u32                  │  8 bytes
+//! ├──────────────────────────────────────────────┤
+//! │ english    [u8; depth * width]  row-major    │
+//! │ vietnamese [u8; depth * width]  row-major    │
+//! └──────────────────────────────────────────────┘
+//! ```
+
+use crate::engine_v2::english::language_decision::LanguageBias;
+
+/// Number of hash rows per sketch
+pub const DEPTH: usize = 4;
+/// Counters per row (power of two)
+pub const WIDTH: usize = 4096;
+/// Header size in bytes
+pub const HEADER_LEN: usize = 16;
+/// Total serialized size in bytes
+pub const FILE_LEN: usize = HEADER_LEN + 2 * DEPTH * WIDTH;
+
+const MAGIC: &[u8; 4] = b"GXRL";
+const VERSION: u16 = 1;
+
+const PLANE: usize = DEPTH * WIDTH;
+
+/// Hash a raw keystroke sequence (FNV-1a 64 over keycodes, case-insensitive)
+#[inline]
+pub fn hash_keys<I: IntoIterator<Item = u16>>(keys: I) -> u64 {
+    let mut h: u64 = 0xcbf2_9ce4_8422_2325;
+    for k in keys {
+        for b in k.to_le_bytes() {
+            h ^= b as u64;
+            h = h.wrapping_mul(0x0000_0100_0000_01b3);
+        }
+    }
+    h
+}
+
+/// Fixed-size store of restore corrections
+pub struct RestoreSketch {
+    english: [u8; PLANE],
+    vietnamese: [u8; PLANE],
+    /// Total corrections recorded (saturating, for fast empty checks)
+    total: u32,
+}
+
+impl RestoreSketch {
+    /// Create an empty sketch (boxed: ~32KB)
+    pub fn new() -> Box<Self> {
+        Box::new(Self {
+            english: [0; PLANE],
+            vietnamese: [0; PLANE],
+            total: 0,
+        })
+    }
+
+    /// Check if no correction has been recorded
+    #[inline]
+    pub fn is_empty(&self) -> bool {
+        self.total == 0
+    }
+
+    /// Number of corrections recorded since creation/load
+    pub fn total(&self) -> u32 {
+        self.total
+    }
+
+    /// Counter index for `row` (double hashing: h1 + row * h2)
+    #[inline]
+    fn slot(hash: u64, row: usize) -> usize {
+        let h1 = hash as u32;
+        let h2 = ((hash >> 32) as u32) | 1;
+        row * WIDTH + (h1.wrapping_add((row as u32).wrapping_mul(h2)) as usize & (WIDTH - 1))
+    }
+
+    /// Record that the user wanted `preferred` for this keystroke hash
+    pub fn record(&mut self, hash: u64, preferred: LanguageBias) {
+        let plane = match preferred {
+            LanguageBias::English => &mut self.english,
+            LanguageBias::Vietnamese => &mut self.vietnamese,
+            LanguageBias::None => return,
+        };
+        let mut saturated = false;
+        for row in 0..DEPTH {
+            let c = &mut plane[Self::slot(hash, row)];
+            *c = c.saturating_add(1);
+            saturated |= *c == u8::MAX;
+        }
+        if saturated {
+            self.decay();
+        }
+        self.total = self.total.saturating_add(1);
+    }
+
+    /// Halve every counter (keeps recent corrections dominant)
+    fn decay(&mut self) {
+        for c in self.english.iter_mut().chain(self.vietnamese.iter_mut()) {
+            *c >>= 1;
+        }
+    }
+
+    /// Estimated correction counts `(english, vietnamese)` for a hash
+    #[inline]
+    pub fn estimate(&self, hash: u64) -> (u8, u8) {
+        let mut en = u8::MAX;
+        let mut vi = u8::MAX;
+        for row in 0..DEPTH {
+            let i = Self::slot(hash, row);
+            en = en.min(self.english[i]);
+            vi = vi.min(self.vietnamese[i]);
+        }
+        (en, vi)
+    }
+
+    /// Learned preference for a keystroke hash
+    ///
+    /// The language with more recorded corrections wins; ties (including
+    /// never-seen sequences) return `LanguageBias::None`.
+    #[inline]
+    pub fn bias(&self, hash: u64) -> LanguageBias {
+        if self.is_empty() {
+            return LanguageBias::None;
+        }
+        let (en, vi) = self.estimate(hash);
+        if en > vi {
+            LanguageBias::English
+        } else if vi > en {
+            LanguageBias::Vietnamese
+        } else {
+            LanguageBias::None
+        }
+    }
+
+    /// Forget all corrections
+    pub fn reset(&mut self) {
+        self.english.fill(0);
+        self.vietnamese.fill(0);
+        self.total = 0;
+    }
+
+    /// Serialize to the fixed-size file layout
+    pub fn to_bytes(&self) -> Vec<u8> {
+        let mut out = Vec::with_capacity(FILE_LEN);
+        out.extend_from_slice(MAGIC);
+        out.extend_from_slice(&VERSION.to_le_bytes());
+        out.extend_from_slice(&(DEPTH as u16).to_le_bytes());
+        out.extend_from_slice(&(WIDTH as u32).to_le_bytes());
+        out.extend_from_slice(&self.total.to_le_bytes());
+        out.extend_from_slice(&self.english);
+        out.extend_from_slice(&self.vietnamese);
+        out
+    }
+
+    /// Load from the fixed-size file layout
+    pub fn from_bytes(data: &[u8]) -> Result<Box<Self>, &'static str> {
+        if data.len() != FILE_LEN {
+            return Err("Invalid learning file size");
+        }
+        if &data[0..4] != MAGIC {
+            return Err("Invalid learning file magic");
+        }
+        if u16::from_le_bytes([data[4], data[5]]) != VERSION {
+            return Err("Unsupported learning file version");
+        }
+        let depth = u16::from_le_bytes([data[6], data[7]]) as usize;
+        let width = u32::from_le_bytes([data[8], data[9], data[10], data[11]]) as usize;
+        if depth != DEPTH || width != WIDTH {
+            return Err("Learning file dimensions mismatch");
+        }
+
+        let mut sketch = Self::new();
+        sketch.total = u32::from_le_bytes([data[12], data[13], data[14], data[15]]);
+        sketch
+            .english
+            .copy_from_slice(&data[HEADER_LEN..HEADER_LEN + PLANE]);
+        sketch
+            .vietnamese
+            .copy_from_slice(&data[HEADER_LEN + PLANE..]);
+        Ok(sketch)
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::data::keys;
+
+    fn h(word: &[u16]) -> u64 {
+        hash_keys(word.iter().copied())
+    }
+
+    #[test]
+    fn test_record_and_bias() {
+        let mut s = RestoreSketch::new();
+        let text = h(&[keys::T, keys::E, keys::X, keys::T]);
+        let viet = h(&[keys::V, keys::I, keys::E, keys::E, keys::T]);
+        assert_eq!(s.bias(text), LanguageBias::None);
+
+        s.record(text, LanguageBias::English);
+        s.record(viet, LanguageBias::Vietnamese);
+        assert_eq!(s.bias(text), LanguageBias::English);
+        assert_eq!(s.bias(viet), LanguageBias::Vietnamese);
+        assert_eq!(s.bias(h(&[keys::A])), LanguageBias::None);
+
+        // Later opposite corrections win back
+        s.record(text, LanguageBias::Vietnamese);
+        assert_eq!(s.bias(text), LanguageBias::None);
+        s.record(text, LanguageBias::Vietnamese);
+        assert_eq!(s.bias(text), LanguageBias::Vietnamese);
+    }
+
+    #[test]
+    fn test_saturation_decays() {
+        let mut s = RestoreSketch::new();
+        let a = h(&[keys::A]);
+        let b = h(&[keys::B]);
+        s.record(b, LanguageBias::English);
+        s.record(b, LanguageBias::English);
+        for _ in 0..1000 {
+            s.record(a, LanguageBias::English);
+        }
+        let (en, _) = s.estimate(a);
+        assert!(en < u8::MAX && en > 100);
+        // Old corrections fade out
+        assert_eq!(s.estimate(b).0, 0);
+    }
+
+    #[test]
+    fn test_roundtrip_bytes() {
+        let mut s = RestoreSketch::new();
+        let w = h(&[keys::D, keys::O]);
+        s.record(w, LanguageBias::Vietnamese);
+        let bytes = s.to_bytes();
+        assert_eq!(bytes.len(), FILE_LEN);
+
+        let loaded = RestoreSketch::from_bytes(&bytes).unwrap();
+        assert_eq!(loaded.total(), 1);
+        assert_eq!(loaded.bias(w), LanguageBias::Vietnamese);
+
+        assert!(RestoreSketch::from_bytes(&bytes[..100]).is_err());
+        let mut bad = bytes.clone();
+        bad[0] = b'X';
+        assert!(RestoreSketch::from_bytes(&bad).is_err());
+    }
+
+    #[test]
+    fn test_hash_is_order_sensitive() {
+        assert_ne!(h(&[keys::A, keys::B]), h(&[keys::B, keys::A]));
+    }
+}
@@ -11,7 +11,7 @@ pub struct VietnameseSyllableValidator;
 impl VietnameseSyllableValidator {
     /// O(1) validation of Vietnamese syllable structure
     pub fn validate(keys: &[u16]) -> ValidationResult {
-        println!("DEBUG: validate() called with {:?}", keys);
+        debug_log!("DEBUG: validate() called with {:?}", keys);
 
         // Fast path: empty is valid
         if keys.is_empty() {
@@ -34,7 +34,7 @@ impl VietnameseSyllableValidator {
         // Rule 1: Validate initial consonants (comprehensive check from OpenKey)
         // Vietnamese allows specific initial consonants and clusters
         if !Self::is_valid_initial_consonant(keys) {
-            println!("DEBUG: Rule 1 failed");
+            debug_log!("DEBUG: Rule 1 failed");
             return ValidationResult {
                 is_valid: false,
                 confidence: 0,
@@ -47,7 +47,7 @@ impl VietnameseSyllableValidator {
             let k1 = keys[0];
             let k2 = keys[1];
             if Self::is_invalid_consonant_cluster(k1, k2) {
-                println!("DEBUG: Rule 1.5 cluster failed");
+                debug_log!("DEBUG: Rule 1.5 cluster failed");
                 return ValidationResult {
                     is_valid: false,
                     confidence: 0,
@@ -56,7 +56,7 @@ impl VietnameseSyllableValidator {
 
             // Check c/k/g/gh/ng/ngh distribution rules
             if Self::violates_ck_distribution(k1, k2) {
-                println!("DEBUG: Rule 1.5 distribution failed");
+                debug_log!("DEBUG: Rule 1.5 distribution failed");
                 return ValidationResult {
                     is_valid: false,
                     confidence: 0,
@@ -74,7 +74,7 @@ impl VietnameseSyllableValidator {
                 if (allowed_next & (1 << k2 as u128)) == 0 {
                     // Check if it's a known vowel compound or allowed cluster
                     if !Self::is_allowed_exception(k1, k2) {
-                        println!("DEBUG: Rule 2 Bigram failed for {:?} -> {:?}", k1, k2);
+                        debug_log!("DEBUG: Rule 2 Bigram failed for {:?} -> {:?}", k1, k2);
                         return ValidationResult {
                             is_valid: false,
                             confidence: 0,
@@ -99,7 +99,7 @@ impl VietnameseSyllableValidator {
                     (prev, last),
                     (keys::N, keys::G) | (keys::N, keys::H) | (keys::C, keys::H)
                 ) {
-                    println!("DEBUG: Rule 5 Coda failed (invalid coda char)");
+                    debug_log!("DEBUG: Rule 5 Coda failed (invalid coda char)");
                     return ValidationResult {
                         is_valid: false,
                         confidence: 0,
@@ -120,7 +120,7 @@ impl VietnameseSyllableValidator {
             if last == keys::H && prev == keys::C && len >= 3 {
                 let vowel = keys[len - 3];
                 if Self::is_invalid_vowel_before_ch(vowel) {
-                    println!("DEBUG: Rule 6 CH check failed");
+                    debug_log!("DEBUG: Rule 6 CH check failed");
                     return ValidationResult {
                         is_valid: false,
                         confidence: 0,
@@ -132,7 +132,7 @@ impl VietnameseSyllableValidator {
             if last == keys::H && prev == keys::N && len >= 3 {
                 let vowel = keys[len - 3];
                 if Self::is_invalid_vowel_before_nh(vowel) {
-                    println!("DEBUG: Rule 6 NH check failed");
+                    debug_log!("DEBUG: Rule 6 NH check failed");
                     return ValidationResult {
                         is_valid: false,
                         confidence: 0,
@@ -143,7 +143,7 @@ impl VietnameseSyllableValidator {
             // Check for -ng ending
             if last == keys::G && prev == keys::N && len >= 3 {
                 if !Self::is_valid_vowel_before_ng(keys, len) {
-                    println!("DEBUG: Rule 6 NG check failed");
+                    debug_log!("DEBUG: Rule 6 NG check failed");
                     return ValidationResult {
                         is_valid: false,
                         confidence: 0,
@@ -154,7 +154,7 @@ impl VietnameseSyllableValidator {
 
         // Rule 7: Validate vowel combinations (from OpenKey)
         if !Self::is_valid_vowel_sequence(keys) {
-            println!("DEBUG: is_valid_vowel_sequence rejected {:?}", keys);
+            debug_log!("DEBUG: is_valid_vowel_sequence rejected {:?}", keys);
             return ValidationResult {
                 is_valid: false,
                 confidence: 0,
@@ -212,23 +212,27 @@ impl VietnameseSyllableValidator {
             return false;
         }
 
-        // Find vowel sequence
-
-        let mut vowel_indices = Vec::new();
-        for (i, &k) in keys.iter().enumerate() {
-            if matches!(k, keys::A | keys::E | keys::I | keys::O | keys::U | keys::Y) {
-                vowel_indices.push(i);
-            } else if !vowel_indices.is_empty() {
-                break; // Stop at first consonant after vowels
-            }
-        }
+        // Find vowel sequence (first run of vowels, up to the next consonant)
+        let is_vowel = |k: &u16| {
+            matches!(
+                *k,
+                keys::A | keys::E | keys::I | keys::O | keys::U | keys::Y
+            )
+        };
+        let Some(start) = keys.iter().position(is_vowel) else {
+            return true;
+        };
+        let end = keys[start..]
+            .iter()
+            .position(|k| !is_vowel(k))
+            .map_or(keys.len(), |n| start + n);
 
-        if vowel_indices.len() < 2 {
+        if end - start < 2 {
             return true; // Single vowel - no tone placement rules
         }
 
-        let vowel_keys: Vec<u16> = vowel_indices.iter().map(|&i| keys[i]).collect();
-        let vowel_tones: Vec<u8> = vowel_indices.iter().map(|&i| tones[i]).collect();
+        let vowel_keys = &keys[start..end];
+        let vowel_tones = &tones[start..end];
 
         match vowel_keys.len() {
             2 => {
@@ -290,25 +294,25 @@ impl VietnameseSyllableValidator {
                             // ..ơ
                             // uơ, ươ valid. iơ (giờ) valid
                             if !matches!(k1, keys::U | keys::I) {
-                                println!("DEBUG: Rejected O Horn (ơ) after {:?}", k1);
+                                debug_log!("DEBUG: Rejected O Horn (ơ) after {:?}", k1);
                                 return false;
                             }
                         } else if k2 == keys::A {
                             // ..ă
                             // oă (xoăn), uă (quặc), iă (giặc) valid
                             if !matches!(k1, keys::O | keys::U | keys::I) {
-                                println!("DEBUG: Rejected A Horn (ă) after {:?}", k1);
+                                debug_log!("DEBUG: Rejected A Horn (ă) after {:?}", k1);
                                 return false;
                             }
                         } else if k2 == keys::U {
                             // ..ư
                             // iư (giữ) valid
                             if !matches!(k1, keys::I) {
-                                println!("DEBUG: Rejected U Horn (ư) after {:?}", k1);
+                                debug_log!("DEBUG: Rejected U Horn (ư) after {:?}", k1);
                                 return false;
                             }
                         } else {
-                            println!("DEBUG: Rejected Horn on {:?}", k2);
+                            debug_log!("DEBUG: Rejected Horn on {:?}", k2);
                             return false;
                         }
                     }
@@ -328,7 +332,7 @@ impl VietnameseSyllableValidator {
                 // Rule 3b: O+Circumflex (ô) invalid as first vowel in triphthong
                 // "ngoao" -> "ngôa" invalid. "ngoao" valid.
                 if vowel_keys[0] == keys::O && vowel_tones[0] == tone::CIRCUMFLEX {
-                    println!("DEBUG: Rule 3b Rejected O(Circ) as v1 (len 3)");
+                    debug_log!("DEBUG: Rule 3b Rejected O(Circ) as v1 (len 3)");
                     return false;
                 }
 
@@ -577,14 +581,17 @@ impl VietnameseSyllableValidator {
 
         for (i, &k) in keys.iter().enumerate() {
             let is_vowel = matches!(k, keys::A | keys::E | keys::I | keys::O | keys::U | keys::Y);
-            println!(
+            debug_log!(
                 "DEBUG: Loop i={} k={} is_vowel={} finished={}",
-                i, k, is_vowel, finished_vowel_block
+                i,
+                k,
+                is_vowel,
+                finished_vowel_block
             );
 
             if is_vowel {
                 if finished_vowel_block {
-                    println!("DEBUG: Found multi-syllable key {} at index {}", k, i);
+                    debug_log!("DEBUG: Found multi-syllable key {} at index {}", k, i);
                     // Found a second vowel block after consonants -> Multi-syllable/Invalid
                     return false;
                 }
@@ -0,0 +1,560 @@
+//! Keyboard Layouts
+//!
+//! The engine's key vocabulary (`data::keys`) is macOS virtual keycodes,
+//! which name physical positions on a US keyboard. This module translates
+//! what other frontends have into that key space with one table lookup:
+//!
+//! - **Scancodes** (`translate_scancode`): macOS keycodes, Linux evdev
+//!   codes or Windows virtual keys, combined with the user's layout (US,
+//!   Dvorak, Colemak, AZERTY). macOS and evdev codes are positional, so the
+//!   layout decides which letter a position types. Windows has already
+//!   applied the layout when it reports a VK, so the layout is ignored.
+//! - **Characters** (`translate_char`): text a platform delivers as
+//!   Unicode (IME text events, WASM, test tools). Independent of layout.
+//!
+//! Every (scancode set, layout) table is built at compile time
+//! (`[u16; 256]`, 6 KB in total). Only `core` is used, so the
+//! `goxviet-embedded` crate compiles this too.
+
+use crate::data::keys;
+
+/// Marks codes and characters with no engine key
+pub const NO_KEY: u16 = u16::MAX;
+
+/// Keyboard layout, for positional scancodes
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+#[repr(u8)]
+pub enum Layout {
+    Us = 0,
+    Dvorak = 1,
+    Colemak = 2,
+    /// French AZERTY. The number row yields digits (its shifted level),
+    /// so VNI tone keys stay where VNI users expect them.
+    Azerty = 3,
+}
+
+impl Layout {
+    pub const COUNT: usize = 4;
+
+    pub fn from_u8(value: u8) -> Option<Self> {
+        Some(match value {
+            0 => Self::Us,
+            1 => Self::Dvorak,
+            2 => Self::Colemak,
+            3 => Self::Azerty,
+            _ => return None,
+        })
+    }
+}
+
+/// Platform scancode vocabulary
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+#[repr(u8)]
+pub enum ScancodeSet {
+    /// macOS virtual keycodes (`kVK_*`), positional
+    MacOs = 0,
+    /// Linux evdev codes (`KEY_*`, X11 keycode − 8), positional
+    Evdev = 1,
+    /// Windows virtual keys (`VK_*`), already layout-translated
+    WindowsVk = 2,
+}
+
+impl ScancodeSet {
+    pub const COUNT: usize = 3;
+
+    pub fn from_u8(value: u8) -> Option<Self> {
+        Some(match value {
+            0 => Self::MacOs,
+            1 => Self::Evdev,
+            2 => Self::WindowsVk,
+            _ => return None,
+        })
+    }
+}
+
+/// A character as an engine key event
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct CharKey {
+    pub key: u16,
+    /// Uppercase letter
+    pub caps: bool,
+    /// Shifted symbol (`!`, `@`, `:` …), see `Engine::on_key_ext`
+    pub shift: bool,
+}
+
+/// Translate a platform scancode into an engine key
+///
+/// Returns None for keys the engine has no code for (function keys,
+/// modifiers, keypad, …); hosts pass those through.
+#[inline]
+pub fn translate_scancode(set: ScancodeSet, layout: Layout, code: u16) -> Option<u16> {
+    match SCANCODE_TABLES[set as usize][layout as usize].get(code as usize) {
+        Some(&key) if key != NO_KEY => Some(key),
+        _ => None,
+    }
+}
+
+/// Translate a character into an engine key event
+///
+/// ASCII letters, digits, punctuation (shifted symbols set `shift`),
+/// space, tab, return, escape and backspace (`\x08` / `\x7f`).
+#[inline]
+pub fn translate_char(c: char) -> Option<CharKey> {
+    let entry = *ASCII_TABLE.get(c as usize)?;
+    if entry == NO_KEY {
+        return None;
+    }
+    Some(CharKey {
+        key: entry & KEY_MASK,
+        caps: entry & CAPS_BIT != 0,
+        shift: entry & SHIFT_BIT != 0,
+    })
+}
+
+/// Character an application types for an engine key (inverse of
+/// `translate_char` for printable ASCII except space)
+///
+/// `caps` uppercases letters; `shift` selects the shifted symbol of
+/// digit and punctuation keys. None for keys that type no character.
+#[inline]
+pub fn key_char(key: u16, caps: bool, shift: bool) -> Option<char> {
+    let [plain, shifted] = *KEY_CHARS.get(key as usize)?;
+    let c = if shift && shifted != 0 {
+        shifted
+    } else {
+        plain
+    };
+    match c {
+        0 => None,
+        _ if caps => Some(c.to_ascii_uppercase() as char),
+        _ => Some(c as char),
+    }
+}
+
+/// Engine key of a printable ASCII character, ignoring Shift and Caps
+/// (`?` and `/` are the same key); used by `table` definitions
+pub(crate) const fn ascii_key(c: u8) -> Option<u16> {
+    if c <= b' ' || c >= 0x7F {
+        return None;
+    }
+    match ASCII_ENTRIES[c as usize] {
+        NO_KEY => None,
+        entry => Some(entry & KEY_MASK),
+    }
+}
+
+// ============================================================
+// Table construction (compile time)
+// ============================================================
+
+const KEY_MASK: u16 = 0xFF;
+const CAPS_BIT: u16 = 1 << 8;
+const SHIFT_BIT: u16 = 1 << 9;
+
+/// Characters of the 47 US positions, in row order
+const US: &[u8; 47] = b"`1234567890-=qwertyuiop[]\\asdfghjkl;'zxcvbnm,./";
+
+/// Character each layout types at the US positions (unshifted level).
+/// 0: no engine key for that character, keep the positional key (all
+/// such positions are punctuation, which the engine treats as a break).
+const LAYOUT_CHARS: [&[u8; 47]; Layout::COUNT] = [
+    US,
+    b"`1234567890[]',.pyfgcrl/=\\aoeuidhtns-;qjkxbmwvz",
+    b"`1234567890-=qwfpgjluy;[]\\arstdhneio'zxcvbkm,./",
+    b"\x001234567890\x00=azertyuiop\x00\x00\x00qsdfghjklm\x00wxcvbn,;:\x00",
+];
+
+/// Scancode of each US position, per set (same order as `US`)
+const POSITION_CODES: [[u16; 47]; ScancodeSet::COUNT] = [
+    macos_position_codes(),
+    [
+        41, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, // ` 1..0 - =
+        16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 43, // q..p [ ] \
+        30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40, // a..l ; '
+        44, 45, 46, 47, 48, 49, 50, 51, 52, 53, // z..m , . /
+    ],
+    [
+        0xC0, 0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x30, 0xBD, 0xBB, //
+        0x51, 0x57, 0x45, 0x52, 0x54, 0x59, 0x55, 0x49, 0x4F, 0x50, 0xDB, 0xDD, 0xDC, //
+        0x41, 0x53, 0x44, 0x46, 0x47, 0x48, 0x4A, 0x4B, 0x4C, 0xBA, 0xDE, //
+        0x5A, 0x58, 0x43, 0x56, 0x42, 0x4E, 0x4D, 0xBC, 0xBE, 0xBF,
+    ],
+];
+
+/// Non-character keys: (scancode, engine key), per set
+const SPECIAL_KEYS: [&[(u16, u16)]; ScancodeSet::COUNT] = [
+    &[
+        (keys::SPACE, keys::SPACE),
+        (keys::DELETE, keys::DELETE),
+        (keys::TAB, keys::TAB),
+        (keys::RETURN, keys::RETURN),
+        (keys::ENTER, keys::ENTER),
+        (keys::ESC, keys::ESC),
+        (keys::LEFT, keys::LEFT),
+        (keys::RIGHT, keys::RIGHT),
+        (keys::DOWN, keys::DOWN),
+        (keys::UP, keys::UP),
+    ],
+    &[
+        (57, keys::SPACE),
+        (14, keys::DELETE),
+        (15, keys::TAB),
+        (28, keys::RETURN),
+        (96, keys::ENTER),
+        (1, keys::ESC),
+        (105, keys::LEFT),
+        (106, keys::RIGHT),
+        (108, keys::DOWN),
+        (103, keys::UP),
+    ],
+    &[
+        (0x20, keys::SPACE),
+        (0x08, keys::DELETE),
+        (0x09, keys::TAB),
+        // Keypad Enter is VK_RETURN too (extended-key flag)
+        (0x0D, keys::RETURN),
+        (0x1B, keys::ESC),
+        (0x25, keys::LEFT),
+        (0x27, keys::RIGHT),
+        (0x28, keys::DOWN),
+        (0x26, keys::UP),
+    ],
+];
+
+static SCANCODE_TABLES: [[[u16; 256]; Layout::COUNT]; ScancodeSet::COUNT] = build_scancode_tables();
+
+static ASCII_TABLE: [u16; 128] = ASCII_ENTRIES;
+
+const ASCII_ENTRIES: [u16; 128] = build_ascii_table();
+
+/// (unshifted, shifted) printable character of each engine key
+static KEY_CHARS: [[u8; 2]; 256] = build_key_chars();
+
+/// Engine key of an unshifted US character
+const fn us_key(c: u8) -> u16 {
+    match c {
+        b'a' => keys::A,
+        b'b' => keys::B,
+        b'c' => keys::C,
+        b'd' => keys::D,
+        b'e' => keys::E,
+        b'f' => keys::F,
+        b'g' => keys::G,
+        b'h' => keys::H,
+        b'i' => keys::I,
+        b'j' => keys::J,
+        b'k' => keys::K,
+        b'l' => keys::L,
+        b'm' => keys::M,
+        b'n' => keys::N,
+        b'o' => keys::O,
+        b'p' => keys::P,
+        b'q' => keys::Q,
+        b'r' => keys::R,
+        b's' => keys::S,
+        b't' => keys::T,
+        b'u' => keys::U,
+        b'v' => keys::V,
+        b'w' => keys::W,
+        b'x' => keys::X,
+        b'y' => keys::Y,
+        b'z' => keys::Z,
+        b'0' => keys::N0,
+        b'1' => keys::N1,
+        b'2' => keys::N2,
+        b'3' => keys::N3,
+        b'4' => keys::N4,
+        b'5' => keys::N5,
+        b'6' => keys::N6,
+        b'7' => keys::N7,
+        b'8' => keys::N8,
+        b'9' => keys::N9,
+        b'`' => keys::BACKQUOTE,
+        b'-' => keys::MINUS,
+        b'=' => keys::EQUAL,
+        b'[' => keys::LBRACKET,
+        b']' => keys::RBRACKET,
+        b'\\' => keys::BACKSLASH,
+        b';' => keys::SEMICOLON,
+        b'\'' => keys::QUOTE,
+        b',' => keys::COMMA,
+        b'.' => keys::DOT,
+        b'/' => keys::SLASH,
+        _ => NO_KEY,
+    }
+}
+
+/// US character typed with Shift → its unshifted key
+const fn us_unshifted(c: u8) -> u8 {
+    match c {
+        b'~' => b'`',
+        b'!' => b'1',
+        b'@' => b'2',
+        b'#' => b'3',
+        b'$' => b'4',
+        b'%' => b'5',
+        b'^' => b'6',
+        b'&' => b'7',
+        b'*' => b'8',
+        b'(' => b'9',
+        b')' => b'0',
+        b'_' => b'-',
+        b'+' => b'=',
+        b'{' => b'[',
+        b'}' => b']',
+        b'|' => b'\\',
+        b':' => b';',
+        b'"' => b'\'',
+        b'<' => b',',
+        b'>' => b'.',
+        b'?' => b'/',
+        _ => 0,
+    }
+}
+
+const fn build_ascii_table() -> [u16; 128] {
+    let mut table = [NO_KEY; 128];
+    let mut c = 0u8;
+    while c < 128 {
+        table[c as usize] = match c {
+            b'A'..=b'Z' => us_key(c.to_ascii_lowercase()) | CAPS_BIT,
+            b' ' => keys::SPACE,
+            b'\t' => keys::TAB,
+            b'\r' | b'\n' => keys::RETURN,
+            0x1B => keys::ESC,
+            0x08 | 0x7F => keys::DELETE,
+            _ => match us_key(c) {
+                NO_KEY => match us_unshifted(c) {
+                    0 => NO_KEY,
+                    base => us_key(base) | SHIFT_BIT,
+                },
+                key => key,
+            },
+        };
+        c += 1;
+    }
+    table
+}
+
+const fn build_key_chars() -> [[u8; 2]; 256] {
+    let mut table = [[0; 2]; 256];
+    let mut c = b'!';
+    while c < 0x7F {
+        let entry = ASCII_ENTRIES[c as usize];
+        // Uppercase letters are the lowercase ones with caps
+        if entry != NO_KEY && entry & CAPS_BIT == 0 {
+            let level = (entry & SHIFT_BIT != 0) as usize;
+            table[(entry & KEY_MASK) as usize][level] = c;
+        }
+        c += 1;
+    }
+    table
+}
+
+const fn macos_position_codes() -> [u16; 47] {
+    let mut codes = [0; 47];
+    let mut i = 0;
+    while i < US.len() {
+        codes[i] = us_key(US[i]);
+        i += 1;
+    }
+    codes
+}
+
+const fn build_table(set: usize, layout: usize) -> [u16; 256] {
+    let mut table = [NO_KEY; 256];
+    // Windows reports VKs after applying the layout
+    let chars = if set == ScancodeSet::WindowsVk as usize {
+        US
+    } else {
+        LAYOUT_CHARS[layout]
+    };
+    let mut i = 0;
+    while i < US.len() {
+        let c = chars[i];
+        // Shifted layout characters (AZERTY ':') keep only the key part
+        let key = if c == 0 {
+            us_key(US[i])
+        } else {
+            ASCII_ENTRIES[c as usize] & KEY_MASK
+        };
+        table[POSITION_CODES[set][i] as usize] = key;
+        i += 1;
+    }
+    let mut i = 0;
+    while i < SPECIAL_KEYS[set].len() {
+        let (code, key) = SPECIAL_KEYS[set][i];
+        table[code as usize] = key;
+        i += 1;
+    }
+    table
+}
+
+const fn build_scancode_tables() -> [[[u16; 256]; Layout::COUNT]; ScancodeSet::COUNT] {
+    let mut tables = [[[NO_KEY; 256]; Layout::COUNT]; ScancodeSet::COUNT];
+    let mut set = 0;
+    while set < ScancodeSet::COUNT {
+        let mut layout = 0;
+        while layout < Layout::COUNT {
+            tables[set][layout] = build_table(set, layout);
+            layout += 1;
+        }
+        set += 1;
+    }
+    tables
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    const SETS: [ScancodeSet; 3] = [
+        ScancodeSet::MacOs,
+        ScancodeSet::Evdev,
+        ScancodeSet::WindowsVk,
+    ];
+    const LAYOUTS: [Layout; 4] = [Layout::Us, Layout::Dvorak, Layout::Colemak, Layout::Azerty];
+
+    /// Scancode of the US position that types `c` on a US keyboard
+    fn position(set: ScancodeSet, c: u8) -> u16 {
+        let i = US.iter().position(|&u| u == c).unwrap();
+        POSITION_CODES[set as usize][i]
+    }
+
+    #[test]
+    fn test_macos_us_is_identity() {
+        for code in 0..128u16 {
+            if let Some(key) = translate_scancode(ScancodeSet::MacOs, Layout::Us, code) {
+                assert_eq!(key, code);
+            }
+        }
+        assert_eq!(
+            translate_scancode(ScancodeSet::MacOs, Layout::Us, keys::A),
+            Some(keys::A)
+        );
+    }
+
+    #[test]
+    fn test_us_positions_agree_across_sets() {
+        for set in SETS {
+            for &c in US {
+                let key = translate_scancode(set, Layout::Us, position(set, c));
+                assert_eq!(key, Some(us_key(c)), "{set:?} '{}'", c as char);
+            }
+        }
+    }
+
+    #[test]
+    fn test_layouts_move_letters() {
+        let evdev = ScancodeSet::Evdev;
+        // Physical US "s" position
+        let s = position(evdev, b's');
+        assert_eq!(translate_scancode(evdev, Layout::Us, s), Some(keys::S));
+        assert_eq!(translate_scancode(evdev, Layout::Dvorak, s), Some(keys::O));
+        assert_eq!(translate_scancode(evdev, Layout::Colemak, s), Some(keys::R));
+        assert_eq!(translate_scancode(evdev, Layout::Azerty, s), Some(keys::S));
+        // AZERTY swaps a/q, z/w and puts m after l
+        let q = position(evdev, b'q');
+        assert_eq!(translate_scancode(evdev, Layout::Azerty, q), Some(keys::A));
+        let semicolon = position(evdev, b';');
+        assert_eq!(
+            translate_scancode(evdev, Layout::Azerty, semicolon),
+            Some(keys::M)
+        );
+        // Number row gives digits
+        let one = position(evdev, b'1');
+        assert_eq!(
+            translate_scancode(evdev, Layout::Azerty, one),
+            Some(keys::N1)
+        );
+    }
+
+    #[test]
+    fn test_every_layout_covers_all_letters() {
+        for set in SETS {
+            for layout in LAYOUTS {
+                let mut letters: u32 = 0;
+                for code in 0..256u16 {
+                    if let Some(key) = translate_scancode(set, layout, code) {
+                        if keys::is_letter(key) {
+                            letters |= 1 << (keys::key_to_char(key, false).unwrap() as u8 - b'a');
+                        }
+                    }
+                }
+                assert_eq!(letters, (1 << 26) - 1, "{set:?} {layout:?}");
+            }
+        }
+    }
+
+    #[test]
+    fn test_windows_vk_ignores_layout() {
+        for layout in LAYOUTS {
+            assert_eq!(
+                translate_scancode(ScancodeSet::WindowsVk, layout, 0x53),
+                Some(keys::S)
+            );
+        }
+    }
+
+    #[test]
+    fn test_special_and_unknown_keys() {
+        assert_eq!(
+            translate_scancode(ScancodeSet::Evdev, Layout::Us, 57),
+            Some(keys::SPACE)
+        );
+        assert_eq!(
+            translate_scancode(ScancodeSet::Evdev, Layout::Us, 14),
+            Some(keys::DELETE)
+        );
+        assert_eq!(
+            translate_scancode(ScancodeSet::WindowsVk, Layout::Us, 0x1B),
+            Some(keys::ESC)
+        );
+        // F1 / Shift / out of range
+        assert_eq!(translate_scancode(ScancodeSet::Evdev, Layout::Us, 59), None);
+        assert_eq!(
+            translate_scancode(ScancodeSet::WindowsVk, Layout::Us, 0x10),
+            None
+        );
+        assert_eq!(
+            translate_scancode(ScancodeSet::MacOs, Layout::Us, 1000),
+            None
+        );
+    }
+
+    #[test]
+    fn test_translate_char() {
+        let k = |key, caps, shift| Some(CharKey { key, caps, shift });
+        assert_eq!(translate_char('a'), k(keys::A, false, false));
+        assert_eq!(translate_char('V'), k(keys::V, true, false));
+        assert_eq!(translate_char('7'), k(keys::N7, false, false));
+        assert_eq!(translate_char('@'), k(keys::N2, false, true));
+        assert_eq!(translate_char(':'), k(keys::SEMICOLON, false, true));
+        assert_eq!(translate_char(' '), k(keys::SPACE, false, false));
+        assert_eq!(translate_char('\u{7f}'), k(keys::DELETE, false, false));
+        assert_eq!(translate_char('ế'), None);
+        assert_eq!(translate_char('\u{1}'), None);
+    }
+
+    #[test]
+    fn test_key_char_inverts_translate_char() {
+        for c in '!'..='~' {
+            let k = translate_char(c).unwrap();
+            assert_eq!(key_char(k.key, k.caps, k.shift), Some(c), "{c:?}");
+        }
+        assert_eq!(key_char(keys::A, true, true), Some('A'));
+        // No shifted symbol on letters
+        assert_eq!(key_char(keys::A, false, true), Some('a'));
+        assert_eq!(key_char(keys::SPACE, false, false), None);
+        assert_eq!(key_char(keys::LEFT, false, false), None);
+        assert_eq!(key_char(NO_KEY, false, false), None);
+    }
+
+    #[test]
+    fn test_from_u8() {
+        assert_eq!(Layout::from_u8(2), Some(Layout::Colemak));
+        assert_eq!(Layout::from_u8(4), None);
+        assert_eq!(ScancodeSet::from_u8(1), Some(ScancodeSet::Evdev));
+        assert_eq!(ScancodeSet::from_u8(3), None);
+    }
+}
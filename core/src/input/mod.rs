@@ -2,12 +2,16 @@
 //!
 //! Defines key mappings for Vietnamese input methods.
 //! Engine handles all pattern matching based on buffer scan.
+//! `table` compiles method definitions (built-in Telex and VNI, or loaded
+//! at runtime) into per-key action tables.
+//! `layout` translates platform scancodes and characters into engine keys.
 
+pub mod layout;
+pub mod table;
 pub mod telex;
 pub mod vni;
 
-pub use telex::Telex;
-pub use vni::Vni;
+pub use table::{DefinitionError, Family, KeyAction, MethodTable};
 
 use crate::data::chars::tone;
 use crate::data::keys;
@@ -19,7 +23,7 @@ pub const HORN_TARGETS_VNI: &[u16] = &[keys::O, keys::U];
 pub const BREVE_TARGETS: &[u16] = &[keys::A];
 
 /// Tone modifier type
-#[derive(Debug, Clone, Copy, PartialEq)]
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
 pub enum ToneType {
     /// Circumflex: â, ê, ô
     Circumflex,
@@ -39,35 +43,27 @@ impl ToneType {
     }
 }
 
-/// Input method trait - defines key mappings only
-pub trait Method {
-    /// Check if key is a mark modifier
-    /// Returns: 1=sắc, 2=huyền, 3=hỏi, 4=ngã, 5=nặng
-    fn mark(&self, key: u16) -> Option<u8>;
-
-    /// Check if key is a tone modifier
-    /// Returns tone type if this key can modify vowels
-    fn tone(&self, key: u16) -> Option<ToneType>;
-
-    /// Get valid targets for tone key
-    /// Returns list of vowel keys this tone can apply to
-    fn tone_targets(&self, key: u16) -> &'static [u16];
-
-    /// Check if key is stroke modifier (d → đ)
-    fn stroke(&self, key: u16) -> bool;
-
-    /// Check if key removes diacritics
-    fn remove(&self, key: u16) -> bool;
+/// Get the built-in method table by id (0 = Telex, 1 = VNI)
+#[inline]
+pub fn get(id: u8) -> &'static MethodTable {
+    match id {
+        1 => &vni::TABLE,
+        _ => &telex::TABLE,
+    }
 }
 
-/// Static method instances (zero-sized types, no heap allocation)
-static TELEX: Telex = Telex;
-static VNI: Vni = Vni;
+#[cfg(test)]
+mod tests {
+    use super::*;
 
-/// Get method by id (returns static reference, no allocation)
-pub fn get(id: u8) -> &'static dyn Method {
-    match id {
-        1 => &VNI,
-        _ => &TELEX,
+    #[test]
+    fn test_builtin_tables() {
+        assert_eq!(get(0).family(), Family::Telex);
+        assert_eq!(get(1).family(), Family::Vni);
+        assert_eq!(get(7), &telex::TABLE);
+        assert_eq!(get(0).tone_targets(keys::W), HORN_TARGETS_TELEX);
+        assert_eq!(get(1).tone_targets(keys::N6), CIRCUMFLEX_TARGETS);
+        assert_eq!(get(1).tone_targets(keys::N7), HORN_TARGETS_VNI);
+        assert_eq!(get(1).tone_targets(keys::N8), BREVE_TARGETS);
     }
 }
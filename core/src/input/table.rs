@@ -0,0 +1,501 @@
+//! Input Method Tables
+//!
+//! An input method is a short text definition, compiled into a table with
+//! one `KeyAction` per key (128 entries, the engine key range). The engine
+//! looks a key up with a single index; there is no per-method code.
+//!
+//! ```text
+//! # Telex
+//! base telex             # telex | vni: behaviours not in the table
+//! mark s sac             # sac | huyen | hoi | nga | nang
+//! tone w horn aou        # circumflex | horn | breve, then target vowels
+//! stroke d               # d → đ
+//! remove z               # remove marks
+//! ```
+//!
+//! Keys are single characters (`a`, `7`, `[` …, see
+//! `layout::translate_char`); Shift is not part of the key, so `?` and `/`
+//! are the same key. Targets are drawn from `aeou`: circumflex takes
+//! `aeo`, horn `aou` (Telex `w` puts the breve on `a`), breve `a`.
+//!
+//! `base` selects the behaviours that live in the engine rather than the
+//! table: Telex's standalone `w` → `ư` and its English heuristics, or
+//! VNI's digit handling. It is required.
+//!
+//! `MethodTable::parse` is a `const fn`: the built-in Telex and VNI tables
+//! are parsed from their definitions at compile time, and user definitions
+//! go through the same parser at runtime. It does not allocate.
+
+use super::layout;
+use super::ToneType;
+use crate::data::keys;
+
+/// Keys covered by a table (engine keys are macOS keycodes < 128)
+pub const TABLE_SIZE: usize = 128;
+
+/// Engine behaviours a method inherits (the engine's method id)
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+#[repr(u8)]
+pub enum Family {
+    Telex = 0,
+    Vni = 1,
+}
+
+/// What a key does under an input method, packed in a `u16`:
+///
+/// ```text
+/// bits 0-2  mark (0 none, 1 sắc … 5 nặng)
+/// bits 3-4  tone (0 none, 1 circumflex, 2 horn, 3 breve)
+/// bit  5    stroke
+/// bit  6    remove
+/// bits 7-10 tone targets (a, e, o, u)
+/// ```
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Default)]
+pub struct KeyAction(u16);
+
+const MARK_MASK: u16 = 0b111;
+const TONE_SHIFT: u16 = 3;
+const TONE_MASK: u16 = 0b11 << TONE_SHIFT;
+const STROKE_BIT: u16 = 1 << 5;
+const REMOVE_BIT: u16 = 1 << 6;
+const TARGET_SHIFT: u16 = 7;
+
+const TARGET_A: u16 = 1;
+const TARGET_E: u16 = 2;
+const TARGET_O: u16 = 4;
+const TARGET_U: u16 = 8;
+
+/// Target vowel keys for each target mask, in a, e, o, u order
+static TARGET_SETS: [&[u16]; 16] = [
+    &[],
+    &[keys::A],
+    &[keys::E],
+    &[keys::A, keys::E],
+    &[keys::O],
+    &[keys::A, keys::O],
+    &[keys::E, keys::O],
+    &[keys::A, keys::E, keys::O],
+    &[keys::U],
+    &[keys::A, keys::U],
+    &[keys::E, keys::U],
+    &[keys::A, keys::E, keys::U],
+    &[keys::O, keys::U],
+    &[keys::A, keys::O, keys::U],
+    &[keys::E, keys::O, keys::U],
+    &[keys::A, keys::E, keys::O, keys::U],
+];
+
+impl KeyAction {
+    pub const NONE: Self = Self(0);
+
+    /// Any of mark, tone, stroke or remove
+    #[inline]
+    pub const fn is_modifier(self) -> bool {
+        self.0 & (MARK_MASK | TONE_MASK | STROKE_BIT | REMOVE_BIT) != 0
+    }
+
+    /// Mark value: 1=sắc, 2=huyền, 3=hỏi, 4=ngã, 5=nặng
+    #[inline]
+    pub const fn mark(self) -> Option<u8> {
+        match self.0 & MARK_MASK {
+            0 => None,
+            m => Some(m as u8),
+        }
+    }
+
+    #[inline]
+    pub const fn tone(self) -> Option<ToneType> {
+        match (self.0 & TONE_MASK) >> TONE_SHIFT {
+            1 => Some(ToneType::Circumflex),
+            2 => Some(ToneType::Horn),
+            3 => Some(ToneType::Breve),
+            _ => None,
+        }
+    }
+
+    /// Vowel keys the tone applies to
+    #[inline]
+    pub fn tone_targets(self) -> &'static [u16] {
+        TARGET_SETS[(self.0 >> TARGET_SHIFT) as usize & 0xF]
+    }
+
+    #[inline]
+    pub const fn stroke(self) -> bool {
+        self.0 & STROKE_BIT != 0
+    }
+
+    #[inline]
+    pub const fn remove(self) -> bool {
+        self.0 & REMOVE_BIT != 0
+    }
+}
+
+/// Why a definition was rejected
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct DefinitionError {
+    /// 1-based line number
+    pub line: usize,
+    pub message: &'static str,
+}
+
+/// A compiled input method
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct MethodTable {
+    family: Family,
+    actions: [KeyAction; TABLE_SIZE],
+}
+
+impl MethodTable {
+    /// Compile a definition (see the module docs)
+    pub const fn parse(definition: &str) -> Result<Self, DefinitionError> {
+        parse(definition.as_bytes())
+    }
+
+    /// Compile a built-in definition; fails the build if it is invalid
+    pub const fn builtin(definition: &str) -> Self {
+        match parse(definition.as_bytes()) {
+            Ok(table) => table,
+            Err(_) => panic!("invalid built-in input method definition"),
+        }
+    }
+
+    pub const fn family(&self) -> Family {
+        self.family
+    }
+
+    /// The action of `key` (one index; `NONE` for keys outside the table)
+    #[inline]
+    pub const fn action(&self, key: u16) -> KeyAction {
+        if (key as usize) < TABLE_SIZE {
+            self.actions[key as usize]
+        } else {
+            KeyAction::NONE
+        }
+    }
+
+    /// Shorthand for `action(key).mark()`
+    #[inline]
+    pub const fn mark(&self, key: u16) -> Option<u8> {
+        self.action(key).mark()
+    }
+
+    /// Shorthand for `action(key).tone()`
+    #[inline]
+    pub const fn tone(&self, key: u16) -> Option<ToneType> {
+        self.action(key).tone()
+    }
+
+    /// Shorthand for `action(key).tone_targets()`
+    #[inline]
+    pub fn tone_targets(&self, key: u16) -> &'static [u16] {
+        self.action(key).tone_targets()
+    }
+
+    /// Shorthand for `action(key).stroke()`
+    #[inline]
+    pub const fn stroke(&self, key: u16) -> bool {
+        self.action(key).stroke()
+    }
+
+    /// Shorthand for `action(key).remove()`
+    #[inline]
+    pub const fn remove(&self, key: u16) -> bool {
+        self.action(key).remove()
+    }
+}
+
+// ============================================================
+// Parser (const, allocation-free)
+// ============================================================
+
+/// Byte range of a word within the definition
+#[derive(Clone, Copy)]
+struct Token {
+    start: usize,
+    end: usize,
+}
+
+impl Token {
+    const fn is_empty(self) -> bool {
+        self.start == self.end
+    }
+}
+
+macro_rules! ctry {
+    ($e:expr) => {
+        match $e {
+            Ok(v) => v,
+            Err(e) => return Err(e),
+        }
+    };
+}
+
+const fn err<T>(line: usize, message: &'static str) -> Result<T, DefinitionError> {
+    Err(DefinitionError { line, message })
+}
+
+/// Next word in `b[pos..end]`; empty at end of line or at a `#` comment
+const fn next_token(b: &[u8], mut pos: usize, end: usize) -> Token {
+    while pos < end && matches!(b[pos], b' ' | b'\t' | b'\r') {
+        pos += 1;
+    }
+    if pos < end && b[pos] == b'#' {
+        return Token { start: end, end };
+    }
+    let start = pos;
+    while pos < end && !matches!(b[pos], b' ' | b'\t' | b'\r' | b'#') {
+        pos += 1;
+    }
+    Token { start, end: pos }
+}
+
+const fn token_is(b: &[u8], t: Token, word: &[u8]) -> bool {
+    if t.end - t.start != word.len() {
+        return false;
+    }
+    let mut i = 0;
+    while i < word.len() {
+        if b[t.start + i] != word[i] {
+            return false;
+        }
+        i += 1;
+    }
+    true
+}
+
+const fn parse_key(b: &[u8], t: Token, line: usize) -> Result<u16, DefinitionError> {
+    if t.end - t.start != 1 {
+        return err(line, "Key must be a single character");
+    }
+    let c = b[t.start];
+    if c.is_ascii_uppercase() {
+        return err(line, "Keys are lowercase");
+    }
+    match layout::ascii_key(c) {
+        Some(key) if (key as usize) < TABLE_SIZE => Ok(key),
+        _ => err(line, "Unknown key"),
+    }
+}
+
+const fn parse_mark(b: &[u8], t: Token, line: usize) -> Result<u16, DefinitionError> {
+    const NAMES: [&[u8]; 5] = [b"sac", b"huyen", b"hoi", b"nga", b"nang"];
+    let mut i = 0;
+    while i < NAMES.len() {
+        if token_is(b, t, NAMES[i]) {
+            return Ok(i as u16 + 1);
+        }
+        i += 1;
+    }
+    err(line, "Unknown mark (sac, huyen, hoi, nga, nang)")
+}
+
+/// Tone kind and the target vowels it allows
+const fn parse_tone(b: &[u8], t: Token, line: usize) -> Result<(u16, u16), DefinitionError> {
+    if token_is(b, t, b"circumflex") {
+        Ok((1, TARGET_A | TARGET_E | TARGET_O))
+    } else if token_is(b, t, b"horn") {
+        Ok((2, TARGET_A | TARGET_O | TARGET_U))
+    } else if token_is(b, t, b"breve") {
+        Ok((3, TARGET_A))
+    } else {
+        err(line, "Unknown tone (circumflex, horn, breve)")
+    }
+}
+
+const fn parse_targets(
+    b: &[u8],
+    t: Token,
+    allowed: u16,
+    line: usize,
+) -> Result<u16, DefinitionError> {
+    let mut mask = 0;
+    let mut i = t.start;
+    while i < t.end {
+        let bit = match b[i] {
+            b'a' => TARGET_A,
+            b'e' => TARGET_E,
+            b'o' => TARGET_O,
+            b'u' => TARGET_U,
+            _ => return err(line, "Targets are vowels from aeou"),
+        };
+        if bit & allowed == 0 {
+            return err(line, "Vowel cannot take this tone");
+        }
+        mask |= bit;
+        i += 1;
+    }
+    if mask == 0 {
+        return err(line, "Missing tone targets");
+    }
+    Ok(mask)
+}
+
+const fn parse(b: &[u8]) -> Result<MethodTable, DefinitionError> {
+    let mut actions = [KeyAction::NONE; TABLE_SIZE];
+    let mut family = None;
+    let mut pos = 0;
+    let mut line = 0;
+    while pos < b.len() {
+        line += 1;
+        let mut end = pos;
+        while end < b.len() && b[end] != b'\n' {
+            end += 1;
+        }
+        let t0 = next_token(b, pos, end);
+        let t1 = next_token(b, t0.end, end);
+        let t2 = next_token(b, t1.end, end);
+        let t3 = next_token(b, t2.end, end);
+        let extra = next_token(b, t3.end, end);
+        pos = end + 1;
+
+        if t0.is_empty() {
+            continue;
+        }
+        // Arguments each directive takes
+        let argc = if token_is(b, t0, b"tone") {
+            3
+        } else if token_is(b, t0, b"mark") {
+            2
+        } else if token_is(b, t0, b"base")
+            || token_is(b, t0, b"stroke")
+            || token_is(b, t0, b"remove")
+        {
+            1
+        } else {
+            return err(line, "Unknown directive (base, mark, tone, stroke, remove)");
+        };
+        let given = !t1.is_empty() as usize
+            + !t2.is_empty() as usize
+            + !t3.is_empty() as usize
+            + !extra.is_empty() as usize;
+        if given != argc {
+            return err(line, "Wrong number of arguments");
+        }
+
+        if token_is(b, t0, b"base") {
+            if family.is_some() {
+                return err(line, "Duplicate base");
+            }
+            family = if token_is(b, t1, b"telex") {
+                Some(Family::Telex)
+            } else if token_is(b, t1, b"vni") {
+                Some(Family::Vni)
+            } else {
+                return err(line, "Unknown base (telex, vni)");
+            };
+            continue;
+        }
+
+        let key = ctry!(parse_key(b, t1, line));
+        let action = if token_is(b, t0, b"mark") {
+            ctry!(parse_mark(b, t2, line))
+        } else if token_is(b, t0, b"tone") {
+            let (tone, allowed) = ctry!(parse_tone(b, t2, line));
+            let targets = ctry!(parse_targets(b, t3, allowed, line));
+            (tone << TONE_SHIFT) | (targets << TARGET_SHIFT)
+        } else if token_is(b, t0, b"stroke") {
+            STROKE_BIT
+        } else {
+            REMOVE_BIT
+        };
+        if actions[key as usize].0 != 0 {
+            return err(line, "Key already assigned");
+        }
+        actions[key as usize] = KeyAction(action);
+    }
+    match family {
+        Some(family) => Ok(MethodTable { family, actions }),
+        None => err(
+            if line == 0 { 1 } else { line },
+            "Missing base (telex, vni)",
+        ),
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn parse_err(text: &str) -> DefinitionError {
+        MethodTable::parse(text).unwrap_err()
+    }
+
+    #[test]
+    fn test_parse_definition() {
+        let t = MethodTable::parse(
+            "# Simplified Telex\n\
+             base telex\n\
+             mark s sac   # acute\n\
+             \n\
+             tone w horn aou\n\
+             tone [ horn u\n\
+             stroke d\n\
+             remove z\n",
+        )
+        .unwrap();
+        assert_eq!(t.family(), Family::Telex);
+        assert_eq!(t.mark(keys::S), Some(1));
+        assert_eq!(t.mark(keys::F), None);
+        assert_eq!(t.tone(keys::W), Some(ToneType::Horn));
+        assert_eq!(t.tone_targets(keys::W), &[keys::A, keys::O, keys::U]);
+        assert_eq!(t.tone_targets(keys::LBRACKET), &[keys::U]);
+        assert!(t.stroke(keys::D) && t.remove(keys::Z));
+        assert!(t.action(keys::D).is_modifier());
+        assert!(!t.action(keys::B).is_modifier());
+        assert_eq!(t.action(500), KeyAction::NONE);
+    }
+
+    #[test]
+    fn test_rejects_invalid_definitions() {
+        let cases = [
+            ("mark s sac", 1, "Missing base (telex, vni)"),
+            ("base telex\nbase vni", 2, "Duplicate base"),
+            ("base qwerty", 1, "Unknown base (telex, vni)"),
+            (
+                "base telex\nmark s acute",
+                2,
+                "Unknown mark (sac, huyen, hoi, nga, nang)",
+            ),
+            ("base telex\nmark S sac", 2, "Keys are lowercase"),
+            (
+                "base telex\nmark ss sac",
+                2,
+                "Key must be a single character",
+            ),
+            (
+                "base telex\nmark é sac",
+                2,
+                "Key must be a single character",
+            ),
+            (
+                "base telex\ntone w horn ae",
+                2,
+                "Vowel cannot take this tone",
+            ),
+            (
+                "base telex\ntone w horn xy",
+                2,
+                "Targets are vowels from aeou",
+            ),
+            ("base telex\ntone w horn", 2, "Wrong number of arguments"),
+            ("base telex\nstroke d d", 2, "Wrong number of arguments"),
+            (
+                "base telex\nmark s sac\nstroke s",
+                3,
+                "Key already assigned",
+            ),
+            (
+                "base telex\nundo z",
+                2,
+                "Unknown directive (base, mark, tone, stroke, remove)",
+            ),
+        ];
+        for (text, line, message) in cases {
+            assert_eq!(
+                parse_err(text),
+                DefinitionError { line, message },
+                "{text:?}"
+            );
+        }
+    }
+}
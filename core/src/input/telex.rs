@@ -6,59 +6,36 @@
 //! - Stroke: d
 //! - Remove: z
 
-use super::Method;
-use crate::data::keys;
-use crate::input::ToneType;
-
-pub struct Telex;
-
-impl Method for Telex {
-    fn mark(&self, key: u16) -> Option<u8> {
-        match key {
-            keys::S => Some(1), // sắc
-            keys::F => Some(2), // huyền
-            keys::R => Some(3), // hỏi
-            keys::X => Some(4), // ngã
-            keys::J => Some(5), // nặng
-            _ => None,
-        }
-    }
-
-    fn tone(&self, key: u16) -> Option<ToneType> {
-        match key {
-            keys::A | keys::E | keys::O => Some(ToneType::Circumflex),
-            keys::W => Some(ToneType::Horn),
-            _ => None,
-        }
-    }
-
-    fn tone_targets(&self, key: u16) -> &'static [u16] {
-        match key {
-            keys::A => &[keys::A],
-            keys::E => &[keys::E],
-            keys::O => &[keys::O],
-            keys::W => &[keys::A, keys::O, keys::U], // Explicitly include A for Breve (ă) support
-            _ => &[],
-        }
-    }
-
-    fn stroke(&self, key: u16) -> bool {
-        key == keys::D
-    }
-
-    fn remove(&self, key: u16) -> bool {
-        key == keys::Z
-    }
-}
+use super::MethodTable;
+
+/// Telex definition (format: see `table`)
+pub const DEFINITION: &str = "\
+base telex
+mark s sac
+mark f huyen
+mark r hoi
+mark x nga
+mark j nang
+tone a circumflex a
+tone e circumflex e
+tone o circumflex o
+tone w horn aou     # a included for breve (ă)
+stroke d
+remove z
+";
+
+/// Telex table, compiled at build time
+pub static TABLE: MethodTable = MethodTable::builtin(DEFINITION);
 
 #[cfg(test)]
 mod tests {
     use super::*;
-    use crate::input::HORN_TARGETS_TELEX;
+    use crate::data::keys;
+    use crate::input::{ToneType, HORN_TARGETS_TELEX};
 
     #[test]
     fn test_marks() {
-        let t = Telex;
+        let t = &TABLE;
         assert_eq!(t.mark(keys::S), Some(1));
         assert_eq!(t.mark(keys::F), Some(2));
         assert_eq!(t.mark(keys::A), None);
@@ -66,7 +43,7 @@ mod tests {
 
     #[test]
     fn test_tones() {
-        let t = Telex;
+        let t = &TABLE;
         assert_eq!(t.tone(keys::A), Some(ToneType::Circumflex));
         assert_eq!(t.tone(keys::W), Some(ToneType::Horn));
         assert_eq!(t.tone(keys::B), None);
@@ -74,7 +51,7 @@ mod tests {
 
     #[test]
     fn test_tone_targets() {
-        let t = Telex;
+        let t = &TABLE;
         assert_eq!(t.tone_targets(keys::A), &[keys::A]);
         assert_eq!(t.tone_targets(keys::W), HORN_TARGETS_TELEX);
     }
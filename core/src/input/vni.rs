@@ -6,57 +6,35 @@
 //! - Stroke: 9
 //! - Remove: 0
 
-use super::{Method, ToneType, BREVE_TARGETS, CIRCUMFLEX_TARGETS, HORN_TARGETS_VNI};
-use crate::data::keys;
-
-pub struct Vni;
-
-impl Method for Vni {
-    fn mark(&self, key: u16) -> Option<u8> {
-        match key {
-            keys::N1 => Some(1), // sắc
-            keys::N2 => Some(2), // huyền
-            keys::N3 => Some(3), // hỏi
-            keys::N4 => Some(4), // ngã
-            keys::N5 => Some(5), // nặng
-            _ => None,
-        }
-    }
-
-    fn tone(&self, key: u16) -> Option<ToneType> {
-        match key {
-            keys::N6 => Some(ToneType::Circumflex),
-            keys::N7 => Some(ToneType::Horn),
-            keys::N8 => Some(ToneType::Breve),
-            _ => None,
-        }
-    }
-
-    fn tone_targets(&self, key: u16) -> &'static [u16] {
-        match key {
-            keys::N6 => CIRCUMFLEX_TARGETS,
-            keys::N7 => HORN_TARGETS_VNI,
-            keys::N8 => BREVE_TARGETS,
-            _ => &[],
-        }
-    }
-
-    fn stroke(&self, key: u16) -> bool {
-        key == keys::N9
-    }
-
-    fn remove(&self, key: u16) -> bool {
-        key == keys::N0
-    }
-}
+use super::MethodTable;
+
+/// VNI definition (format: see `table`)
+pub const DEFINITION: &str = "\
+base vni
+mark 1 sac
+mark 2 huyen
+mark 3 hoi
+mark 4 nga
+mark 5 nang
+tone 6 circumflex aeo
+tone 7 horn ou
+tone 8 breve a
+stroke 9
+remove 0
+";
+
+/// VNI table, compiled at build time
+pub static TABLE: MethodTable = MethodTable::builtin(DEFINITION);
 
 #[cfg(test)]
 mod tests {
     use super::*;
+    use crate::data::keys;
+    use crate::input::ToneType;
 
     #[test]
     fn test_marks() {
-        let v = Vni;
+        let v = &TABLE;
         assert_eq!(v.mark(keys::N1), Some(1));
         assert_eq!(v.mark(keys::N5), Some(5));
         assert_eq!(v.mark(keys::A), None);
@@ -64,7 +42,7 @@ mod tests {
 
     #[test]
     fn test_tones() {
-        let v = Vni;
+        let v = &TABLE;
         assert_eq!(v.tone(keys::N6), Some(ToneType::Circumflex));
         assert_eq!(v.tone(keys::N7), Some(ToneType::Horn));
         assert_eq!(v.tone(keys::N8), Some(ToneType::Breve));
@@ -72,7 +50,7 @@ mod tests {
 
     #[test]
     fn test_stroke() {
-        let v = Vni;
+        let v = &TABLE;
         assert!(v.stroke(keys::N9));
         assert!(!v.stroke(keys::D));
     }
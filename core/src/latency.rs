@@ -0,0 +1,322 @@
+//! Keystroke Latency Histograms
+//!
+//! Attributes each timed keystroke's latency to the stage that spent it:
+//! - `Queue`: OS event timestamp → key handed to the engine (event tap,
+//!   run loop scheduling, then the wait for the engine lock)
+//! - `Processing`: key processing inside `ime_key_timed`, lock held
+//! - `Injection`: processed → platform reports the edit injected
+//! - `Total`: OS event timestamp → injection complete
+//!
+//! The platform supplies its timestamps in one monotonic nanosecond clock
+//! of its choice (on macOS, `clock_gettime_nsec_np(CLOCK_UPTIME_RAW)`
+//! matches `CGEventGetTimestamp`); processing time is measured here, so
+//! only differences between platform timestamps are ever taken.
+//!
+//! Histograms are log-linear: one bucket below 1 µs, then 4 buckets per
+//! power of two up to ~13 s (the last bucket holds everything above).
+//! Bucket bounds are within 25% of each other, so percentiles read from
+//! them are within that of the true value. Counters are relaxed atomics:
+//! recording is a few atomic adds, and reading from another thread never
+//! blocks typing (a snapshot may miss a key recorded meanwhile).
+
+use std::sync::atomic::{AtomicBool, AtomicU32, AtomicU64, Ordering};
+
+/// Buckets per histogram
+pub const LATENCY_BUCKETS: usize = 96;
+
+/// Values below this share bucket 0 (ns)
+const FIRST_BOUND_NS: u64 = 1024;
+const FIRST_BOUND_LOG2: u32 = FIRST_BOUND_NS.trailing_zeros();
+
+/// Stage of a keystroke's latency
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+#[repr(u8)]
+pub enum LatencyStage {
+    Queue = 0,
+    Processing = 1,
+    Injection = 2,
+    Total = 3,
+}
+
+impl LatencyStage {
+    pub const ALL: [Self; 4] = [Self::Queue, Self::Processing, Self::Injection, Self::Total];
+
+    pub fn from_u8(value: u8) -> Option<Self> {
+        Self::ALL.get(value as usize).copied()
+    }
+}
+
+/// Bucket holding a latency of `ns`
+#[inline]
+pub fn bucket_index(ns: u64) -> usize {
+    if ns < FIRST_BOUND_NS {
+        return 0;
+    }
+    let log2 = 63 - ns.leading_zeros();
+    let sub = (ns >> (log2 - 2)) & 3;
+    let index = 1 + (log2 - FIRST_BOUND_LOG2) as usize * 4 + sub as usize;
+    index.min(LATENCY_BUCKETS - 1)
+}
+
+/// Exclusive upper bound of bucket `index` in ns (`u64::MAX` for the last)
+pub fn bucket_upper_ns(index: usize) -> u64 {
+    if index == 0 {
+        return FIRST_BOUND_NS;
+    }
+    if index >= LATENCY_BUCKETS - 1 {
+        return u64::MAX;
+    }
+    let log2 = FIRST_BOUND_LOG2 + ((index - 1) / 4) as u32;
+    let sub = ((index - 1) % 4) as u64;
+    (5 + sub) << (log2 - 2)
+}
+
+/// Summary of one stage (C layout: `ImeLatencyStats`)
+#[repr(C)]
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct LatencyStats {
+    pub count: u64,
+    pub mean_ns: u64,
+    pub p50_ns: u64,
+    pub p90_ns: u64,
+    pub p99_ns: u64,
+    pub max_ns: u64,
+}
+
+/// Latency histogram of one stage
+pub struct Histogram {
+    buckets: [AtomicU32; LATENCY_BUCKETS],
+    count: AtomicU64,
+    sum_ns: AtomicU64,
+    max_ns: AtomicU64,
+}
+
+impl Default for Histogram {
+    fn default() -> Self {
+        Self::new()
+    }
+}
+
+impl Histogram {
+    pub const fn new() -> Self {
+        Self {
+            buckets: [const { AtomicU32::new(0) }; LATENCY_BUCKETS],
+            count: AtomicU64::new(0),
+            sum_ns: AtomicU64::new(0),
+            max_ns: AtomicU64::new(0),
+        }
+    }
+
+    #[inline]
+    pub fn record(&self, ns: u64) {
+        self.buckets[bucket_index(ns)].fetch_add(1, Ordering::Relaxed);
+        self.count.fetch_add(1, Ordering::Relaxed);
+        self.sum_ns.fetch_add(ns, Ordering::Relaxed);
+        self.max_ns.fetch_max(ns, Ordering::Relaxed);
+    }
+
+    pub fn count(&self) -> u64 {
+        self.count.load(Ordering::Relaxed)
+    }
+
+    /// Copy bucket counts into `out` (up to `LATENCY_BUCKETS`); returns
+    /// the number written
+    pub fn copy_buckets(&self, out: &mut [u32]) -> usize {
+        let n = out.len().min(LATENCY_BUCKETS);
+        for (dst, bucket) in out[..n].iter_mut().zip(&self.buckets) {
+            *dst = bucket.load(Ordering::Relaxed);
+        }
+        n
+    }
+
+    /// Latency at or below which `percent` of the keys fall: the upper
+    /// bound of the bucket holding that rank, capped at the maximum seen
+    pub fn percentile(&self, percent: f64) -> u64 {
+        let mut counts = [0u32; LATENCY_BUCKETS];
+        self.copy_buckets(&mut counts);
+        let total: u64 = counts.iter().map(|&c| c as u64).sum();
+        if total == 0 {
+            return 0;
+        }
+        let rank = ((total as f64 * percent.clamp(0.0, 100.0) / 100.0).ceil() as u64).max(1);
+        let max = self.max_ns.load(Ordering::Relaxed);
+        let mut seen = 0;
+        for (i, &c) in counts.iter().enumerate() {
+            seen += c as u64;
+            if seen >= rank {
+                return bucket_upper_ns(i).min(max);
+            }
+        }
+        max
+    }
+
+    pub fn stats(&self) -> LatencyStats {
+        let count = self.count();
+        LatencyStats {
+            count,
+            mean_ns: self.sum_ns.load(Ordering::Relaxed) / count.max(1),
+            p50_ns: self.percentile(50.0),
+            p90_ns: self.percentile(90.0),
+            p99_ns: self.percentile(99.0),
+            max_ns: self.max_ns.load(Ordering::Relaxed),
+        }
+    }
+
+    pub fn reset(&self) {
+        for bucket in &self.buckets {
+            bucket.store(0, Ordering::Relaxed);
+        }
+        self.count.store(0, Ordering::Relaxed);
+        self.sum_ns.store(0, Ordering::Relaxed);
+        self.max_ns.store(0, Ordering::Relaxed);
+    }
+}
+
+/// Per-stage histograms plus the key awaiting its injection report
+pub struct LatencyRecorder {
+    stages: [Histogram; 4],
+    /// Last timed key: OS event time and time its result was returned
+    pending: AtomicBool,
+    pending_event_ns: AtomicU64,
+    pending_returned_ns: AtomicU64,
+}
+
+impl Default for LatencyRecorder {
+    fn default() -> Self {
+        Self::new()
+    }
+}
+
+impl LatencyRecorder {
+    pub const fn new() -> Self {
+        Self {
+            stages: [const { Histogram::new() }; 4],
+            pending: AtomicBool::new(false),
+            pending_event_ns: AtomicU64::new(0),
+            pending_returned_ns: AtomicU64::new(0),
+        }
+    }
+
+    pub fn stage(&self, stage: LatencyStage) -> &Histogram {
+        &self.stages[stage as usize]
+    }
+
+    /// Record a processed key. `event_ns` / `received_ns` are platform
+    /// timestamps; `lock_wait_ns` (the wait for the engine lock) counts
+    /// toward the queue, and the result is considered returned at
+    /// `received_ns + lock_wait_ns + processing_ns`. A queue time that
+    /// runs backwards (mismatched clocks) counts as the lock wait alone.
+    #[inline]
+    pub fn record_key(
+        &self,
+        event_ns: u64,
+        received_ns: u64,
+        lock_wait_ns: u64,
+        processing_ns: u64,
+    ) {
+        let queue = received_ns.saturating_sub(event_ns);
+        self.stage(LatencyStage::Queue)
+            .record(queue.saturating_add(lock_wait_ns));
+        self.stage(LatencyStage::Processing).record(processing_ns);
+        let returned = received_ns
+            .saturating_add(lock_wait_ns)
+            .saturating_add(processing_ns);
+        self.pending_event_ns.store(event_ns, Ordering::Relaxed);
+        self.pending_returned_ns.store(returned, Ordering::Relaxed);
+        self.pending.store(true, Ordering::Release);
+    }
+
+    /// Record the injection of the last recorded key, done at `done_ns`.
+    /// False if no key is waiting (already reported, or none recorded).
+    #[inline]
+    pub fn record_injected(&self, done_ns: u64) -> bool {
+        if !self.pending.swap(false, Ordering::Acquire) {
+            return false;
+        }
+        let returned = self.pending_returned_ns.load(Ordering::Relaxed);
+        let event = self.pending_event_ns.load(Ordering::Relaxed);
+        self.stage(LatencyStage::Injection)
+            .record(done_ns.saturating_sub(returned));
+        self.stage(LatencyStage::Total)
+            .record(done_ns.saturating_sub(event));
+        true
+    }
+
+    pub fn reset(&self) {
+        for histogram in &self.stages {
+            histogram.reset();
+        }
+        self.pending.store(false, Ordering::Relaxed);
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_buckets() {
+        assert_eq!(bucket_index(0), 0);
+        assert_eq!(bucket_index(1023), 0);
+        assert_eq!(bucket_index(1024), 1);
+        assert_eq!(bucket_index(u64::MAX), LATENCY_BUCKETS - 1);
+        // Every value falls below its bucket's bound and at or above the
+        // previous one
+        for ns in [1024, 1279, 1280, 5_000, 250_000, 16_000_000, 8_000_000_000] {
+            let i = bucket_index(ns);
+            assert!(ns < bucket_upper_ns(i), "{ns}");
+            assert!(ns >= bucket_upper_ns(i - 1), "{ns}");
+        }
+        for i in 1..LATENCY_BUCKETS - 1 {
+            let (lo, hi) = (bucket_upper_ns(i - 1), bucket_upper_ns(i));
+            assert!(hi > lo && hi - lo <= lo / 4, "bucket {i}");
+        }
+    }
+
+    #[test]
+    fn test_percentiles() {
+        let h = Histogram::new();
+        assert_eq!(h.stats(), LatencyStats::default());
+        for _ in 0..99 {
+            h.record(200_000);
+        }
+        h.record(5_000_000);
+        let s = h.stats();
+        assert_eq!((s.count, s.max_ns), (100, 5_000_000));
+        assert_eq!(s.mean_ns, (99 * 200_000 + 5_000_000) / 100);
+        assert!((200_000..250_000).contains(&s.p50_ns));
+        assert_eq!(s.p99_ns, s.p50_ns);
+        assert_eq!(h.percentile(100.0), 5_000_000);
+        h.reset();
+        assert_eq!(h.count(), 0);
+    }
+
+    #[test]
+    fn test_stages() {
+        let r = LatencyRecorder::new();
+        r.record_key(1_000_000, 1_300_000, 0, 20_000);
+        assert!(r.record_injected(2_320_000));
+        assert!(!r.record_injected(3_000_000));
+
+        let max = |stage| r.stage(stage).stats().max_ns;
+        assert_eq!(max(LatencyStage::Queue), 300_000);
+        assert_eq!(max(LatencyStage::Processing), 20_000);
+        assert_eq!(max(LatencyStage::Injection), 1_000_000);
+        assert_eq!(max(LatencyStage::Total), 1_320_000);
+
+        // A lock wait is queue time, not injection time
+        r.record_key(3_000_000, 3_100_000, 50_000, 20_000);
+        assert!(r.record_injected(4_170_000));
+        let mean = |stage| r.stage(stage).stats().mean_ns;
+        assert_eq!(mean(LatencyStage::Queue), (300_000 + 150_000) / 2);
+        assert_eq!(mean(LatencyStage::Injection), 1_000_000);
+
+        // Clock mismatch: negative spans count as 0
+        r.record_key(5_000, 4_000, 0, 10);
+        assert!(r.record_injected(0));
+        let mut first = [0u32; 1];
+        r.stage(LatencyStage::Injection).copy_buckets(&mut first);
+        assert_eq!(first[0], 1);
+        assert_eq!(r.stage(LatencyStage::Queue).stats().count, 3);
+    }
+}
@@ -20,25 +20,108 @@
 //! ime_clear();
 //! ```
 
+/// Trace logging for engine internals
+///
+/// Compiled out unless the `debug-log` feature is enabled: the engine runs
+/// on every keystroke, and formatting + stderr writes cost far more than
+/// the key processing itself. Arguments are still type-checked.
+macro_rules! debug_log {
+    ($($arg:tt)*) => {
+        if cfg!(feature = "debug-log") {
+            eprintln!($($arg)*);
+        }
+    };
+}
+
+pub mod daemon;
 pub mod data;
+pub mod embedded;
 pub mod engine;
 pub mod engine_v2;
 pub mod input;
+pub mod latency;
+#[cfg(feature = "updater")]
 pub mod updater;
 pub mod utils;
 
+use engine::state::ProfileRegistry;
 use engine::{Engine, Result};
 use std::sync::Mutex;
 
 // Global engine instance (thread-safe via Mutex)
 static ENGINE: Mutex<Option<Engine>> = Mutex::new(None);
 
+// Committed-word events published by the FFI engine (`ime_commit_events`)
+static COMMITS: engine::features::CommitRing = engine::features::CommitRing::new();
+
+// Per-stage latency of keys processed with `ime_key_timed`
+static LATENCY: latency::LatencyRecorder = latency::LatencyRecorder::new();
+
+// Parked per-app profiles (created on first activation).
+// Lock order: ENGINE, then PROFILES.
+static PROFILES: Mutex<Option<ProfileRegistry>> = Mutex::new(None);
+
 /// Lock the engine mutex, recovering from poisoned state if needed (for tests)
 #[inline(always)]
 fn lock_engine() -> std::sync::MutexGuard<'static, Option<Engine>> {
     ENGINE.lock().unwrap_or_else(|e| e.into_inner())
 }
 
+#[inline(always)]
+fn lock_profiles() -> std::sync::MutexGuard<'static, Option<ProfileRegistry>> {
+    PROFILES.lock().unwrap_or_else(|e| e.into_inner())
+}
+
+// ============================================================
+// Build Features
+// ============================================================
+
+/// `ime_features` bit: English detection and auto-restore
+pub const FEATURE_ENGLISH_DETECTION: u32 = 1 << 0;
+/// `ime_features` bit: embedded English word lists and shortcode table
+pub const FEATURE_DICTIONARIES: u32 = 1 << 1;
+/// `ime_features` bit: shortcuts, snippets and their JSON import/export
+pub const FEATURE_SHORTCUTS: u32 = 1 << 2;
+/// `ime_features` bit: legacy output encodings (TCVN3, VNI, CP1258)
+pub const FEATURE_ENCODING: u32 = 1 << 3;
+/// `ime_features` bit: `updater` module
+pub const FEATURE_UPDATER: u32 = 1 << 4;
+
+/// Subsystems compiled into this build (`FEATURE_*` bits)
+pub const fn compiled_features() -> u32 {
+    let mut bits = 0;
+    if cfg!(feature = "english-detection") {
+        bits |= FEATURE_ENGLISH_DETECTION;
+    }
+    if cfg!(feature = "dictionaries") {
+        bits |= FEATURE_DICTIONARIES;
+    }
+    if cfg!(feature = "shortcuts") {
+        bits |= FEATURE_SHORTCUTS;
+    }
+    if cfg!(feature = "encoding") {
+        bits |= FEATURE_ENCODING;
+    }
+    if cfg!(feature = "updater") {
+        bits |= FEATURE_UPDATER;
+    }
+    bits
+}
+
+/// Report which optional subsystems this library was built with.
+///
+/// Hosts should hide settings for missing subsystems: their FFI calls
+/// still link but fail (false / -1 / null) or do nothing.
+/// Safe to call before `ime_init`.
+///
+/// # Returns
+/// Bitmask: 1=English detection, 2=dictionaries, 4=shortcuts,
+/// 8=encodings, 16=updater
+#[no_mangle]
+pub extern "C" fn ime_features() -> u32 {
+    compiled_features()
+}
+
 // ============================================================
 // FFI Interface
 // ============================================================
@@ -54,6 +137,35 @@ fn lock_engine() -> std::sync::MutexGuard<'static, Option<Engine>> {
 pub extern "C" fn ime_init() {
     let mut guard = lock_engine();
     *guard = Some(Engine::new());
+    *lock_profiles() = None;
+}
+
+/// Drop the IME engine and free its state.
+///
+/// Afterwards `ime_*` functions behave as before `ime_init` (null / -1 /
+/// false / no-op). `ime_init` may be called again.
+#[no_mangle]
+pub extern "C" fn ime_shutdown() {
+    let mut guard = lock_engine();
+    let engine = guard.take();
+    let profiles = lock_profiles().take();
+    drop(guard);
+    // Drop outside the locks (dictionaries, learned data)
+    drop((engine, profiles));
+}
+
+/// Fault in the embedded English dictionaries on a background thread.
+///
+/// The engine initializes lazily and the word lists (~1.4MB) are only
+/// paged in by the first lookup. Call this at startup, well before the
+/// user types, to move that cost off the first keystroke. Optional and
+/// independent of `ime_init`.
+///
+/// # Returns
+/// false if the build has no dictionaries or the thread could not start.
+#[no_mangle]
+pub extern "C" fn ime_prefetch_dictionaries() -> bool {
+    engine::Dictionary::prefetch_in_background()
 }
 
 /// Process a key event and return the result.
@@ -120,489 +232,1865 @@ pub extern "C" fn ime_key_ext(key: u16, caps: bool, ctrl: bool, shift: bool) ->
     }
 }
 
-/// Set the input method.
+/// Process a character (IME text events, WASM, test tools).
+///
+/// The character is mapped to an engine key with one table lookup
+/// (`input::layout::translate_char`): uppercase letters set `caps`,
+/// shifted symbols (`@`, `:` …) set `shift`.
 ///
 /// # Arguments
-/// * `method` - 0 for Telex, 1 for VNI
+/// * `codepoint` - Unicode scalar value; `\b`/DEL = backspace, `\r`/`\n` = return
+/// * `ctrl` - true if Cmd/Ctrl/Alt is pressed (bypasses IME)
 ///
-/// No-op if engine not initialized.
+/// # Returns
+/// * Pointer to `Result` struct (caller must free with `ime_free`);
+///   action 0 (pass through) for characters with no engine key
+/// * `null` if engine not initialized
 #[no_mangle]
-#[inline]
-pub extern "C" fn ime_method(method: u8) {
-    if let Some(e) = lock_engine().as_mut() {
-        e.set_method(method);
-    }
+pub extern "C" fn ime_key_char(codepoint: u32, ctrl: bool) -> *mut Result {
+    let mut guard = lock_engine();
+    let Some(e) = guard.as_mut() else {
+        return std::ptr::null_mut();
+    };
+    let r = match char::from_u32(codepoint).and_then(input::layout::translate_char) {
+        Some(k) => e.on_key_ext(k.key, k.caps, ctrl, k.shift),
+        None => Result::none(),
+    };
+    Box::into_raw(Box::new(r))
 }
 
-/// Enable or disable the engine.
+/// Process a platform scancode under a keyboard layout.
 ///
-/// When disabled, `ime_key` returns action=0 (pass through).
-/// No-op if engine not initialized.
-#[no_mangle]
-#[inline]
-pub extern "C" fn ime_enabled(enabled: bool) {
-    if let Some(e) = lock_engine().as_mut() {
-        e.set_enabled(enabled);
-    }
-}
-
-/// Set whether to skip w→ư shortcut in Telex mode.
+/// # Arguments
+/// * `set` - 0 = macOS keycode, 1 = Linux evdev, 2 = Windows VK
+/// * `layout` - 0 = US, 1 = Dvorak, 2 = Colemak, 3 = AZERTY
+///   (ignored for Windows VKs, which are already layout-translated)
+/// * `code` - the scancode
+/// * `caps`, `ctrl`, `shift` - as for `ime_key_ext`
 ///
-/// When `skip` is true, typing 'w' at word start stays as 'w'
-/// instead of converting to 'ư'.
-/// No-op if engine not initialized.
+/// # Returns
+/// * Pointer to `Result` struct (caller must free with `ime_free`);
+///   action 0 (pass through) for keys with no engine key
+/// * `null` if engine not initialized or `set`/`layout` is invalid
 #[no_mangle]
-pub extern "C" fn ime_skip_w_shortcut(skip: bool) {
+pub extern "C" fn ime_key_scancode(
+    set: u8,
+    layout: u8,
+    code: u16,
+    caps: bool,
+    ctrl: bool,
+    shift: bool,
+) -> *mut Result {
+    let (Some(set), Some(layout)) = (
+        input::layout::ScancodeSet::from_u8(set),
+        input::layout::Layout::from_u8(layout),
+    ) else {
+        return std::ptr::null_mut();
+    };
     let mut guard = lock_engine();
-    if let Some(ref mut e) = *guard {
-        e.set_skip_w_shortcut(skip);
-    }
+    let Some(e) = guard.as_mut() else {
+        return std::ptr::null_mut();
+    };
+    let r = match input::layout::translate_scancode(set, layout, code) {
+        Some(key) => e.on_key_ext(key, caps, ctrl, shift),
+        None => Result::none(),
+    };
+    Box::into_raw(Box::new(r))
 }
 
-/// Set whether ESC key restores raw ASCII input.
+/// Translate a platform scancode into an engine key (see `ime_key_scancode`).
 ///
-/// When `enabled` is true (default), pressing ESC restores original keystrokes.
-/// When `enabled` is false, ESC key is passed through without restoration.
-/// No-op if engine not initialized.
+/// For hosts that queue or batch keys before calling `ime_key_ext`.
+///
+/// # Returns
+/// The engine key, or 0xFFFF if the key has none or `set`/`layout` is invalid.
 #[no_mangle]
-pub extern "C" fn ime_esc_restore(enabled: bool) {
-    let mut guard = lock_engine();
-    if let Some(ref mut e) = *guard {
-        e.set_esc_restore(enabled);
+pub extern "C" fn ime_translate_scancode(set: u8, layout: u8, code: u16) -> u16 {
+    match (
+        input::layout::ScancodeSet::from_u8(set),
+        input::layout::Layout::from_u8(layout),
+    ) {
+        (Some(set), Some(layout)) => {
+            input::layout::translate_scancode(set, layout, code).unwrap_or(input::layout::NO_KEY)
+        }
+        _ => input::layout::NO_KEY,
     }
 }
 
-/// Set whether to enable free tone placement (skip validation).
+/// Shared body of `ime_key_into_utf16` / `ime_key_into_utf8`
 ///
-/// When `enabled` is true, allows placing diacritics anywhere without
-/// spelling validation (e.g., "Zìa" is allowed).
-/// When `enabled` is false (default), validates Vietnamese spelling rules.
-/// No-op if engine not initialized.
-#[no_mangle]
-pub extern "C" fn ime_free_tone(enabled: bool) {
-    let mut guard = lock_engine();
-    if let Some(ref mut e) = *guard {
-        e.set_free_tone(enabled);
+/// # Safety
+/// Pointer requirements as documented on the public functions.
+#[allow(clippy::too_many_arguments)]
+unsafe fn key_into<T>(
+    key: u16,
+    caps: bool,
+    ctrl: bool,
+    shift: bool,
+    out: *mut T,
+    capacity: usize,
+    min_capacity: usize,
+    action: *mut u8,
+    backspace: *mut u8,
+    encode: fn(&[u32], engine::NormalizationForm, &mut [T]) -> Option<usize>,
+) -> i32 {
+    if out.is_null() || action.is_null() || backspace.is_null() || capacity < min_capacity {
+        return -1;
     }
+    let mut guard = lock_engine();
+    let Some(e) = guard.as_mut() else {
+        return -1;
+    };
+    let dst = std::slice::from_raw_parts_mut(out, capacity);
+    // The edit is built in per-thread storage and encoded straight into
+    // `out`: nothing is allocated for it
+    Result::with_edit_storage(|| {
+        // Only action and backspace are reported: no range replacements
+        let r = e.on_key_flat(key, caps, ctrl, shift);
+        // Cannot fail: capacity covers the longest possible edit
+        let written = encode(r.as_slice(), e.output_form(), dst).unwrap_or(0);
+        *action = r.action;
+        *backspace = r.backspace;
+        r.release();
+        written as i32
+    })
 }
 
-/// Set whether to use modern orthography for tone placement.
+/// Process a key and write the edit as UTF-16 into a caller buffer.
 ///
-/// When `modern` is true: hoà, thuý (tone on second vowel - new style)
-/// When `modern` is false (default): hòa, thúy (tone on first vowel - traditional)
-/// No-op if engine not initialized.
+/// Same as `ime_key_ext`, without a heap-allocated `Result`: the inserted
+/// text is encoded in the form set by `ime_set_output_form` (NFC default).
+///
+/// # Arguments
+/// * `out` - Buffer of at least `IME_MAX_UTF16_LEN` (768) units
+/// * `action` / `backspace` - Receive the `Result` action and backspace count
+///   (backspaces count displayed characters, not code units)
+///
+/// # Returns
+/// Number of UTF-16 units written, or -1 if the engine is not initialized,
+/// a pointer is null or `capacity` is too small (the key is not processed).
+///
+/// # Safety
+/// `out` must point to `capacity` writable `u16`s; `action` and
+/// `backspace` must point to writable bytes.
 #[no_mangle]
-pub extern "C" fn ime_modern(modern: bool) {
-    let mut guard = lock_engine();
-    if let Some(ref mut e) = *guard {
-        e.set_modern_tone(modern);
-    }
+pub unsafe extern "C" fn ime_key_into_utf16(
+    key: u16,
+    caps: bool,
+    ctrl: bool,
+    shift: bool,
+    out: *mut u16,
+    capacity: usize,
+    action: *mut u8,
+    backspace: *mut u8,
+) -> i32 {
+    key_into(
+        key,
+        caps,
+        ctrl,
+        shift,
+        out,
+        capacity,
+        engine::output::MAX_UTF16_LEN,
+        action,
+        backspace,
+        engine::output::encode_utf16,
+    )
 }
 
-/// Set whether to enable instant auto-restore for English words.
+/// Process a key and write the edit as UTF-8 into a caller buffer.
 ///
-/// When `enabled` is true (default), restores English words immediately upon detection.
-/// When `enabled` is false, auto-restore is disabled.
-/// No-op if engine not initialized.
+/// UTF-8 counterpart of `ime_key_into_utf16`; `out` must hold at least
+/// `IME_MAX_UTF8_LEN` (1280) bytes. The output is not null-terminated.
+///
+/// # Safety
+/// `out` must point to `capacity` writable bytes; `action` and
+/// `backspace` must point to writable bytes.
 #[no_mangle]
-pub extern "C" fn ime_instant_restore(enabled: bool) {
-    let mut guard = lock_engine();
-    if let Some(ref mut e) = *guard {
-        e.set_english_auto_restore(enabled);
-    }
+pub unsafe extern "C" fn ime_key_into_utf8(
+    key: u16,
+    caps: bool,
+    ctrl: bool,
+    shift: bool,
+    out: *mut u8,
+    capacity: usize,
+    action: *mut u8,
+    backspace: *mut u8,
+) -> i32 {
+    key_into(
+        key,
+        caps,
+        ctrl,
+        shift,
+        out,
+        capacity,
+        engine::output::MAX_UTF8_LEN,
+        action,
+        backspace,
+        engine::output::encode_utf8,
+    )
 }
 
-/// Get the current buffer as a C string.
+/// Process a key and write the edit as UTF-32 into a caller buffer.
+///
+/// UTF-32 counterpart of `ime_key_into_utf16`, for callers that keep
+/// their own result storage; `out` must hold at least `IME_MAX_UTF32_LEN`
+/// (768) code points.
 ///
 /// # Safety
-/// Returns a pointer to a static buffer. Do not free.
+/// `out` must point to `capacity` writable `u32`s; `action` and
+/// `backspace` must point to writable bytes.
 #[no_mangle]
-pub unsafe extern "C" fn ime_get_buffer() -> *const std::os::raw::c_char {
-    static mut BUFFER: [u8; 256] = [0; 256];
-    let guard = lock_engine();
-    if let Some(ref e) = *guard {
-        let s = e.get_buffer();
-        let c_str = std::ffi::CString::new(s).unwrap_or_default();
-        let bytes = c_str.as_bytes_with_nul();
-        let len = bytes.len().min(256);
-        #[allow(static_mut_refs)]
-        {
-            for i in 0..len {
-                let ptr = BUFFER.as_mut_ptr();
-                *ptr.add(i) = bytes[i];
-            }
-            BUFFER.as_ptr() as *const std::os::raw::c_char
-        }
-    } else {
-        std::ptr::null()
-    }
+pub unsafe extern "C" fn ime_key_into_utf32(
+    key: u16,
+    caps: bool,
+    ctrl: bool,
+    shift: bool,
+    out: *mut u32,
+    capacity: usize,
+    action: *mut u8,
+    backspace: *mut u8,
+) -> i32 {
+    key_into(
+        key,
+        caps,
+        ctrl,
+        shift,
+        out,
+        capacity,
+        engine::output::MAX_UTF32_LEN,
+        action,
+        backspace,
+        engine::output::encode_utf32,
+    )
 }
 
-/// Clear the input buffer.
+/// Set the normalization form for the `ime_key_into_*` functions.
 ///
-/// Call on word boundaries (space, punctuation, mouse click, focus change).
-/// No-op if engine not initialized.
+/// # Arguments
+/// * `form` - 0 = NFC (precomposed, default), 1 = NFD (combining marks)
+///
+/// # Returns
+/// false if `form` is invalid or the engine is not initialized.
 #[no_mangle]
-pub extern "C" fn ime_clear() {
+pub extern "C" fn ime_set_output_form(form: u8) -> bool {
+    let Some(form) = engine::NormalizationForm::from_u8(form) else {
+        return false;
+    };
     let mut guard = lock_engine();
-    if let Some(ref mut e) = *guard {
-        e.clear();
+    match guard.as_mut() {
+        Some(e) => {
+            e.set_output_form(form);
+            true
+        }
+        None => false,
     }
 }
 
-/// Clear all state including word history.
+/// Set the input method.
+///
+/// # Arguments
+/// * `method` - 0 for Telex, 1 for VNI
 ///
-/// Call when cursor position changes (mouse click, selection-delete, arrow keys).
-/// This prevents restoring stale state from history after navigation.
 /// No-op if engine not initialized.
 #[no_mangle]
-pub extern "C" fn ime_clear_all() {
-    let mut guard = lock_engine();
-    if let Some(ref mut e) = *guard {
-        e.clear_all();
+#[inline]
+pub extern "C" fn ime_method(method: u8) {
+    if let Some(e) = lock_engine().as_mut() {
+        e.set_method(method);
     }
 }
 
-/// Free a result pointer returned by `ime_key`.
+/// Load an input method from a text definition and switch to it.
 ///
-/// # Safety
-/// * `r` must be a pointer returned by `ime_key`, or null
-/// * Must be called exactly once per non-null `ime_key` return
-/// * Do not use `r` after calling this function
+/// The format (`base`, `mark`, `tone`, `stroke`, `remove` lines) is
+/// described in `input::table`. `ime_method` switches back to a built-in
+/// method.
 ///
-/// # Memory Management
-/// This function:
-/// 1. Reconstructs the Vec from raw parts (if chars is non-null)
-/// 2. Drops the Vec (freeing heap memory)
-/// 3. Drops the Box<Result> (freeing Result struct)
+/// # Returns
+/// 0 on success, the 1-based line of the first error in the definition,
+/// or -1 (null / invalid UTF-8 / engine not initialized). The previous
+/// loaded table is freed once no engine uses it.
+///
+/// # Safety
+/// Pointer must be a valid null-terminated UTF-8 string.
 #[no_mangle]
-pub unsafe extern "C" fn ime_free(r: *mut Result) {
-    if r.is_null() {
-        return;
+pub unsafe extern "C" fn ime_load_method(definition: *const std::os::raw::c_char) -> i32 {
+    if definition.is_null() {
+        return -1;
     }
-
-    // Take ownership of Result
-    let result = Box::from_raw(r);
-
-    // Reconstruct and drop Vec if chars were allocated
-    if !result.chars.is_null() && result.capacity > 0 {
-        // SAFETY: We created this Vec in Result::send()
-        // Reconstruct Vec with exact same parameters
-        let _ = Vec::from_raw_parts(result.chars, result.count as usize, result.capacity);
-        // Vec drops here, freeing heap memory
+    let text = match std::ffi::CStr::from_ptr(definition).to_str() {
+        Ok(s) => s,
+        Err(_) => return -1,
+    };
+    match lock_engine().as_mut() {
+        Some(e) => match e.load_method(text) {
+            Ok(()) => 0,
+            Err(err) if err.line > 0 => err.line.min(i32::MAX as usize) as i32,
+            Err(_) => -1,
+        },
+        None => -1,
     }
-    // Box<Result> drops here, freeing Result struct
 }
 
 // ============================================================
-// Shortcut FFI
+// Committed-Word Events
 // ============================================================
 
-/// Add a shortcut to the engine.
+/// Publish a record of each committed word (`true`) or stop (`false`).
 ///
-/// # Arguments
-/// * `trigger` - C string for trigger text
-/// * `replacement` - C string for replacement text
+/// Records go to a fixed ring (`COMMIT_RING_CAPACITY` = 256) that
+/// `ime_drain_commits` empties from any thread. They stay with the active
+/// profile's engine. No-op if engine not initialized.
+#[no_mangle]
+pub extern "C" fn ime_commit_events(enabled: bool) {
+    if let Some(e) = lock_engine().as_mut() {
+        e.set_commit_ring(enabled.then_some(&COMMITS));
+    }
+}
+
+/// Copy up to `capacity` committed-word records into `out`, oldest first.
+///
+/// Does not take the engine lock. A gap in `seq` means records were
+/// dropped because the ring was full (see `ime_commits_dropped`).
 ///
 /// # Returns
-/// * `true` if shortcut was added successfully
-/// * `false` if capacity limit reached or invalid input
+/// Number of records written, 0 while another thread is draining, or -1
+/// if `out` is null.
 ///
 /// # Safety
-/// Both pointers must be valid null-terminated UTF-8 strings.
+/// `out` must point to `capacity` writable records.
 #[no_mangle]
-pub unsafe extern "C" fn ime_add_shortcut(
-    trigger: *const std::os::raw::c_char,
-    replacement: *const std::os::raw::c_char,
-) -> bool {
-    if trigger.is_null() || replacement.is_null() {
-        return false;
+pub unsafe extern "C" fn ime_drain_commits(
+    out: *mut engine::features::CommitRecord,
+    capacity: usize,
+) -> i32 {
+    if out.is_null() {
+        return -1;
     }
-
-    let trigger_str = match std::ffi::CStr::from_ptr(trigger).to_str() {
-        Ok(s) => s,
-        Err(_) => return false,
-    };
-    let replacement_str = match std::ffi::CStr::from_ptr(replacement).to_str() {
-        Ok(s) => s,
-        Err(_) => return false,
-    };
-
-    let mut guard = lock_engine();
-    if let Some(ref mut e) = *guard {
-        e.shortcuts_mut().add(engine::shortcut::Shortcut::new(
-            trigger_str,
-            replacement_str,
-        ))
-    } else {
-        false
+    // Drain through a local chunk: `out` may be uninitialized memory
+    let capacity = capacity.min(i32::MAX as usize);
+    let mut chunk = [engine::features::CommitRecord::EMPTY; 32];
+    let mut written = 0;
+    while written < capacity {
+        let want = (capacity - written).min(chunk.len());
+        let n = COMMITS.drain(&mut chunk[..want]);
+        std::ptr::copy_nonoverlapping(chunk.as_ptr(), out.add(written), n);
+        written += n;
+        if n < want {
+            break;
+        }
     }
+    written as i32
 }
 
-/// Remove a shortcut from the engine.
-///
+/// Committed-word records dropped because the ring was full.
+#[no_mangle]
+pub extern "C" fn ime_commits_dropped() -> u32 {
+    COMMITS.dropped()
+}
+
+// ============================================================
+// Latency Attribution
+// ============================================================
+
+/// Process a key event like `ime_key_ext`, recording its latency.
+///
+/// `event_ns` is the OS event timestamp and `received_ns` the time the
+/// platform got the event, both from the same monotonic clock (any epoch;
+/// on macOS `clock_gettime_nsec_np(CLOCK_UPTIME_RAW)` matches CGEvent
+/// timestamps). Take `received_ns` right before the call. Queue delay is
+/// `received_ns - event_ns` plus the wait for the engine lock, measured
+/// here; processing time is measured around the engine call only. Report
+/// the injection of the result with `ime_key_injected`.
+///
+/// # Returns
+/// * Pointer to `Result` struct (caller must free with `ime_free`)
+/// * `null` if engine not initialized (nothing recorded)
+#[no_mangle]
+pub extern "C" fn ime_key_timed(
+    key: u16,
+    caps: bool,
+    ctrl: bool,
+    shift: bool,
+    event_ns: u64,
+    received_ns: u64,
+) -> *mut Result {
+    let nanos = |d: std::time::Duration| d.as_nanos().min(u64::MAX as u128) as u64;
+    let entry = std::time::Instant::now();
+    let mut guard = lock_engine();
+    let Some(e) = guard.as_mut() else {
+        return std::ptr::null_mut();
+    };
+    // Engine work only: waiting for the lock is queue time
+    let start = std::time::Instant::now();
+    let result = e.on_key_ext(key, caps, ctrl, shift);
+    let processing_ns = nanos(start.elapsed());
+    drop(guard);
+    let lock_wait_ns = nanos(start.duration_since(entry));
+    LATENCY.record_key(event_ns, received_ns, lock_wait_ns, processing_ns);
+    Box::into_raw(Box::new(result))
+}
+
+/// Report that the result of the last `ime_key_timed` call was injected,
+/// at `done_ns` (same clock as its timestamps).
+///
+/// Records the injection time (from the result's return) and the total
+/// (from the OS event). Call only for keys whose result was injected.
+///
+/// # Returns
+/// false if no timed key is waiting (already reported, or none yet).
+#[no_mangle]
+pub extern "C" fn ime_key_injected(done_ns: u64) -> bool {
+    LATENCY.record_injected(done_ns)
+}
+
+/// Summary of one stage's histogram (0=queue, 1=processing, 2=injection,
+/// 3=total): count, mean, p50/p90/p99 (bucket bounds) and max, in ns.
+///
+/// # Returns
+/// false if `out` is null or `stage` is unknown.
+///
+/// # Safety
+/// `out` must be null or point to a writable `LatencyStats`.
+#[no_mangle]
+pub unsafe extern "C" fn ime_latency_stats(stage: u8, out: *mut latency::LatencyStats) -> bool {
+    let Some(stage) = latency::LatencyStage::from_u8(stage) else {
+        return false;
+    };
+    if out.is_null() {
+        return false;
+    }
+    *out = LATENCY.stage(stage).stats();
+    true
+}
+
+/// Copy one stage's bucket counts into `out` (`LATENCY_BUCKETS` = 96 at
+/// most). Bucket `i` counts latencies below
+/// `ime_latency_bucket_upper_ns(i)` and at or above the previous bound.
+///
+/// # Returns
+/// Buckets written, or -1 if `out` is null or `stage` is unknown.
+///
+/// # Safety
+/// `out` must point to `capacity` writable `u32`s.
+#[no_mangle]
+pub unsafe extern "C" fn ime_latency_histogram(stage: u8, out: *mut u32, capacity: usize) -> i32 {
+    let Some(stage) = latency::LatencyStage::from_u8(stage) else {
+        return -1;
+    };
+    if out.is_null() {
+        return -1;
+    }
+    let out = std::slice::from_raw_parts_mut(out, capacity.min(latency::LATENCY_BUCKETS));
+    LATENCY.stage(stage).copy_buckets(out) as i32
+}
+
+/// Exclusive upper bound of latency bucket `index` in ns (`u64::MAX` for
+/// the last bucket and past the end).
+#[no_mangle]
+pub extern "C" fn ime_latency_bucket_upper_ns(index: u32) -> u64 {
+    latency::bucket_upper_ns(index as usize)
+}
+
+/// Clear all latency histograms.
+#[no_mangle]
+pub extern "C" fn ime_latency_reset() {
+    LATENCY.reset();
+}
+
+// ============================================================
+// Burst Mode
+// ============================================================
+
+/// Start a burst: text keys offered to `ime_burst_key` are queued and
+/// come back as one edit from `ime_burst_end`.
+///
+/// For input the host knows is machine-generated (autotype, replay).
+///
+/// # Returns
+/// false if the engine is not initialized or in composition mode.
+#[no_mangle]
+pub extern "C" fn ime_burst_begin() -> bool {
+    let mut guard = lock_engine();
+    match guard.as_mut() {
+        Some(e) => e.burst_begin(),
+        None => false,
+    }
+}
+
+/// Offer a key to burst mode; call before `ime_key_*` for every key.
+///
+/// `event_ns` is the OS event timestamp (0 if unknown). Keys arriving
+/// faster than the detection threshold start a burst on their own (see
+/// `ime_set_burst_detection`); such a burst ends at the first slower key.
+///
+/// # Returns
+/// * 0: no burst, handle the key with `ime_key_*` as usual
+/// * 1: queued, consume the key and inject nothing
+/// * 2: the burst is over: inject the edit from `ime_burst_end`, then
+///   handle this key as usual (Ctrl shortcuts, arrows, return … end a
+///   burst too)
+///
+/// 0 if the engine is not initialized.
+#[no_mangle]
+pub extern "C" fn ime_burst_key(
+    key: u16,
+    caps: bool,
+    ctrl: bool,
+    shift: bool,
+    event_ns: u64,
+) -> u8 {
+    let mut guard = lock_engine();
+    match guard.as_mut() {
+        Some(e) => e.burst_key(key, caps, ctrl, shift, event_ns) as u8,
+        None => engine::BurstKey::Pass as u8,
+    }
+}
+
+/// End the burst and return its coalesced edit.
+///
+/// Call when `ime_burst_key` returns 2, when a host-started burst is
+/// done, and from an idle timer (no key for the detection gap), since a
+/// detected burst only notices its end at the next key. Same delivery as
+/// `ime_key_wide`: an edit longer than `inline_limit` characters comes
+/// back with `count = 0` and is read with `ime_read_expansion`.
+///
+/// # Returns
+/// Pointer to `WideResult` (free with `ime_free_wide`); action 0 if no
+/// burst was active. Null if the engine is not initialized.
+#[no_mangle]
+pub extern "C" fn ime_burst_end(inline_limit: u32) -> *mut engine::WideResult {
+    let mut guard = lock_engine();
+    match guard.as_mut() {
+        Some(e) => Box::into_raw(Box::new(e.burst_end(inline_limit as usize))),
+        None => std::ptr::null_mut(),
+    }
+}
+
+/// Set burst detection: `min_keys` key events in a row less than
+/// `gap_ns` apart start a burst (defaults 5 ms, 8 keys; `gap_ns` 0 turns
+/// detection off). No-op if engine not initialized.
+#[no_mangle]
+pub extern "C" fn ime_set_burst_detection(gap_ns: u64, min_keys: u32) {
+    let mut guard = lock_engine();
+    if let Some(ref mut e) = *guard {
+        e.set_burst_detection(gap_ns, min_keys);
+    }
+}
+
+// ============================================================
+// Per-App Profiles
+// ============================================================
+
+/// Profile id of an application identifier (e.g. a bundle id).
+///
+/// Stable hash of the UTF-8 bytes; compute it once per app and pass it to
+/// `ime_activate_profile`. Returns 0 (the default profile) for null.
+///
+/// # Safety
+/// Pointer must be a valid null-terminated string.
+#[no_mangle]
+pub unsafe extern "C" fn ime_profile_id(app: *const std::os::raw::c_char) -> u64 {
+    if app.is_null() {
+        return engine::state::profile::DEFAULT_PROFILE;
+    }
+    engine::state::profile::profile_id(std::ffi::CStr::from_ptr(app).to_bytes())
+}
+
+/// Switch to an application's profile.
+///
+/// Parks the current settings and typing state, and restores those of
+/// profile `id` (0 = default profile). A profile seen for the first time
+/// starts from the default profile's settings. Settings changed with
+/// `ime_method`, `ime_enabled`, … apply to the active profile only.
+///
+/// # Returns
+/// false if the engine is not initialized or the profile limit is reached.
+#[no_mangle]
+pub extern "C" fn ime_activate_profile(id: u64) -> bool {
+    let mut guard = lock_engine();
+    let Some(e) = guard.as_mut() else {
+        return false;
+    };
+    lock_profiles()
+        .get_or_insert_with(ProfileRegistry::new)
+        .activate(e, id)
+        .is_ok()
+}
+
+/// Give the active profile its own shortcut table (`true`, starting with
+/// the defaults) or use the shared one again (`false`).
+///
+/// No-op if engine not initialized.
+#[no_mangle]
+pub extern "C" fn ime_profile_own_shortcuts(own: bool) {
+    let mut guard = lock_engine();
+    if let Some(e) = guard.as_mut() {
+        lock_profiles()
+            .get_or_insert_with(ProfileRegistry::new)
+            .set_own_shortcuts(e, own);
+    }
+}
+
+/// Forget a parked profile (not the active or the default one).
+///
+/// # Returns
+/// true if the profile was removed.
+#[no_mangle]
+pub extern "C" fn ime_remove_profile(id: u64) -> bool {
+    lock_profiles().as_mut().is_some_and(|p| p.remove(id))
+}
+
+/// Enable or disable the engine.
+///
+/// When disabled, `ime_key` returns action=0 (pass through).
+/// No-op if engine not initialized.
+#[no_mangle]
+#[inline]
+pub extern "C" fn ime_enabled(enabled: bool) {
+    if let Some(e) = lock_engine().as_mut() {
+        e.set_enabled(enabled);
+    }
+}
+
+/// Set whether to skip w→ư shortcut in Telex mode.
+///
+/// When `skip` is true, typing 'w' at word start stays as 'w'
+/// instead of converting to 'ư'.
+/// No-op if engine not initialized.
+#[no_mangle]
+pub extern "C" fn ime_skip_w_shortcut(skip: bool) {
+    let mut guard = lock_engine();
+    if let Some(ref mut e) = *guard {
+        e.set_skip_w_shortcut(skip);
+    }
+}
+
+/// Set whether ESC key restores raw ASCII input.
+///
+/// When `enabled` is true (default), pressing ESC restores original keystrokes.
+/// When `enabled` is false, ESC key is passed through without restoration.
+/// No-op if engine not initialized.
+#[no_mangle]
+pub extern "C" fn ime_esc_restore(enabled: bool) {
+    let mut guard = lock_engine();
+    if let Some(ref mut e) = *guard {
+        e.set_esc_restore(enabled);
+    }
+}
+
+/// Set whether to enable free tone placement (skip validation).
+///
+/// When `enabled` is true, allows placing diacritics anywhere without
+/// spelling validation (e.g., "Zìa" is allowed).
+/// When `enabled` is false (default), validates Vietnamese spelling rules.
+/// No-op if engine not initialized.
+#[no_mangle]
+pub extern "C" fn ime_free_tone(enabled: bool) {
+    let mut guard = lock_engine();
+    if let Some(ref mut e) = *guard {
+        e.set_free_tone(enabled);
+    }
+}
+
+/// Set whether to use modern orthography for tone placement.
+///
+/// When `modern` is true: hoà, thuý (tone on second vowel - new style)
+/// When `modern` is false (default): hòa, thúy (tone on first vowel - traditional)
+/// No-op if engine not initialized.
+#[no_mangle]
+pub extern "C" fn ime_modern(modern: bool) {
+    let mut guard = lock_engine();
+    if let Some(ref mut e) = *guard {
+        e.set_modern_tone(modern);
+    }
+}
+
+/// Set whether to enable instant auto-restore for English words.
+///
+/// When `enabled` is true (default), restores English words immediately upon detection.
+/// When `enabled` is false, auto-restore is disabled.
+/// No-op if engine not initialized.
+#[no_mangle]
+pub extern "C" fn ime_instant_restore(enabled: bool) {
+    let mut guard = lock_engine();
+    if let Some(ref mut e) = *guard {
+        e.set_english_auto_restore(enabled);
+    }
+}
+
+/// Get the current buffer as a C string.
+///
+/// # Safety
+/// Returns a pointer to a static buffer. Do not free.
+#[no_mangle]
+pub unsafe extern "C" fn ime_get_buffer() -> *const std::os::raw::c_char {
+    static mut BUFFER: [u8; 256] = [0; 256];
+    let guard = lock_engine();
+    if let Some(ref e) = *guard {
+        let s = e.get_buffer();
+        let c_str = std::ffi::CString::new(s).unwrap_or_default();
+        let bytes = c_str.as_bytes_with_nul();
+        let len = bytes.len().min(256);
+        #[allow(static_mut_refs)]
+        {
+            for i in 0..len {
+                let ptr = BUFFER.as_mut_ptr();
+                *ptr.add(i) = bytes[i];
+            }
+            BUFFER.as_ptr() as *const std::os::raw::c_char
+        }
+    } else {
+        std::ptr::null()
+    }
+}
+
+/// Clear the input buffer.
+///
+/// Call on word boundaries (space, punctuation, mouse click, focus change).
+/// No-op if engine not initialized.
+#[no_mangle]
+pub extern "C" fn ime_clear() {
+    let mut guard = lock_engine();
+    if let Some(ref mut e) = *guard {
+        e.clear();
+    }
+}
+
+/// Clear all state including word history.
+///
+/// Call when cursor position changes (mouse click, selection-delete, arrow keys).
+/// This prevents restoring stale state from history after navigation.
+/// No-op if engine not initialized.
+#[no_mangle]
+pub extern "C" fn ime_clear_all() {
+    let mut guard = lock_engine();
+    if let Some(ref mut e) = *guard {
+        e.clear_all();
+    }
+}
+
+/// Free a result pointer returned by `ime_key`.
+///
+/// # Safety
+/// * `r` must be a pointer returned by `ime_key`, or null
+/// * Must be called exactly once per non-null `ime_key` return
+/// * Do not use `r` after calling this function
+///
+/// # Memory Management
+/// This function:
+/// 1. Reconstructs the Vec from raw parts (if chars is non-null)
+/// 2. Drops the Vec (freeing heap memory)
+/// 3. Drops the Box<Result> (freeing Result struct)
+#[no_mangle]
+pub unsafe extern "C" fn ime_free(r: *mut Result) {
+    if r.is_null() {
+        return;
+    }
+
+    // Take ownership of Result
+    let result = Box::from_raw(r);
+
+    // Reconstruct and drop Vec if chars were allocated
+    if !result.chars.is_null() && result.capacity > 0 {
+        // SAFETY: We created this Vec in Result::send()
+        // Reconstruct Vec with exact same parameters
+        let _ = Vec::from_raw_parts(result.chars, result.count as usize, result.capacity);
+        // Vec drops here, freeing heap memory
+    }
+    // Box<Result> drops here, freeing Result struct
+}
+
+/// Process a key event, returning a result with wide counts.
+///
+/// Same as `ime_key_ext`, but shortcut expansions are never truncated to
+/// 255 characters. An expansion of at most `inline_limit` characters is
+/// returned whole in `chars`; a longer one comes back with `count = 0`
+/// and `remaining` set, to be read with `ime_read_expansion` before the
+/// next key (pass `u32::MAX` to always inline).
+///
+/// # Returns
+/// Pointer to `WideResult` (free with `ime_free_wide`), or null if the
+/// engine is not initialized.
+#[no_mangle]
+pub extern "C" fn ime_key_wide(
+    key: u16,
+    caps: bool,
+    ctrl: bool,
+    shift: bool,
+    inline_limit: u32,
+) -> *mut engine::WideResult {
+    let mut guard = lock_engine();
+    if let Some(ref mut e) = *guard {
+        let r = e.on_key_wide(key, caps, ctrl, shift, inline_limit as usize);
+        Box::into_raw(Box::new(r))
+    } else {
+        std::ptr::null_mut()
+    }
+}
+
+/// Read the next chunk of a pending expansion (after `ime_key_wide`).
+///
+/// # Arguments
+/// * `out` - Buffer for UTF-32 codepoints
+/// * `capacity` - Size of `out` (any chunk size works)
+///
+/// # Returns
+/// Characters written, 0 once the expansion is fully delivered, or -1 if
+/// `out` is null or the engine is not initialized.
+///
+/// # Safety
+/// `out` must point to `capacity` writable `u32`s.
+#[no_mangle]
+pub unsafe extern "C" fn ime_read_expansion(out: *mut u32, capacity: usize) -> i32 {
+    if out.is_null() {
+        return -1;
+    }
+    let mut guard = lock_engine();
+    match guard.as_mut() {
+        Some(e) => {
+            let dst = std::slice::from_raw_parts_mut(out, capacity.min(i32::MAX as usize));
+            e.read_expansion(dst) as i32
+        }
+        None => -1,
+    }
+}
+
+/// Free a result returned by `ime_key_wide`.
+///
+/// # Safety
+/// * `r` must be a pointer returned by `ime_key_wide`, or null
+/// * Must be called exactly once per non-null return
+#[no_mangle]
+pub unsafe extern "C" fn ime_free_wide(r: *mut engine::WideResult) {
+    if r.is_null() {
+        return;
+    }
+    Box::from_raw(r).release();
+}
+
+// ============================================================
+// Shortcut FFI
+// ============================================================
+
+/// Add a shortcut to the engine.
+///
+/// # Arguments
+/// * `trigger` - C string for trigger text
+/// * `replacement` - C string for replacement text
+///
+/// # Returns
+/// * `true` if shortcut was added successfully
+/// * `false` if capacity limit reached, invalid input or built without
+///   the `shortcuts` feature
+///
+/// # Safety
+/// Both pointers must be valid null-terminated UTF-8 strings.
+#[no_mangle]
+pub unsafe extern "C" fn ime_add_shortcut(
+    trigger: *const std::os::raw::c_char,
+    replacement: *const std::os::raw::c_char,
+) -> bool {
+    if !cfg!(feature = "shortcuts") || trigger.is_null() || replacement.is_null() {
+        return false;
+    }
+
+    let trigger_str = match std::ffi::CStr::from_ptr(trigger).to_str() {
+        Ok(s) => s,
+        Err(_) => return false,
+    };
+    let replacement_str = match std::ffi::CStr::from_ptr(replacement).to_str() {
+        Ok(s) => s,
+        Err(_) => return false,
+    };
+
+    let mut guard = lock_engine();
+    if let Some(ref mut e) = *guard {
+        e.shortcuts_mut().add(engine::shortcut::Shortcut::new(
+            trigger_str,
+            replacement_str,
+        ))
+    } else {
+        false
+    }
+}
+
+/// Add a snippet (long word-boundary shortcut) to the engine.
+///
+/// The replacement may be up to 65,536 characters. It is delivered whole
+/// through `ime_key_wide`; `ime_key` receives the first 255 characters.
+///
+/// # Returns
+/// false if a pointer is null, a string is not UTF-8, the table is full,
+/// the engine is not initialized or it was built without `shortcuts`.
+///
+/// # Safety
+/// Both pointers must be valid null-terminated UTF-8 strings.
+#[no_mangle]
+pub unsafe extern "C" fn ime_add_snippet(
+    trigger: *const std::os::raw::c_char,
+    replacement: *const std::os::raw::c_char,
+) -> bool {
+    if !cfg!(feature = "shortcuts") || trigger.is_null() || replacement.is_null() {
+        return false;
+    }
+    let (Ok(trigger), Ok(replacement)) = (
+        std::ffi::CStr::from_ptr(trigger).to_str(),
+        std::ffi::CStr::from_ptr(replacement).to_str(),
+    ) else {
+        return false;
+    };
+    // Build outside the engine lock (the text may be large)
+    let snippet = engine::shortcut::Shortcut::snippet(trigger, replacement);
+    let mut guard = lock_engine();
+    match guard.as_mut() {
+        Some(e) => e.shortcuts_mut().add(snippet),
+        None => false,
+    }
+}
+
+/// Remove a shortcut from the engine.
+///
+/// # Arguments
+/// * `trigger` - C string for trigger to remove
+///
+/// # Safety
+/// Pointer must be a valid null-terminated UTF-8 string.
+#[no_mangle]
+pub unsafe extern "C" fn ime_remove_shortcut(trigger: *const std::os::raw::c_char) {
+    if trigger.is_null() {
+        return;
+    }
+
+    let trigger_str = match std::ffi::CStr::from_ptr(trigger).to_str() {
+        Ok(s) => s,
+        Err(_) => return,
+    };
+
+    let mut guard = lock_engine();
+    if let Some(ref mut e) = *guard {
+        e.shortcuts_mut().remove(trigger_str);
+    }
+}
+
+/// Clear all shortcuts from the engine.
+#[no_mangle]
+pub extern "C" fn ime_clear_shortcuts() {
+    let mut guard = lock_engine();
+    if let Some(ref mut e) = *guard {
+        e.shortcuts_mut().clear();
+    }
+}
+
+/// Get current number of shortcuts.
+///
+/// # Returns
+/// Number of shortcuts currently stored
+#[no_mangle]
+pub extern "C" fn ime_shortcuts_count() -> usize {
+    let guard = lock_engine();
+    if let Some(ref e) = *guard {
+        e.shortcuts().len()
+    } else {
+        0
+    }
+}
+
+/// Get maximum shortcuts capacity.
+///
+/// # Returns
+/// Maximum number of shortcuts allowed
+#[no_mangle]
+pub extern "C" fn ime_shortcuts_capacity() -> usize {
+    let guard = lock_engine();
+    if let Some(ref e) = *guard {
+        e.shortcuts().capacity()
+    } else {
+        0
+    }
+}
+
+/// Check if shortcuts table is at capacity.
+///
+/// # Returns
+/// `true` if at capacity, `false` otherwise
+#[no_mangle]
+pub extern "C" fn ime_shortcuts_is_at_capacity() -> bool {
+    let guard = lock_engine();
+    if let Some(ref e) = *guard {
+        e.shortcuts().is_at_capacity()
+    } else {
+        false
+    }
+}
+
+/// Export all shortcuts to JSON string.
+///
+/// # Returns
+/// Pointer to JSON string (caller must free with `ime_free_string`)
+/// Returns null if engine not initialized or built without `shortcuts`.
+///
+/// # Safety
+/// Caller must free the returned string using `ime_free_string`.
+#[no_mangle]
+pub extern "C" fn ime_export_shortcuts_json() -> *mut std::os::raw::c_char {
+    if !cfg!(feature = "shortcuts") {
+        return std::ptr::null_mut();
+    }
+    let guard = lock_engine();
+    if let Some(ref e) = *guard {
+        let json = e.shortcuts().to_json();
+        match std::ffi::CString::new(json) {
+            Ok(c_str) => c_str.into_raw(),
+            Err(_) => std::ptr::null_mut(),
+        }
+    } else {
+        std::ptr::null_mut()
+    }
+}
+
+/// Import shortcuts from JSON string.
+///
+/// # Arguments
+/// * `json` - C string containing JSON data
+///
+/// # Returns
+/// Number of shortcuts imported, or -1 on error (always -1 without the
+/// `shortcuts` feature)
+///
+/// # Safety
+/// Pointer must be a valid null-terminated UTF-8 string.
+#[no_mangle]
+pub unsafe extern "C" fn ime_import_shortcuts_json(json: *const std::os::raw::c_char) -> i32 {
+    if !cfg!(feature = "shortcuts") || json.is_null() {
+        return -1;
+    }
+
+    let json_str = match std::ffi::CStr::from_ptr(json).to_str() {
+        Ok(s) => s,
+        Err(_) => return -1,
+    };
+
+    let mut guard = lock_engine();
+    if let Some(ref mut e) = *guard {
+        match e.shortcuts_mut().from_json(json_str) {
+            Ok(count) => count as i32,
+            Err(_) => -1,
+        }
+    } else {
+        -1
+    }
+}
+
+/// Free a string allocated by `ime_export_shortcuts_json`.
+///
+/// # Safety
+/// * `s` must be a pointer returned by `ime_export_shortcuts_json`, or null
+/// * Must be called exactly once per non-null pointer
+#[no_mangle]
+pub unsafe extern "C" fn ime_free_string(s: *mut std::os::raw::c_char) {
+    if !s.is_null() {
+        // Reconstruct and drop CString
+        let _ = std::ffi::CString::from_raw(s);
+    }
+}
+
+/// Set whether shortcuts are enabled globally.
+///
+/// When disabled, shortcut expansion is skipped.
+/// No-op if engine not initialized.
+#[no_mangle]
+pub extern "C" fn ime_set_shortcuts_enabled(enabled: bool) {
+    let mut guard = lock_engine();
+    if let Some(ref mut e) = *guard {
+        e.shortcuts_enabled = enabled;
+    }
+}
+
+// ============================================================
+// Encoding FFI
+// ============================================================
+
+/// Global encoding converter (thread-safe via Mutex)
+static ENCODING: std::sync::Mutex<crate::engine::features::encoding::EncodingConverter> =
+    std::sync::Mutex::new(crate::engine::features::encoding::EncodingConverter::new_const());
+
+/// Set the output encoding.
+///
+/// # Arguments
+/// * `encoding` - Encoding type: 0=Unicode (default), 1=TCVN3, 2=VNI, 3=CP1258
+///
+/// Unicode is the default and requires no conversion. Without the
+/// `encoding` feature the output stays Unicode.
+/// TCVN3, VNI, and CP1258 are legacy Vietnamese encodings.
+#[no_mangle]
+pub extern "C" fn ime_set_encoding(encoding: u8) {
+    use crate::engine::features::encoding::OutputEncoding;
+    if !cfg!(feature = "encoding") {
+        return;
+    }
+    if let Ok(mut guard) = ENCODING.lock() {
+        guard.set_encoding(OutputEncoding::from_u8(encoding));
+    }
+}
+
+/// Get the current output encoding.
+///
+/// # Returns
+/// Encoding type: 0=Unicode, 1=TCVN3, 2=VNI, 3=CP1258
+#[no_mangle]
+pub extern "C" fn ime_get_encoding() -> u8 {
+    if let Ok(guard) = ENCODING.lock() {
+        guard.encoding().to_u8()
+    } else {
+        0 // Default to Unicode on error
+    }
+}
+
+/// Convert a Unicode string to the current encoding.
+///
+/// # Arguments
+/// * `input` - UTF-8 string to convert
+///
+/// # Returns
+/// Pointer to encoded bytes (caller must free with `ime_free_bytes`)
+/// Returns null on error, or if built without the `encoding` feature.
+///
+/// # Safety
+/// Caller must free the returned buffer using `ime_free_bytes`.
+#[no_mangle]
+pub unsafe extern "C" fn ime_convert_encoding(input: *const std::os::raw::c_char) -> *mut u8 {
+    if !cfg!(feature = "encoding") || input.is_null() {
+        return std::ptr::null_mut();
+    }
+
+    let input_str = match std::ffi::CStr::from_ptr(input).to_str() {
+        Ok(s) => s,
+        Err(_) => return std::ptr::null_mut(),
+    };
+
+    if let Ok(guard) = ENCODING.lock() {
+        let bytes = guard.convert_string(input_str);
+        let mut boxed = bytes.into_boxed_slice();
+        let ptr = boxed.as_mut_ptr();
+        std::mem::forget(boxed);
+        ptr
+    } else {
+        std::ptr::null_mut()
+    }
+}
+
+/// Convert a Unicode string to the current encoding, reporting its length.
+///
+/// Same as `ime_convert_encoding`; `len` receives the byte count needed
+/// by `ime_free_bytes`.
+///
+/// # Returns
+/// Pointer to encoded bytes (free with `ime_free_bytes(ptr, *len)`), or
+/// null on error (`*len` is set to 0).
+///
+/// # Safety
+/// `input` must be a valid null-terminated UTF-8 string; `len` must point
+/// to a writable `usize`.
+#[no_mangle]
+pub unsafe extern "C" fn ime_convert_encoding_ext(
+    input: *const std::os::raw::c_char,
+    len: *mut usize,
+) -> *mut u8 {
+    if input.is_null() || len.is_null() {
+        return std::ptr::null_mut();
+    }
+    *len = 0;
+    if !cfg!(feature = "encoding") {
+        return std::ptr::null_mut();
+    }
+    let Ok(input_str) = std::ffi::CStr::from_ptr(input).to_str() else {
+        return std::ptr::null_mut();
+    };
+    let Ok(guard) = ENCODING.lock() else {
+        return std::ptr::null_mut();
+    };
+    let bytes = guard.convert_string(input_str).into_boxed_slice();
+    if bytes.is_empty() {
+        return std::ptr::null_mut();
+    }
+    *len = bytes.len();
+    Box::into_raw(bytes) as *mut u8
+}
+
+/// Free bytes allocated by ime_convert_encoding.
+///
+/// # Safety
+/// Must be called with pointer from ime_convert_encoding, or null.
+#[no_mangle]
+pub unsafe extern "C" fn ime_free_bytes(ptr: *mut u8, len: usize) {
+    if !ptr.is_null() && len > 0 {
+        let _ = Vec::from_raw_parts(ptr, len, len);
+    }
+}
+
+// ============================================================
+// Word Restore FFI
+// ============================================================
+
+/// Restore buffer from a Vietnamese word string.
+///
+/// Used when native app detects cursor at word boundary and user
+/// wants to continue editing (e.g., backspace into previous word).
+/// Parses Vietnamese characters back to buffer components.
+///
 /// # Arguments
-/// * `trigger` - C string for trigger to remove
+/// * `word` - C string containing the Vietnamese word to restore
 ///
 /// # Safety
 /// Pointer must be a valid null-terminated UTF-8 string.
 #[no_mangle]
-pub unsafe extern "C" fn ime_remove_shortcut(trigger: *const std::os::raw::c_char) {
-    if trigger.is_null() {
+pub unsafe extern "C" fn ime_restore_word(word: *const std::os::raw::c_char) {
+    if word.is_null() {
         return;
     }
-
-    let trigger_str = match std::ffi::CStr::from_ptr(trigger).to_str() {
+    let word_str = match std::ffi::CStr::from_ptr(word).to_str() {
         Ok(s) => s,
         Err(_) => return,
     };
+    let mut guard = lock_engine();
+    if let Some(ref mut e) = *guard {
+        e.restore_word(word_str);
+    }
+}
+
+// ============================================================
+// Prediction FFI
+// ============================================================
+
+/// Load a next-word prediction model from a file (GXNG format).
+///
+/// # Arguments
+/// * `path` - C string path to the model file
+///
+/// # Returns
+/// * `true` if the model was loaded and validated
+/// * `false` on I/O error, invalid model, or engine not initialized
+///
+/// # Safety
+/// Pointer must be a valid null-terminated UTF-8 string.
+#[no_mangle]
+pub unsafe extern "C" fn ime_load_prediction_model(path: *const std::os::raw::c_char) -> bool {
+    if path.is_null() {
+        return false;
+    }
+    let path_str = match std::ffi::CStr::from_ptr(path).to_str() {
+        Ok(s) => s,
+        Err(_) => return false,
+    };
+    // Read and validate outside the engine lock so typing is never blocked on I/O
+    let model = match std::fs::read(path_str)
+        .ok()
+        .and_then(|bytes| engine::prediction::NgramModel::from_bytes(bytes.into()).ok())
+    {
+        Some(m) => m,
+        None => return false,
+    };
 
     let mut guard = lock_engine();
     if let Some(ref mut e) = *guard {
-        e.shortcuts_mut().remove(trigger_str);
+        e.set_prediction_model(Some(model));
+        true
+    } else {
+        false
     }
 }
 
-/// Clear all shortcuts from the engine.
+/// Load a next-word prediction model from memory (GXNG format).
+///
+/// The bytes are copied; the caller keeps ownership of `data`.
+///
+/// # Returns
+/// * `true` if the model was loaded and validated
+///
+/// # Safety
+/// `data` must point to at least `len` readable bytes.
 #[no_mangle]
-pub extern "C" fn ime_clear_shortcuts() {
+pub unsafe extern "C" fn ime_load_prediction_model_bytes(data: *const u8, len: usize) -> bool {
+    if data.is_null() || len == 0 {
+        return false;
+    }
+    let bytes = std::slice::from_raw_parts(data, len).to_vec();
+    let model = match engine::prediction::NgramModel::from_bytes(bytes.into()) {
+        Ok(m) => m,
+        Err(_) => return false,
+    };
+
     let mut guard = lock_engine();
     if let Some(ref mut e) = *guard {
-        e.shortcuts_mut().clear();
+        e.set_prediction_model(Some(model));
+        true
+    } else {
+        false
     }
 }
 
-/// Get current number of shortcuts.
+/// Unload the prediction model (disables prediction).
+#[no_mangle]
+pub extern "C" fn ime_unload_prediction_model() {
+    let mut guard = lock_engine();
+    if let Some(ref mut e) = *guard {
+        e.set_prediction_model(None);
+    }
+}
+
+/// Predict the next words after the most recent word commit.
+///
+/// Writes up to `max_candidates` words into `out` as UTF-8, separated by
+/// `\n` and null-terminated. Candidates that don't fit are dropped.
+///
+/// # Arguments
+/// * `out` - Caller-provided output buffer
+/// * `out_len` - Size of `out` in bytes (including the terminator)
+/// * `max_candidates` - Maximum number of candidates (capped at 16)
 ///
 /// # Returns
-/// Number of shortcuts currently stored
+/// Number of candidates written, or -1 if no model is loaded, the engine
+/// is not initialized, or `out` is invalid.
+///
+/// # Safety
+/// `out` must point to at least `out_len` writable bytes.
 #[no_mangle]
-pub extern "C" fn ime_shortcuts_count() -> usize {
+pub unsafe extern "C" fn ime_predict_next(
+    out: *mut std::os::raw::c_char,
+    out_len: usize,
+    max_candidates: u32,
+) -> i32 {
+    if out.is_null() || out_len == 0 {
+        return -1;
+    }
+    let dst = std::slice::from_raw_parts_mut(out as *mut u8, out_len);
+    dst[0] = 0;
+
     let guard = lock_engine();
-    if let Some(ref e) = *guard {
-        e.shortcuts().len()
-    } else {
-        0
+    let e = match *guard {
+        Some(ref e) => e,
+        None => return -1,
+    };
+    let model = match e.prediction_model() {
+        Some(m) => m,
+        None => return -1,
+    };
+
+    let mut preds = [engine::prediction::Prediction::default(); 16];
+    let want = (max_candidates as usize).min(preds.len());
+    let n = e.predict_next(&mut preds[..want]);
+
+    let mut written = 0usize;
+    let mut count = 0i32;
+    for p in &preds[..n] {
+        let word = match model.word(p.word_id) {
+            Some(w) => w.as_bytes(),
+            None => continue,
+        };
+        let sep = if count > 0 { 1 } else { 0 };
+        // Need room for separator + word + terminator
+        if written + sep + word.len() + 1 > out_len {
+            break;
+        }
+        if sep == 1 {
+            dst[written] = b'\n';
+            written += 1;
+        }
+        dst[written..written + word.len()].copy_from_slice(word);
+        written += word.len();
+        count += 1;
     }
+    dst[written] = 0;
+    count
 }
 
-/// Get maximum shortcuts capacity.
+// ============================================================
+// Shortcode FFI
+// ============================================================
+
+/// Enable or disable `:code` emoji/symbol shortcode completion.
+///
+/// When enabled, typing `:` on an empty buffer starts a shortcode session.
+/// No-op if engine not initialized.
+#[no_mangle]
+pub extern "C" fn ime_set_shortcodes_enabled(enabled: bool) {
+    let mut guard = lock_engine();
+    if let Some(ref mut e) = *guard {
+        e.set_shortcodes_enabled(enabled);
+    }
+}
+
+/// List completions for the active `:code` session.
+///
+/// Writes up to `max_candidates` lines of `index\tcode\tvalue` into `out`
+/// as UTF-8, separated by `\n` and null-terminated. Pass `index` to
+/// `ime_select_shortcode` to insert a candidate.
+///
+/// # Arguments
+/// * `out` - Caller-provided output buffer
+/// * `out_len` - Size of `out` in bytes (including the terminator)
+/// * `max_candidates` - Maximum number of candidates (capped at 16)
 ///
 /// # Returns
-/// Maximum number of shortcuts allowed
+/// Number of candidates written, or -1 if no session is active, the engine
+/// is not initialized, or `out` is invalid.
+///
+/// # Safety
+/// `out` must point to at least `out_len` writable bytes.
 #[no_mangle]
-pub extern "C" fn ime_shortcuts_capacity() -> usize {
+pub unsafe extern "C" fn ime_shortcode_candidates(
+    out: *mut std::os::raw::c_char,
+    out_len: usize,
+    max_candidates: u32,
+) -> i32 {
+    use std::io::Write;
+
+    if out.is_null() || out_len == 0 {
+        return -1;
+    }
+    let dst = std::slice::from_raw_parts_mut(out as *mut u8, out_len);
+    dst[0] = 0;
+
     let guard = lock_engine();
-    if let Some(ref e) = *guard {
-        e.shortcuts().capacity()
-    } else {
-        0
+    let e = match *guard {
+        Some(ref e) => e,
+        None => return -1,
+    };
+    if e.shortcode_query().is_none() {
+        return -1;
+    }
+
+    let mut best = [0usize; 16];
+    let want = (max_candidates as usize).min(best.len());
+    let n = e.shortcode_candidates(&mut best[..want]);
+    let table = engine::shortcode::ShortcodeTable::builtin();
+
+    let mut written = 0usize;
+    let mut count = 0i32;
+    for &i in &best[..n] {
+        // Keep the last byte for the terminator; a partial line is discarded
+        let mut cursor = &mut dst[written..out_len - 1];
+        let room = cursor.len();
+        let sep = if count > 0 { "\n" } else { "" };
+        if write!(
+            cursor,
+            "{}{}\t{}\t{}",
+            sep,
+            i,
+            table.code(i),
+            table.value(i)
+        )
+        .is_err()
+        {
+            break;
+        }
+        written += room - cursor.len();
+        count += 1;
     }
+    dst[written] = 0;
+    count
 }
 
-/// Check if shortcuts table is at capacity.
+/// Replace the typed `:code` with shortcode candidate `index`.
 ///
 /// # Returns
-/// `true` if at capacity, `false` otherwise
+/// * Pointer to `Result` (caller must free with `ime_free`); action is
+///   `None` if no session is active
+/// * `null` if engine not initialized
 #[no_mangle]
-pub extern "C" fn ime_shortcuts_is_at_capacity() -> bool {
+pub extern "C" fn ime_select_shortcode(index: u32) -> *mut Result {
+    let mut guard = lock_engine();
+    match guard.as_mut() {
+        Some(e) => {
+            let r = e.select_shortcode(index as usize);
+            Box::into_raw(Box::new(r))
+        }
+        None => std::ptr::null_mut(),
+    }
+}
+
+// ============================================================
+// Amplification FFI
+// ============================================================
+
+/// Enable or disable low-amplification mode.
+///
+/// Edits never retype characters already on screen, and speculative
+/// tone/mark keys are not applied to words that look definitely English.
+/// No-op if engine not initialized.
+#[no_mangle]
+pub extern "C" fn ime_set_low_amplification(enabled: bool) {
+    let mut guard = lock_engine();
+    if let Some(ref mut e) = *guard {
+        e.set_low_amplification(enabled);
+    }
+}
+
+/// Why the last key produced an edit (`EditCause` value).
+///
+/// 0=None, 1=Compose, 2=ToneReposition, 3=AutoRestore, 4=InstantRestore,
+/// 5=Shortcut, 6=Other. Returns 0 if engine not initialized.
+#[no_mangle]
+pub extern "C" fn ime_last_edit_cause() -> u8 {
     let guard = lock_engine();
-    if let Some(ref e) = *guard {
-        e.shortcuts().is_at_capacity()
-    } else {
-        false
+    match *guard {
+        Some(ref e) => e.last_edit_cause() as u8,
+        None => 0,
     }
 }
 
-/// Export all shortcuts to JSON string.
+// ============================================================
+// Edit Planner FFI
+// ============================================================
+
+/// Register the costs of the platform's injection method.
+///
+/// Every edit is then planned for the lowest cost: backspaces + text
+/// (action `Send`), a range replacement (action `ReplaceRange`: replace
+/// the `backspace` chars that end `keep` chars before the caret) or a
+/// deferred commit (keys pass through as typed; one edit fixes the word at
+/// its boundary, `CommitPassThrough` before keys that type nothing). The
+/// `ime_key_into_*` and wide paths never return `ReplaceRange`.
+///
+/// # Arguments
+/// * `per_edit` / `per_backspace` / `per_char` - Fixed price of one edit,
+///   of one backspace and of one inserted character (any unit, e.g. µs)
+/// * `per_replace` - Price of replacing a range on top of `per_edit`
+///   (`UINT32_MAX`: not supported)
+/// * `per_deferred_key` - Price of each key shown as typed while a word is
+///   deferred (`UINT32_MAX`: never defer; call `ime_settle_edit` before
+///   `ime_clear` otherwise)
 ///
 /// # Returns
-/// Pointer to JSON string (caller must free with `ime_free_string`)
-/// Returns null if engine not initialized.
+/// false if the engine is not initialized.
+#[no_mangle]
+pub extern "C" fn ime_set_edit_costs(
+    per_edit: u32,
+    per_backspace: u32,
+    per_char: u32,
+    per_replace: u32,
+    per_deferred_key: u32,
+) -> bool {
+    let mut guard = lock_engine();
+    let Some(e) = guard.as_mut() else {
+        return false;
+    };
+    e.set_edit_costs(engine::EditCosts {
+        per_edit,
+        per_backspace,
+        per_char,
+        per_replace,
+        per_deferred_key,
+    });
+    true
+}
+
+/// Stop planning edits (edits are backspaces + text as computed).
+/// No-op if engine not initialized.
+#[no_mangle]
+pub extern "C" fn ime_clear_edit_costs() {
+    let mut guard = lock_engine();
+    if let Some(ref mut e) = *guard {
+        e.clear_edit_costs();
+    }
+}
+
+/// Settle a deferred edit and reset the word state.
+///
+/// With deferral enabled, call this instead of `ime_clear` on focus
+/// changes, mouse clicks and other non-key boundaries, and apply the edit.
+///
+/// # Returns
+/// * Pointer to `Result` (caller must free with `ime_free`); action is
+///   `Send` fixing the word, or `None` if nothing was deferred
+/// * `null` if engine not initialized
+#[no_mangle]
+pub extern "C" fn ime_settle_edit() -> *mut Result {
+    let mut guard = lock_engine();
+    match guard.as_mut() {
+        Some(e) => Box::into_raw(Box::new(e.settle_edit())),
+        None => std::ptr::null_mut(),
+    }
+}
+
+// ============================================================
+// Composition FFI
+// ============================================================
+
+/// Enable or disable composition (marked text) mode.
+///
+/// When enabled, `ime_key` reports the word being typed as marked text
+/// (action `Preedit`: replace the marked text with `chars`) and only emits
+/// committed text at word boundaries (actions `Commit` / `CommitPassThrough`).
+/// Any displayed marked text is discarded; commit it first if needed.
+/// No-op if engine not initialized.
+#[no_mangle]
+pub extern "C" fn ime_set_composition_mode(enabled: bool) {
+    let mut guard = lock_engine();
+    if let Some(ref mut e) = *guard {
+        e.set_composition_mode(enabled);
+    }
+}
+
+/// Copy the current marked text (UTF-32 code points) into `out`.
+///
+/// # Arguments
+/// * `out` - Caller-provided buffer of `capacity` code points (may be null
+///   to query the length)
+/// * `capacity` - Size of `out` in code points
+/// * `caret` - Receives the caret position in code points (may be null)
+///
+/// # Returns
+/// Number of code points in the marked text (0 if none), or -1 if the
+/// engine is not initialized or `out` is too small.
 ///
 /// # Safety
-/// Caller must free the returned string using `ime_free_string`.
+/// `out` must point to at least `capacity` writable `u32`s; `caret` must be
+/// null or point to a writable `u32`.
 #[no_mangle]
-pub extern "C" fn ime_export_shortcuts_json() -> *mut std::os::raw::c_char {
+pub unsafe extern "C" fn ime_get_preedit(out: *mut u32, capacity: usize, caret: *mut u32) -> i32 {
     let guard = lock_engine();
-    if let Some(ref e) = *guard {
-        let json = e.shortcuts().to_json();
-        match std::ffi::CString::new(json) {
-            Ok(c_str) => c_str.into_raw(),
-            Err(_) => std::ptr::null_mut(),
-        }
-    } else {
-        std::ptr::null_mut()
+    let e = match *guard {
+        Some(ref e) => e,
+        None => return -1,
+    };
+    let preedit = e.preedit();
+    if !caret.is_null() {
+        *caret = preedit.caret() as u32;
+    }
+    if out.is_null() {
+        return preedit.len() as i32;
+    }
+    if capacity < preedit.len() {
+        return -1;
+    }
+    let dst = std::slice::from_raw_parts_mut(out, preedit.len());
+    for (d, &c) in dst.iter_mut().zip(preedit.as_slice()) {
+        *d = c as u32;
+    }
+    preedit.len() as i32
+}
+
+/// Commit the marked text and reset the word state.
+///
+/// In composition mode call this instead of `ime_clear` on focus changes,
+/// mouse clicks and other non-key boundaries, and insert the returned text.
+///
+/// # Returns
+/// * Pointer to `Result` (caller must free with `ime_free`); action is
+///   `Commit` with the marked text, or `None` if there was none
+/// * `null` if engine not initialized
+#[no_mangle]
+pub extern "C" fn ime_commit_preedit() -> *mut Result {
+    let mut guard = lock_engine();
+    match guard.as_mut() {
+        Some(e) => Box::into_raw(Box::new(e.commit_preedit())),
+        None => std::ptr::null_mut(),
+    }
+}
+
+// ============================================================
+// Adaptive Learning FFI
+// ============================================================
+
+/// Enable or disable learning from restore corrections.
+///
+/// When enabled, ESC restores and backspaces right after an auto-restore
+/// are remembered per keystroke sequence and bias later decisions.
+/// Disabling drops learned corrections (save them first to keep them).
+/// No-op if engine not initialized.
+#[no_mangle]
+pub extern "C" fn ime_set_adaptive_learning(enabled: bool) {
+    let mut guard = lock_engine();
+    if let Some(ref mut e) = *guard {
+        e.set_adaptive_learning(enabled);
     }
 }
 
-/// Import shortcuts from JSON string.
-///
-/// # Arguments
-/// * `json` - C string containing JSON data
+/// Load learned corrections from a file and enable learning.
 ///
 /// # Returns
-/// Number of shortcuts imported, or -1 on error
+/// * `true` if the file was valid and loaded
+/// * `false` on I/O error, invalid file, or engine not initialized
 ///
 /// # Safety
 /// Pointer must be a valid null-terminated UTF-8 string.
 #[no_mangle]
-pub unsafe extern "C" fn ime_import_shortcuts_json(json: *const std::os::raw::c_char) -> i32 {
-    if json.is_null() {
-        return -1;
+pub unsafe extern "C" fn ime_load_learning(path: *const std::os::raw::c_char) -> bool {
+    if path.is_null() {
+        return false;
     }
-
-    let json_str = match std::ffi::CStr::from_ptr(json).to_str() {
+    let path_str = match std::ffi::CStr::from_ptr(path).to_str() {
         Ok(s) => s,
-        Err(_) => return -1,
+        Err(_) => return false,
+    };
+    // Read and validate outside the engine lock
+    let sketch = match std::fs::read(path_str)
+        .ok()
+        .and_then(|bytes| engine::RestoreSketch::from_bytes(&bytes).ok())
+    {
+        Some(s) => s,
+        None => return false,
     };
 
     let mut guard = lock_engine();
     if let Some(ref mut e) = *guard {
-        match e.shortcuts_mut().from_json(json_str) {
-            Ok(count) => count as i32,
-            Err(_) => -1,
-        }
+        e.set_learning(Some(sketch));
+        true
     } else {
-        -1
+        false
     }
 }
 
-/// Free a string allocated by `ime_export_shortcuts_json`.
+/// Save learned corrections to a file (fixed size, see `restore_learning`).
+///
+/// # Returns
+/// * `true` if written
+/// * `false` if learning is disabled, on I/O error, or engine not initialized
 ///
 /// # Safety
-/// * `s` must be a pointer returned by `ime_export_shortcuts_json`, or null
-/// * Must be called exactly once per non-null pointer
+/// Pointer must be a valid null-terminated UTF-8 string.
 #[no_mangle]
-pub unsafe extern "C" fn ime_free_string(s: *mut std::os::raw::c_char) {
-    if !s.is_null() {
-        // Reconstruct and drop CString
-        let _ = std::ffi::CString::from_raw(s);
+pub unsafe extern "C" fn ime_save_learning(path: *const std::os::raw::c_char) -> bool {
+    if path.is_null() {
+        return false;
     }
+    let path_str = match std::ffi::CStr::from_ptr(path).to_str() {
+        Ok(s) => s,
+        Err(_) => return false,
+    };
+    // Snapshot under the lock, write outside it
+    let bytes = {
+        let guard = lock_engine();
+        match guard.as_ref().and_then(|e| e.learning()) {
+            Some(sketch) => sketch.to_bytes(),
+            None => return false,
+        }
+    };
+    std::fs::write(path_str, bytes).is_ok()
 }
 
-/// Set whether shortcuts are enabled globally.
-///
-/// When disabled, shortcut expansion is skipped.
-/// No-op if engine not initialized.
+/// Forget all learned corrections (learning stays enabled).
 #[no_mangle]
-pub extern "C" fn ime_set_shortcuts_enabled(enabled: bool) {
+pub extern "C" fn ime_reset_learning() {
     let mut guard = lock_engine();
     if let Some(ref mut e) = *guard {
-        e.shortcuts_enabled = enabled;
+        if let Some(sketch) = e.learning_mut() {
+            sketch.reset();
+        }
     }
 }
 
 // ============================================================
-// Encoding FFI
+// Override Lists FFI
 // ============================================================
 
-/// Global encoding converter (thread-safe via Mutex)
-static ENCODING: std::sync::Mutex<crate::engine::features::encoding::EncodingConverter> =
-    std::sync::Mutex::new(crate::engine::features::encoding::EncodingConverter::new_const());
-
-/// Set the output encoding.
-///
-/// # Arguments
-/// * `encoding` - Encoding type: 0=Unicode (default), 1=TCVN3, 2=VNI, 3=CP1258
-///
-/// Unicode is the default and requires no conversion.
-/// TCVN3, VNI, and CP1258 are legacy Vietnamese encodings.
-#[no_mangle]
-pub extern "C" fn ime_set_encoding(encoding: u8) {
-    use crate::engine::features::encoding::OutputEncoding;
-    if let Ok(mut guard) = ENCODING.lock() {
-        guard.set_encoding(OutputEncoding::from_u8(encoding));
+/// Override list kind: 0 = always English, 1 = always Vietnamese
+fn override_kind(kind: u8) -> Option<engine::LanguageBias> {
+    match kind {
+        0 => Some(engine::LanguageBias::English),
+        1 => Some(engine::LanguageBias::Vietnamese),
+        _ => None,
     }
 }
 
-/// Get the current output encoding.
-///
-/// # Returns
-/// Encoding type: 0=Unicode, 1=TCVN3, 2=VNI, 3=CP1258
-#[no_mangle]
-pub extern "C" fn ime_get_encoding() -> u8 {
-    if let Ok(guard) = ENCODING.lock() {
-        guard.encoding().to_u8()
-    } else {
-        0 // Default to Unicode on error
-    }
+/// Build an override set outside the lock and swap it in.
+/// Returns entry count, or -1 if kind is invalid / engine not initialized.
+fn install_override_list(kind: u8, text: &str) -> i32 {
+    let kind = match override_kind(kind) {
+        Some(k) => k,
+        None => return -1,
+    };
+    let (set, _rejected) = engine::OverrideSet::parse(text);
+    let count = set.len() as i32;
+
+    let old = {
+        let mut guard = lock_engine();
+        match guard.as_mut() {
+            Some(e) => e.set_override_list(kind, Some(set)),
+            None => return -1,
+        }
+    };
+    // Free the previous list after releasing the lock
+    drop(old);
+    count
 }
 
-/// Convert a Unicode string to the current encoding.
+/// Replace an override list with newline-separated words.
+///
+/// Words are the ASCII keystrokes as typed (e.g. `hex`, or Telex `mas`);
+/// blank lines and `#` comments are skipped. Entries are checked before
+/// English detection. The list is built before the engine lock is taken,
+/// so replacing 100k entries never blocks typing. An empty list clears it.
 ///
 /// # Arguments
-/// * `input` - UTF-8 string to convert
+/// * `kind` - 0 = always English, 1 = always Vietnamese
+/// * `words` - Newline-separated UTF-8 text
 ///
 /// # Returns
-/// Pointer to encoded bytes (caller must free with `ime_free_bytes`)
-/// Returns null on error.
+/// Number of entries loaded, or -1 on invalid arguments / engine not initialized
 ///
 /// # Safety
-/// Caller must free the returned buffer using `ime_free_bytes`.
+/// Pointer must be a valid null-terminated UTF-8 string.
 #[no_mangle]
-pub unsafe extern "C" fn ime_convert_encoding(input: *const std::os::raw::c_char) -> *mut u8 {
-    if input.is_null() {
-        return std::ptr::null_mut();
-    }
-
-    let input_str = match std::ffi::CStr::from_ptr(input).to_str() {
-        Ok(s) => s,
-        Err(_) => return std::ptr::null_mut(),
-    };
-
-    if let Ok(guard) = ENCODING.lock() {
-        let bytes = guard.convert_string(input_str);
-        let mut boxed = bytes.into_boxed_slice();
-        let ptr = boxed.as_mut_ptr();
-        std::mem::forget(boxed);
-        ptr
-    } else {
-        std::ptr::null_mut()
+pub unsafe extern "C" fn ime_set_override_list(
+    kind: u8,
+    words: *const std::os::raw::c_char,
+) -> i32 {
+    if words.is_null() {
+        return -1;
     }
-}
-
-/// Free bytes allocated by ime_convert_encoding.
-///
-/// # Safety
-/// Must be called with pointer from ime_convert_encoding, or null.
-#[no_mangle]
-pub unsafe extern "C" fn ime_free_bytes(ptr: *mut u8, len: usize) {
-    if !ptr.is_null() && len > 0 {
-        let _ = Vec::from_raw_parts(ptr, len, len);
+    match std::ffi::CStr::from_ptr(words).to_str() {
+        Ok(text) => install_override_list(kind, text),
+        Err(_) => -1,
     }
 }
 
-// ============================================================
-// Word Restore FFI
-// ============================================================
-
-/// Restore buffer from a Vietnamese word string.
+/// Replace an override list from a file (same format as `ime_set_override_list`).
 ///
-/// Used when native app detects cursor at word boundary and user
-/// wants to continue editing (e.g., backspace into previous word).
-/// Parses Vietnamese characters back to buffer components.
+/// Call again after the file changes to hot-reload it.
 ///
-/// # Arguments
-/// * `word` - C string containing the Vietnamese word to restore
+/// # Returns
+/// Number of entries loaded, or -1 on I/O error / invalid arguments
 ///
 /// # Safety
 /// Pointer must be a valid null-terminated UTF-8 string.
 #[no_mangle]
-pub unsafe extern "C" fn ime_restore_word(word: *const std::os::raw::c_char) {
-    if word.is_null() {
-        return;
+pub unsafe extern "C" fn ime_load_override_file(
+    kind: u8,
+    path: *const std::os::raw::c_char,
+) -> i32 {
+    if path.is_null() {
+        return -1;
     }
-    let word_str = match std::ffi::CStr::from_ptr(word).to_str() {
+    let path_str = match std::ffi::CStr::from_ptr(path).to_str() {
         Ok(s) => s,
-        Err(_) => return,
+        Err(_) => return -1,
     };
-    let mut guard = lock_engine();
-    if let Some(ref mut e) = *guard {
-        e.restore_word(word_str);
+    match std::fs::read_to_string(path_str) {
+        Ok(text) => install_override_list(kind, &text),
+        Err(_) => -1,
     }
 }
 
+/// Remove an override list (0 = English, 1 = Vietnamese).
+#[no_mangle]
+pub extern "C" fn ime_clear_override_list(kind: u8) {
+    let Some(kind) = override_kind(kind) else {
+        return;
+    };
+    let old = {
+        let mut guard = lock_engine();
+        match guard.as_mut() {
+            Some(e) => e.set_override_list(kind, None),
+            None => None,
+        }
+    };
+    drop(old);
+}
+
 // ============================================================
 // Tests
 // ============================================================
@@ -640,6 +2128,7 @@ mod tests {
     }
 
     #[test]
+    #[cfg(feature = "shortcuts")]
     #[serial]
     fn test_shortcut_ffi_add_and_clear() {
         ime_init();
@@ -675,6 +2164,7 @@ mod tests {
     }
 
     #[test]
+    #[cfg(feature = "shortcuts")]
     #[serial]
     fn test_shortcut_ffi_remove() {
         ime_init();
@@ -736,6 +2226,7 @@ mod tests {
     }
 
     #[test]
+    #[cfg(feature = "shortcuts")]
     #[serial]
     fn test_shortcut_ffi_unicode() {
         ime_init();
@@ -804,4 +2295,406 @@ mod tests {
 
         ime_clear();
     }
+
+    #[test]
+    #[cfg(feature = "dictionaries")]
+    #[serial]
+    fn test_shortcode_ffi() {
+        ime_init();
+        ime_set_shortcodes_enabled(true);
+
+        let r = ime_key_ext(keys::SEMICOLON, false, false, true);
+        unsafe { ime_free(r) };
+        for k in [keys::S, keys::M, keys::I] {
+            let r = ime_key(k, false, false);
+            unsafe { ime_free(r) };
+        }
+
+        let mut buf = [0 as std::os::raw::c_char; 512];
+        let n = unsafe { ime_shortcode_candidates(buf.as_mut_ptr(), buf.len(), 4) };
+        assert!(n > 0, "Should list candidates for :smi");
+        let text = unsafe { std::ffi::CStr::from_ptr(buf.as_ptr()) }
+            .to_str()
+            .unwrap();
+        let first: Vec<&str> = text.lines().next().unwrap().split('\t').collect();
+        assert_eq!(first[1], "smile");
+        assert_eq!(first[2], "😄");
+
+        let index: u32 = first[0].parse().unwrap();
+        let r = ime_select_shortcode(index);
+        assert!(!r.is_null());
+        unsafe {
+            assert_eq!((*r).action, 1);
+            assert_eq!((*r).backspace, 4, "Deletes ':smi'");
+            assert_eq!((*r).count, 1);
+            ime_free(r);
+        }
+
+        // Session ended
+        let n = unsafe { ime_shortcode_candidates(buf.as_mut_ptr(), buf.len(), 4) };
+        assert_eq!(n, -1);
+
+        ime_set_shortcodes_enabled(false);
+        ime_clear();
+    }
+
+    #[test]
+    #[serial]
+    fn test_learning_ffi_save_load() {
+        ime_init();
+        ime_set_adaptive_learning(true);
+
+        let path = std::env::temp_dir().join("goxviet_learning_ffi_test.bin");
+        let c_path = CString::new(path.to_str().unwrap()).unwrap();
+        unsafe {
+            assert!(ime_save_learning(c_path.as_ptr()));
+            assert!(ime_load_learning(c_path.as_ptr()));
+            assert!(!ime_load_learning(std::ptr::null()));
+        }
+        assert_eq!(
+            std::fs::metadata(&path).unwrap().len() as usize,
+            engine::restore_learning::FILE_LEN
+        );
+        ime_reset_learning();
+
+        ime_set_adaptive_learning(false);
+        unsafe {
+            assert!(!ime_save_learning(c_path.as_ptr()), "Nothing to save");
+        }
+        let _ = std::fs::remove_file(&path);
+        ime_clear();
+    }
+
+    #[test]
+    #[serial]
+    fn test_override_list_ffi() {
+        ime_init();
+        ime_method(0);
+
+        // "of" in Telex would be "ò"; pin it to English
+        let list = CString::new("of\nhex\n# comment\n").unwrap();
+        assert_eq!(unsafe { ime_set_override_list(0, list.as_ptr()) }, 2);
+        assert_eq!(unsafe { ime_set_override_list(7, list.as_ptr()) }, -1);
+        assert_eq!(unsafe { ime_set_override_list(0, std::ptr::null()) }, -1);
+
+        for k in [keys::O, keys::F] {
+            let r = ime_key(k, false, false);
+            unsafe { ime_free(r) };
+        }
+        let buf = unsafe { std::ffi::CStr::from_ptr(ime_get_buffer()) };
+        assert_eq!(buf.to_str().unwrap(), "of");
+
+        ime_clear_override_list(0);
+        ime_clear();
+    }
+
+    #[test]
+    #[serial]
+    fn test_composition_ffi() {
+        ime_init();
+        ime_method(0);
+        ime_set_composition_mode(true);
+
+        for k in [keys::V, keys::I, keys::E, keys::E] {
+            let r = ime_key(k, false, false);
+            unsafe {
+                assert_eq!((*r).action, 3, "Preedit update");
+                ime_free(r);
+            }
+        }
+
+        let mut out = [0u32; 8];
+        let mut caret = 0u32;
+        let n = unsafe { ime_get_preedit(out.as_mut_ptr(), out.len(), &mut caret) };
+        assert_eq!(n, 3);
+        assert_eq!(caret, 3);
+        let text: String = out[..3].iter().filter_map(|&c| char::from_u32(c)).collect();
+        assert_eq!(text, "viê");
+        assert_eq!(
+            unsafe { ime_get_preedit(out.as_mut_ptr(), 2, std::ptr::null_mut()) },
+            -1
+        );
+
+        let r = ime_commit_preedit();
+        unsafe {
+            assert_eq!((*r).action, 4);
+            assert_eq!((*r).backspace, 0);
+            assert_eq!((*r).count, 3);
+            ime_free(r);
+        }
+        assert_eq!(
+            unsafe { ime_get_preedit(std::ptr::null_mut(), 0, std::ptr::null_mut()) },
+            0
+        );
+
+        ime_set_composition_mode(false);
+        ime_clear();
+    }
+
+    #[test]
+    #[cfg(all(feature = "english-detection", feature = "dictionaries"))]
+    #[serial]
+    fn test_amplification_ffi() {
+        ime_init();
+        ime_method(0);
+        ime_set_low_amplification(true);
+
+        for k in [keys::T, keys::E, keys::X] {
+            let r = ime_key(k, false, false);
+            unsafe { ime_free(r) };
+        }
+        assert_eq!(ime_last_edit_cause(), engine::EditCause::Compose as u8);
+        let r = ime_key(keys::T, false, false);
+        unsafe {
+            assert_eq!((*r).backspace, 1);
+            ime_free(r);
+        }
+        assert_eq!(
+            ime_last_edit_cause(),
+            engine::EditCause::InstantRestore as u8
+        );
+
+        ime_set_low_amplification(false);
+        ime_clear();
+    }
+
+    #[test]
+    #[serial]
+    fn test_key_into_utf16_utf8() {
+        ime_init();
+        ime_method(0);
+        let mut out16 = [0u16; engine::output::MAX_UTF16_LEN];
+        let mut out8 = [0u8; engine::output::MAX_UTF8_LEN];
+        let (mut action, mut bs) = (0u8, 0u8);
+
+        for k in [keys::V, keys::I, keys::E] {
+            let n = unsafe {
+                ime_key_into_utf16(
+                    k,
+                    false,
+                    false,
+                    false,
+                    out16.as_mut_ptr(),
+                    out16.len(),
+                    &mut action,
+                    &mut bs,
+                )
+            };
+            assert_eq!(n, 0);
+            assert_eq!(action, 0);
+        }
+        let n = unsafe {
+            ime_key_into_utf16(
+                keys::E,
+                false,
+                false,
+                false,
+                out16.as_mut_ptr(),
+                out16.len(),
+                &mut action,
+                &mut bs,
+            )
+        };
+        assert_eq!((action, bs), (1, 1));
+        assert_eq!(String::from_utf16(&out16[..n as usize]).unwrap(), "ê");
+
+        assert!(ime_set_output_form(1));
+        let n = unsafe {
+            ime_key_into_utf8(
+                keys::J,
+                false,
+                false,
+                false,
+                out8.as_mut_ptr(),
+                out8.len(),
+                &mut action,
+                &mut bs,
+            )
+        };
+        assert_eq!(action, 1);
+        assert_eq!(
+            std::str::from_utf8(&out8[..n as usize]).unwrap(),
+            "e\u{0323}\u{0302}"
+        );
+
+        // Undersized buffer: rejected before the key is processed
+        let n = unsafe {
+            ime_key_into_utf8(
+                keys::T,
+                false,
+                false,
+                false,
+                out8.as_mut_ptr(),
+                16,
+                &mut action,
+                &mut bs,
+            )
+        };
+        assert_eq!(n, -1);
+        assert_eq!(
+            unsafe { std::ffi::CStr::from_ptr(ime_get_buffer()) }
+                .to_str()
+                .unwrap(),
+            "việ"
+        );
+        assert!(!ime_set_output_form(9));
+
+        assert!(ime_set_output_form(0));
+        ime_clear();
+    }
+
+    #[test]
+    #[cfg(feature = "shortcuts")]
+    #[serial]
+    fn test_wide_result_ffi() {
+        ime_init();
+        ime_method(0);
+        let text = "Trân trọng, Nguyễn Văn A. ".repeat(40);
+        let trigger = CString::new("sig").unwrap();
+        let replacement = CString::new(text.clone()).unwrap();
+        assert!(unsafe { ime_add_snippet(trigger.as_ptr(), replacement.as_ptr()) });
+        let expected = text.chars().count() as u32 + 1; // + space
+
+        // Inline: whole expansion in one result
+        for k in [keys::S, keys::I, keys::G] {
+            unsafe { ime_free_wide(ime_key_wide(k, false, false, false, u32::MAX)) };
+        }
+        let r = ime_key_wide(keys::SPACE, false, false, false, u32::MAX);
+        unsafe {
+            assert_eq!((*r).action, 1);
+            assert_eq!((*r).backspace, 3);
+            assert_eq!((*r).count, expected);
+            assert_eq!((*r).remaining, 0);
+            ime_free_wide(r);
+        }
+
+        // Chunked: read into a small caller buffer
+        for k in [keys::S, keys::I, keys::G] {
+            unsafe { ime_free_wide(ime_key_wide(k, false, false, false, 0)) };
+        }
+        let r = ime_key_wide(keys::SPACE, false, false, false, 0);
+        unsafe {
+            assert_eq!((*r).count, 0);
+            assert_eq!((*r).remaining, expected);
+            ime_free_wide(r);
+        }
+        let mut chunk = [0u32; 100];
+        let mut streamed = String::new();
+        loop {
+            let n = unsafe { ime_read_expansion(chunk.as_mut_ptr(), chunk.len()) };
+            assert!(n >= 0);
+            if n == 0 {
+                break;
+            }
+            streamed.extend(
+                chunk[..n as usize]
+                    .iter()
+                    .filter_map(|&c| char::from_u32(c)),
+            );
+        }
+        assert_eq!(streamed, format!("{text} "));
+        assert_eq!(unsafe { ime_read_expansion(std::ptr::null_mut(), 4) }, -1);
+
+        // Legacy path: truncated to the u8 count
+        for k in [keys::S, keys::I, keys::G, keys::SPACE] {
+            let r = ime_key(k, false, false);
+            if k == keys::SPACE {
+                assert_eq!(unsafe { (*r).count }, 255);
+            }
+            unsafe { ime_free(r) };
+        }
+
+        ime_clear_shortcuts();
+        ime_clear();
+    }
+
+    #[test]
+    #[serial]
+    fn test_key_into_utf32_and_shutdown() {
+        ime_init();
+        ime_method(0);
+        let mut out = [0u32; engine::output::MAX_UTF32_LEN];
+        let (mut action, mut bs) = (0u8, 0u8);
+        let mut n = 0;
+        for k in [keys::V, keys::I, keys::E, keys::E] {
+            n = unsafe {
+                ime_key_into_utf32(
+                    k,
+                    false,
+                    false,
+                    false,
+                    out.as_mut_ptr(),
+                    out.len(),
+                    &mut action,
+                    &mut bs,
+                )
+            };
+        }
+        assert_eq!((n, action, bs), (1, 1, 1));
+        assert_eq!(out[0], 'ê' as u32);
+
+        ime_shutdown();
+        let n = unsafe {
+            ime_key_into_utf32(
+                keys::A,
+                false,
+                false,
+                false,
+                out.as_mut_ptr(),
+                out.len(),
+                &mut action,
+                &mut bs,
+            )
+        };
+        assert_eq!(n, -1);
+        assert!(ime_key(keys::A, false, false).is_null());
+        ime_init();
+    }
+
+    #[test]
+    #[cfg(feature = "encoding")]
+    #[serial]
+    fn test_convert_encoding_ext() {
+        let input = CString::new("Việt").unwrap();
+        let mut len = usize::MAX;
+        let ptr = unsafe { ime_convert_encoding_ext(input.as_ptr(), &mut len) };
+        assert!(!ptr.is_null());
+        assert!(len > 0);
+        unsafe { ime_free_bytes(ptr, len) };
+        assert!(
+            unsafe { ime_convert_encoding_ext(input.as_ptr(), std::ptr::null_mut()) }.is_null()
+        );
+    }
+
+    #[test]
+    #[serial]
+    fn test_key_timed_counts_lock_wait_as_queue() {
+        ime_init();
+        // First key: lazily loaded data is not what this test measures
+        unsafe { ime_free(ime_key(keys::A, false, false)) };
+        ime_clear();
+        ime_latency_reset();
+
+        // Another thread holds the engine for 50 ms while the key waits
+        let guard = lock_engine();
+        let key = std::thread::spawn(|| {
+            let r = ime_key_timed(keys::A, false, false, false, 0, 0);
+            assert!(!r.is_null());
+            unsafe { ime_free(r) };
+        });
+        std::thread::sleep(std::time::Duration::from_millis(50));
+        drop(guard);
+        key.join().unwrap();
+
+        let processing = LATENCY.stage(latency::LatencyStage::Processing).stats();
+        assert_eq!(processing.count, 1);
+        assert!(processing.max_ns < 50_000_000);
+        // Same event and receive time: the queue stage is the lock wait
+        let queue = LATENCY.stage(latency::LatencyStage::Queue).stats();
+        assert!(queue.max_ns >= 25_000_000, "{}", queue.max_ns);
+        assert!(ime_key_injected(queue.max_ns + processing.max_ns));
+        let injection = LATENCY.stage(latency::LatencyStage::Injection).stats();
+        assert_eq!(injection.max_ns, 0);
+        ime_latency_reset();
+    }
 }
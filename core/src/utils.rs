@@ -8,61 +8,28 @@ use crate::data::{
     keys,
     vowel::{Modifier, Vowel},
 };
-use crate::engine::buffer::Buffer;
-
-/// Convert key code to character
-pub fn key_to_char(key: u16, caps: bool) -> Option<char> {
-    let ch = match key {
-        keys::A => 'a',
-        keys::B => 'b',
-        keys::C => 'c',
-        keys::D => 'd',
-        keys::E => 'e',
-        keys::F => 'f',
-        keys::G => 'g',
-        keys::H => 'h',
-        keys::I => 'i',
-        keys::J => 'j',
-        keys::K => 'k',
-        keys::L => 'l',
-        keys::M => 'm',
-        keys::N => 'n',
-        keys::O => 'o',
-        keys::P => 'p',
-        keys::Q => 'q',
-        keys::R => 'r',
-        keys::S => 's',
-        keys::T => 't',
-        keys::U => 'u',
-        keys::V => 'v',
-        keys::W => 'w',
-        keys::X => 'x',
-        keys::Y => 'y',
-        keys::Z => 'z',
-        keys::N0 => return Some('0'),
-        keys::N1 => return Some('1'),
-        keys::N2 => return Some('2'),
-        keys::N3 => return Some('3'),
-        keys::N4 => return Some('4'),
-        keys::N5 => return Some('5'),
-        keys::N6 => return Some('6'),
-        keys::N7 => return Some('7'),
-        keys::N8 => return Some('8'),
-        keys::N9 => return Some('9'),
-        _ => return None,
-    };
-    Some(if caps { ch.to_ascii_uppercase() } else { ch })
-}
+use crate::engine::buffer::{Buffer, Scratch};
+
+pub use crate::data::keys::key_to_char;
 
 /// Collect vowels from buffer with phonological info
 /// Excludes 'i' when it's part of "gi" initial (e.g., "giống", "giàu")
 pub fn collect_vowels(buf: &Buffer) -> Vec<Vowel> {
+    vowels(buf).collect()
+}
+
+/// `collect_vowels` in the word's scratch arena
+pub fn collect_vowels_in<'a>(buf: &Buffer, scratch: &'a Scratch) -> &'a [Vowel] {
+    scratch.collect_at_most(buf.len(), vowels(buf))
+}
+
+fn vowels(buf: &Buffer) -> impl Iterator<Item = Vowel> + '_ {
     // Check for "gi" initial: g + i + vowel
     let has_gi_initial = has_gi_initial(buf);
 
     buf.iter()
         .enumerate()
-        .filter(|(pos, c)| {
+        .filter(move |(pos, c)| {
             if !keys::is_vowel(c.key) {
                 return false;
             }
@@ -90,7 +57,6 @@ pub fn collect_vowels(buf: &Buffer) -> Vec<Vowel> {
             };
             Vowel::new(c.key, modifier, pos)
         })
-        .collect()
 }
 
 /// Check if there's a consonant after position
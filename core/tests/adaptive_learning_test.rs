@@ -0,0 +1,96 @@
+//! Adaptive restore learning tests
+//!
+//! ESC restores and backspaces after auto-restore are remembered per raw
+//! keystroke sequence and change the decision the next time.
+
+use goxviet_core::data::keys;
+use goxviet_core::engine::{Engine, LanguageBias, RestoreSketch};
+
+fn key_for(c: char) -> u16 {
+    match c {
+        'a' => keys::A,
+        'e' => keys::E,
+        'i' => keys::I,
+        'm' => keys::M,
+        'r' => keys::R,
+        's' => keys::S,
+        'x' => keys::X,
+        _ => panic!("unmapped char {c:?}"),
+    }
+}
+
+fn type_word(e: &mut Engine, word: &str) -> String {
+    e.clear_all();
+    for c in word.chars() {
+        e.on_key(key_for(c), false, false);
+    }
+    e.get_buffer()
+}
+
+fn learning_engine() -> Engine {
+    let mut e = Engine::new();
+    e.set_method(0);
+    e.set_esc_restore(true);
+    e.set_adaptive_learning(true);
+    e
+}
+
+#[test]
+fn test_esc_restore_is_learned_as_english() {
+    let mut e = learning_engine();
+    assert_eq!(type_word(&mut e, "mix"), "mĩ");
+
+    let r = e.on_key(keys::ESC, false, false);
+    assert_eq!(r.action, 1, "ESC should restore 'mix'");
+    assert_eq!(e.learning().unwrap().total(), 1);
+
+    assert_eq!(type_word(&mut e, "mix"), "mix");
+    // Other words are unaffected
+    assert_eq!(type_word(&mut e, "mas"), "má");
+}
+
+#[test]
+fn test_backspace_after_auto_restore_is_learned_as_vietnamese() {
+    let mut e = learning_engine();
+    assert_eq!(type_word(&mut e, "mass"), "mass", "Auto-restored");
+
+    e.on_key(keys::DELETE, false, false);
+    assert_eq!(e.learning().unwrap().total(), 1);
+
+    // Telex double-mark revert instead of English restore
+    assert_eq!(type_word(&mut e, "mass"), "mas");
+}
+
+#[test]
+fn test_other_key_after_auto_restore_is_not_learned() {
+    let mut e = learning_engine();
+    type_word(&mut e, "mass");
+    e.on_key(keys::SPACE, false, false);
+    e.on_key(keys::DELETE, false, false);
+    assert_eq!(e.learning().unwrap().total(), 0);
+}
+
+#[test]
+fn test_disabled_by_default() {
+    let mut e = Engine::new();
+    e.set_esc_restore(true);
+    type_word(&mut e, "mix");
+    e.on_key(keys::ESC, false, false);
+    assert!(e.learning().is_none());
+    assert_eq!(type_word(&mut e, "mix"), "mĩ");
+}
+
+#[test]
+fn test_learning_survives_persistence() {
+    let mut e = learning_engine();
+    type_word(&mut e, "mix");
+    e.on_key(keys::ESC, false, false);
+    let bytes = e.learning().unwrap().to_bytes();
+
+    let mut fresh = Engine::new();
+    fresh.set_learning(Some(RestoreSketch::from_bytes(&bytes).unwrap()));
+    assert_eq!(type_word(&mut fresh, "mix"), "mix");
+
+    let hash = goxviet_core::engine::restore_learning::hash_keys([keys::M, keys::I, keys::X]);
+    assert_eq!(fresh.learning().unwrap().bias(hash), LanguageBias::English);
+}
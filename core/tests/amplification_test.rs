@@ -0,0 +1,143 @@
+//! Edit cause and low-amplification mode tests
+//!
+//! Every edit is attributed to an `EditCause`; low-amplification mode must
+//! emit fewer backspaces/chars while leaving the same text on screen.
+
+use goxviet_core::data::chars::parse_char;
+use goxviet_core::data::keys;
+use goxviet_core::engine::shortcut::Shortcut;
+use goxviet_core::engine::{Action, EditCause, Engine};
+
+fn key_for(c: char) -> (u16, bool) {
+    if c == ' ' {
+        return (keys::SPACE, false);
+    }
+    let p = parse_char(c).expect("letter");
+    (p.key, p.caps)
+}
+
+/// Type `input`, returning the final screen text, emitted units and causes
+fn type_word(e: &mut Engine, input: &str) -> (String, usize, Vec<EditCause>) {
+    let mut screen: Vec<char> = Vec::new();
+    let mut emitted = 0;
+    let mut causes = Vec::new();
+    for c in input.chars() {
+        let (key, caps) = key_for(c);
+        let r = e.on_key(key, caps, false);
+        causes.push(e.last_edit_cause());
+        if r.action == Action::Send as u8 {
+            emitted += r.backspace as usize + r.count as usize;
+            screen.truncate(screen.len().saturating_sub(r.backspace as usize));
+            screen.extend(r.as_slice().iter().filter_map(|&c| char::from_u32(c)));
+        } else {
+            screen.push(c);
+        }
+        r.release();
+    }
+    (screen.into_iter().collect(), emitted, causes)
+}
+
+fn engine(low_amplification: bool) -> Engine {
+    let mut e = Engine::new();
+    e.set_method(0);
+    e.set_low_amplification(low_amplification);
+    e
+}
+
+#[test]
+fn test_edit_causes() {
+    let mut e = engine(false);
+    let (_, _, causes) = type_word(&mut e, "text");
+    assert_eq!(
+        causes,
+        [
+            EditCause::None,
+            EditCause::None,
+            EditCause::Compose,
+            EditCause::InstantRestore
+        ]
+    );
+    e.clear();
+
+    let (screen, _, causes) = type_word(&mut e, "muasn");
+    assert_eq!(screen, "muán");
+    assert_eq!(causes.last(), Some(&EditCause::ToneReposition));
+    e.clear();
+
+    let (_, _, causes) = type_word(&mut e, "resol");
+    assert_eq!(causes.last(), Some(&EditCause::AutoRestore));
+    e.clear();
+
+    e.shortcuts_mut().add(Shortcut::new("vn", "Việt Nam"));
+    let (_, _, causes) = type_word(&mut e, "vn ");
+    assert_eq!(causes.last(), Some(&EditCause::Shortcut));
+}
+
+#[test]
+fn test_low_amplification_keeps_unchanged_prefix() {
+    let mut e = engine(true);
+    let r = {
+        for c in "tex".chars() {
+            let (key, caps) = key_for(c);
+            e.on_key(key, caps, false).release();
+        }
+        e.on_key(keys::T, false, false)
+    };
+    assert_eq!(r.backspace, 1, "Keeps 't' on screen");
+    let out: String = r
+        .as_slice()
+        .iter()
+        .filter_map(|&c| char::from_u32(c))
+        .collect();
+    assert_eq!(out, "ext");
+    assert_eq!(e.last_edit_cause(), EditCause::InstantRestore);
+}
+
+#[test]
+fn test_low_amplification_same_screen_fewer_units() {
+    let words = [
+        "text",
+        "disease",
+        "resolution",
+        "user",
+        "tieengs",
+        "vieetj",
+        "muasn",
+        "hoaf",
+        "nguowif",
+        "release",
+        "console",
+        "dduowcj",
+    ];
+    let mut total_default = 0;
+    let mut total_low = 0;
+    for w in words {
+        let mut a = engine(false);
+        let mut b = engine(true);
+        let (screen_a, units_a, _) = type_word(&mut a, w);
+        let (screen_b, units_b, _) = type_word(&mut b, w);
+        assert_eq!(screen_a, screen_b, "word {w}");
+        assert!(units_b <= units_a, "word {w}: {units_b} > {units_a}");
+        total_default += units_a;
+        total_low += units_b;
+    }
+    assert!(total_low < total_default);
+}
+
+#[test]
+fn test_low_amplification_after_history_restore() {
+    // Backspace-after-space restores a word the engine did not see typed
+    // on screen in this word; edits must stay untrimmed and correct
+    let mut e = engine(true);
+    type_word(&mut e, "vieet ");
+    let r = e.on_key(keys::DELETE, false, false);
+    r.release();
+    let r = e.on_key(keys::J, false, false);
+    assert_eq!(r.action, Action::Send as u8);
+    let out: String = r
+        .as_slice()
+        .iter()
+        .filter_map(|&c| char::from_u32(c))
+        .collect();
+    assert!(out.contains('ệ'), "got {out:?}");
+}
@@ -0,0 +1,207 @@
+//! Burst mode: the coalesced edit must leave the same text on screen as
+//! the per-key edits for the same keys.
+
+use goxviet_core::data::keys;
+use goxviet_core::engine::shortcut::Shortcut;
+use goxviet_core::engine::{Action, BurstKey, Engine};
+use goxviet_core::input::layout::translate_char;
+
+/// Key events of `text` (`\x08` = backspace)
+fn key_events(text: &str) -> Vec<(u16, bool, bool)> {
+    text.chars()
+        .map(|c| {
+            let k = translate_char(c).unwrap();
+            (k.key, k.caps, k.shift)
+        })
+        .collect()
+}
+
+/// Apply one edit to `screen`, typing the key itself if passed through
+fn apply(screen: &mut Vec<u32>, key: (u16, bool, bool), action: u8, bs: usize, chars: &[u32]) {
+    if action == Action::None as u8 {
+        match key.0 {
+            keys::DELETE => drop(screen.pop()),
+            keys::SPACE => screen.push(' ' as u32),
+            _ => {
+                let c = goxviet_core::input::layout::key_char(key.0, key.1, key.2).unwrap();
+                screen.push(c as u32);
+            }
+        }
+        return;
+    }
+    screen.truncate(screen.len().saturating_sub(bs));
+    screen.extend_from_slice(chars);
+}
+
+fn type_keys(e: &mut Engine, screen: &mut Vec<u32>, text: &str) {
+    for key in key_events(text) {
+        let r = e.on_key_ext(key.0, key.1, false, key.2);
+        apply(screen, key, r.action, r.backspace as usize, r.as_slice());
+        r.release();
+    }
+}
+
+/// Apply the edit from `burst_end`, reading chunks if it was not inlined
+fn end_burst(e: &mut Engine, screen: &mut Vec<u32>, inline_limit: usize) {
+    let r = e.burst_end(inline_limit);
+    let mut chars = r.as_slice().to_vec();
+    let mut chunk = [0u32; 16];
+    loop {
+        let n = e.read_expansion(&mut chunk);
+        if n == 0 {
+            break;
+        }
+        chars.extend_from_slice(&chunk[..n]);
+    }
+    assert_eq!(chars.len(), r.count as usize + r.remaining as usize);
+    if r.action != Action::None as u8 {
+        screen.truncate(screen.len() - r.backspace as usize);
+        screen.extend_from_slice(&chars);
+    }
+    r.release();
+}
+
+fn text(screen: &[u32]) -> String {
+    screen.iter().map(|&c| char::from_u32(c).unwrap()).collect()
+}
+
+/// Type `before` key by key, then `burst` as an explicit burst; compare
+/// with typing everything key by key
+fn check(before: &str, burst: &str, inline_limit: usize) {
+    let mut expected = Vec::new();
+    let mut e = Engine::new();
+    e.shortcuts_mut().add(Shortcut::new("vn", "Việt Nam"));
+    type_keys(&mut e, &mut expected, before);
+    type_keys(&mut e, &mut expected, burst);
+
+    let mut screen = Vec::new();
+    let mut e = Engine::new();
+    e.shortcuts_mut().add(Shortcut::new("vn", "Việt Nam"));
+    type_keys(&mut e, &mut screen, before);
+    assert!(e.burst_begin());
+    for key in key_events(burst) {
+        assert_eq!(e.burst_key(key.0, key.1, false, key.2, 0), BurstKey::Queued);
+    }
+    end_burst(&mut e, &mut screen, inline_limit);
+    assert!(!e.burst_active());
+    assert_eq!(text(&screen), text(&expected), "{before:?} + {burst:?}");
+
+    // The engine continues where per-key typing would be
+    type_keys(&mut e, &mut screen, "ddaay ");
+    type_keys(&mut e, &mut expected, "ddaay ");
+    assert_eq!(text(&screen), text(&expected));
+}
+
+#[test]
+fn test_coalesced_edit_matches_per_key() {
+    check(
+        "",
+        "tieengs vieejt laf ngoon nguwx cuar nguwowif vieejt nam ",
+        255,
+    );
+    check(
+        "xin chaof ",
+        "the restore process should keep english words ",
+        255,
+    );
+    // Starts mid-word: the edit reaches into text typed before the burst
+    check("vie", "ejt nam ", 255);
+    check("hoaf", "s ", 255);
+    // Backspaces, including past the start of the burst
+    check("ab tieng", "\x08\x08\x08\x08\x08\x08\x08bcs ", 255);
+    check("ab ", "cc\x08ddaf\x08f.", 255);
+    // Shortcuts, punctuation and shifted symbols
+    check("", "vn, ok! @home: 100% ", 255);
+}
+
+#[test]
+fn test_long_burst_is_read_in_chunks() {
+    // More keys than the queue holds and more chars than one `Result`
+    let burst = "tieengs vieejt ".repeat(40);
+    check("", &burst, 255);
+    check("ddaay ", &burst, 0);
+}
+
+#[test]
+fn test_detected_burst() {
+    let mut e = Engine::new();
+    e.set_burst_detection(5_000_000, 4);
+    let mut screen = Vec::new();
+    let mut expected = Vec::new();
+    type_keys(&mut Engine::new(), &mut expected, "tieengs vieejt ");
+
+    let mut t = 1_000_000_000u64;
+    let mut statuses = Vec::new();
+    for key in key_events("tieengs vieejt ") {
+        t += 1_000_000; // 1 ms apart
+        let status = e.burst_key(key.0, key.1, false, key.2, t);
+        statuses.push(status);
+        if status == BurstKey::Pass {
+            let r = e.on_key_ext(key.0, key.1, false, key.2);
+            apply(
+                &mut screen,
+                key,
+                r.action,
+                r.backspace as usize,
+                r.as_slice(),
+            );
+            r.release();
+        }
+    }
+    // The fourth fast key starts the burst
+    assert_eq!(statuses[..3], [BurstKey::Pass; 3]);
+    assert!(statuses[3..].iter().all(|&s| s == BurstKey::Queued));
+
+    // A slow key ends it; the host flushes, then handles the key
+    let key = key_events("a")[0];
+    assert_eq!(
+        e.burst_key(key.0, key.1, false, key.2, t + 200_000_000),
+        BurstKey::Flush
+    );
+    end_burst(&mut e, &mut screen, 255);
+    assert_eq!(text(&screen), text(&expected));
+    assert_eq!(
+        e.burst_key(key.0, key.1, false, key.2, t + 300_000_000),
+        BurstKey::Pass
+    );
+}
+
+#[test]
+fn test_keys_that_end_a_burst() {
+    let mut e = Engine::new();
+    assert!(e.burst_begin());
+    assert_eq!(
+        e.burst_key(keys::A, false, false, false, 0),
+        BurstKey::Queued
+    );
+    // Ctrl shortcuts, return and arrows need the edit injected first
+    assert_eq!(e.burst_key(keys::C, false, true, false, 0), BurstKey::Flush);
+    assert_eq!(
+        e.burst_key(keys::RETURN, false, false, false, 0),
+        BurstKey::Flush
+    );
+    assert_eq!(
+        e.burst_key(keys::LEFT, false, false, false, 0),
+        BurstKey::Flush
+    );
+    let r = e.burst_end(255);
+    assert_eq!(r.as_slice(), ['a' as u32]);
+    r.release();
+
+    // Nothing to end
+    let r = e.burst_end(255);
+    assert_eq!(r.action, Action::None as u8);
+    r.release();
+    assert_eq!(e.burst_key(keys::A, false, false, false, 0), BurstKey::Pass);
+}
+
+#[test]
+fn test_no_bursts_in_composition_mode() {
+    let mut e = Engine::new();
+    e.set_composition_mode(true);
+    assert!(!e.burst_begin());
+    e.set_burst_detection(5_000_000, 2);
+    for t in 1..10u64 {
+        assert_eq!(e.burst_key(keys::A, false, false, false, t), BurstKey::Pass);
+    }
+}
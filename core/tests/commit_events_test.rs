@@ -0,0 +1,73 @@
+//! Committed-word events: each commit publishes one record with the word,
+//! how it was committed and the key that ended it.
+
+use goxviet_core::data::keys;
+use goxviet_core::engine::features::{CommitKind, CommitRecord, CommitRing, Shortcut};
+use goxviet_core::engine::Engine;
+use goxviet_core::utils::type_word;
+use goxviet_core::*;
+use serial_test::serial;
+
+fn drain(ring: &CommitRing) -> Vec<(String, CommitKind, u16)> {
+    let mut out = [CommitRecord::EMPTY; 16];
+    let n = ring.drain(&mut out);
+    out[..n]
+        .iter()
+        .map(|r| (r.text().to_string(), r.kind().unwrap(), r.key))
+        .collect()
+}
+
+#[test]
+fn test_commit_records() {
+    let ring: &'static CommitRing = Box::leak(Box::new(CommitRing::new()));
+    let mut e = Engine::new();
+    e.set_commit_ring(Some(ring));
+    e.shortcuts_mut().add(Shortcut::new("vn", "Việt Nam"));
+
+    type_word(&mut e, "vieetj nam, ");
+    let mut expected = vec![
+        ("việt".to_string(), CommitKind::Vietnamese, keys::SPACE),
+        ("nam".to_string(), CommitKind::Vietnamese, keys::COMMA),
+    ];
+    if cfg!(feature = "shortcuts") {
+        type_word(&mut e, "vn ");
+        expected.push(("vn".to_string(), CommitKind::Shortcut, keys::SPACE));
+    }
+    if cfg!(feature = "english-detection") {
+        type_word(&mut e, "console ");
+        expected.push(("console".to_string(), CommitKind::English, keys::SPACE));
+    }
+    assert_eq!(drain(ring), expected);
+
+    // Spaces and breaks without a word publish nothing
+    type_word(&mut e, "  . ");
+    assert!(drain(ring).is_empty());
+
+    e.set_commit_ring(None);
+    type_word(&mut e, "hoaf ");
+    assert!(ring.is_empty());
+}
+
+#[test]
+#[serial]
+fn test_ffi_commit_events() {
+    ime_init();
+    ime_commit_events(true);
+    let mut out = [CommitRecord::EMPTY; 4];
+    // Leftovers from other tests
+    while unsafe { ime_drain_commits(out.as_mut_ptr(), out.len()) } > 0 {}
+
+    for c in "xin chaof ".chars() {
+        let r = ime_key(utils::char_to_key(c), false, false);
+        unsafe { ime_free(r) };
+    }
+    let n = unsafe { ime_drain_commits(out.as_mut_ptr(), out.len()) };
+    assert_eq!(n, 2);
+    assert_eq!((out[0].text(), out[1].text()), ("xin", "chào"));
+    assert_eq!(out[1].seq, out[0].seq.wrapping_add(1));
+    assert_eq!(unsafe { ime_drain_commits(std::ptr::null_mut(), 4) }, -1);
+    assert_eq!(ime_commits_dropped(), 0);
+
+    ime_commit_events(false);
+    ime_shutdown();
+}
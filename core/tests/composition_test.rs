@@ -0,0 +1,212 @@
+//! Composition (preedit) mode tests
+//!
+//! The word in progress is reported as marked text and only committed at
+//! word boundaries: space, punctuation, shortcuts, and `commit_preedit()`.
+
+use goxviet_core::data::keys;
+use goxviet_core::engine::shortcut::Shortcut;
+use goxviet_core::engine::{Action, Engine, Result};
+
+fn key_for(c: char) -> (u16, bool) {
+    match c {
+        ' ' => (keys::SPACE, false),
+        ',' => (keys::COMMA, false),
+        '<' => (keys::DELETE, false),
+        'a' => (keys::A, false),
+        'c' => (keys::C, false),
+        'e' => (keys::E, false),
+        'f' => (keys::F, false),
+        'h' => (keys::H, false),
+        'i' => (keys::I, false),
+        'j' => (keys::J, false),
+        'n' => (keys::N, false),
+        'o' => (keys::O, false),
+        's' => (keys::S, false),
+        't' => (keys::T, false),
+        'v' => (keys::V, false),
+        _ => panic!("unmapped char {c:?}"),
+    }
+}
+
+fn press(e: &mut Engine, c: char) -> Result {
+    let (key, shift) = key_for(c);
+    e.on_key_ext(key, false, false, shift)
+}
+
+fn output(r: &Result) -> String {
+    (0..r.count as usize)
+        .filter_map(|i| unsafe { char::from_u32(*r.chars.add(i)) })
+        .collect()
+}
+
+fn engine() -> Engine {
+    let mut e = Engine::new();
+    e.set_method(0);
+    e.set_composition_mode(true);
+    e
+}
+
+#[test]
+fn test_typing_updates_preedit_only() {
+    let mut e = engine();
+    let mut shown = String::new();
+    for c in "vieetj".chars() {
+        let r = press(&mut e, c);
+        assert_eq!(r.action, Action::Preedit as u8, "key {c:?}");
+        assert_eq!(r.backspace, 0);
+        shown = output(&r);
+    }
+    assert_eq!(shown, "việt");
+    let marked: String = e.preedit().as_slice().iter().collect();
+    assert_eq!(marked, "việt");
+    assert_eq!(e.preedit().caret(), 4);
+}
+
+#[test]
+fn test_space_commits_and_passes_through() {
+    let mut e = engine();
+    for c in "vieetj".chars() {
+        press(&mut e, c);
+    }
+    let r = press(&mut e, ' ');
+    assert_eq!(r.action, Action::CommitPassThrough as u8);
+    assert_eq!(r.backspace, 0);
+    assert_eq!(output(&r), "việt");
+    assert!(e.preedit().is_empty());
+
+    // Next word starts a fresh preedit
+    let r = press(&mut e, 'a');
+    assert_eq!(r.action, Action::Preedit as u8);
+    assert_eq!(output(&r), "a");
+}
+
+#[test]
+fn test_punctuation_commits() {
+    let mut e = engine();
+    for c in "chaof".chars() {
+        press(&mut e, c);
+    }
+    let r = press(&mut e, ',');
+    assert!(
+        r.action == Action::Commit as u8 || r.action == Action::CommitPassThrough as u8,
+        "action {}",
+        r.action
+    );
+    assert!(output(&r).starts_with("chào"), "got {:?}", output(&r));
+    assert!(e.preedit().is_empty());
+}
+
+#[test]
+fn test_delete_edits_preedit() {
+    let mut e = engine();
+    for c in "vieet".chars() {
+        press(&mut e, c);
+    }
+    let r = press(&mut e, '<');
+    assert_eq!(r.action, Action::Preedit as u8);
+    assert_eq!(output(&r), "viê");
+
+    for _ in 0..2 {
+        press(&mut e, '<');
+    }
+    let r = press(&mut e, '<');
+    assert_eq!(r.action, Action::Preedit as u8);
+    assert_eq!(r.count, 0, "Last character removes the marked text");
+    assert!(e.preedit().is_empty());
+
+    // With no marked text, backspace goes to the document
+    let r = press(&mut e, '<');
+    assert_ne!(r.action, Action::Preedit as u8);
+}
+
+#[test]
+fn test_shortcut_commits_expansion() {
+    let mut e = engine();
+    e.shortcuts_mut().add(Shortcut::new("vn", "Việt Nam"));
+    for c in "vn".chars() {
+        press(&mut e, c);
+    }
+    let r = press(&mut e, ' ');
+    assert_eq!(r.action, Action::Commit as u8);
+    assert_eq!(r.backspace, 0, "Trigger was only marked text");
+    assert!(output(&r).starts_with("Việt Nam"), "got {:?}", output(&r));
+}
+
+#[test]
+fn test_commit_preedit() {
+    let mut e = engine();
+    for c in "in".chars() {
+        press(&mut e, c);
+    }
+    let r = e.commit_preedit();
+    assert_eq!(r.action, Action::Commit as u8);
+    assert_eq!(output(&r), "in");
+    assert!(e.preedit().is_empty());
+
+    let r = e.commit_preedit();
+    assert_eq!(r.action, Action::None as u8);
+}
+
+#[test]
+fn test_restored_word_moves_into_preedit() {
+    let mut e = engine();
+    for c in "vieet ".chars() {
+        press(&mut e, c);
+    }
+    // Backspace after space edits the document and restores the word state
+    let r = press(&mut e, '<');
+    assert_ne!(r.action, Action::Preedit as u8);
+
+    // Continuing the word pulls it back from the document into marked text
+    let r = press(&mut e, 'j');
+    assert_eq!(r.action, Action::Preedit as u8);
+    assert_eq!(r.backspace, 4, "Removes 'viêt' from the document");
+    assert_eq!(output(&r), "việt");
+}
+
+#[test]
+fn test_off_by_default() {
+    let mut e = Engine::new();
+    e.set_method(0);
+    assert!(!e.composition_mode());
+    for c in "vie".chars() {
+        press(&mut e, c);
+    }
+    let r = press(&mut e, 'e');
+    assert_eq!(r.action, Action::Send as u8);
+    assert!(e.preedit().is_empty());
+}
+
+#[test]
+fn test_toggle_discards_preedit() {
+    let mut e = engine();
+    for c in "an".chars() {
+        press(&mut e, c);
+    }
+    assert!(!e.preedit().is_empty());
+    e.set_composition_mode(false);
+    assert!(e.preedit().is_empty());
+    e.set_composition_mode(true);
+    e.clear_all();
+    assert!(e.preedit().is_empty());
+}
+
+#[test]
+fn test_restored_word_backspace_counts_displayed_chars() {
+    let mut e = engine();
+    // A restored word longer than a u8 count: the backspace count
+    // saturates instead of wrapping to 0
+    let long = "a".repeat(300);
+    e.restore_word(&long);
+    let shown = e.get_buffer().chars().count();
+    let r = press(&mut e, 'n');
+    assert_eq!(r.action, Action::Preedit as u8);
+    assert_eq!(r.backspace as usize, shown.min(255));
+    assert_ne!(r.backspace, 0);
+
+    e.clear_all();
+    e.restore_word("Nguyễn");
+    let r = press(&mut e, 'h');
+    assert_eq!(r.action, Action::Preedit as u8);
+    assert_eq!(r.backspace, 6, "Removes 'Nguyễn' from the document");
+}
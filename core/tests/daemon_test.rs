@@ -0,0 +1,224 @@
+//! Daemon mode: typing through the socket matches the in-process engine,
+//! contexts and connections are isolated, bad frames get error replies.
+#![cfg(unix)]
+
+use goxviet_core::daemon::protocol::{self, KeyEvent};
+use goxviet_core::daemon::{Client, ConfigOption, Daemon, StopHandle};
+use goxviet_core::engine::{Action, Engine};
+use goxviet_core::utils::{char_to_key, type_word};
+use std::path::PathBuf;
+use std::sync::atomic::{AtomicUsize, Ordering};
+use std::thread::JoinHandle;
+
+/// A daemon serving a fresh socket; stopped, and its socket removed,
+/// when dropped at the end of the test (also when the test fails)
+struct TestDaemon {
+    path: PathBuf,
+    stop: StopHandle,
+    thread: Option<JoinHandle<std::io::Result<()>>>,
+}
+
+impl Drop for TestDaemon {
+    fn drop(&mut self) {
+        self.stop.stop();
+        if let Some(thread) = self.thread.take() {
+            let _ = thread.join();
+        }
+    }
+}
+
+fn start_daemon() -> TestDaemon {
+    static NEXT: AtomicUsize = AtomicUsize::new(0);
+    let path = std::env::temp_dir().join(format!(
+        "goxviet-test-{}-{}.sock",
+        std::process::id(),
+        NEXT.fetch_add(1, Ordering::Relaxed)
+    ));
+    let daemon = Daemon::bind(&path).expect("bind test socket");
+    let stop = daemon.stop_handle();
+    let thread = std::thread::spawn(move || daemon.serve());
+    TestDaemon {
+        path,
+        stop,
+        thread: Some(thread),
+    }
+}
+
+fn events(text: &str) -> Vec<KeyEvent> {
+    text.chars()
+        .map(|c| KeyEvent::new(char_to_key(c), c.is_ascii_uppercase()))
+        .collect()
+}
+
+/// Type `text` in one batch and apply the replies to `screen`, like
+/// `type_word` does locally
+fn type_remote_onto(client: &mut Client, context: u16, screen: &mut String, text: &str) {
+    let replies = client
+        .keys(context, &events(text))
+        .expect("keys round trip");
+    assert_eq!(replies.len(), text.chars().count());
+    for (c, r) in text.chars().zip(replies) {
+        if r.action == Action::Send as u8 {
+            for _ in 0..r.backspace {
+                screen.pop();
+            }
+            screen.push_str(r.text);
+        } else {
+            // Pass through if not handled (mimic editor receiving char)
+            screen.push(c);
+        }
+    }
+}
+
+fn type_remote(client: &mut Client, context: u16, text: &str) -> String {
+    let mut screen = String::new();
+    type_remote_onto(client, context, &mut screen, text);
+    screen
+}
+
+#[test]
+fn test_typing_matches_local_engine() {
+    let daemon = start_daemon();
+    let mut client = Client::connect(&daemon.path).unwrap();
+    for text in ["vieetj ", "tieengs Vieetj ", "console "] {
+        let mut local = Engine::new();
+        assert_eq!(
+            type_remote(&mut client, 0, text),
+            type_word(&mut local, text)
+        );
+    }
+}
+
+#[test]
+fn test_contexts_are_isolated() {
+    let daemon = start_daemon();
+    let mut client = Client::connect(&daemon.path).unwrap();
+    client.configure(1, ConfigOption::Method, 1).unwrap();
+    // Context 0 is still Telex, context 1 is VNI
+    assert_eq!(type_remote(&mut client, 0, "vieetj "), "việt ");
+    assert_eq!(type_remote(&mut client, 1, "vie65t "), "việt ");
+    // Half-typed words don't leak across contexts
+    let mut screen = type_remote(&mut client, 0, "vie");
+    assert_eq!(type_remote(&mut client, 2, "ej"), "ẹ");
+    type_remote_onto(&mut client, 0, &mut screen, "etj ");
+    assert_eq!(screen, "việt ");
+    client.close_context(1).unwrap();
+    // A reopened id starts from defaults (Telex)
+    assert_eq!(type_remote(&mut client, 1, "vieetj "), "việt ");
+}
+
+#[test]
+fn test_concurrent_clients() {
+    let daemon = start_daemon();
+    let handles: Vec<_> = (0..8)
+        .map(|i| {
+            let path = daemon.path.clone();
+            std::thread::spawn(move || {
+                let mut client = Client::connect(&path).unwrap();
+                // Same context id on every connection: still separate engines
+                if i % 2 == 1 {
+                    client.configure(0, ConfigOption::Method, 1).unwrap();
+                }
+                let text = if i % 2 == 1 { "vie65t " } else { "vieetj " };
+                for _ in 0..50 {
+                    assert_eq!(type_remote(&mut client, 0, text), "việt ");
+                }
+            })
+        })
+        .collect();
+    for h in handles {
+        h.join().unwrap();
+    }
+}
+
+#[test]
+fn test_config_clear_features_ping() {
+    let daemon = start_daemon();
+    let mut client = Client::connect(&daemon.path).unwrap();
+    client.ping().unwrap();
+    assert_eq!(
+        client.features().unwrap(),
+        goxviet_core::compiled_features()
+    );
+
+    client.configure(0, ConfigOption::OutputForm, 1).unwrap();
+    let replies = client.keys(0, &events("ees")).unwrap();
+    // Backspace counts are in characters; the text is decomposed
+    let last = replies.last().unwrap();
+    assert_eq!((last.backspace, last.text), (1, "e\u{302}\u{301}"));
+    client.clear(0, true).unwrap();
+
+    client.configure(0, ConfigOption::Enabled, 0).unwrap();
+    assert_eq!(type_remote(&mut client, 0, "vieetj "), "vieetj ");
+
+    assert!(client.configure(0, ConfigOption::Method, 9).is_err());
+    assert!(client.configure(0, ConfigOption::OutputForm, 9).is_err());
+    // Connection still usable after a rejected request
+    client.ping().unwrap();
+}
+
+#[test]
+fn test_malformed_frames_get_error_reply() {
+    let daemon = start_daemon();
+    let mut client = Client::connect(&daemon.path).unwrap();
+    for payload in [&[][..], &[42, 0, 0], &[protocol::OP_KEYS, 0, 0, 5, 0]] {
+        let reply = client.raw(payload).unwrap();
+        assert_eq!(reply, [protocol::OP_ERROR, protocol::ERR_MALFORMED]);
+    }
+    client.ping().unwrap();
+}
+
+#[test]
+fn test_context_limit() {
+    let daemon = start_daemon();
+    let mut client = Client::connect(&daemon.path).unwrap();
+    let max = goxviet_core::daemon::server::MAX_CONTEXTS as u16;
+    for ctx in 0..max {
+        client.clear(ctx, false).unwrap();
+    }
+    assert!(client.clear(max, false).is_err());
+    client.close_context(0).unwrap();
+    client.clear(max, false).unwrap();
+}
+
+#[test]
+fn test_stale_socket_replaced_live_one_refused() {
+    let daemon = start_daemon();
+    Client::connect(&daemon.path).unwrap().ping().unwrap();
+    let err = Daemon::bind(&daemon.path)
+        .err()
+        .expect("live socket must be refused");
+    assert_eq!(err.kind(), std::io::ErrorKind::AddrInUse);
+
+    let stale = std::env::temp_dir().join(format!("goxviet-stale-{}.sock", std::process::id()));
+    drop(std::os::unix::net::UnixListener::bind(&stale).unwrap());
+    let daemon = Daemon::bind(&stale).expect("stale socket replaced");
+    drop(daemon);
+    assert!(!stale.exists());
+}
+
+#[test]
+fn test_bind_keeps_other_files() {
+    let path = std::env::temp_dir().join(format!("goxviet-notsock-{}", std::process::id()));
+    std::fs::write(&path, "not a socket").unwrap();
+    let err = Daemon::bind(&path)
+        .err()
+        .expect("regular file must be refused");
+    assert_eq!(err.kind(), std::io::ErrorKind::AlreadyExists);
+    assert_eq!(std::fs::read_to_string(&path).unwrap(), "not a socket");
+    std::fs::remove_file(&path).unwrap();
+}
+
+#[test]
+fn test_stop_removes_socket() {
+    let daemon = start_daemon();
+    let path = daemon.path.clone();
+    let mut client = Client::connect(&path).unwrap();
+    client.ping().unwrap();
+
+    drop(daemon);
+    assert!(!path.exists());
+    // The open connection is still served; new ones are refused
+    client.ping().unwrap();
+    assert!(Client::connect(&path).is_err());
+}
@@ -0,0 +1,209 @@
+//! Edit planner: whatever plan the injection costs pick (backspaces, range
+//! replacement, deferred commit), the screen must end up with the same
+//! text as the engine's own edits.
+
+use goxviet_core::data::keys;
+use goxviet_core::engine::edit_plan::{typed_char, COST_UNSUPPORTED};
+use goxviet_core::engine::shortcut::Shortcut;
+use goxviet_core::engine::{Action, EditCosts, Engine, Result};
+use goxviet_core::input::layout::translate_char;
+
+/// Key events of `text` (`\x08` = backspace)
+fn key_events(text: &str) -> Vec<(u16, bool, bool)> {
+    text.chars()
+        .map(|c| {
+            let k = translate_char(c).unwrap();
+            (k.key, k.caps, k.shift)
+        })
+        .collect()
+}
+
+/// Apply one result to `screen` (caret at the end); returns its cost
+fn apply(screen: &mut Vec<char>, key: (u16, bool, bool), r: &Result, costs: &EditCosts) -> u64 {
+    let chars = r.as_slice().iter().map(|&c| char::from_u32(c).unwrap());
+    let bs = r.backspace as usize;
+    let cost = costs.edit_cost(r.action, bs, r.count as usize);
+    match r.action {
+        a if a == Action::None as u8 => pass_through(screen, key),
+        a if a == Action::ReplaceRange as u8 => {
+            let end = screen.len() - r.keep as usize;
+            screen.splice(end - bs..end, chars);
+        }
+        a => {
+            screen.truncate(screen.len() - bs);
+            screen.extend(chars);
+            if a == Action::CommitPassThrough as u8 {
+                pass_through(screen, key);
+            }
+        }
+    }
+    cost
+}
+
+fn pass_through(screen: &mut Vec<char>, key: (u16, bool, bool)) {
+    if key.0 == keys::DELETE {
+        screen.pop();
+    } else if let Some(c) = typed_char(key.0, key.1, false, key.2) {
+        screen.push(c);
+    }
+}
+
+fn new_engine(costs: Option<EditCosts>) -> Engine {
+    let mut e = Engine::new();
+    e.shortcuts_mut().add(Shortcut::new("vn", "Việt Nam"));
+    if let Some(costs) = costs {
+        e.set_edit_costs(costs);
+    }
+    e
+}
+
+/// Type `text`; returns (screen, total cost under `costs`, actions seen)
+fn type_text(e: &mut Engine, text: &str, costs: &EditCosts) -> (String, u64, Vec<u8>) {
+    let mut screen = Vec::new();
+    let mut total = 0;
+    let mut actions = Vec::new();
+    for key in key_events(text) {
+        let r = e.on_key_ext(key.0, key.1, false, key.2);
+        total += apply(&mut screen, key, &r, costs);
+        actions.push(r.action);
+        r.release();
+    }
+    (screen.into_iter().collect(), total, actions)
+}
+
+const SESSION: &str = "tieengs vieejt laf ngoon nguwx cuar nguwowif vieejt nam. \
+                       chungs toi ddang hocj tieengs anh vaf tieengs phaps, \
+                       the restore process should keep english words intact \
+                       vn oke! hoaf\x08\x08af nguoiwf\x08\x08\x08 @home 100% ";
+
+/// Synthetic backspaces + typing
+const KEYSTROKES: EditCosts = EditCosts {
+    per_edit: 20,
+    per_backspace: 10,
+    per_char: 10,
+    per_replace: COST_UNSUPPORTED,
+    per_deferred_key: COST_UNSUPPORTED,
+};
+
+/// Shift+Left selection: backspaces are dear, replacing a range is not
+const SELECTION: EditCosts = EditCosts {
+    per_edit: 20,
+    per_backspace: 30,
+    per_char: 10,
+    per_replace: 25,
+    per_deferred_key: COST_UNSUPPORTED,
+};
+
+/// Accessibility API: every edit is a slow round trip
+const ACCESSIBILITY: EditCosts = EditCosts {
+    per_edit: 2000,
+    per_backspace: 1,
+    per_char: 1,
+    per_replace: 0,
+    per_deferred_key: 50,
+};
+
+#[test]
+fn test_planned_edits_leave_the_same_text() {
+    let expected = type_text(&mut new_engine(None), SESSION, &KEYSTROKES).0;
+    for costs in [EditCosts::BACKSPACE, KEYSTROKES, SELECTION, ACCESSIBILITY] {
+        let (screen, _, _) = type_text(&mut new_engine(Some(costs)), SESSION, &costs);
+        assert_eq!(screen, expected, "{costs:?}");
+    }
+}
+
+#[test]
+fn test_plans_cost_no_more_than_plain_edits() {
+    for costs in [KEYSTROKES, SELECTION, ACCESSIBILITY] {
+        let plain = type_text(&mut new_engine(None), SESSION, &costs).1;
+        let planned = type_text(&mut new_engine(Some(costs)), SESSION, &costs).1;
+        assert!(planned <= plain, "{costs:?}: {planned} > {plain}");
+    }
+}
+
+#[test]
+fn test_each_plan_is_used() {
+    let replace = type_text(&mut new_engine(Some(SELECTION)), SESSION, &SELECTION).2;
+    assert!(replace.contains(&(Action::ReplaceRange as u8)));
+
+    let mut e = new_engine(Some(ACCESSIBILITY));
+    let (screen, _, actions) = type_text(&mut e, "tieengs", &ACCESSIBILITY);
+    // Deferred: the word is shown as typed until its boundary
+    assert_eq!(screen, "tieengs");
+    assert!(actions.iter().all(|&a| a == Action::None as u8));
+    assert!(e.edit_deferred());
+
+    // Keys that type nothing get the fix-up first, then pass through
+    let r = e.on_key_ext(keys::LEFT, false, false, false);
+    assert_eq!(r.action, Action::CommitPassThrough as u8);
+    let mut shown: Vec<char> = screen.chars().collect();
+    apply(&mut shown, (keys::LEFT, false, false), &r, &ACCESSIBILITY);
+    assert_eq!(shown.iter().collect::<String>(), "tiếng");
+    r.release();
+    assert!(!e.edit_deferred());
+}
+
+#[test]
+fn test_settle_edit() {
+    let mut e = new_engine(Some(ACCESSIBILITY));
+    let (screen, _, _) = type_text(&mut e, "ddaay", &ACCESSIBILITY);
+    assert_eq!(screen, "ddaay");
+    let r = e.settle_edit();
+    let mut shown: Vec<char> = screen.chars().collect();
+    apply(&mut shown, (0, false, false), &r, &ACCESSIBILITY);
+    assert_eq!(shown.iter().collect::<String>(), "đây");
+    r.release();
+    assert!(!e.edit_deferred());
+    assert_eq!(e.get_buffer(), "");
+
+    // Nothing deferred: nothing to settle
+    let r = e.settle_edit();
+    assert_eq!(r.action, Action::None as u8);
+}
+
+#[test]
+fn test_flat_paths_never_replace_ranges() {
+    let mut e = new_engine(Some(SELECTION));
+    for key in key_events(SESSION) {
+        let r = e.on_key_flat(key.0, key.1, false, key.2);
+        assert_ne!(r.action, Action::ReplaceRange as u8);
+        r.release();
+        let r = e.on_key_wide(key.0, key.1, false, key.2, 255);
+        assert_ne!(r.action, Action::ReplaceRange as u8);
+        r.release();
+    }
+}
+
+#[test]
+fn test_wide_path_with_deferral() {
+    let mut plain = new_engine(None);
+    let expected = type_text(&mut plain, SESSION, &KEYSTROKES).0;
+
+    let mut e = new_engine(Some(ACCESSIBILITY));
+    let mut screen = Vec::new();
+    for key in key_events(SESSION) {
+        let r = e.on_key_wide(key.0, key.1, false, key.2, 255);
+        let chars = r.as_slice().iter().map(|&c| char::from_u32(c).unwrap());
+        if r.action == Action::None as u8 {
+            pass_through(&mut screen, key);
+        } else {
+            screen.truncate(screen.len() - r.backspace as usize);
+            screen.extend(chars);
+            if r.action == Action::CommitPassThrough as u8 {
+                pass_through(&mut screen, key);
+            }
+        }
+        r.release();
+    }
+    assert_eq!(screen.into_iter().collect::<String>(), expected);
+}
+
+#[test]
+fn test_clearing_costs() {
+    let mut e = new_engine(Some(SELECTION));
+    assert_eq!(e.edit_costs(), Some(SELECTION));
+    e.clear_edit_costs();
+    assert_eq!(e.edit_costs(), None);
+    let plain = type_text(&mut new_engine(None), SESSION, &KEYSTROKES);
+    assert_eq!(type_text(&mut e, SESSION, &KEYSTROKES), plain);
+}
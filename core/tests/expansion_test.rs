@@ -0,0 +1,115 @@
+//! Wide result and long expansion tests
+//!
+//! `on_key_wide` must match `on_key_ext` for ordinary keys and deliver
+//! snippet expansions longer than 255 characters whole or in chunks.
+
+use goxviet_core::data::keys;
+use goxviet_core::engine::shortcut::Shortcut;
+use goxviet_core::engine::{Action, Engine};
+
+const KEYS: [(char, u16); 9] = [
+    ('a', keys::A),
+    ('e', keys::E),
+    ('g', keys::G),
+    ('i', keys::I),
+    ('j', keys::J),
+    ('n', keys::N),
+    ('t', keys::T),
+    ('v', keys::V),
+    (' ', keys::SPACE),
+];
+
+fn key(c: char) -> u16 {
+    KEYS.iter().find(|(k, _)| *k == c).expect("mapped key").1
+}
+
+fn engine_with_snippet(text: &str) -> Engine {
+    let mut e = Engine::new();
+    e.set_method(0);
+    e.shortcuts_mut().add(Shortcut::snippet("tt", text));
+    e
+}
+
+fn chars_to_string(chars: &[u32]) -> String {
+    chars.iter().filter_map(|&c| char::from_u32(c)).collect()
+}
+
+#[test]
+fn test_wide_matches_regular_for_typing() {
+    let mut a = Engine::new();
+    let mut b = Engine::new();
+    a.set_method(0);
+    b.set_method(0);
+    for c in "vieetj tieng ".chars() {
+        let r = a.on_key_ext(key(c), false, false, false);
+        let w = b.on_key_wide(key(c), false, false, false, usize::MAX);
+        assert_eq!(w.action, r.action, "key {c:?}");
+        assert_eq!(w.backspace, r.backspace as u32);
+        assert_eq!(w.as_slice(), r.as_slice());
+        assert_eq!(w.remaining, 0);
+        r.release();
+        w.release();
+    }
+}
+
+#[test]
+fn test_long_snippet_inline() {
+    let text = "Việt Nam ".repeat(200);
+    let mut e = engine_with_snippet(&text);
+    for c in "tt".chars() {
+        e.on_key_wide(key(c), false, false, false, usize::MAX)
+            .release();
+    }
+    let w = e.on_key_wide(keys::SPACE, false, false, false, usize::MAX);
+    assert_eq!(w.action, Action::Send as u8);
+    assert_eq!(w.backspace, 2);
+    assert_eq!(chars_to_string(w.as_slice()), format!("{text} "));
+    // Collected into one exactly sized buffer, never grown
+    assert_eq!(w.capacity, w.count as usize);
+    w.release();
+}
+
+#[test]
+fn test_long_snippet_chunked() {
+    let text = "ậ".repeat(5000);
+    let mut e = engine_with_snippet(&text);
+    for c in "tt".chars() {
+        e.on_key_wide(key(c), false, false, false, 0).release();
+    }
+    let w = e.on_key_wide(keys::SPACE, false, false, false, 1024);
+    assert_eq!((w.backspace, w.count, w.remaining), (2, 0, 5001));
+    w.release();
+
+    let mut out = [0u32; 512];
+    let mut total = 0;
+    loop {
+        let n = e.read_expansion(&mut out);
+        if n == 0 {
+            break;
+        }
+        total += n;
+    }
+    assert_eq!(total, 5001);
+}
+
+#[test]
+fn test_unread_expansion_dropped_on_next_key() {
+    let mut e = engine_with_snippet(&"x".repeat(1000));
+    for c in "tt ".chars() {
+        e.on_key_wide(key(c), false, false, false, 0).release();
+    }
+    e.on_key_ext(keys::A, false, false, false).release();
+    assert_eq!(e.read_expansion(&mut [0u32; 16]), 0);
+}
+
+#[test]
+fn test_regular_path_truncates() {
+    let mut e = engine_with_snippet(&"x".repeat(1000));
+    for c in "tt".chars() {
+        e.on_key_ext(key(c), false, false, false).release();
+    }
+    let r = e.on_key_ext(keys::SPACE, false, false, false);
+    assert_eq!(r.count, 255);
+    r.release();
+    assert_eq!(e.read_expansion(&mut [0u32; 16]), 0);
+}
@@ -0,0 +1,90 @@
+//! Cargo feature gates: reported features match the build, and each
+//! subsystem is either fully working or cleanly absent.
+//!
+//! Run against the minimal build too:
+//! `cargo test --no-default-features --test feature_gates_test`
+
+use goxviet_core::engine::Engine;
+use goxviet_core::utils::type_word;
+use goxviet_core::*;
+use serial_test::serial;
+use std::ffi::CString;
+
+#[test]
+fn test_reported_features_match_build() {
+    let bits = ime_features();
+    assert_eq!(bits, compiled_features());
+    for (bit, enabled) in [
+        (
+            FEATURE_ENGLISH_DETECTION,
+            cfg!(feature = "english-detection"),
+        ),
+        (FEATURE_DICTIONARIES, cfg!(feature = "dictionaries")),
+        (FEATURE_SHORTCUTS, cfg!(feature = "shortcuts")),
+        (FEATURE_ENCODING, cfg!(feature = "encoding")),
+        (FEATURE_UPDATER, cfg!(feature = "updater")),
+    ] {
+        assert_eq!(bits & bit != 0, enabled, "feature bit {bit}");
+    }
+}
+
+#[test]
+fn test_telex_always_available() {
+    let mut e = Engine::new();
+    assert_eq!(type_word(&mut e, "tieengs vieetj "), "tiếng việt ");
+    let mut e = Engine::new();
+    e.set_method(1);
+    assert_eq!(type_word(&mut e, "tie61ng vie65t "), "tiếng việt ");
+}
+
+#[test]
+fn test_english_auto_restore_gate() {
+    let mut e = Engine::new();
+    e.set_english_auto_restore(true);
+    let screen = type_word(&mut e, "console ");
+    if cfg!(feature = "english-detection") {
+        assert_eq!(screen, "console ");
+    } else {
+        assert_ne!(screen, "console ");
+        assert!(!e.should_auto_restore());
+        assert_eq!(e.auto_restore_confidence(), 0);
+    }
+}
+
+#[test]
+#[serial]
+fn test_shortcuts_gate() {
+    ime_init();
+    let trigger = CString::new("vn").unwrap();
+    let replacement = CString::new("Việt Nam").unwrap();
+    let added = unsafe { ime_add_shortcut(trigger.as_ptr(), replacement.as_ptr()) };
+    assert_eq!(added, cfg!(feature = "shortcuts"));
+
+    let json = CString::new(r#"{"shortcuts":[]}"#).unwrap();
+    let imported = unsafe { ime_import_shortcuts_json(json.as_ptr()) };
+    if !cfg!(feature = "shortcuts") {
+        assert_eq!(imported, -1);
+        assert!(ime_export_shortcuts_json().is_null());
+        assert_eq!(ime_shortcuts_count(), 0);
+    }
+    ime_clear_shortcuts();
+}
+
+#[test]
+#[serial]
+fn test_encoding_gate() {
+    ime_set_encoding(1); // TCVN3
+    let input = CString::new("Việt").unwrap();
+    let mut len = 0usize;
+    let ptr = unsafe { ime_convert_encoding_ext(input.as_ptr(), &mut len) };
+    if cfg!(feature = "encoding") {
+        assert_eq!(ime_get_encoding(), 1);
+        assert!(!ptr.is_null() && len > 0);
+        unsafe { ime_free_bytes(ptr, len) };
+    } else {
+        assert_eq!(ime_get_encoding(), 0);
+        assert!(ptr.is_null());
+        assert_eq!(len, 0);
+    }
+    ime_set_encoding(0);
+}
@@ -0,0 +1,143 @@
+//! Fuzz regression: the fuzz harness (`fuzz/src/lib.rs`) over its seeds,
+//! the saved slow inputs (`fuzz/slow/`) and a deterministic pseudo-random
+//! sweep of each target. No input may overflow a `Result` count or leave
+//! the screen out of step with the engine; steps may not allocate more
+//! than the fuzz default.
+//!
+//! Timing is not asserted here (unoptimized, parallel tests); the fuzz
+//! targets and `benches/fuzz_replay_bench.rs` measure it.
+
+#[allow(dead_code)]
+#[path = "../fuzz/src/lib.rs"]
+mod harness;
+
+use harness::{restore_input, run, saved_cases, seeds, text_ops, CountingAlloc, Limits, Target};
+use serial_test::serial;
+
+#[global_allocator]
+static ALLOC: CountingAlloc = CountingAlloc;
+
+const LIMITS: Limits = Limits {
+    slow_key_ns: u64::MAX,
+    alloc_bytes: Limits::DEFAULT.alloc_bytes,
+};
+
+fn assert_clean(name: &str, target: Target, data: &[u8]) {
+    let r = run(target, data, &LIMITS);
+    assert!(r.findings.is_empty(), "{name}: {:?}", r.findings);
+}
+
+/// xorshift64: the same inputs on every run
+struct Rng(u64);
+
+impl Rng {
+    fn next(&mut self) -> u64 {
+        self.0 ^= self.0 << 13;
+        self.0 ^= self.0 >> 7;
+        self.0 ^= self.0 << 17;
+        self.0
+    }
+
+    fn bytes(&mut self, len: usize) -> Vec<u8> {
+        (0..len).map(|_| self.next() as u8).collect()
+    }
+}
+
+#[test]
+#[serial]
+fn test_seeds_and_saved_cases() {
+    for (name, target, data) in seeds().into_iter().chain(saved_cases()) {
+        assert_clean(&name, target, &data);
+    }
+}
+
+#[test]
+fn test_seeds_measure_every_step() {
+    let keys = &seeds()[0];
+    let r = run(keys.1, &keys.2, &Limits::NONE);
+    assert!(r.steps > 100);
+    assert!(r.max_step_ns > 0);
+    assert!(r.findings.is_empty());
+}
+
+#[test]
+fn test_random_keys() {
+    let mut rng = Rng(0x9E37_79B9_7F4A_7C15);
+    for i in 0..300 {
+        let len = 2 * (1 + rng.next() as usize % 200);
+        let data = rng.bytes(len);
+        assert_clean(&format!("keys #{i} {data:?}"), Target::Keys, &data);
+    }
+}
+
+#[test]
+fn test_random_restore_words() {
+    let mut rng = Rng(0xD1B5_4A32_D192_ED03);
+    for i in 0..300 {
+        let len = 1 + rng.next() as usize % 120;
+        let data = rng.bytes(len);
+        assert_clean(
+            &format!("restore_word #{i} {data:?}"),
+            Target::RestoreWord,
+            &data,
+        );
+    }
+}
+
+#[test]
+fn test_random_shortcuts_json() {
+    let mut rng = Rng(0x2545_F491_4F6C_DD1D);
+    let seed = seeds().remove(1).2;
+    for i in 0..300 {
+        // Mutate the seed document so most inputs still parse
+        let mut data = seed.clone();
+        for _ in 0..1 + rng.next() % 4 {
+            let at = rng.next() as usize % data.len();
+            match rng.next() % 3 {
+                0 => data[at] = rng.next() as u8,
+                1 => data.insert(at, b"\"{}[],:\\u"[rng.next() as usize % 9]),
+                _ => {
+                    data.remove(at);
+                }
+            }
+        }
+        assert_clean(
+            &format!("shortcuts_json #{i}"),
+            Target::ShortcutsJson,
+            &data,
+        );
+    }
+}
+
+#[test]
+fn test_long_words_do_not_overflow() {
+    // Restored and typed words past 255 characters
+    let long = "nghieeng".repeat(40);
+    assert_clean("long keys", Target::Keys, &text_ops(&long));
+    let word = "Nguyễn".repeat(42);
+    let data = restore_input(&word, &text_ops("aa"));
+    assert_clean("long restore", Target::RestoreWord, &data);
+}
+
+#[test]
+#[serial]
+fn test_slow_oracle_flags_and_saves() {
+    let dir = std::env::temp_dir().join(format!("goxviet-fuzz-{}", std::process::id()));
+    std::env::set_var("GOXVIET_FUZZ_SLOW_DIR", &dir);
+    let zero = Limits {
+        slow_key_ns: 0,
+        alloc_bytes: usize::MAX,
+    };
+    let data = text_ops("vieejt ");
+    let r = run(Target::Keys, &data, &zero);
+    assert_eq!(r.findings.len(), 7, "{:?}", r.findings);
+
+    let path = harness::save_case(Target::Keys, &data).unwrap();
+    assert!(path.starts_with(&dir));
+    let saved = saved_cases();
+    assert_eq!(saved.len(), 1);
+    assert_eq!(saved[0].1, Target::Keys);
+    assert_eq!(saved[0].2, data);
+    std::env::remove_var("GOXVIET_FUZZ_SLOW_DIR");
+    std::fs::remove_dir_all(&dir).unwrap();
+}
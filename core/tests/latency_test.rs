@@ -0,0 +1,122 @@
+//! Latency attribution through the FFI: synthetic event, receive and
+//! injection timestamps come back out of the per-stage histograms.
+
+use goxviet_core::latency::{bucket_index, bucket_upper_ns, LatencyStats, LATENCY_BUCKETS};
+use goxviet_core::*;
+use serial_test::serial;
+
+const QUEUE: Stage = 0;
+const PROCESSING: Stage = 1;
+const INJECTION: Stage = 2;
+const TOTAL: Stage = 3;
+type Stage = u8;
+
+const US: u64 = 1_000;
+const MS: u64 = 1_000_000;
+
+/// Most an uncontended engine lock wait may add to a key's queue time
+const LOCK_SLACK: u64 = 50 * US;
+
+fn stats(stage: Stage) -> LatencyStats {
+    let mut s = LatencyStats::default();
+    assert!(unsafe { ime_latency_stats(stage, &mut s) });
+    s
+}
+
+/// `value`, measured up to `slack` longer, reported as a bucket bound:
+/// not below it, within one bucket
+fn assert_bucketed(reported: u64, value: u64, slack: u64) {
+    assert!(
+        reported >= value && reported <= bucket_upper_ns(bucket_index(value + slack)),
+        "{reported} for {value}"
+    );
+}
+
+#[test]
+#[serial]
+fn test_synthetic_timestamps() {
+    ime_init();
+    ime_latency_reset();
+
+    // 100 keys, 1 ms apart: 200 µs in the event queue (4 ms for every
+    // 20th), injected 5 ms after the engine got the key
+    let text = "vieetj nam hoaf binhf ".repeat(5);
+    let keys: Vec<char> = text.chars().take(100).collect();
+    let mut clock = 1_000 * MS;
+    for (i, &c) in keys.iter().enumerate() {
+        let queue = if i % 20 == 19 { 4 * MS } else { 200 * US };
+        let (event, received) = (clock, clock + queue);
+        let r = ime_key_timed(utils::char_to_key(c), false, false, false, event, received);
+        assert!(!r.is_null());
+        unsafe { ime_free(r) };
+        assert!(ime_key_injected(received + 5 * MS));
+        clock += MS;
+    }
+    assert!(!ime_key_injected(clock));
+
+    // Queue time also holds the (uncontended) engine lock wait
+    let queue = stats(QUEUE);
+    assert_eq!(queue.count, 100);
+    assert!((4 * MS..4 * MS + LOCK_SLACK).contains(&queue.max_ns));
+    let queue_mean = (95 * 200 * US + 5 * 4 * MS) / 100;
+    assert!((queue_mean..queue_mean + LOCK_SLACK).contains(&queue.mean_ns));
+    assert_bucketed(queue.p50_ns, 200 * US, LOCK_SLACK);
+    assert_bucketed(queue.p90_ns, 200 * US, LOCK_SLACK);
+    assert_bucketed(queue.p99_ns, 4 * MS, LOCK_SLACK);
+
+    // Processing is real time; injection is what remains of the 5 ms
+    let processing = stats(PROCESSING);
+    assert_eq!(processing.count, 100);
+    assert!(processing.max_ns < 5 * MS);
+    let injection = stats(INJECTION);
+    assert_eq!(injection.count, 100);
+    assert!(injection.max_ns <= 5 * MS);
+    // Stages add up (each mean is rounded down)
+    let lock_wait = queue.mean_ns - queue_mean;
+    let split = lock_wait + processing.mean_ns + injection.mean_ns;
+    assert!(split.abs_diff(5 * MS) <= 2, "{split}");
+
+    let total = stats(TOTAL);
+    assert_eq!((total.count, total.max_ns), (100, 9 * MS));
+    assert_bucketed(total.p50_ns, 5 * MS + 200 * US, 0);
+
+    let mut buckets = [0u32; LATENCY_BUCKETS + 4];
+    let n = unsafe { ime_latency_histogram(QUEUE, buckets.as_mut_ptr(), buckets.len()) };
+    assert_eq!(n, LATENCY_BUCKETS as i32);
+    let queued = |ns: u64| -> u32 {
+        buckets[bucket_index(ns)..=bucket_index(ns + LOCK_SLACK)]
+            .iter()
+            .sum()
+    };
+    assert_eq!(queued(200 * US), 95);
+    assert_eq!(queued(4 * MS), 5);
+    assert_eq!(
+        ime_latency_bucket_upper_ns(bucket_index(4 * MS) as u32),
+        bucket_upper_ns(bucket_index(4 * MS))
+    );
+
+    ime_latency_reset();
+    assert_eq!(stats(TOTAL), LatencyStats::default());
+    ime_shutdown();
+}
+
+#[test]
+#[serial]
+fn test_invalid_arguments() {
+    let mut s = LatencyStats::default();
+    let mut buckets = [0u32; 4];
+    unsafe {
+        assert!(!ime_latency_stats(4, &mut s));
+        assert!(!ime_latency_stats(QUEUE, std::ptr::null_mut()));
+        assert_eq!(ime_latency_histogram(9, buckets.as_mut_ptr(), 4), -1);
+        assert_eq!(ime_latency_histogram(QUEUE, std::ptr::null_mut(), 4), -1);
+        assert_eq!(ime_latency_histogram(QUEUE, buckets.as_mut_ptr(), 4), 4);
+    }
+
+    // Not initialized: no result, nothing recorded
+    ime_shutdown();
+    ime_latency_reset();
+    assert!(ime_key_timed(0, false, false, false, 0, 0).is_null());
+    assert!(!ime_key_injected(1));
+    assert_eq!(stats(QUEUE).count, 0);
+}
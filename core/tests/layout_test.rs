@@ -0,0 +1,127 @@
+//! Keyboard layouts: typing through scancodes on every layout, and through
+//! characters, gives the same text as the engine's native keycodes.
+
+use goxviet_core::data::keys;
+use goxviet_core::engine::{Action, Engine, Result as ImeResult};
+use goxviet_core::input::layout::{self, Layout, ScancodeSet};
+use goxviet_core::utils::type_word;
+use goxviet_core::*;
+use serial_test::serial;
+
+const LAYOUTS: [Layout; 4] = [Layout::Us, Layout::Dvorak, Layout::Colemak, Layout::Azerty];
+
+/// Scancode that types `c` on `layout` (inverse of the layout table)
+fn scancode_for(set: ScancodeSet, layout: Layout, c: char) -> u16 {
+    let want = layout::translate_char(c).unwrap().key;
+    (0..256)
+        .find(|&code| layout::translate_scancode(set, layout, code) == Some(want))
+        .unwrap_or_else(|| panic!("no {set:?} {layout:?} scancode for {c:?}"))
+}
+
+/// Type `text` as scancodes and apply results to a simulated screen
+fn type_scancodes(e: &mut Engine, set: ScancodeSet, layout: Layout, text: &str) -> String {
+    let mut screen = String::new();
+    for c in text.chars() {
+        let code = scancode_for(set, layout, c);
+        let key = layout::translate_scancode(set, layout, code).unwrap();
+        let r = e.on_key_ext(key, c.is_uppercase(), false, false);
+        if r.action == Action::Send as u8 {
+            for _ in 0..r.backspace {
+                screen.pop();
+            }
+            screen.extend(r.as_slice().iter().filter_map(|&u| char::from_u32(u)));
+        } else {
+            screen.push(c);
+        }
+        r.release();
+    }
+    screen
+}
+
+#[test]
+fn test_typing_on_every_layout() {
+    for set in [
+        ScancodeSet::MacOs,
+        ScancodeSet::Evdev,
+        ScancodeSet::WindowsVk,
+    ] {
+        for layout in LAYOUTS {
+            for text in ["vieetj nam ", "Tieengs Vieejt ", "dduowngf "] {
+                let expected = type_word(&mut Engine::new(), text);
+                let got = type_scancodes(&mut Engine::new(), set, layout, text);
+                assert_eq!(got, expected, "{set:?} {layout:?}");
+            }
+        }
+    }
+}
+
+#[test]
+fn test_same_position_different_letter() {
+    // Physical US "d" position: d / e / s / d
+    let code = 32; // KEY_D
+    let typed: Vec<_> = LAYOUTS
+        .iter()
+        .map(|&l| layout::translate_scancode(ScancodeSet::Evdev, l, code))
+        .collect();
+    assert_eq!(
+        typed,
+        [Some(keys::D), Some(keys::E), Some(keys::S), Some(keys::D)]
+    );
+}
+
+fn ffi_screen(results: impl IntoIterator<Item = (char, *mut ImeResult)>) -> String {
+    let mut screen = String::new();
+    for (c, r) in results {
+        assert!(!r.is_null());
+        let res = unsafe { &*r };
+        if res.action == Action::Send as u8 {
+            for _ in 0..res.backspace {
+                screen.pop();
+            }
+            screen.extend(res.as_slice().iter().filter_map(|&u| char::from_u32(u)));
+        } else {
+            screen.push(c);
+        }
+        unsafe { ime_free(r) };
+    }
+    screen
+}
+
+#[test]
+#[serial]
+fn test_ffi_key_char() {
+    ime_init();
+    ime_method(0);
+    let text = "Vieejt Nam ";
+    let screen = ffi_screen(text.chars().map(|c| (c, ime_key_char(c as u32, false))));
+    assert_eq!(screen, "Việt Nam ");
+
+    // No engine key: pass through
+    let r = ime_key_char('€' as u32, false);
+    assert_eq!(unsafe { (*r).action }, 0);
+    unsafe { ime_free(r) };
+    ime_clear();
+}
+
+#[test]
+#[serial]
+fn test_ffi_key_scancode() {
+    ime_init();
+    ime_method(0);
+    let (set, layout) = (ScancodeSet::Evdev, Layout::Dvorak);
+    let text = "vieetj ";
+    let screen = ffi_screen(text.chars().map(|c| {
+        let code = scancode_for(set, layout, c);
+        (
+            c,
+            ime_key_scancode(set as u8, layout as u8, code, false, false, false),
+        )
+    }));
+    assert_eq!(screen, "việt ");
+
+    assert!(ime_key_scancode(9, 0, 30, false, false, false).is_null());
+    assert!(ime_key_scancode(1, 9, 30, false, false, false).is_null());
+    assert_eq!(ime_translate_scancode(1, 1, 31), keys::O);
+    assert_eq!(ime_translate_scancode(1, 0, 59), layout::NO_KEY);
+    ime_clear();
+}
@@ -0,0 +1,63 @@
+//! Lazy engine initialization: creating an engine allocates nothing,
+//! subsystems allocate on first use, behaviour is unchanged.
+
+#[allow(dead_code)]
+#[path = "support/counting_alloc.rs"]
+mod counting_alloc;
+
+use counting_alloc::allocations_during;
+use goxviet_core::engine::shortcut::Shortcut;
+use goxviet_core::engine::{Dictionary, Engine};
+use goxviet_core::utils::type_word;
+
+#[global_allocator]
+static ALLOC: counting_alloc::CountingAlloc = counting_alloc::CountingAlloc;
+
+#[test]
+fn test_engine_new_allocates_nothing() {
+    let (n, engine) = allocations_during(Engine::new);
+    assert_eq!(n, 0, "Engine::new allocated {n} times");
+    drop(engine);
+}
+
+#[test]
+fn test_ime_init_allocates_nothing() {
+    let (n, _) = allocations_during(|| goxviet_core::ime_init());
+    assert_eq!(n, 0, "ime_init allocated {n} times");
+}
+
+#[test]
+fn test_history_works_after_lazy_allocation() {
+    let mut e = Engine::new();
+    type_word(&mut e, "vieetj ");
+    // Backspace after space restores the committed word from history
+    assert_eq!(type_word(&mut e, "<"), "");
+    assert_eq!(e.get_buffer(), "việt");
+}
+
+#[test]
+fn test_shortcuts_created_on_first_use() {
+    let mut e = Engine::new();
+    assert_eq!(type_word(&mut e, "vn "), "vn ");
+    assert!(e.shortcuts().is_empty());
+
+    if cfg!(feature = "shortcuts") {
+        let mut e = Engine::new();
+        e.shortcuts_mut().add(Shortcut::new("vn", "Việt Nam"));
+        assert_eq!(type_word(&mut e, "vn "), "Việt Nam ");
+    }
+}
+
+#[test]
+fn test_dictionary_prefetch() {
+    let covered = Dictionary::prefetch();
+    if cfg!(feature = "dictionaries") {
+        assert!(covered > 1_000_000, "prefetched {covered} bytes");
+    } else {
+        assert_eq!(covered, 0);
+    }
+    assert_eq!(
+        goxviet_core::ime_prefetch_dictionaries(),
+        cfg!(all(feature = "dictionaries", feature = "english-detection"))
+    );
+}
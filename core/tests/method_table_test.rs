@@ -0,0 +1,148 @@
+//! Input method tables: built-in definitions reloaded at runtime type
+//! exactly like the built-in methods, custom definitions change the keys,
+//! and invalid definitions are rejected with their line.
+
+use goxviet_core::engine::Engine;
+use goxviet_core::input::{self, telex, vni, Family};
+use goxviet_core::utils::type_word;
+use goxviet_core::*;
+use serial_test::serial;
+use std::ffi::CString;
+
+const TELEX_TEXT: &[&str] = &[
+    "vieetj nam ",
+    "Tieengs Vieejt ",
+    "dduowngf ",
+    "nguwowif ",
+    "hoaf binhf ",
+    "thuowng ",
+    "console ",
+    "release ",
+    "tesst ",
+    "awn uoongs ",
+];
+
+const VNI_TEXT: &[&str] = &[
+    "vie65t nam ",
+    "d9u7o7ng2 ",
+    "nguo7i72 ",
+    "hoa2 bi2nh ",
+    "a8n uo6ng1 ",
+    "tie6ng1 Vie65t ",
+];
+
+fn engine_with(definition: &str) -> Engine {
+    let mut e = Engine::new();
+    e.load_method(definition).unwrap();
+    e
+}
+
+fn typed(e: &mut Engine, text: &str) -> String {
+    e.clear_all();
+    type_word(e, text)
+}
+
+#[test]
+fn test_builtin_definitions_reload_identically() {
+    let mut builtin = Engine::new();
+    let mut loaded = engine_with(telex::DEFINITION);
+    assert_eq!(loaded.method_table(), input::get(0));
+    for text in TELEX_TEXT {
+        assert_eq!(
+            typed(&mut loaded, text),
+            typed(&mut builtin, text),
+            "{text:?}"
+        );
+    }
+
+    builtin.set_method(1);
+    let mut loaded = engine_with(vni::DEFINITION);
+    assert_eq!(loaded.method_table().family(), Family::Vni);
+    for text in VNI_TEXT {
+        assert_eq!(
+            typed(&mut loaded, text),
+            typed(&mut builtin, text),
+            "{text:?}"
+        );
+    }
+}
+
+#[test]
+fn test_reloading_many_definitions() {
+    // Each load replaces the previous table, which is then freed
+    let mut e = Engine::new();
+    for key in "abcdefghijklmnopqrstuvwxyz0123456789".chars() {
+        e.load_method(&format!("base telex\nstroke {key}\n"))
+            .unwrap();
+    }
+    assert_eq!(typed(&mut e, "d9"), "đ");
+}
+
+#[test]
+fn test_custom_definition() {
+    // Telex with the tone marks on the home row's right hand
+    let mut e = engine_with(
+        "base telex\n\
+         mark j sac\n\
+         mark k huyen\n\
+         mark l hoi\n\
+         mark ; nga\n\
+         mark ' nang\n\
+         tone a circumflex a\n\
+         tone e circumflex e\n\
+         tone o circumflex o\n\
+         tone w horn aou\n\
+         stroke d\n\
+         remove z\n",
+    );
+    assert_eq!(typed(&mut e, "vieet'"), "việt");
+    assert_eq!(typed(&mut e, "hoak"), "hoà");
+    assert_eq!(typed(&mut e, "ddaauj"), "đấu");
+    // Old Telex mark keys are plain letters
+    assert_eq!(typed(&mut e, "bas"), "bas");
+
+    // Back to the built-in table
+    e.set_method(0);
+    assert_eq!(typed(&mut e, "vieetj"), "việt");
+}
+
+#[test]
+fn test_vni_variant_without_breve_key() {
+    // VNI where 7 also makes ă (Telex-style horn targets)
+    let mut e = engine_with(
+        "base vni\n\
+         mark 1 sac\nmark 2 huyen\nmark 3 hoi\nmark 4 nga\nmark 5 nang\n\
+         tone 6 circumflex aeo\n\
+         tone 7 horn aou\n\
+         stroke 9\n\
+         remove 0\n",
+    );
+    assert_eq!(typed(&mut e, "a7n"), "ăn");
+    assert_eq!(typed(&mut e, "tu7"), "tư");
+    assert_eq!(typed(&mut e, "a8"), "a8");
+}
+
+#[test]
+fn test_invalid_definitions_keep_current_method() {
+    let mut e = Engine::new();
+    let err = e
+        .load_method("base telex\nmark s sac\ntone s horn aou\n")
+        .unwrap_err();
+    assert_eq!((err.line, err.message), (3, "Key already assigned"));
+    assert_eq!(e.method_table(), input::get(0));
+    assert_eq!(typed(&mut e, "vieetj"), "việt");
+}
+
+#[test]
+#[serial]
+fn test_ffi_load_method() {
+    ime_init();
+    let ok = CString::new(vni::DEFINITION).unwrap();
+    let bad = CString::new("base vni\n\nmark 1 acute\n").unwrap();
+    unsafe {
+        assert_eq!(ime_load_method(ok.as_ptr()), 0);
+        assert_eq!(ime_load_method(bad.as_ptr()), 3);
+        assert_eq!(ime_load_method(std::ptr::null()), -1);
+    }
+    ime_method(0);
+}
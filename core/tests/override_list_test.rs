@@ -0,0 +1,119 @@
+//! User override list tests
+//!
+//! Always-English / always-Vietnamese keystroke sequences are checked before
+//! English detection and can be replaced at runtime.
+
+use goxviet_core::data::keys;
+use goxviet_core::engine::{Engine, LanguageBias, OverrideSet};
+
+fn key_for(c: char) -> u16 {
+    match c {
+        'a' => keys::A,
+        'b' => keys::B,
+        'c' => keys::C,
+        'd' => keys::D,
+        'e' => keys::E,
+        'f' => keys::F,
+        'g' => keys::G,
+        'h' => keys::H,
+        'i' => keys::I,
+        'j' => keys::J,
+        'k' => keys::K,
+        'l' => keys::L,
+        'm' => keys::M,
+        'n' => keys::N,
+        'o' => keys::O,
+        'p' => keys::P,
+        'q' => keys::Q,
+        'r' => keys::R,
+        's' => keys::S,
+        't' => keys::T,
+        'u' => keys::U,
+        'v' => keys::V,
+        'w' => keys::W,
+        'x' => keys::X,
+        'y' => keys::Y,
+        'z' => keys::Z,
+        _ => panic!("unmapped char {c:?}"),
+    }
+}
+
+fn type_word(e: &mut Engine, word: &str) -> String {
+    e.clear_all();
+    for c in word.chars() {
+        e.on_key(key_for(c), false, false);
+    }
+    e.get_buffer()
+}
+
+fn engine_with(kind: LanguageBias, words: &str) -> Engine {
+    let mut e = Engine::new();
+    e.set_method(0);
+    e.set_override_list(kind, Some(OverrideSet::parse(words).0));
+    e
+}
+
+#[test]
+fn test_english_override() {
+    let mut e = Engine::new();
+    assert_eq!(type_word(&mut e, "this"), "thí");
+
+    let mut e = engine_with(LanguageBias::English, "this\nbias\n");
+    assert_eq!(type_word(&mut e, "this"), "this");
+    assert_eq!(type_word(&mut e, "bias"), "bias");
+    // Only the exact sequence is pinned
+    assert_eq!(type_word(&mut e, "as"), "á");
+}
+
+#[test]
+fn test_vietnamese_override_beats_dictionary_restore() {
+    let mut e = Engine::new();
+    assert_eq!(type_word(&mut e, "mass"), "mass");
+
+    let mut e = engine_with(LanguageBias::Vietnamese, "mass");
+    assert_eq!(type_word(&mut e, "mass"), "mas");
+}
+
+#[test]
+fn test_replace_and_clear_at_runtime() {
+    let mut e = engine_with(LanguageBias::English, "this");
+    let old = e.set_override_list(LanguageBias::English, Some(OverrideSet::parse("is").0));
+    assert_eq!(old.map(|s| s.len()), Some(1));
+    assert_eq!(type_word(&mut e, "this"), "thí");
+    assert_eq!(type_word(&mut e, "is"), "is");
+
+    e.set_override_list(LanguageBias::English, None);
+    assert!(e.override_list(LanguageBias::English).is_none());
+    assert_eq!(type_word(&mut e, "is"), "í");
+}
+
+#[test]
+fn test_failure_blacklist_as_english_overrides() {
+    let text = std::fs::read_to_string("tests/data/english_100k_failures_blacklist.txt")
+        .expect("Could not open blacklist");
+    let mut e = engine_with(LanguageBias::English, &text);
+    assert!(e.override_list(LanguageBias::English).unwrap().len() > 2000);
+
+    let mut failures = Vec::new();
+    let mut total = 0usize;
+    for line in text.lines() {
+        let word = match line.split_whitespace().next() {
+            Some(w) if w.bytes().all(|b| b.is_ascii_lowercase()) && w.len() <= 25 => w,
+            _ => continue,
+        };
+        total += 1;
+        let out = type_word(&mut e, word);
+        if out != word {
+            failures.push(format!("{word} → {out}"));
+        }
+    }
+    // A few words lose keystrokes from raw_input during double-key reverts
+    // (e.g. "veneer"), so the restored text cannot be rebuilt exactly
+    assert!(
+        failures.len() * 100 < total,
+        "{} / {} failures: {:?}",
+        failures.len(),
+        total,
+        &failures[..failures.len().min(20)]
+    );
+}
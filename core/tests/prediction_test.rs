@@ -0,0 +1,110 @@
+//! Next-word prediction integration tests
+//!
+//! Builds a small n-gram model, installs it in the engine and checks that
+//! committed words (SPACE) drive the prediction context.
+
+use goxviet_core::data::keys;
+use goxviet_core::engine::prediction::{NgramModel, NgramModelBuilder, Prediction};
+use goxviet_core::engine::Engine;
+
+fn key_for(c: char) -> u16 {
+    match c {
+        'a' => keys::A,
+        'b' => keys::B,
+        'c' => keys::C,
+        'd' => keys::D,
+        'e' => keys::E,
+        'f' => keys::F,
+        'g' => keys::G,
+        'h' => keys::H,
+        'i' => keys::I,
+        'j' => keys::J,
+        'k' => keys::K,
+        'l' => keys::L,
+        'm' => keys::M,
+        'n' => keys::N,
+        'o' => keys::O,
+        'p' => keys::P,
+        'q' => keys::Q,
+        'r' => keys::R,
+        's' => keys::S,
+        't' => keys::T,
+        'u' => keys::U,
+        'v' => keys::V,
+        'w' => keys::W,
+        'x' => keys::X,
+        'y' => keys::Y,
+        'z' => keys::Z,
+        ' ' => keys::SPACE,
+        '.' => keys::DOT,
+        _ => panic!("unmapped char {c:?}"),
+    }
+}
+
+fn type_telex(e: &mut Engine, input: &str) {
+    for c in input.chars() {
+        e.on_key(key_for(c), false, false);
+    }
+}
+
+fn engine_with_model() -> Engine {
+    let mut b = NgramModelBuilder::new();
+    b.add_sentence("xin chào việt nam".split(' '));
+    b.add_sentence("xin chào việt nam".split(' '));
+    b.add_sentence("xin chào các bạn".split(' '));
+    b.add_sentence("chào buổi sáng".split(' '));
+    let model = NgramModel::from_bytes(b.build(8).into()).unwrap();
+
+    let mut e = Engine::new();
+    e.set_method(0);
+    e.set_prediction_model(Some(model));
+    e
+}
+
+fn top_prediction(e: &Engine) -> Option<String> {
+    let mut out = [Prediction::default(); 4];
+    let n = e.predict_next(&mut out);
+    let model = e.prediction_model()?;
+    out[..n]
+        .first()
+        .and_then(|p| model.word(p.word_id))
+        .map(str::to_string)
+}
+
+#[test]
+fn test_predicts_after_space_commit() {
+    let mut e = engine_with_model();
+    assert_eq!(top_prediction(&e), None, "No context before any commit");
+
+    type_telex(&mut e, "xin ");
+    assert_eq!(top_prediction(&e).as_deref(), Some("chào"));
+
+    type_telex(&mut e, "chaof ");
+    assert_eq!(top_prediction(&e).as_deref(), Some("việt"));
+}
+
+#[test]
+fn test_punctuation_resets_context() {
+    let mut e = engine_with_model();
+    type_telex(&mut e, "xin ");
+    assert!(top_prediction(&e).is_some());
+
+    type_telex(&mut e, "chaof.");
+    assert_eq!(top_prediction(&e), None, "Sentence break clears context");
+}
+
+#[test]
+fn test_unknown_word_breaks_context() {
+    let mut e = engine_with_model();
+    type_telex(&mut e, "xin ");
+    type_telex(&mut e, "hello ");
+    assert_eq!(top_prediction(&e), None);
+}
+
+#[test]
+fn test_no_model_predicts_nothing() {
+    let mut e = Engine::new();
+    type_telex(&mut e, "xin ");
+    let mut out = [Prediction::default(); 4];
+    assert_eq!(e.predict_next(&mut out), 0);
+}
@@ -0,0 +1,93 @@
+//! Per-app profiles through the FFI: settings, typing state and shortcut
+//! tables follow the active profile.
+
+use goxviet_core::*;
+use serial_test::serial;
+use std::ffi::CString;
+
+fn id(app: &str) -> u64 {
+    let app = CString::new(app).unwrap();
+    unsafe { ime_profile_id(app.as_ptr()) }
+}
+
+/// Type `text` and return the engine buffer
+fn type_text(text: &str) -> String {
+    for c in text.chars() {
+        let r = ime_key(utils::char_to_key(c), c.is_uppercase(), false);
+        unsafe { ime_free(r) };
+    }
+    let s = unsafe { ime_get_buffer() };
+    unsafe { std::ffi::CStr::from_ptr(s) }
+        .to_string_lossy()
+        .into_owned()
+}
+
+fn has_shortcut(trigger: &str) -> bool {
+    let json = ime_export_shortcuts_json();
+    assert!(!json.is_null());
+    let s = unsafe { std::ffi::CStr::from_ptr(json) }
+        .to_string_lossy()
+        .into_owned();
+    unsafe { ime_free_string(json) };
+    s.contains(&format!("\"{trigger}\""))
+}
+
+#[test]
+#[serial]
+fn test_profiles_switch_settings_and_state() {
+    ime_init();
+    let (terminal, notes) = (id("com.apple.Terminal"), id("com.apple.Notes"));
+    assert_ne!(terminal, notes);
+    assert_eq!(unsafe { ime_profile_id(std::ptr::null()) }, 0);
+
+    assert!(ime_activate_profile(terminal));
+    ime_enabled(false);
+    assert_eq!(type_text("vieetj"), "");
+
+    assert!(ime_activate_profile(notes));
+    ime_method(1);
+    assert_eq!(type_text("vie65"), "việ");
+
+    // Terminal: still disabled; Notes: VNI, word in progress kept
+    assert!(ime_activate_profile(terminal));
+    assert_eq!(type_text("a"), "");
+    assert!(ime_activate_profile(notes));
+    assert_eq!(type_text("t"), "việt");
+
+    assert!(ime_activate_profile(0));
+    ime_clear();
+    assert_eq!(type_text("vieetj"), "việt");
+
+    assert!(ime_remove_profile(terminal));
+    assert!(!ime_remove_profile(terminal));
+    assert!(!ime_remove_profile(0));
+    ime_shutdown();
+    assert!(!ime_activate_profile(notes));
+}
+
+#[test]
+#[serial]
+fn test_profile_shortcut_tables() {
+    ime_init();
+    let trigger = CString::new("vn").unwrap();
+    let text = CString::new("Việt Nam").unwrap();
+    ime_clear_shortcuts();
+    assert!(unsafe { ime_add_shortcut(trigger.as_ptr(), text.as_ptr()) });
+
+    // Shared table: visible from a new profile
+    assert!(ime_activate_profile(id("app.shared")));
+    assert!(has_shortcut("vn"));
+
+    // Own table: starts with the defaults, changes stay in the profile
+    assert!(ime_activate_profile(id("app.own")));
+    ime_profile_own_shortcuts(true);
+    assert!(!has_shortcut("vn"));
+    let own = CString::new("gg").unwrap();
+    assert!(unsafe { ime_add_shortcut(own.as_ptr(), text.as_ptr()) });
+
+    assert!(ime_activate_profile(0));
+    assert!(has_shortcut("vn") && !has_shortcut("gg"));
+    assert!(ime_activate_profile(id("app.own")));
+    assert!(has_shortcut("gg") && !has_shortcut("vn"));
+    ime_shutdown();
+}
@@ -0,0 +1,194 @@
+//! Per-word scratch arena: once warm, typing allocates only the `Result`
+//! buffers handed to the caller; transient per-key data lives in the arena.
+//! `ime_key_into_*` builds the edit in per-thread storage and allocates
+//! nothing at all.
+
+#[allow(dead_code)]
+#[path = "support/counting_alloc.rs"]
+mod counting_alloc;
+
+use goxviet_core::data::keys;
+use goxviet_core::engine::edit_plan::COST_UNSUPPORTED;
+use goxviet_core::engine::output::{MAX_UTF16_LEN, MAX_UTF32_LEN, MAX_UTF8_LEN};
+use goxviet_core::engine::Engine;
+use goxviet_core::utils::{char_to_key, type_word};
+use goxviet_core::{
+    ime_add_shortcut, ime_clear_edit_costs, ime_init, ime_key_into_utf16, ime_key_into_utf32,
+    ime_key_into_utf8, ime_method, ime_set_edit_costs, ime_set_low_amplification,
+    ime_set_output_form,
+};
+use std::ffi::CString;
+
+#[global_allocator]
+static ALLOC: counting_alloc::CountingAlloc = counting_alloc::CountingAlloc;
+
+/// Type `text` key by key; returns (allocations, results that own a buffer)
+fn type_counted(e: &mut Engine, text: &str) -> (usize, usize) {
+    let (mut allocations, mut results) = (0, 0);
+    for c in text.chars() {
+        let key = if c == ' ' {
+            keys::SPACE
+        } else {
+            char_to_key(c)
+        };
+        let before = counting_alloc::allocations();
+        let r = e.on_key(key, c.is_uppercase(), false);
+        allocations += counting_alloc::allocations() - before;
+        results += (r.capacity > 0) as usize;
+        r.release();
+    }
+    (allocations, results)
+}
+
+const SESSION: &str = "tieengs vieejt laf ngoon nguwx cuar nguwowif vieejt nam \
+                       chungs toi ddang hocj tieengs anh vaf tieengs phaps \
+                       the restore process should keep english words intact ";
+
+#[test]
+fn test_warm_typing_allocates_only_results() {
+    let mut e = Engine::new();
+    // Warm up: lazily created subsystems and the arena's first chunk
+    type_counted(&mut e, SESSION);
+
+    let (allocations, results) = type_counted(&mut e, &SESSION.repeat(3));
+    assert!(results > 0);
+    assert_eq!(
+        allocations,
+        results,
+        "{} transient allocations",
+        allocations - results
+    );
+}
+
+#[test]
+fn test_long_word_stays_in_arena() {
+    let mut e = Engine::new();
+    type_counted(&mut e, SESSION);
+
+    // No word boundary for 200 keys: the arena starts over instead of growing
+    let word = "nguwowif".repeat(25);
+    let (allocations, results) = type_counted(&mut e, &word);
+    assert_eq!(
+        allocations,
+        results,
+        "{} transient allocations",
+        allocations - results
+    );
+}
+
+#[test]
+fn test_output_unchanged() {
+    let mut e = Engine::new();
+    assert_eq!(type_word(&mut e, "tieengs vieejt "), "tiếng việt ");
+    assert_eq!(type_word(&mut e, "nguwowif "), "người ");
+    // Mark revert (ss) renders through the arena too
+    assert_eq!(type_word(&mut e, "ass "), "as ");
+}
+
+/// Type `text` through `ime_key_into_*`; returns (allocations, edits)
+fn type_into(text: &str) -> (usize, usize) {
+    let mut utf16 = [0u16; MAX_UTF16_LEN];
+    let mut utf8 = [0u8; MAX_UTF8_LEN];
+    let mut utf32 = [0u32; MAX_UTF32_LEN];
+    let (mut action, mut backspace) = (0u8, 0u8);
+    let (mut allocations, mut edits) = (0, 0);
+    for (i, c) in text.chars().enumerate() {
+        let key = if c == ' ' {
+            keys::SPACE
+        } else {
+            char_to_key(c)
+        };
+        let caps = c.is_uppercase();
+        let before = counting_alloc::allocations();
+        let written = unsafe {
+            match i % 3 {
+                0 => ime_key_into_utf16(
+                    key,
+                    caps,
+                    false,
+                    false,
+                    utf16.as_mut_ptr(),
+                    utf16.len(),
+                    &mut action,
+                    &mut backspace,
+                ),
+                1 => ime_key_into_utf8(
+                    key,
+                    caps,
+                    false,
+                    false,
+                    utf8.as_mut_ptr(),
+                    utf8.len(),
+                    &mut action,
+                    &mut backspace,
+                ),
+                _ => ime_key_into_utf32(
+                    key,
+                    caps,
+                    false,
+                    false,
+                    utf32.as_mut_ptr(),
+                    utf32.len(),
+                    &mut action,
+                    &mut backspace,
+                ),
+            }
+        };
+        allocations += counting_alloc::allocations() - before;
+        assert!(written >= 0);
+        edits += (written > 0) as usize;
+    }
+    (allocations, edits)
+}
+
+#[test]
+fn test_key_into_allocates_nothing() {
+    ime_init();
+    ime_method(0);
+    let trigger = CString::new("vn").unwrap();
+    let text = CString::new("Việt Nam").unwrap();
+    unsafe { ime_add_shortcut(trigger.as_ptr(), text.as_ptr()) };
+    let session = format!("{SESSION}vn ");
+    type_into(&session);
+
+    for form in [0, 1] {
+        assert!(ime_set_output_form(form));
+        type_into(&session);
+        let (allocations, edits) = type_into(&session.repeat(3));
+        assert!(edits > 0);
+        assert_eq!(allocations, 0, "form {form}: {allocations} allocations");
+    }
+    ime_set_output_form(0);
+
+    // Low amplification trims restore edits in place
+    ime_set_low_amplification(true);
+    type_into(&session);
+    let (allocations, edits) = type_into(&session.repeat(3));
+    ime_set_low_amplification(false);
+    assert!(edits > 0);
+    assert_eq!(
+        allocations, 0,
+        "low amplification: {allocations} allocations"
+    );
+
+    // Planned edits, deferred ones included; backspacing into the previous
+    // word replaces a deferred word as shown
+    let session = format!("{session}tieengs <<<vieejt <vieejt< ");
+    let keystrokes = [20, 10, 10, COST_UNSUPPORTED, COST_UNSUPPORTED];
+    let deferred = [2000, 1, 1, COST_UNSUPPORTED, 50];
+    for costs in [keystrokes, deferred] {
+        let [per_edit, per_backspace, per_char, per_replace, per_deferred_key] = costs;
+        assert!(ime_set_edit_costs(
+            per_edit,
+            per_backspace,
+            per_char,
+            per_replace,
+            per_deferred_key
+        ));
+        type_into(&session);
+        let (allocations, edits) = type_into(&session.repeat(3));
+        assert!(edits > 0);
+        assert_eq!(allocations, 0, "{costs:?}: {allocations} allocations");
+    }
+    ime_clear_edit_costs();
+}
@@ -0,0 +1,154 @@
+//! Shortcode completion tests
+//!
+//! `:code` sessions: typing, exact-match replacement on `:`/SPACE,
+//! TAB completion, backspace, and coexistence with Vietnamese typing.
+
+use goxviet_core::data::keys;
+use goxviet_core::engine::shortcode::ShortcodeTable;
+use goxviet_core::engine::{Action, Engine, Result};
+
+fn key_for(c: char) -> (u16, bool) {
+    match c {
+        ':' => (keys::SEMICOLON, true),
+        '_' => (keys::MINUS, true),
+        '-' => (keys::MINUS, false),
+        '+' => (keys::EQUAL, true),
+        ' ' => (keys::SPACE, false),
+        '\t' => (keys::TAB, false),
+        '<' => (keys::DELETE, false),
+        '0' => (keys::N0, false),
+        '1' => (keys::N1, false),
+        'a' => (keys::A, false),
+        'c' => (keys::C, false),
+        'x' => (keys::X, false),
+        'b' => (keys::B, false),
+        'd' => (keys::D, false),
+        'e' => (keys::E, false),
+        'f' => (keys::F, false),
+        'g' => (keys::G, false),
+        'h' => (keys::H, false),
+        'i' => (keys::I, false),
+        'l' => (keys::L, false),
+        'm' => (keys::M, false),
+        'n' => (keys::N, false),
+        'o' => (keys::O, false),
+        'r' => (keys::R, false),
+        's' => (keys::S, false),
+        't' => (keys::T, false),
+        'v' => (keys::V, false),
+        _ => panic!("unmapped char {c:?}"),
+    }
+}
+
+/// Type keys and return the last result
+fn type_keys(e: &mut Engine, input: &str) -> Result {
+    let mut last = Result::none();
+    for c in input.chars() {
+        let (key, shift) = key_for(c);
+        last = e.on_key_ext(key, false, false, shift);
+    }
+    last
+}
+
+fn output(r: &Result) -> String {
+    (0..r.count as usize)
+        .filter_map(|i| unsafe { char::from_u32(*r.chars.add(i)) })
+        .collect()
+}
+
+fn engine() -> Engine {
+    let mut e = Engine::new();
+    e.set_method(0);
+    e.set_shortcodes_enabled(true);
+    e
+}
+
+#[test]
+fn test_closing_colon_replaces_exact_code() {
+    let mut e = engine();
+    let r = type_keys(&mut e, ":smile:");
+    assert_eq!(r.action, Action::Send as u8);
+    assert_eq!(r.backspace, 6, "Deletes ':smile'");
+    assert_eq!(output(&r), "😄");
+    assert_eq!(e.shortcode_query(), None);
+}
+
+#[test]
+fn test_space_replaces_exact_code() {
+    let mut e = engine();
+    let r = type_keys(&mut e, ":vnd ");
+    assert_eq!(r.backspace, 4);
+    assert_eq!(output(&r), "₫ ");
+
+    let r = type_keys(&mut e, ":+1 ");
+    assert_eq!(output(&r), "👍 ");
+}
+
+#[test]
+fn test_tab_completes_best_candidate() {
+    let mut e = engine();
+    let r = type_keys(&mut e, ":smi\t");
+    assert_eq!(r.backspace, 4);
+    assert_eq!(output(&r), "😄");
+}
+
+#[test]
+fn test_letters_are_not_transformed_in_session() {
+    let mut e = engine();
+    // "aa" would become "â" in Telex; "s" would add a mark
+    type_keys(&mut e, ":bass");
+    assert_eq!(e.shortcode_query(), Some("bass"));
+    assert_eq!(e.get_buffer(), "");
+}
+
+#[test]
+fn test_backspace_shortens_code_and_ends_on_colon() {
+    let mut e = engine();
+    type_keys(&mut e, ":smilx<");
+    assert_eq!(e.shortcode_query(), Some("smil"));
+    type_keys(&mut e, "<<<<");
+    assert_eq!(e.shortcode_query(), Some(""));
+    type_keys(&mut e, "<");
+    assert_eq!(e.shortcode_query(), None);
+
+    // Back to normal Vietnamese typing
+    type_keys(&mut e, "ddi");
+    assert_eq!(e.get_buffer(), "đi");
+}
+
+#[test]
+fn test_unknown_code_passes_through() {
+    let mut e = engine();
+    let r = type_keys(&mut e, ":notacode ");
+    assert_eq!(r.action, Action::None as u8);
+    assert_eq!(e.shortcode_query(), None);
+}
+
+#[test]
+fn test_disabled_by_default() {
+    let mut e = Engine::new();
+    type_keys(&mut e, ":dd");
+    assert_eq!(e.shortcode_query(), None);
+    assert_eq!(e.get_buffer(), "đ");
+}
+
+#[test]
+fn test_colon_mid_word_does_not_start_session() {
+    let mut e = engine();
+    type_keys(&mut e, "ab:");
+    assert_eq!(e.shortcode_query(), None);
+}
+
+#[test]
+fn test_candidates_are_prefix_matches() {
+    let mut e = engine();
+    type_keys(&mut e, ":hea");
+    let mut out = [0usize; 8];
+    let n = e.shortcode_candidates(&mut out);
+    assert!(n > 0);
+    let t = ShortcodeTable::builtin();
+    for &i in &out[..n] {
+        assert!(t.code(i).starts_with("hea"), "{}", t.code(i));
+    }
+    assert_eq!(t.code(out[0]), "heart");
+}
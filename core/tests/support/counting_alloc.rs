@@ -0,0 +1,66 @@
+//! Counting Global Allocator
+//!
+//! Shared by the allocation tests and benches, the embedded no-alloc test
+//! and the fuzz harness. Include this file with `#[path]` and install it:
+//!
+//! ```ignore
+//! #[path = "support/counting_alloc.rs"]
+//! mod counting_alloc;
+//!
+//! #[global_allocator]
+//! static ALLOC: counting_alloc::CountingAlloc = counting_alloc::CountingAlloc;
+//! ```
+//!
+//! `alloc` and `realloc` calls are counted, with the bytes they request.
+//! Counts are per thread, so tests running in parallel don't see each
+//! other.
+
+use std::alloc::{GlobalAlloc, Layout, System};
+use std::cell::Cell;
+
+thread_local! {
+    static CALLS: Cell<usize> = const { Cell::new(0) };
+    static BYTES: Cell<usize> = const { Cell::new(0) };
+}
+
+/// Global allocator that counts what each thread allocates
+pub struct CountingAlloc;
+
+unsafe impl GlobalAlloc for CountingAlloc {
+    unsafe fn alloc(&self, layout: Layout) -> *mut u8 {
+        count(layout.size());
+        System.alloc(layout)
+    }
+
+    unsafe fn realloc(&self, ptr: *mut u8, layout: Layout, new_size: usize) -> *mut u8 {
+        count(new_size);
+        System.realloc(ptr, layout, new_size)
+    }
+
+    unsafe fn dealloc(&self, ptr: *mut u8, layout: Layout) {
+        System.dealloc(ptr, layout)
+    }
+}
+
+// `try_with`: the thread's counters may already be gone while it exits
+fn count(bytes: usize) {
+    let _ = CALLS.try_with(|n| n.set(n.get().wrapping_add(1)));
+    let _ = BYTES.try_with(|n| n.set(n.get().wrapping_add(bytes)));
+}
+
+/// Allocation calls on this thread so far
+pub fn allocations() -> usize {
+    CALLS.try_with(Cell::get).unwrap_or(0)
+}
+
+/// Bytes requested by this thread's allocation calls so far (wrapping)
+pub fn allocated_bytes() -> usize {
+    BYTES.try_with(Cell::get).unwrap_or(0)
+}
+
+/// Run `f`; returns the allocation calls it made on this thread, and its value
+pub fn allocations_during<T>(f: impl FnOnce() -> T) -> (usize, T) {
+    let before = allocations();
+    let value = f();
+    (allocations() - before, value)
+}
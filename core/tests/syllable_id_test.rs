@@ -0,0 +1,74 @@
+//! Syllable IDs against the Vietnamese corpus and the engine: corpus
+//! syllables encode, decode back to the same text, and typing a word
+//! leaves the engine on the same ID as its text.
+
+use goxviet_core::engine::syllable_id::{decode_string, encode_str, ID_COUNT, SYLLABLES};
+use goxviet_core::engine::Engine;
+use goxviet_core::input::layout::translate_char;
+
+fn corpus_syllables() -> Vec<String> {
+    let text = std::fs::read_to_string("tests/data/vietnamese_22k.txt").unwrap();
+    text.split(|c: char| c.is_whitespace() || c == '-')
+        .filter(|w| !w.is_empty() && w.chars().all(char::is_alphabetic))
+        .map(str::to_string)
+        .collect()
+}
+
+#[test]
+fn test_corpus_round_trips() {
+    let words = corpus_syllables();
+    let mut encoded = 0;
+    let mut misplaced = Vec::new();
+    for word in &words {
+        let Some(id) = encode_str(word) else {
+            continue;
+        };
+        encoded += 1;
+        assert!((id as usize) < ID_COUNT);
+        // The corpus mixes old and modern mark placement
+        let modern = decode_string(id, true).unwrap();
+        let old = decode_string(id, false).unwrap();
+        if *word != modern && *word != old {
+            misplaced.push(word.as_str());
+        }
+    }
+    // Marks on neither of the two positions ("tơì") are corpus typos
+    assert!(misplaced.len() < 20, "{misplaced:?}");
+    // The rest are loanwords, abbreviations and typos
+    let coverage = encoded as f64 / words.len() as f64;
+    assert!(coverage > 0.985, "coverage {coverage:.4}");
+    println!(
+        "{encoded}/{} corpus syllables, {SYLLABLES} per case",
+        words.len()
+    );
+}
+
+#[test]
+fn test_engine_state_encodes() {
+    let mut e = Engine::new();
+    for (keys, word) in [
+        ("tieengs", "tiếng"),
+        ("Vieetj", "Việt"),
+        ("DDUWOWNGF", "ĐƯỜNG"),
+        ("quoocs", "quốc"),
+        ("hoaf", "hoà"),
+        ("nghieeng", "nghiêng"),
+    ] {
+        e.clear();
+        for c in keys.chars() {
+            let k = translate_char(c).unwrap();
+            e.on_key(k.key, k.caps, false).release();
+        }
+        assert_eq!(e.get_buffer(), word);
+        assert_eq!(e.syllable_id(), encode_str(word), "{keys}");
+        assert!(e.syllable_id().is_some());
+    }
+
+    // English words have no ID
+    e.clear();
+    for c in "text".chars() {
+        let k = translate_char(c).unwrap();
+        e.on_key(k.key, k.caps, false).release();
+    }
+    assert_eq!(e.syllable_id(), None);
+}
@@ -12,6 +12,22 @@
 /// Initialize the IME engine (must be called once at startup)
 void ime_init(void);
 
+/// Drop the engine and free its state (ime_init may be called again)
+void ime_shutdown(void);
+
+/// Optional subsystems compiled into the library (ime_features bits).
+/// FFI calls of a missing subsystem still link but fail or do nothing.
+#define IME_FEATURE_ENGLISH_DETECTION (1u << 0)
+#define IME_FEATURE_DICTIONARIES (1u << 1)
+#define IME_FEATURE_SHORTCUTS (1u << 2)
+#define IME_FEATURE_ENCODING (1u << 3)
+#define IME_FEATURE_UPDATER (1u << 4)
+uint32_t ime_features(void);
+
+/// Page in the English dictionaries on a background thread (optional,
+/// call at startup). Returns false if the build has none.
+bool ime_prefetch_dictionaries(void);
+
 /// Process a key event
 /// Returns pointer to Result struct (must be freed with ime_free)
 /// Returns NULL if engine not initialized
@@ -19,10 +35,11 @@ void ime_init(void);
 typedef struct {
   uint32_t *chars;   // Heap-allocated UTF-32 codepoints
   size_t capacity;   // Allocated capacity
-  uint8_t action;    // 0=None, 1=Send, 2=Restore
+  uint8_t action;    // 0=None, 1=Send, 2=Restore, 3=Preedit, 4=Commit,
+                     // 5=CommitPassThrough, 6=ReplaceRange
   uint8_t backspace; // Number of chars to delete
   uint8_t count;     // Number of valid chars
-  uint8_t _pad;      // Padding
+  uint8_t keep;      // ReplaceRange: chars kept after the replaced range
 } ImeResult;
 
 ImeResult *ime_key(uint16_t key, bool caps, bool ctrl);
@@ -30,12 +47,183 @@ ImeResult *ime_key(uint16_t key, bool caps, bool ctrl);
 /// Process key event with extended parameters (for Shift handling)
 ImeResult *ime_key_ext(uint16_t key, bool caps, bool ctrl, bool shift);
 
+/// Process a Unicode character (IME text events). Uppercase letters set
+/// caps, shifted symbols set shift. Action 0 for characters with no key.
+ImeResult *ime_key_char(uint32_t codepoint, bool ctrl);
+
+/// Scancode sets and keyboard layouts for ime_key_scancode
+#define IME_SCANCODE_MACOS 0
+#define IME_SCANCODE_EVDEV 1
+#define IME_SCANCODE_WINDOWS_VK 2 // layout ignored: VKs are layout-translated
+#define IME_LAYOUT_US 0
+#define IME_LAYOUT_DVORAK 1
+#define IME_LAYOUT_COLEMAK 2
+#define IME_LAYOUT_AZERTY 3
+#define IME_NO_KEY 0xFFFF
+
+/// Process a platform scancode under a keyboard layout.
+/// NULL if not initialized or set/layout is invalid; action 0 for
+/// keys with no engine key.
+ImeResult *ime_key_scancode(uint8_t set, uint8_t layout, uint16_t code,
+                            bool caps, bool ctrl, bool shift);
+
+/// Scancode to engine key for ime_key_ext (IME_NO_KEY if none)
+uint16_t ime_translate_scancode(uint8_t set, uint8_t layout, uint16_t code);
+
+/// Buffer sizes for ime_key_into_utf16 / _utf8 / _utf32
+#define IME_MAX_UTF16_LEN 768
+#define IME_MAX_UTF8_LEN 1280
+#define IME_MAX_UTF32_LEN 768
+
+/// Process key event, writing the inserted text into a caller buffer
+/// (no ImeResult to free, no allocation). Returns units written, or -1 if
+/// not processed.
+/// backspace counts characters, not code units.
+int32_t ime_key_into_utf16(uint16_t key, bool caps, bool ctrl, bool shift,
+                           uint16_t *out, size_t capacity, uint8_t *action,
+                           uint8_t *backspace);
+int32_t ime_key_into_utf8(uint16_t key, bool caps, bool ctrl, bool shift,
+                          uint8_t *out, size_t capacity, uint8_t *action,
+                          uint8_t *backspace);
+
+int32_t ime_key_into_utf32(uint16_t key, bool caps, bool ctrl, bool shift,
+                           uint32_t *out, size_t capacity, uint8_t *action,
+                           uint8_t *backspace);
+
+/// Output form for the _into functions (0=NFC default, 1=NFD)
+bool ime_set_output_form(uint8_t form);
+
 /// Free a result pointer
 void ime_free(ImeResult *result);
 
+// Result with wide counts, for long snippet expansions
+typedef struct {
+  uint32_t *chars;    // Heap-allocated UTF-32 codepoints (NULL if none)
+  size_t capacity;    // Allocated capacity
+  uint32_t backspace; // Number of chars to delete
+  uint32_t count;     // Number of valid chars
+  uint32_t remaining; // Chars left to read with ime_read_expansion
+  uint8_t action;     // Same values as ImeResult.action
+  uint8_t _pad[3];
+} ImeWideResult;
+
+/// Process key event with wide counts; expansions longer than inline_limit
+/// are read with ime_read_expansion (must be freed with ime_free_wide)
+ImeWideResult *ime_key_wide(uint16_t key, bool caps, bool ctrl, bool shift,
+                            uint32_t inline_limit);
+
+/// Read the next expansion chunk; returns count, 0 when done, -1 on error
+int32_t ime_read_expansion(uint32_t *out, size_t capacity);
+
+/// Free a wide result pointer
+void ime_free_wide(ImeWideResult *result);
+
 /// Set input method (0=Telex, 1=VNI)
 void ime_method(uint8_t method);
 
+/// Load an input method definition (base/mark/tone/stroke/remove lines)
+/// and switch to it. Returns 0, the line of the first error, or -1.
+int32_t ime_load_method(const char *definition);
+
+/// Profile id of an application identifier such as a bundle id
+/// (0 = default profile for NULL)
+uint64_t ime_profile_id(const char *app);
+
+/// Switch to an app's profile: settings and typing state are parked and
+/// restored per profile. False if not initialized or too many profiles.
+bool ime_activate_profile(uint64_t id);
+
+/// Active profile uses its own shortcut table (true) or the shared one
+void ime_profile_own_shortcuts(bool own);
+
+/// Forget a parked profile (not the active or default one)
+bool ime_remove_profile(uint64_t id);
+
+// Committed word (64 bytes), drained with ime_drain_commits
+typedef struct {
+  uint32_t seq;     // Commit number (wrapping); a gap means dropped records
+  uint16_t key;     // Key that ended the word (SPACE, punctuation, ...)
+  uint8_t kind;     // IME_COMMIT_*
+  uint8_t len;      // Bytes used in text
+  uint8_t text[56]; // Word as shown, UTF-8 (not NUL-terminated)
+} ImeCommitRecord;
+
+#define IME_COMMIT_VIETNAMESE 0
+#define IME_COMMIT_ENGLISH 1
+#define IME_COMMIT_SHORTCUT 2 // text is the trigger, not the expansion
+
+/// Publish a record of each committed word to a fixed 256-record ring
+/// (true) or stop (false)
+void ime_commit_events(bool enabled);
+
+/// Move up to capacity records into out, oldest first, from any thread.
+/// Returns the count, 0 while another thread drains, -1 if out is NULL.
+int32_t ime_drain_commits(ImeCommitRecord *out, size_t capacity);
+
+/// Records dropped because the ring was full
+uint32_t ime_commits_dropped(void);
+
+// Per-stage latency summary in ns, from ime_latency_stats
+typedef struct {
+  uint64_t count;
+  uint64_t mean_ns;
+  uint64_t p50_ns; // Percentiles are bucket bounds (within 25%)
+  uint64_t p90_ns;
+  uint64_t p99_ns;
+  uint64_t max_ns;
+} ImeLatencyStats;
+
+#define IME_LATENCY_QUEUE 0      // OS event -> engine lock taken (incl. wait)
+#define IME_LATENCY_PROCESSING 1 // key processing (engine lock held)
+#define IME_LATENCY_INJECTION 2  // processed -> ime_key_injected
+#define IME_LATENCY_TOTAL 3      // OS event -> ime_key_injected
+#define IME_LATENCY_BUCKETS 96
+
+/// ime_key_ext, recording queue and processing latency. event_ns is the
+/// OS event timestamp, received_ns when the platform got it (taken right
+/// before the call); both from one monotonic clock (macOS:
+/// clock_gettime_nsec_np(CLOCK_UPTIME_RAW)). The wait for the engine lock
+/// is measured by the core and counted as queue time.
+ImeResult *ime_key_timed(uint16_t key, bool caps, bool ctrl, bool shift,
+                         uint64_t event_ns, uint64_t received_ns);
+
+/// The last timed key's result was injected at done_ns (same clock).
+/// False if no timed key is waiting.
+bool ime_key_injected(uint64_t done_ns);
+
+/// Summary of one IME_LATENCY_* stage; false for NULL or unknown stage
+bool ime_latency_stats(uint8_t stage, ImeLatencyStats *out);
+
+/// Copy a stage's bucket counts; returns count written or -1
+int32_t ime_latency_histogram(uint8_t stage, uint32_t *out, size_t capacity);
+
+/// Exclusive upper bound of a bucket in ns (UINT64_MAX for the last)
+uint64_t ime_latency_bucket_upper_ns(uint32_t index);
+
+/// Clear all latency histograms
+void ime_latency_reset(void);
+
+#define IME_BURST_PASS 0   // no burst: handle the key with ime_key_*
+#define IME_BURST_QUEUED 1 // consume the key, inject nothing
+#define IME_BURST_FLUSH 2  // inject ime_burst_end's edit, then handle the key
+
+/// Start a burst (host knows the input is machine-generated); false if not
+/// initialized or in composition mode
+bool ime_burst_begin(void);
+
+/// Offer a key to burst mode before ime_key_*; returns IME_BURST_*.
+/// event_ns (0 if unknown) detects bursts from key timing.
+uint8_t ime_burst_key(uint16_t key, bool caps, bool ctrl, bool shift,
+                      uint64_t event_ns);
+
+/// End the burst: one edit for all queued keys, delivered like
+/// ime_key_wide (free with ime_free_wide). Also call from an idle timer.
+ImeWideResult *ime_burst_end(uint32_t inline_limit);
+
+/// min_keys key events less than gap_ns apart start a burst
+/// (default 5 ms / 8 keys; gap_ns 0 disables detection)
+void ime_set_burst_detection(uint64_t gap_ns, uint32_t min_keys);
+
 /// Enable or disable the engine
 void ime_enabled(bool enabled);
 
@@ -73,6 +261,9 @@ void ime_instant_restore(bool enabled);
 /// Returns true on success, false on error
 bool ime_add_shortcut(const char *trigger, const char *replacement);
 
+/// Add a long word-boundary snippet (up to 65536 chars, see ime_key_wide)
+bool ime_add_snippet(const char *trigger, const char *replacement);
+
 /// Remove a shortcut
 void ime_remove_shortcut(const char *trigger);
 
@@ -105,4 +296,106 @@ void ime_free_string(char *str);
 /// Restore buffer from a Vietnamese word string
 void ime_restore_word(const char *word);
 
+// ============================================================
+// Next-Word Prediction
+// ============================================================
+
+/// Load a GXNG n-gram model from a file path
+bool ime_load_prediction_model(const char *path);
+
+/// Load a GXNG n-gram model from memory (bytes are copied)
+bool ime_load_prediction_model_bytes(const uint8_t *data, size_t len);
+
+/// Unload the prediction model
+void ime_unload_prediction_model(void);
+
+/// Write up to max_candidates '\n'-separated UTF-8 predictions into out
+/// Returns candidate count, or -1 if no model / invalid buffer
+int32_t ime_predict_next(char *out, size_t out_len, uint32_t max_candidates);
+
+// ============================================================
+// Shortcodes (:smile: → emoji)
+// ============================================================
+
+/// Enable or disable :code shortcode completion
+void ime_set_shortcodes_enabled(bool enabled);
+
+/// Write up to max_candidates "index\tcode\tvalue" lines into out
+/// Returns candidate count, or -1 if no session / invalid buffer
+int32_t ime_shortcode_candidates(char *out, size_t out_len, uint32_t max_candidates);
+
+/// Replace typed :code with candidate index (caller must free with ime_free)
+ImeResult *ime_select_shortcode(uint32_t index);
+
+// ============================================================
+// Output amplification
+// ============================================================
+
+/// Enable or disable low-amplification mode (fewer synthetic edits)
+void ime_set_low_amplification(bool enabled);
+
+/// Cause of the last edit: 0=None, 1=Compose, 2=ToneReposition,
+/// 3=AutoRestore, 4=InstantRestore, 5=Shortcut, 6=Other
+uint8_t ime_last_edit_cause(void);
+
+/// Register injection costs; edits are planned for the lowest cost:
+/// Send, ReplaceRange (replace the `backspace` chars ending `keep` chars
+/// before the caret) or deferred (keys pass through, one edit at the word
+/// boundary). UINT32_MAX disables per_replace / per_deferred_key.
+bool ime_set_edit_costs(uint32_t per_edit, uint32_t per_backspace,
+                        uint32_t per_char, uint32_t per_replace,
+                        uint32_t per_deferred_key);
+
+/// Stop planning edits
+void ime_clear_edit_costs(void);
+
+/// Settle a deferred edit and reset word state (use instead of ime_clear
+/// while deferral is on). Caller must free with ime_free
+ImeResult *ime_settle_edit(void);
+
+// ============================================================
+// Composition (marked text, commit on word boundary)
+// ============================================================
+
+/// Enable or disable composition mode (discards current marked text)
+void ime_set_composition_mode(bool enabled);
+
+/// Copy marked text (UTF-32) into out; out may be NULL to query length
+/// Returns length, or -1 if engine not initialized / buffer too small
+int32_t ime_get_preedit(uint32_t *out, size_t capacity, uint32_t *caret);
+
+/// Commit marked text and reset word state (use instead of ime_clear)
+/// Caller must free with ime_free
+ImeResult *ime_commit_preedit(void);
+
+// ============================================================
+// Adaptive Learning (restore corrections)
+// ============================================================
+
+/// Enable or disable learning from ESC restores / backspace-after-restore
+void ime_set_adaptive_learning(bool enabled);
+
+/// Load learned corrections from file (enables learning)
+bool ime_load_learning(const char *path);
+
+/// Save learned corrections to file
+bool ime_save_learning(const char *path);
+
+/// Forget all learned corrections
+void ime_reset_learning(void);
+
+// ============================================================
+// Override Lists (0 = always English, 1 = always Vietnamese)
+// ============================================================
+
+/// Replace an override list with newline-separated keystroke sequences
+/// Returns entry count, or -1 on error
+int32_t ime_set_override_list(uint8_t kind, const char *words);
+
+/// Replace an override list from a file (call again to hot-reload)
+int32_t ime_load_override_file(uint8_t kind, const char *path);
+
+/// Remove an override list
+void ime_clear_override_list(uint8_t kind);
+
 #endif /* GoxViet_Bridging_Header_h */
\ No newline at end of file
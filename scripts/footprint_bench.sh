@@ -0,0 +1,69 @@
+#!/bin/bash
+# Footprint benchmark: minimal vs full goxviet-core builds
+#
+# Builds the release libraries for each feature set, reports their sizes
+# (cdylib, staticlib, and the staticlib's own object code) and runs
+# benches/footprint_bench.rs (cold start, engine init, typing) for each.
+#
+# Usage: ./scripts/footprint_bench.sh [--no-bench]
+
+set -e
+
+CORE_DIR="$(cd "$(dirname "$0")/../core" && pwd)"
+OUT_DIR="$CORE_DIR/target/footprint"
+RUN_BENCH=1
+[ "$1" = "--no-bench" ] && RUN_BENCH=0
+
+# name|cargo feature flags
+CONFIGS=(
+    "full|"
+    "no-dictionaries|--no-default-features --features english-detection,shortcuts,encoding,updater"
+    "minimal|--no-default-features"
+)
+
+case "$(uname -s)" in
+    Darwin) DYLIB_EXT="dylib" ;;
+    MINGW*|MSYS*|CYGWIN*) DYLIB_EXT="dll" ;;
+    *) DYLIB_EXT="so" ;;
+esac
+
+file_size() {
+    if [ -f "$1" ]; then
+        wc -c < "$1" | tr -d ' '
+    else
+        echo 0
+    fi
+}
+
+# Object code contributed by goxviet itself (std members excluded)
+own_object_size() {
+    local lib="$1"
+    command -v size >/dev/null 2>&1 || { echo "?"; return; }
+    size -t "$lib" 2>/dev/null | awk '/goxviet_core/ { sum += $4 } END { print sum + 0 }'
+}
+
+cd "$CORE_DIR"
+
+printf "\n%-16s %12s %12s %14s\n" "build" "cdylib" "staticlib" "own objects"
+for config in "${CONFIGS[@]}"; do
+    name="${config%%|*}"
+    flags="${config#*|}"
+    target="$OUT_DIR/$name"
+    # shellcheck disable=SC2086
+    cargo build --release --quiet --target-dir "$target" $flags
+    dylib="$(ls "$target"/release/*goxviet_core*."$DYLIB_EXT" 2>/dev/null | head -1)"
+    staticlib="$(ls "$target"/release/libgoxviet_core.a "$target"/release/goxviet_core.lib 2>/dev/null | head -1)"
+    printf "%-16s %12s %12s %14s\n" "$name" \
+        "$(file_size "$dylib")" "$(file_size "$staticlib")" "$(own_object_size "$staticlib")"
+done
+
+if [ "$RUN_BENCH" = 1 ]; then
+    for config in "${CONFIGS[@]}"; do
+        name="${config%%|*}"
+        flags="${config#*|}"
+        echo ""
+        echo "== $name =="
+        # shellcheck disable=SC2086
+        cargo bench --quiet --target-dir "$OUT_DIR/$name" $flags --bench footprint_bench
+    done
+fi
@@ -0,0 +1,165 @@
+#!/usr/bin/env python3
+"""Generate the embedded shortcode table used by `engine/features/shortcode.rs`.
+
+Output: core/src/engine/features/data/shortcodes.tsv
+Format: one `code<TAB>value` pair per line, sorted by the UTF-8 bytes of `code`.
+Codes only use [a-z0-9_+-] so they can be typed while the shortcode session
+is active. Names come from the Unicode database; hand-written aliases win
+over generated names.
+
+Usage: python3 scripts/generate_shortcodes.py
+"""
+
+import os
+import re
+import unicodedata
+
+OUTPUT = os.path.join(
+    os.path.dirname(__file__), "..", "core", "src", "engine", "features", "data", "shortcodes.tsv"
+)
+
+# Unicode blocks whose character names become shortcodes
+RANGES = [
+    (0x1F300, 0x1F5FF),  # Misc symbols and pictographs
+    (0x1F600, 0x1F64F),  # Emoticons
+    (0x1F680, 0x1F6FF),  # Transport and map
+    (0x1F900, 0x1F9FF),  # Supplemental symbols and pictographs
+    (0x1FA70, 0x1FAFF),  # Symbols and pictographs extended-A
+    (0x2600, 0x26FF),    # Misc symbols
+    (0x2700, 0x27BF),    # Dingbats
+    (0x2190, 0x21FF),    # Arrows
+    (0x2200, 0x22FF),    # Mathematical operators
+    (0x20A0, 0x20C0),    # Currency symbols
+    (0x2100, 0x214F),    # Letterlike symbols
+    (0x0391, 0x03C9),    # Greek letters
+    (0x00A1, 0x00BF),    # Latin-1 punctuation and symbols
+    (0x00D7, 0x00D7),
+    (0x00F7, 0x00F7),
+    (0x2010, 0x2044),    # General punctuation
+]
+
+# Common aliases (GitHub/Slack style) and Vietnamese symbols
+ALIASES = {
+    "+1": "\U0001F44D",
+    "-1": "\U0001F44E",
+    "100": "\U0001F4AF",
+    "thumbsup": "\U0001F44D",
+    "thumbsdown": "\U0001F44E",
+    "smile": "\U0001F604",
+    "smiley": "\U0001F603",
+    "grin": "\U0001F601",
+    "laughing": "\U0001F606",
+    "joy": "\U0001F602",
+    "rofl": "\U0001F923",
+    "wink": "\U0001F609",
+    "blush": "\U0001F60A",
+    "heart_eyes": "\U0001F60D",
+    "kissing_heart": "\U0001F618",
+    "sunglasses": "\U0001F60E",
+    "thinking": "\U0001F914",
+    "sob": "\U0001F62D",
+    "cry": "\U0001F622",
+    "angry": "\U0001F620",
+    "rage": "\U0001F621",
+    "scream": "\U0001F631",
+    "sweat_smile": "\U0001F605",
+    "upside_down": "\U0001F643",
+    "neutral": "\U0001F610",
+    "sleeping": "\U0001F634",
+    "heart": "❤️",
+    "broken_heart": "\U0001F494",
+    "fire": "\U0001F525",
+    "ok_hand": "\U0001F44C",
+    "pray": "\U0001F64F",
+    "clap": "\U0001F44F",
+    "wave": "\U0001F44B",
+    "muscle": "\U0001F4AA",
+    "raised_hands": "\U0001F64C",
+    "tada": "\U0001F389",
+    "rocket": "\U0001F680",
+    "eyes": "\U0001F440",
+    "star": "⭐",
+    "sparkles": "✨",
+    "check": "✔️",
+    "white_check_mark": "✅",
+    "x": "❌",
+    "warning": "⚠️",
+    "poop": "\U0001F4A9",
+    "skull": "\U0001F480",
+    "party": "\U0001F973",
+    "coffee": "☕",
+    "beer": "\U0001F37A",
+    "pizza": "\U0001F355",
+    "bug": "\U0001F41B",
+    "zap": "⚡",
+    "bulb": "\U0001F4A1",
+    "lock": "\U0001F512",
+    "memo": "\U0001F4DD",
+    "shrug": "\U0001F937",
+    "facepalm": "\U0001F926",
+    # Vietnamese
+    "dong": "₫",
+    "vnd": "₫",
+    "vn": "\U0001F1FB\U0001F1F3",
+    "flag_vn": "\U0001F1FB\U0001F1F3",
+    "vietnam": "\U0001F1FB\U0001F1F3",
+    "co_vn": "\U0001F1FB\U0001F1F3",
+    "pho": "\U0001F35C",
+    "banh_mi": "\U0001F956",
+    "ca_phe": "☕",
+    "tra_da": "\U0001F9CB",
+    "bao_li_xi": "\U0001F9E7",
+    "li_xi": "\U0001F9E7",
+    "hoa_dao": "\U0001F338",
+    "hoa_mai": "\U0001F33C",
+    "hoa_sen": "\U0001FAB7",
+    "tet": "\U0001F9E7",
+    "do": "°",
+    "do_c": "℃",
+    "so": "№",
+    "cong_tru": "±",
+    "nhan": "×",
+    "chia": "÷",
+    "khac": "≠",
+    "xap_xi": "≈",
+    "nho_bang": "≤",
+    "lon_bang": "≥",
+    "vo_cuc": "∞",
+    "mui_ten": "→",
+    "ngoac_kep_mo": "“",
+    "ngoac_kep_dong": "”",
+    "ba_cham": "…",
+    "gach_ngang": "–",
+}
+
+
+def code_from_name(name):
+    code = name.lower().replace(" ", "_").replace("-", "_")
+    code = re.sub(r"[^a-z0-9_]", "", code)
+    return re.sub(r"_+", "_", code).strip("_")
+
+
+def main():
+    table = dict(ALIASES)
+    for lo, hi in RANGES:
+        for cp in range(lo, hi + 1):
+            ch = chr(cp)
+            if unicodedata.category(ch) in ("Cn", "Mn", "Mc", "Me", "Cc", "Cf", "Zs"):
+                continue
+            name = unicodedata.name(ch, "")
+            if not name:
+                continue
+            code = code_from_name(name)
+            if code and code not in table:
+                table[code] = ch
+
+    entries = sorted(table.items(), key=lambda kv: kv[0].encode("utf-8"))
+    with open(OUTPUT, "w", encoding="utf-8", newline="\n") as f:
+        for code, value in entries:
+            assert "\t" not in value and "\n" not in value
+            f.write(f"{code}\t{value}\n")
+    print(f"Wrote {len(entries)} shortcodes to {os.path.normpath(OUTPUT)}")
+
+
+if __name__ == "__main__":
+    main()